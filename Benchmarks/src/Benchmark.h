@@ -0,0 +1,62 @@
+#pragma once
+#include "DLEngine/Core/Headless.h"
+
+#include "DLEngine/Utils/Timer.h"
+
+namespace DLEngine::Benchmarks
+{
+    struct BenchmarkContext
+    {
+        std::filesystem::path AssetsDir;
+    };
+
+    using BenchmarkFunc = void(const BenchmarkContext&);
+
+    // Runs func once to warm the caches up, then returns the fastest of the timed runs in milliseconds
+    template <typename Func>
+    float Measure(uint32_t runs, Func&& func)
+    {
+        func();
+
+        float bestMS{ std::numeric_limits<float>::max() };
+        for (uint32_t i{ 0u }; i < runs; ++i)
+        {
+            Timer timer{};
+            func();
+            bestMS = std::min(bestMS, timer.ElapsedMS());
+        }
+
+        return bestMS;
+    }
+
+    // Same as above for work that consumes its input, e.g. sorting in place. setup restores the input before every run and is not timed
+    template <typename SetupFunc, typename Func>
+    float Measure(uint32_t runs, SetupFunc&& setup, Func&& func)
+    {
+        setup();
+        func();
+
+        float bestMS{ std::numeric_limits<float>::max() };
+        for (uint32_t i{ 0u }; i < runs; ++i)
+        {
+            setup();
+
+            Timer timer{};
+            func();
+            bestMS = std::min(bestMS, timer.ElapsedMS());
+        }
+
+        return bestMS;
+    }
+
+    // Millions of items per second
+    inline float Throughput(size_t count, float elapsedMS) noexcept
+    {
+        return static_cast<float>(count) / (elapsedMS * 1.0e3f);
+    }
+}
+
+#define DL_BENCHMARK(name) \
+    DL_HEADLESS_ENTRY(::DLEngine::Benchmarks::BenchmarkFunc, name, [[maybe_unused]] const ::DLEngine::Benchmarks::BenchmarkContext& context)
+
+#define DL_BENCHMARK_LOG(...) DL_LOG_INFO_TAG("Benchmark", __VA_ARGS__)
@@ -0,0 +1,136 @@
+#include "BenchmarkScenes.h"
+
+#include "DLEngine/Core/Assert.h"
+
+#include "DLEngine/Utils/RandomStream.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#ifdef DL_DEBUG
+#pragma comment(lib, "assimp-vc143-mtd.lib")
+#else
+#pragma comment(lib, "assimp-vc143-mt.lib")
+#endif
+
+namespace DLEngine::Benchmarks
+{
+    std::vector<Submesh> LoadSubmeshes(const std::filesystem::path& path)
+    {
+        Assimp::Importer importer{};
+        const aiScene* assimpScene{ importer.ReadFile(path.string().c_str(), aiProcess_Triangulate | static_cast<uint32_t>(aiProcess_ConvertToLeftHanded)) };
+
+        DL_ASSERT(assimpScene, "Failed to load model '{}'", path.string().c_str());
+
+        std::vector<Submesh> submeshes;
+        submeshes.reserve(assimpScene->mNumMeshes);
+
+        for (uint32_t i{ 0u }; i < assimpScene->mNumMeshes; ++i)
+        {
+            const aiMesh* srcMesh{ assimpScene->mMeshes[i] };
+
+            std::vector<Submesh::Vertex> vertices(srcMesh->mNumVertices);
+            for (uint32_t v{ 0u }; v < srcMesh->mNumVertices; ++v)
+                vertices[v].Position = Math::Vec3{ srcMesh->mVertices[v].x, srcMesh->mVertices[v].y, srcMesh->mVertices[v].z };
+
+            std::vector<Submesh::Triangle> triangles;
+            triangles.reserve(srcMesh->mNumFaces);
+            for (uint32_t f{ 0u }; f < srcMesh->mNumFaces; ++f)
+            {
+                const aiFace& face{ srcMesh->mFaces[f] };
+                if (face.mNumIndices == 3u)
+                    triangles.push_back(Submesh::Triangle{ { face.mIndices[0], face.mIndices[1], face.mIndices[2] } });
+            }
+
+            submeshes.emplace_back(srcMesh->mName.C_Str(), std::move(vertices), std::move(triangles));
+        }
+
+        return submeshes;
+    }
+
+    Submesh CreateGridSubmesh(uint32_t resolution)
+    {
+        const uint32_t rowSize{ resolution + 1u };
+        const float step{ 2.0f / static_cast<float>(resolution) };
+
+        std::vector<Submesh::Vertex> vertices(rowSize * rowSize);
+        for (uint32_t z{ 0u }; z < rowSize; ++z)
+        {
+            for (uint32_t x{ 0u }; x < rowSize; ++x)
+            {
+                const float posX{ -1.0f + static_cast<float>(x) * step };
+                const float posZ{ -1.0f + static_cast<float>(z) * step };
+                const float height{ 0.1f * std::sin(posX * 7.0f) * std::cos(posZ * 5.0f) + 0.02f * std::sin(posX * 41.0f + posZ * 37.0f) };
+
+                vertices[z * rowSize + x].Position = Math::Vec3{ posX, height, posZ };
+            }
+        }
+
+        std::vector<Submesh::Triangle> triangles;
+        triangles.reserve(2u * resolution * resolution);
+        for (uint32_t z{ 0u }; z < resolution; ++z)
+        {
+            for (uint32_t x{ 0u }; x < resolution; ++x)
+            {
+                const uint32_t corner{ z * rowSize + x };
+                triangles.push_back(Submesh::Triangle{ { corner, corner + rowSize, corner + 1u } });
+                triangles.push_back(Submesh::Triangle{ { corner + 1u, corner + rowSize, corner + rowSize + 1u } });
+            }
+        }
+
+        return Submesh{ "GRID", std::move(vertices), std::move(triangles) };
+    }
+
+    std::vector<Math::Ray> CreateRays(const Math::AABB& target, uint32_t count, uint64_t seed)
+    {
+        const Math::Vec3 center{ (target.Min + target.Max) * 0.5f };
+        const Math::Vec3 extents{ (target.Max - target.Min) * 0.5f };
+        const float radius{ 2.0f * Math::Length(extents) };
+
+        RandomStream randomStream{ seed };
+
+        std::vector<Math::Vec3> origins(count);
+        randomStream.GenerateUnitVectors(origins);
+
+        std::vector<Math::Ray> rays(count);
+        for (uint32_t i{ 0u }; i < count; ++i)
+        {
+            const Math::Vec3 targetPoint{
+                center.x + extents.x * randomStream.GenerateFloat(-1.0f, 1.0f),
+                center.y + extents.y * randomStream.GenerateFloat(-1.0f, 1.0f),
+                center.z + extents.z * randomStream.GenerateFloat(-1.0f, 1.0f)
+            };
+
+            rays[i].Origin = center + origins[i] * radius;
+            rays[i].Direction = Math::Normalize(targetPoint - rays[i].Origin);
+        }
+
+        return rays;
+    }
+    std::vector<Math::Ray> CreateCameraRays(const Math::AABB& target, uint32_t width, uint32_t height)
+    {
+        const Math::Vec3 center{ (target.Min + target.Max) * 0.5f };
+        const Math::Vec3 extents{ (target.Max - target.Min) * 0.5f };
+        const float radius{ Math::Length(extents) };
+
+        // Looks along +Z from twice the radius, the image plane at the center covers the bounding sphere
+        const Math::Vec3 origin{ center.x, center.y, center.z - 2.0f * radius };
+
+        std::vector<Math::Ray> rays;
+        rays.reserve(static_cast<size_t>(width) * height);
+        for (uint32_t y{ 0u }; y < height; ++y)
+        {
+            for (uint32_t x{ 0u }; x < width; ++x)
+            {
+                const float u{ (static_cast<float>(x) + 0.5f) / static_cast<float>(width) * 2.0f - 1.0f };
+                const float v{ (static_cast<float>(y) + 0.5f) / static_cast<float>(height) * 2.0f - 1.0f };
+
+                const Math::Vec3 pixel{ center.x + u * radius, center.y - v * radius, center.z };
+                rays.push_back(Math::Ray{ .Origin = origin, .Direction = Math::Normalize(pixel - origin) });
+            }
+        }
+
+        return rays;
+    }
+}
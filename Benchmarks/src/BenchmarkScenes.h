@@ -0,0 +1,27 @@
+#pragma once
+#include "Benchmark.h"
+
+#include "DLEngine/Math/Primitives.h"
+
+#include "DLEngine/Renderer/Mesh/Mesh.h"
+
+namespace DLEngine::Benchmarks
+{
+    // Loads the triangles of every mesh in the file into standalone submeshes, no GPU resources are created
+    std::vector<Submesh> LoadSubmeshes(const std::filesystem::path& path);
+
+    // Bumpy heightfield of 2 * resolution^2 triangles over [-1, 1]^2, for sizes the sample assets do not reach
+    Submesh CreateGridSubmesh(uint32_t resolution);
+
+    // Incoherent rays from a sphere around the box towards random points inside it, reproducible from the seed
+    std::vector<Math::Ray> CreateRays(const Math::AABB& target, uint32_t count, uint64_t seed = 0u);
+
+    // Hit distances of two traversals of the same ray agree up to the rounding of a different test order, two misses agree as well
+    inline bool SameHitDistance(float t, float referenceT) noexcept
+    {
+        return t == referenceT || std::abs(t - referenceT) <= 1.0e-4f * std::min(t, referenceT);
+    }
+
+    // Coherent rays of a pinhole camera in front of the box covering it, row by row, like a picking grid
+    std::vector<Math::Ray> CreateCameraRays(const Math::AABB& target, uint32_t width, uint32_t height);
+}
@@ -0,0 +1,165 @@
+#include "Benchmark.h"
+
+#include "DLEngine/Core/solid_vector.h"
+
+#include "DLEngine/Math/Vec3.h"
+
+#include <random>
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr std::array<uint32_t, 2u> ELEMENTS_COUNTS{ 100'000u, 1'000'000u };
+
+        // A point light, the pass below fades the intensity and touches nothing else
+        struct Light
+        {
+            Math::Vec3 Position;
+            Math::Vec3 Color;
+            float Radius;
+            float Intensity;
+        };
+
+        constexpr float FADE{ 0.99f };
+
+        using LightRecords = solid_vector<Light>;
+        using LightColumns = solid_vector<Math::Vec3, Math::Vec3, float, float>;
+
+        constexpr size_t INTENSITY_COLUMN{ 3u };
+
+        std::vector<Light> CreateLights(uint32_t count)
+        {
+            std::vector<Light> lights(count);
+            for (uint32_t i{ 0u }; i < count; ++i)
+            {
+                const float value{ static_cast<float>(i) };
+                lights[i] = Light{ .Position = Math::Vec3{ value }, .Color = Math::Vec3{ 1.0f }, .Radius = 1.0f, .Intensity = 1.0f };
+            }
+
+            return lights;
+        }
+    }
+
+    // Lights kept in a solid_vector with one column per field against one column of whole records, and against the unordered_map
+    // the stable handles would otherwise come from. Half of the lights are erased in random order before the per-frame pass,
+    // the lookups go through the IDs of the survivors in random order
+    DL_BENCHMARK(SolidVector)
+    {
+        for (const uint32_t count : ELEMENTS_COUNTS)
+        {
+            const std::vector<Light> lights{ CreateLights(count) };
+
+            std::vector<Math::Vec3> positions(count), colors(count);
+            std::vector<float> radii(count), intensities(count);
+            for (uint32_t i{ 0u }; i < count; ++i)
+            {
+                positions[i] = lights[i].Position;
+                colors[i] = lights[i].Color;
+                radii[i] = lights[i].Radius;
+                intensities[i] = lights[i].Intensity;
+            }
+
+            // Spawn
+            LightColumns columns{};
+            const float insertMS{ Measure(RUNS_COUNT, [&columns] { columns = LightColumns{}; }, [&] {
+                for (uint32_t i{ 0u }; i < count; ++i)
+                    columns.insert(positions[i], colors[i], radii[i], intensities[i]);
+            }) };
+
+            std::vector<LightColumns::ID> ids{};
+            const float insertRangeMS{ Measure(RUNS_COUNT, [&columns] { columns = LightColumns{}; }, [&] {
+                ids = columns.insert_range(std::span<const Math::Vec3>{ positions }, std::span<const Math::Vec3>{ colors },
+                    std::span<const float>{ radii }, std::span<const float>{ intensities }
+                );
+            }) };
+
+            LightRecords records{};
+            std::vector<LightRecords::ID> recordIDs{ records.insert_range(std::span<const Light>{ lights }) };
+
+            std::unordered_map<uint32_t, Light> map{};
+            const float mapInsertMS{ Measure(RUNS_COUNT, [&map] { map = std::unordered_map<uint32_t, Light>{}; }, [&] {
+                for (uint32_t i{ 0u }; i < count; ++i)
+                    map.emplace(i, lights[i]);
+            }) };
+
+            DL_BENCHMARK_LOG("{0} lights, spawn: insert {1:.2f} ns, insert_range {2:.2f} ns, unordered_map {3:.2f} ns per light",
+                count, insertMS * 1.0e6f / static_cast<float>(count), insertRangeMS * 1.0e6f / static_cast<float>(count),
+                mapInsertMS * 1.0e6f / static_cast<float>(count)
+            );
+
+            // Half of the lights go, every run erases from a copy of the spawned containers
+            std::vector<uint32_t> order(count);
+            std::iota(order.begin(), order.end(), 0u);
+            std::ranges::shuffle(order, std::mt19937{ 0u });
+
+            const std::span<const uint32_t> erased{ order.data(), count / 2u };
+            const std::span<const uint32_t> kept{ order.data() + count / 2u, count - count / 2u };
+
+            const LightColumns spawnedColumns{ columns };
+            const float eraseMS{ Measure(RUNS_COUNT, [&] { columns = spawnedColumns; }, [&] {
+                for (const uint32_t i : erased)
+                    columns.erase(ids[i]);
+            }) };
+
+            const std::unordered_map<uint32_t, Light> spawnedMap{ map };
+            const float mapEraseMS{ Measure(RUNS_COUNT, [&] { map = spawnedMap; }, [&] {
+                for (const uint32_t i : erased)
+                    map.erase(i);
+            }) };
+
+            for (const uint32_t i : erased)
+                records.erase(recordIDs[i]);
+
+            DL_ASSERT(columns.size() == kept.size() && records.size() == kept.size() && map.size() == kept.size());
+
+            DL_BENCHMARK_LOG("{0} lights, erase of half: solid_vector {1:.2f} ns, unordered_map {2:.2f} ns per light",
+                count, eraseMS * 1.0e6f / static_cast<float>(erased.size()), mapEraseMS * 1.0e6f / static_cast<float>(erased.size())
+            );
+
+            // Per-frame pass over the survivors
+            const float columnPassMS{ Measure(RUNS_COUNT, [&] {
+                for (float& intensity : columns.column<INTENSITY_COLUMN>())
+                    intensity *= FADE;
+            }) };
+
+            const float recordPassMS{ Measure(RUNS_COUNT, [&] {
+                for (Light& light : records)
+                    light.Intensity *= FADE;
+            }) };
+
+            const float mapPassMS{ Measure(RUNS_COUNT, [&] {
+                for (Light& light : map | std::views::values)
+                    light.Intensity *= FADE;
+            }) };
+
+            const float columnForEachMS{ Measure(RUNS_COUNT, [&] {
+                columns.for_each(std::execution::par_unseq, [](const Math::Vec3&, const Math::Vec3&, float, float& intensity) { intensity *= FADE; });
+            }) };
+
+            const float keptCount{ static_cast<float>(kept.size()) };
+            DL_BENCHMARK_LOG("{0} lights, fade pass: intensity column {1:.2f} ns, whole records {2:.2f} ns, unordered_map {3:.2f} ns, "
+                "for_each over all the columns {4:.2f} ns per light",
+                kept.size(), columnPassMS * 1.0e6f / keptCount, recordPassMS * 1.0e6f / keptCount, mapPassMS * 1.0e6f / keptCount,
+                columnForEachMS * 1.0e6f / keptCount
+            );
+
+            // Random lookups by handle
+            float checksum{ 0.0f };
+            const float lookupMS{ Measure(RUNS_COUNT, [&] {
+                for (const uint32_t i : kept)
+                    checksum += columns.get<INTENSITY_COLUMN>(ids[i]);
+            }) };
+
+            const float mapLookupMS{ Measure(RUNS_COUNT, [&] {
+                for (const uint32_t i : kept)
+                    checksum += map.find(i)->second.Intensity;
+            }) };
+
+            DL_BENCHMARK_LOG("{0} lights, random lookup: solid_vector {1:.2f} ns, unordered_map {2:.2f} ns per light ({3:.2f}x), checksum {4}",
+                kept.size(), lookupMS * 1.0e6f / keptCount, mapLookupMS * 1.0e6f / keptCount, mapLookupMS / lookupMS, checksum
+            );
+        }
+    }
+}
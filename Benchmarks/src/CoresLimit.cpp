@@ -0,0 +1,85 @@
+#include "CoresLimit.h"
+
+#if defined(_WIN32)
+#include "DLEngine/Core/DLWin.h"
+#else
+#include <sched.h>
+#endif
+
+#include <bit>
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        // Only the first 64 cores are tracked, the limits measured never go past them
+        uint64_t GetProcessCoresMask() noexcept
+        {
+#if defined(_WIN32)
+            DWORD_PTR processMask{ 0u };
+            DWORD_PTR systemMask{ 0u };
+            GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+
+            return static_cast<uint64_t>(processMask);
+#else
+            cpu_set_t cpuSet{};
+            sched_getaffinity(0, sizeof(cpuSet), &cpuSet);
+
+            uint64_t mask{ 0u };
+            for (uint32_t core{ 0u }; core < 64u; ++core)
+                mask |= CPU_ISSET(core, &cpuSet) ? uint64_t{ 1u } << core : 0u;
+
+            return mask;
+#endif
+        }
+
+        void SetProcessCoresMask(uint64_t mask) noexcept
+        {
+#if defined(_WIN32)
+            SetProcessAffinityMask(GetCurrentProcess(), static_cast<DWORD_PTR>(mask));
+#else
+            cpu_set_t cpuSet{};
+            CPU_ZERO(&cpuSet);
+            for (uint32_t core{ 0u }; core < 64u; ++core)
+            {
+                if (mask & uint64_t{ 1u } << core)
+                    CPU_SET(core, &cpuSet);
+            }
+
+            sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+#endif
+        }
+    }
+
+    ScopedCoresLimit::ScopedCoresLimit(uint32_t coresCount) noexcept
+        : m_OriginalMask(GetProcessCoresMask())
+    {
+        uint64_t mask{ m_OriginalMask };
+        while (static_cast<uint32_t>(std::popcount(mask)) > coresCount)
+            mask &= ~(uint64_t{ 1u } << (std::bit_width(mask) - 1u));
+
+        SetProcessCoresMask(mask);
+    }
+
+    ScopedCoresLimit::~ScopedCoresLimit() noexcept
+    {
+        SetProcessCoresMask(m_OriginalMask);
+    }
+
+    uint32_t GetAvailableCoresCount() noexcept
+    {
+        return static_cast<uint32_t>(std::popcount(GetProcessCoresMask()));
+    }
+
+    std::vector<uint32_t> GetCoresCountsToMeasure(uint32_t maxCoresCount)
+    {
+        const uint32_t lastCoresCount{ std::max(std::min(GetAvailableCoresCount(), maxCoresCount), 1u) };
+
+        std::vector<uint32_t> coresCounts{};
+        for (uint32_t coresCount{ 1u }; coresCount < lastCoresCount; coresCount *= 2u)
+            coresCounts.push_back(coresCount);
+        coresCounts.push_back(lastCoresCount);
+
+        return coresCounts;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Benchmark.h"
+
+namespace DLEngine::Benchmarks
+{
+    // Restricts the process to the first coresCount cores of the original mask, which every
+    // worker of the parallel algorithms and the tasks they start inherits
+    class ScopedCoresLimit
+    {
+    public:
+        explicit ScopedCoresLimit(uint32_t coresCount) noexcept;
+        ~ScopedCoresLimit() noexcept;
+
+        ScopedCoresLimit(const ScopedCoresLimit&) = delete;
+        ScopedCoresLimit& operator=(const ScopedCoresLimit&) = delete;
+
+    private:
+        uint64_t m_OriginalMask{ 0u };
+    };
+
+    uint32_t GetAvailableCoresCount() noexcept;
+
+    // 1, 2, 4... up to maxCoresCount and the available cores, the last one included even if it is not a power of two
+    std::vector<uint32_t> GetCoresCountsToMeasure(uint32_t maxCoresCount = std::numeric_limits<uint32_t>::max());
+}
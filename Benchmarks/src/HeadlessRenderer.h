@@ -0,0 +1,129 @@
+#pragma once
+#include "Benchmark.h"
+
+#include "DLEngine/Renderer/Instance.h"
+#include "DLEngine/Renderer/InstanceStore.h"
+#include "DLEngine/Renderer/Material.h"
+
+// Stand-ins for the renderer objects the CPU side of the renderer uses, none of them needs a device
+namespace DLEngine::Benchmarks
+{
+    // Only the per-instance layouts, laid out as the dissolution shader has them. The instance store needs nothing else from a shader
+    class LayoutOnlyShader : public Shader
+    {
+    public:
+        LayoutOnlyShader()
+        {
+            m_InputLayout[1u] = { VertexBufferLayout{ { "TRANSFORM", ShaderDataType::Mat4 } }, InputLayoutType::PerInstance, 1u };
+            m_InputLayout[2u] = {
+                VertexBufferLayout{
+                    { "INSTANCE_UUID"       , ShaderDataType::Uint2 },
+                    { "DISSOLUTION_DURATION", ShaderDataType::Float },
+                    { "ELAPSED_TIME"        , ShaderDataType::Float }
+                },
+                InputLayoutType::PerInstance, 1u
+            };
+        }
+
+        const std::string& GetName() const noexcept override { return m_Name; }
+        const std::map<uint32_t, InputLayoutSpecification>& GetInputLayout() const noexcept override { return m_InputLayout; }
+
+    private:
+        std::string m_Name{ "LayoutOnly" };
+        std::map<uint32_t, InputLayoutSpecification> m_InputLayout;
+    };
+
+    // Only what the batch hash tables use, the materials are never bound
+    class HashOnlyMaterial : public Material
+    {
+    public:
+        explicit HashOnlyMaterial(uint32_t id, const Ref<Shader>& shader = nullptr)
+            : m_Shader(shader), m_Name(std::to_string(id)), m_Hash(std::hash<uint32_t>{}(id))
+        {}
+
+        void Set(const std::string&, const Ref<ConstantBuffer>&) noexcept override {}
+        void Set(const std::string&, const Ref<Texture2D>&) noexcept override {}
+        void Set(const std::string&, const Ref<TextureCube>&) noexcept override {}
+
+        void SetTextureView(const std::string&, const TextureViewSpecification&) noexcept override {}
+
+        bool HasSetConstantBuffer(const std::string&) const noexcept override { return false; }
+        bool HasSetTexture2D(const std::string&) const noexcept override { return false; }
+        bool HasSetTextureCube(const std::string&) const noexcept override { return false; }
+
+        Ref<ConstantBuffer> GetConstantBuffer(const std::string&) const noexcept override { return nullptr; }
+        Ref<Texture2D> GetTexture2D(const std::string&) const noexcept override { return nullptr; }
+        Ref<TextureCube> GetTextureCube(const std::string&) const noexcept override { return nullptr; }
+
+        const std::map<uint32_t, Ref<ConstantBuffer>>& GetConstantBuffers() const noexcept override { return m_ConstantBuffers; }
+        const std::unordered_map<uint32_t, uint8_t>& GetConstantBuffersShaderStages() const noexcept override { return m_ShaderStages; }
+
+        const std::map<uint32_t, Ref<Texture2D>>& GetTexture2Ds() const noexcept override { return m_Texture2Ds; }
+        const std::map<uint32_t, Ref<TextureCube>>& GetTextureCubes() const noexcept override { return m_TextureCubes; }
+        const std::unordered_map<uint32_t, TextureViewSpecification>& GetTextureViews() const noexcept override { return m_TextureViews; }
+        const std::unordered_map<uint32_t, uint8_t>& GetTextureShaderStages() const noexcept override { return m_ShaderStages; }
+
+        Ref<Shader> GetShader() const noexcept override { return m_Shader; }
+
+        const std::string& GetName() const noexcept override { return m_Name; }
+
+        std::size_t GetHash() const noexcept override { return m_Hash; }
+
+        bool operator==(const Material& other) const noexcept override { return m_Name == other.GetName(); }
+
+    private:
+        Ref<Shader> m_Shader;
+
+        std::string m_Name;
+        std::size_t m_Hash;
+
+        std::map<uint32_t, Ref<ConstantBuffer>> m_ConstantBuffers;
+        std::map<uint32_t, Ref<Texture2D>> m_Texture2Ds;
+        std::map<uint32_t, Ref<TextureCube>> m_TextureCubes;
+        std::unordered_map<uint32_t, TextureViewSpecification> m_TextureViews;
+        std::unordered_map<uint32_t, uint8_t> m_ShaderStages;
+    };
+
+    // Row of an instance store, as D3D11Instance is, but the store is given instead of taken from the renderer
+    class StoreInstance : public Instance
+    {
+    public:
+        explicit StoreInstance(const Ref<InstanceStore>& store)
+            : m_Store(store), m_ID(store->Allocate())
+        {}
+        ~StoreInstance() override
+        {
+            if (m_OwnsRow)
+                m_Store->Free(m_ID);
+        }
+
+        UniformHandle GetUniformHandle(const std::string& name) const noexcept override { return m_Store->GetUniformHandle(name); }
+
+        void Set(const std::string& name, const Buffer& buffer) noexcept override { Set(GetUniformHandle(name), buffer); }
+        void Set(UniformHandle handle, const Buffer& buffer) noexcept override { m_Store->Set(m_ID, handle, buffer); }
+
+        using Instance::Get;
+        const Buffer Get(const std::string& name) const noexcept override { return Get(GetUniformHandle(name)); }
+        const Buffer Get(UniformHandle handle) const noexcept override { return m_Store->Get(m_ID, handle); }
+
+        bool HasUniform(const std::string& name) const noexcept override { return m_Store->HasUniform(name); }
+
+        uint32_t GetTransformVersion() const noexcept override { return m_Store->GetTransformVersion(m_ID); }
+        uint32_t GetDataVersion() const noexcept override { return m_Store->GetDataVersion(m_ID); }
+
+        const Buffer GetLayoutData(uint32_t bindingPoint) const noexcept override { return m_Store->GetRow(m_ID, bindingPoint); }
+        Ref<Shader> GetShader() const noexcept override { return m_Store->GetShader(); }
+        const std::string& GetName() const noexcept override { return m_Name; }
+
+        const Ref<InstanceStore>& GetStore() const noexcept override { return m_Store; }
+        InstanceStore::ID GetStoreID() const noexcept override { return m_ID; }
+        void ReleaseRow() noexcept override { m_OwnsRow = false; }
+
+    private:
+        std::string m_Name{ "StoreInstance" };
+
+        Ref<InstanceStore> m_Store;
+        InstanceStore::ID m_ID;
+        bool m_OwnsRow{ true };
+    };
+}
@@ -0,0 +1,95 @@
+#include "Benchmark.h"
+
+#include "DLEngine/Math/BatchTransform.h"
+#include "DLEngine/Math/Intersections.h"
+#include "DLEngine/Math/Mat4A.h"
+#include "DLEngine/Math/Math.h"
+
+#include "DLEngine/Utils/RandomStream.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr uint32_t ELEMENTS_COUNT{ 1'000'000u };
+        constexpr float SCENE_SIZE{ 1000.0f };
+
+        std::vector<Math::Mat4x4> CreateTransforms(RandomStream& random)
+        {
+            std::vector<Math::Mat4x4> transforms(ELEMENTS_COUNT);
+            for (Math::Mat4x4& transform : transforms)
+            {
+                const Math::Vec3 axis{ Math::Normalize(Math::Vec3{ random.GenerateFloat(-1.0f, 1.0f), random.GenerateFloat(-1.0f, 1.0f), random.GenerateFloat(0.1f, 1.0f) }) };
+                const Math::Vec3 translation{ random.GenerateFloat(-SCENE_SIZE, SCENE_SIZE), random.GenerateFloat(-SCENE_SIZE, SCENE_SIZE), random.GenerateFloat(-SCENE_SIZE, SCENE_SIZE) };
+                transform = Math::Mat4x4::Rotate(axis, random.GenerateFloat(0.0f, Math::Numeric::Pi)) * Math::Mat4x4::Translate(translation);
+            }
+
+            return transforms;
+        }
+
+        void LogSpeedup(std::string_view kernel, float loopMS, float batchMS)
+        {
+            DL_BENCHMARK_LOG("{0}, {1} elements: Mat4A loop {2:.2f} ms ({3:.0f} M/s), batch kernel {4:.2f} ms ({5:.0f} M/s, {6:.2f}x)",
+                kernel, ELEMENTS_COUNT, loopMS, Throughput(ELEMENTS_COUNT, loopMS), batchMS, Throughput(ELEMENTS_COUNT, batchMS), loopMS / batchMS
+            );
+        }
+    }
+
+    // The batch kernels against the per element Mat4A loops they replaced in the registry and the scene, on the math backend
+    // the build selects. The cull compares the batch test against the single box one
+    DL_BENCHMARK(BatchTransform)
+    {
+        RandomStream random{ 7u };
+        const std::vector<Math::Mat4x4> transforms{ CreateTransforms(random) };
+        const std::vector<Math::Mat4x4> otherTransforms{ CreateTransforms(random) };
+        const Math::AABB submeshBox{ .Min = Math::Vec3{ -1.0f, -2.0f, -0.5f }, .Max = Math::Vec3{ 1.0f, 2.0f, 0.5f } };
+
+        std::vector<Math::AABB> meshBoxes(ELEMENTS_COUNT, submeshBox);
+        std::vector<Math::AABB> worldBoxes(ELEMENTS_COUNT);
+        std::vector<Math::Mat4x4> products(ELEMENTS_COUNT);
+
+        // The bounds of the instances of one submesh, UpdateInstanceBuffer
+        const float oneBoxLoopMS{ Measure(RUNS_COUNT, [&] {
+            for (uint32_t i{ 0u }; i < ELEMENTS_COUNT; ++i)
+                worldBoxes[i] = Math::Mat4A{ transforms[i] }.TransformAABB(submeshBox);
+        }) };
+        const float oneBoxBatchMS{ Measure(RUNS_COUNT, [&] { Math::TransformAABB(submeshBox, transforms, worldBoxes); }) };
+        LogSpeedup("One box, many matrices", oneBoxLoopMS, oneBoxBatchMS);
+
+        // The world bounds of the transform cache
+        const float boxesLoopMS{ Measure(RUNS_COUNT, [&] {
+            for (uint32_t i{ 0u }; i < ELEMENTS_COUNT; ++i)
+                worldBoxes[i] = Math::Mat4A{ transforms[i] }.TransformAABB(meshBoxes[i]);
+        }) };
+        const float boxesBatchMS{ Measure(RUNS_COUNT, [&] { Math::TransformAABBs(meshBoxes, transforms, worldBoxes); }) };
+        LogSpeedup("Box per matrix", boxesLoopMS, boxesBatchMS);
+
+        // The decal transforms composed with their parents
+        const float multiplyLoopMS{ Measure(RUNS_COUNT, [&] {
+            for (uint32_t i{ 0u }; i < ELEMENTS_COUNT; ++i)
+                products[i] = (Math::Mat4A{ transforms[i] } * Math::Mat4A{ otherTransforms[i] }).Store();
+        }) };
+        const float multiplyBatchMS{ Measure(RUNS_COUNT, [&] { Math::MultiplyMatrices(transforms, otherTransforms, products); }) };
+        LogSpeedup("Matrix products", multiplyLoopMS, multiplyBatchMS);
+
+        // A camera at the center of the scene culls the boxes placed above
+        Math::TransformAABB(submeshBox, transforms, worldBoxes);
+        const Math::Mat4x4 view{ Math::Mat4x4::LookTo(Math::Vec3{ 0.0f }, Math::Vec3{ 0.0f, 0.0f, 1.0f }, Math::Vec3{ 0.0f, 1.0f, 0.0f }) };
+        const Math::Frustum frustum{ Math::FrustumFromViewProjection(view * Math::Mat4x4::PerspectiveFov(Math::Numeric::Pi / 3.0f, 16.0f / 9.0f, 0.1f, SCENE_SIZE)) };
+
+        std::vector<uint32_t> visibleIndices(ELEMENTS_COUNT);
+        uint32_t loopVisibleCount{ 0u };
+        const float cullLoopMS{ Measure(RUNS_COUNT, [&] {
+            loopVisibleCount = 0u;
+            for (uint32_t i{ 0u }; i < ELEMENTS_COUNT; ++i)
+                if (Math::Intersects(frustum, worldBoxes[i]))
+                    visibleIndices[loopVisibleCount++] = i;
+        }) };
+
+        uint32_t batchVisibleCount{ 0u };
+        const float cullBatchMS{ Measure(RUNS_COUNT, [&] { batchVisibleCount = Math::Intersects(frustum, worldBoxes, visibleIndices); }) };
+        LogSpeedup("Frustum culling", cullLoopMS, cullBatchMS);
+        DL_BENCHMARK_LOG("Frustum culling kept {0} boxes one by one and {1} in the batch", loopVisibleCount, batchVisibleCount);
+    }
+}
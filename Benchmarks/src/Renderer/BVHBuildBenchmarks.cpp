@@ -0,0 +1,68 @@
+#include "Benchmark.h"
+#include "BenchmarkScenes.h"
+#include "CoresLimit.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 3u };
+        constexpr uint32_t GRID_RESOLUTION{ 1024u };
+
+        // Builds the submeshes one after another, or all at once the way Mesh::LoadFromFile does
+        float MeasureBuild(std::vector<Submesh>& submeshes, bool buildConcurrently)
+        {
+            return Measure(RUNS_COUNT, [&submeshes, buildConcurrently] {
+                if (buildConcurrently)
+                    std::for_each(std::execution::par, submeshes.begin(), submeshes.end(), [](Submesh& submesh) { submesh.UpdateBVH(); });
+                else
+                    std::ranges::for_each(submeshes, [](Submesh& submesh) { submesh.UpdateBVH(); });
+            });
+        }
+    }
+
+    // Build time of the parallel BVH builder with the process limited to 1, 2, 4... cores,
+    // for one large submesh and for all submeshes of a model built one by one and concurrently
+    DL_BENCHMARK(BVHBuildScaling)
+    {
+        std::vector<Submesh> grid;
+        grid.push_back(CreateGridSubmesh(GRID_RESOLUTION));
+
+        std::vector<Submesh> model{ LoadSubmeshes(context.AssetsDir / "models" / "samurai" / "samurai.fbx") };
+
+        const auto CountTriangles = [](const std::vector<Submesh>& submeshes)
+            {
+                return std::transform_reduce(submeshes.begin(), submeshes.end(), size_t{ 0u }, std::plus<>{},
+                    [](const Submesh& submesh) { return submesh.GetTriangles().size(); }
+                );
+            };
+
+        DL_BENCHMARK_LOG("Grid: {0} triangles, samurai: {1} submeshes, {2} triangles", CountTriangles(grid), model.size(), CountTriangles(model));
+
+        float gridSingleCoreMS{ 0.0f };
+        float modelSingleCoreMS{ 0.0f };
+        for (const uint32_t coresCount : GetCoresCountsToMeasure())
+        {
+            float gridMS{ 0.0f };
+            float modelSequentialMS{ 0.0f };
+            float modelConcurrentMS{ 0.0f };
+            {
+                const ScopedCoresLimit coresLimit{ coresCount };
+
+                gridMS = MeasureBuild(grid, false);
+                modelSequentialMS = MeasureBuild(model, false);
+                modelConcurrentMS = MeasureBuild(model, true);
+            }
+
+            if (coresCount == 1u)
+            {
+                gridSingleCoreMS = gridMS;
+                modelSingleCoreMS = modelConcurrentMS;
+            }
+
+            DL_BENCHMARK_LOG("{0} cores: grid {1:.1f} ms ({2:.2f}x), samurai one by one {3:.1f} ms, concurrently {4:.1f} ms ({5:.2f}x)",
+                coresCount, gridMS, gridSingleCoreMS / gridMS, modelSequentialMS, modelConcurrentMS, modelSingleCoreMS / modelConcurrentMS
+            );
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include "Benchmark.h"
+#include "BenchmarkScenes.h"
+
+#include "DLEngine/Math/Intersections.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr uint32_t RAYS_COUNT{ 1u << 16u };
+
+        constexpr std::array<std::string_view, 2u> MODELS{ "samurai/samurai.fbx", "flashlight/flashlight.fbx" };
+        constexpr std::array<uint32_t, 2u> GRID_RESOLUTIONS{ 256u, 1024u };
+
+        // The tree TriangleBVH builds before quantizing it, with full precision 32-byte nodes
+        struct FullBVH
+        {
+            std::vector<BVHNode> Nodes;
+            std::vector<uint32_t> TriangleIndices;
+
+            size_t GetMemoryUsage() const noexcept { return Nodes.size() * sizeof(BVHNode) + TriangleIndices.size() * sizeof(uint32_t); }
+        };
+
+        FullBVH BuildFullBVH(const Submesh& submesh)
+        {
+            const auto& triangles{ submesh.GetTriangles() };
+            const auto& vertices{ submesh.GetVertices() };
+
+            std::vector<BVHBuilder::Primitive> primitives(triangles.size());
+            for (size_t i{ 0u }; i < triangles.size(); ++i)
+            {
+                BVHBuilder::Primitive& primitive{ primitives[i] };
+                primitive.BoundingBox = BVHBuilder::EmptyAABB();
+                for (const uint32_t vertexIndex : triangles[i].Indices)
+                    BVHBuilder::Grow(primitive.BoundingBox, vertices[vertexIndex].Position);
+                primitive.Centroid = (primitive.BoundingBox.Min + primitive.BoundingBox.Max) * 0.5f;
+            }
+
+            FullBVH bvh{};
+            BVHBuilder::Build(primitives, TriangleBVH::MaxTrianglesPerLeaf, bvh.Nodes, bvh.TriangleIndices);
+            return bvh;
+        }
+
+        // Same ordered traversal as TriangleBVH, reading the bounds straight from the nodes instead of decoding them
+        bool Intersects(const FullBVH& bvh, const Submesh& submesh, const Math::Ray& ray, Math::IntersectInfo& outIntersectInfo)
+        {
+            const auto& triangles{ submesh.GetTriangles() };
+            const auto& vertices{ submesh.GetVertices() };
+
+            const Math::Vec3 invDirection{ 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z };
+
+            struct StackEntry
+            {
+                uint32_t NodeIndex;
+                float TNear;
+            };
+
+            std::array<StackEntry, BVHBuilder::MaxDepth> stack;
+            uint32_t stackSize{ 0u };
+
+            float rootTNear{ 0.0f };
+            if (bvh.Nodes.empty() || !bvh.Nodes[0u].Intersects(ray.Origin, invDirection, outIntersectInfo.T, rootTNear))
+                return false;
+
+            bool intersects{ false };
+            uint32_t nodeIndex{ 0u };
+
+            while (true)
+            {
+                const BVHNode& node{ bvh.Nodes[nodeIndex] };
+
+                if (node.IsLeaf())
+                {
+                    for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                    {
+                        const auto& triangle{ triangles[bvh.TriangleIndices[i]] };
+                        const Math::Triangle triangleToCheck{
+                            .V0 = vertices[triangle.Indices[0]].Position,
+                            .V1 = vertices[triangle.Indices[1]].Position,
+                            .V2 = vertices[triangle.Indices[2]].Position
+                        };
+
+                        intersects |= Math::Intersects(ray, triangleToCheck, outIntersectInfo);
+                    }
+                }
+                else
+                {
+                    uint32_t nearChild{ nodeIndex + 1u };
+                    uint32_t farChild{ node.Offset };
+
+                    float tNear{ 0.0f }, tFar{ 0.0f };
+                    const bool hitsNear{ bvh.Nodes[nearChild].Intersects(ray.Origin, invDirection, outIntersectInfo.T, tNear) };
+                    const bool hitsFar{ bvh.Nodes[farChild].Intersects(ray.Origin, invDirection, outIntersectInfo.T, tFar) };
+
+                    if (hitsNear && hitsFar)
+                    {
+                        if (tFar < tNear)
+                        {
+                            std::swap(nearChild, farChild);
+                            std::swap(tNear, tFar);
+                        }
+
+                        stack[stackSize++] = StackEntry{ .NodeIndex = farChild, .TNear = tFar };
+                        nodeIndex = nearChild;
+                        continue;
+                    }
+
+                    if (hitsNear || hitsFar)
+                    {
+                        nodeIndex = hitsNear ? nearChild : farChild;
+                        continue;
+                    }
+                }
+
+                while (stackSize > 0u && stack[stackSize - 1u].TNear > outIntersectInfo.T)
+                    --stackSize;
+
+                if (stackSize == 0u)
+                    break;
+
+                nodeIndex = stack[--stackSize].NodeIndex;
+            }
+
+            return intersects;
+        }
+
+        void BenchmarkSubmesh(const Submesh& submesh)
+        {
+            const size_t trianglesCount{ submesh.GetTriangles().size() };
+            if (trianglesCount == 0u)
+                return;
+
+            const TriangleBVH& compactBVH{ submesh.GetBVH() };
+            const FullBVH fullBVH{ BuildFullBVH(submesh) };
+
+            const std::vector<Math::Ray> rays{ CreateRays(submesh.GetBoundingBox(), RAYS_COUNT) };
+
+            std::vector<float> fullT(rays.size());
+            const float fullMS{ Measure(RUNS_COUNT, [&] {
+                for (size_t i{ 0u }; i < rays.size(); ++i)
+                {
+                    Math::IntersectInfo intersectInfo{};
+                    Intersects(fullBVH, submesh, rays[i], intersectInfo);
+                    fullT[i] = intersectInfo.T;
+                }
+            }) };
+
+            std::vector<float> compactT(rays.size());
+            const float compactMS{ Measure(RUNS_COUNT, [&] {
+                for (size_t i{ 0u }; i < rays.size(); ++i)
+                {
+                    Math::IntersectInfo intersectInfo{};
+                    uint32_t triangleIndex{ 0u };
+                    compactBVH.Intersects(submesh, rays[i], intersectInfo, triangleIndex);
+                    compactT[i] = intersectInfo.T;
+                }
+            }) };
+
+            const auto mismatchesCount{ std::ranges::count_if(std::views::iota(0u, static_cast<uint32_t>(rays.size())), [&](uint32_t i) {
+                return !SameHitDistance(compactT[i], fullT[i]);
+            }) };
+
+            const float triangles{ static_cast<float>(trianglesCount) };
+            const float fullBytesPerTriangle{ static_cast<float>(fullBVH.GetMemoryUsage()) / triangles };
+            const float compactBytesPerTriangle{ static_cast<float>(compactBVH.GetMemoryUsage()) / triangles };
+
+            DL_BENCHMARK_LOG("[{0}] {1} triangles, {2} nodes: full {3:.1f} bytes per triangle, compact {4:.1f} ({5:.0f}% less)",
+                submesh.GetName(), trianglesCount, fullBVH.Nodes.size(),
+                fullBytesPerTriangle, compactBytesPerTriangle, 100.0f * (1.0f - compactBytesPerTriangle / fullBytesPerTriangle)
+            );
+            DL_BENCHMARK_LOG("[{0}] full {1:.3f} Mrays/s, compact {2:.3f} Mrays/s ({3:+.0f}% query time), {4} rays disagree",
+                submesh.GetName(), Throughput(rays.size(), fullMS), Throughput(rays.size(), compactMS),
+                100.0f * (compactMS / fullMS - 1.0f), mismatchesCount
+            );
+        }
+    }
+
+    // Memory and closest-hit query time of the 16-byte quantized nodes against the same tree with 32-byte float nodes.
+    // Both walk the same tree the same way, the difference is the node size, the decoding and the looser quantized bounds
+    DL_BENCHMARK(CompactBVHLayout)
+    {
+        for (const std::string_view model : MODELS)
+        {
+            for (const Submesh& submesh : LoadSubmeshes(context.AssetsDir / "models" / model))
+                BenchmarkSubmesh(submesh);
+        }
+
+        for (const uint32_t resolution : GRID_RESOLUTIONS)
+            BenchmarkSubmesh(CreateGridSubmesh(resolution));
+    }
+}
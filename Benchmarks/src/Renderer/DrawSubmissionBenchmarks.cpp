@@ -0,0 +1,176 @@
+#include "Benchmark.h"
+#include "HeadlessRenderer.h"
+
+#include "DLEngine/Math/Distance.h"
+
+#include "DLEngine/Renderer/Mesh/MeshRegistry.h"
+
+#include "DLEngine/Utils/RandomGenerator.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 10u };
+        constexpr uint32_t INSTANCES_COUNT{ 100'000u };
+        constexpr float SCENE_SIZE{ 1000.0f };
+
+        struct BatchLayout
+        {
+            uint32_t MeshesCount;
+            uint32_t SubmeshesPerMesh;
+            uint32_t MaterialsPerSubmesh;
+            uint32_t MaterialsCount;
+        };
+
+        // A few large batches and many small ones, the instances of a batch share one instanced draw
+        constexpr std::array<BatchLayout, 2u> BATCH_LAYOUTS{
+            BatchLayout{ .MeshesCount = 250u, .SubmeshesPerMesh = 2u, .MaterialsPerSubmesh = 2u, .MaterialsCount = 64u },
+            BatchLayout{ .MeshesCount = 3125u, .SubmeshesPerMesh = 2u, .MaterialsPerSubmesh = 4u, .MaterialsCount = 256u }
+        };
+
+        // The batches of one shader held in the nested hash tables of the registry, every instance left visible,
+        // and the flat list of them the registry builds
+        struct DrawBatches
+        {
+            MeshRegistry::MeshBatch MeshBatch;
+            std::vector<MeshRegistry::DrawBatch> FlatBatches;
+        };
+
+        DrawBatches CreateDrawBatches(const BatchLayout& layout)
+        {
+            std::vector<Ref<Material>> materials(layout.MaterialsCount);
+            for (uint32_t i{ 0u }; i < layout.MaterialsCount; ++i)
+                materials[i] = CreateRef<HashOnlyMaterial>(i);
+
+            const uint32_t batchesCount{ layout.MeshesCount * layout.SubmeshesPerMesh * layout.MaterialsPerSubmesh };
+            const uint32_t instancesPerBatch{ INSTANCES_COUNT / batchesCount };
+
+            DrawBatches drawBatches{};
+            std::unordered_map<Ref<Material>, uint32_t> materialIDs{};
+            for (uint32_t meshID{ 0u }; meshID < layout.MeshesCount; ++meshID)
+            {
+                const Ref<Mesh> mesh{ CreateRef<Mesh>() };
+                MeshRegistry::SubmeshBatch& submeshBatch{ drawBatches.MeshBatch.SubmeshBatches[mesh] };
+                submeshBatch.MaterialBatches.resize(layout.SubmeshesPerMesh);
+
+                for (uint32_t submeshIndex{ 0u }; submeshIndex < layout.SubmeshesPerMesh; ++submeshIndex)
+                {
+                    for (uint32_t i{ 0u }; i < layout.MaterialsPerSubmesh; ++i)
+                    {
+                        const Ref<Material>& material{ materials[(meshID * 7u + submeshIndex * 3u + i) % layout.MaterialsCount] };
+                        MeshRegistry::InstanceBatch& instanceBatch{ submeshBatch.MaterialBatches[submeshIndex].InstanceBatches[material] };
+
+                        instanceBatch.WorldBoundingBoxes.resize(instancesPerBatch);
+                        for (Math::AABB& boundingBox : instanceBatch.WorldBoundingBoxes)
+                        {
+                            const Math::Vec3 center{
+                                RandomGenerator::GenerateRandom<float>(-SCENE_SIZE, SCENE_SIZE),
+                                RandomGenerator::GenerateRandom<float>(-SCENE_SIZE, SCENE_SIZE),
+                                RandomGenerator::GenerateRandom<float>(-SCENE_SIZE, SCENE_SIZE)
+                            };
+                            boundingBox = Math::AABB{ .Min = center - Math::Vec3{ 1.0f }, .Max = center + Math::Vec3{ 1.0f } };
+                        }
+
+                        instanceBatch.VisibleInstances.resize(instancesPerBatch);
+                        std::iota(instanceBatch.VisibleInstances.begin(), instanceBatch.VisibleInstances.end(), 0u);
+                        instanceBatch.VisibleInstanceCount = instancesPerBatch;
+
+                        // Recorded by the cull of a view at the origin
+                        instanceBatch.NearestVisibleDistanceSquared = Math::MinDistanceSquared(Math::Vec3{ 0.0f }, instanceBatch.WorldBoundingBoxes, instanceBatch.VisibleInstances);
+
+                        drawBatches.FlatBatches.emplace_back(MeshRegistry::DrawBatch{
+                            .SourceMesh = mesh,
+                            .SubmeshIndex = submeshIndex,
+                            .SourceMaterial = material,
+                            .Batch = &instanceBatch,
+                            .MeshID = meshID,
+                            .MaterialID = materialIDs.try_emplace(material, static_cast<uint32_t>(materialIDs.size())).first->second
+                        });
+                    }
+                }
+            }
+
+            return drawBatches;
+        }
+
+        struct SubmitResult
+        {
+            uint32_t DrawsCount{ 0u };
+            uint32_t MaterialBindsCount{ 0u };
+            uint32_t InstancesCount{ 0u };
+        };
+    }
+
+    // Per-frame submission of 100k visible instances of one shader: the walk of the nested batch hash tables the draws were submitted from
+    // before the draw list, against building the sorted draw list and walking it. The submission records the draws and the material binds
+    // instead of issuing them, the culling before it, nearest distances included, is the same for both
+    DL_BENCHMARK(DrawSubmission)
+    {
+        for (const BatchLayout& layout : BATCH_LAYOUTS)
+        {
+            const DrawBatches drawBatches{ CreateDrawBatches(layout) };
+
+            // Every batch bound its material
+            SubmitResult nestedResult{};
+            const float nestedMS{ Measure(RUNS_COUNT, [&] {
+                nestedResult = SubmitResult{};
+                for (const auto& submeshBatch : drawBatches.MeshBatch.SubmeshBatches | std::views::values)
+                {
+                    for (const MeshRegistry::MaterialBatch& materialBatch : submeshBatch.MaterialBatches)
+                    {
+                        for (const MeshRegistry::InstanceBatch& instanceBatch : materialBatch.InstanceBatches | std::views::values)
+                        {
+                            if (instanceBatch.VisibleInstanceCount == 0u)
+                                continue;
+
+                            ++nestedResult.MaterialBindsCount;
+                            ++nestedResult.DrawsCount;
+                            nestedResult.InstancesCount += instanceBatch.VisibleInstanceCount;
+                        }
+                    }
+                }
+            }) };
+
+            MeshRegistry::DrawList drawList{};
+            std::vector<uint64_t> sortKeysScratch{};
+            std::vector<const MeshRegistry::DrawBatch*> drawsScratch{};
+
+            SubmitResult drawListResult{};
+            const float drawListMS{ Measure(RUNS_COUNT, [&] {
+                MeshRegistry::BuildDrawList(drawBatches.FlatBatches, drawList, sortKeysScratch, drawsScratch);
+
+                drawListResult = SubmitResult{};
+                uint32_t boundMaterialID{ std::numeric_limits<uint32_t>::max() };
+                for (const MeshRegistry::DrawBatch* drawBatch : drawList.Draws)
+                {
+                    if (boundMaterialID != drawBatch->MaterialID)
+                    {
+                        ++drawListResult.MaterialBindsCount;
+                        boundMaterialID = drawBatch->MaterialID;
+                    }
+
+                    ++drawListResult.DrawsCount;
+                    drawListResult.InstancesCount += drawBatch->Batch->VisibleInstanceCount;
+                }
+            }) };
+
+            // The depth order costs the cull a scan of the boxes it has just tested, timed here on its own
+            const float distancesMS{ Measure(RUNS_COUNT, [&] {
+                for (const MeshRegistry::DrawBatch& drawBatch : drawBatches.FlatBatches)
+                {
+                    MeshRegistry::InstanceBatch& instanceBatch{ *drawBatch.Batch };
+                    instanceBatch.NearestVisibleDistanceSquared = Math::MinDistanceSquared(Math::Vec3{ 0.0f }, instanceBatch.WorldBoundingBoxes, instanceBatch.VisibleInstances);
+                }
+            }) };
+
+            DL_BENCHMARK_LOG("{0} instances in {1} batches: nested hash tables {2:.3f} ms ({3} material binds), "
+                "sorted draw list {4:.3f} ms ({5} material binds, {6:.2f}x), {7} and {8} draws, {9} and {10} instances. "
+                "Nearest distances recorded by the cull {11:.3f} ms",
+                INSTANCES_COUNT, drawBatches.FlatBatches.size(), nestedMS, nestedResult.MaterialBindsCount,
+                drawListMS, drawListResult.MaterialBindsCount, nestedMS / drawListMS,
+                nestedResult.DrawsCount, drawListResult.DrawsCount, nestedResult.InstancesCount, drawListResult.InstancesCount, distancesMS
+            );
+        }
+    }
+}
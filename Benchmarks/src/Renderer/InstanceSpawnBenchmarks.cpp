@@ -0,0 +1,117 @@
+#include "Benchmark.h"
+#include "BenchmarkScenes.h"
+#include "HeadlessRenderer.h"
+
+#include "DLEngine/Math/Mat4x4.h"
+
+#include "DLEngine/Renderer/Mesh/MeshRegistry.h"
+
+#include "DLEngine/Utils/RandomGenerator.h"
+
+#include <optional>
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 3u };
+        constexpr std::array<uint32_t, 3u> INSTANCES_COUNTS{ 10'000u, 100'000u, 1'000'000u };
+        constexpr uint32_t MATERIALS_COUNT{ 16u };
+        constexpr float SCENE_SIZE{ 1000.0f };
+
+        // The scan AddSubmesh did before the reverse index is quadratic, beyond this it takes minutes
+        constexpr uint32_t MAX_SCANNED_INSTANCES_COUNT{ 10'000u };
+
+        // Instances of one mesh spawned in runs of the same material, as a spawner places them
+        std::vector<MeshRegistry::SubmeshEntry> CreateSpawnEntries(uint32_t count, const Ref<InstanceStore>& store)
+        {
+            const Ref<Mesh> mesh{ CreateRef<Mesh>("GRID", std::vector<Submesh>{ CreateGridSubmesh(4u) }) };
+
+            std::vector<Ref<Material>> materials(MATERIALS_COUNT);
+            for (uint32_t i{ 0u }; i < MATERIALS_COUNT; ++i)
+                materials[i] = CreateRef<HashOnlyMaterial>(i, store->GetShader());
+
+            const UniformHandle transformHandle{ store->GetUniformHandle("TRANSFORM") };
+
+            std::vector<MeshRegistry::SubmeshEntry> entries(count);
+            for (uint32_t i{ 0u }; i < count; ++i)
+            {
+                const Math::Mat4x4 transform{ Math::Mat4x4::Translate(Math::Vec3{
+                    RandomGenerator::GenerateRandom<float>(-SCENE_SIZE, SCENE_SIZE),
+                    RandomGenerator::GenerateRandom<float>(-SCENE_SIZE, SCENE_SIZE),
+                    RandomGenerator::GenerateRandom<float>(-SCENE_SIZE, SCENE_SIZE)
+                }) };
+
+                const Ref<Instance> instance{ CreateRef<StoreInstance>(store) };
+                instance->Set(transformHandle, Buffer{ &transform, sizeof(Math::Mat4x4) });
+
+                entries[i] = MeshRegistry::SubmeshEntry{
+                    .SourceMesh = mesh,
+                    .SubmeshIndex = 0u,
+                    .SourceMaterial = materials[static_cast<uint64_t>(i) * MATERIALS_COUNT / count],
+                    .SubmeshInstance = instance
+                };
+            }
+
+            return entries;
+        }
+    }
+
+    // Spawning instances of one mesh into an empty registry: AddSubmesh for every instance against one AddSubmeshes call.
+    // For the smallest count also the duplicate lookup AddSubmesh did before the reverse instance index, a scan of every registered instance
+    DL_BENCHMARK(InstanceSpawn)
+    {
+        const Ref<InstanceStore> store{ CreateRef<InstanceStore>(CreateRef<LayoutOnlyShader>()) };
+
+        for (const uint32_t count : INSTANCES_COUNTS)
+        {
+            std::vector<MeshRegistry::SubmeshEntry> entries{};
+
+            // The registry takes the rows of the instances it registers, so every run gets a new registry and new instances, untimed
+            std::optional<MeshRegistry> registry{};
+            const auto ResetRegistry = [&] { registry.reset(); registry.emplace(); entries = CreateSpawnEntries(count, store); };
+
+            uint32_t oneByOneUUIDsCount{ 0u };
+            const float oneByOneMS{ Measure(RUNS_COUNT, ResetRegistry, [&] {
+                oneByOneUUIDsCount = 0u;
+                for (const MeshRegistry::SubmeshEntry& entry : entries)
+                    oneByOneUUIDsCount += registry->AddSubmesh(entry.SourceMesh, entry.SubmeshIndex, entry.SourceMaterial, entry.SubmeshInstance) != 0u ? 1u : 0u;
+            }) };
+
+            uint32_t bulkUUIDsCount{ 0u };
+            const float bulkMS{ Measure(RUNS_COUNT, ResetRegistry, [&] {
+                const std::vector<MeshRegistry::MeshUUID> uuids{ registry->AddSubmeshes(entries) };
+                bulkUUIDsCount = static_cast<uint32_t>(std::ranges::count_if(uuids, [](MeshRegistry::MeshUUID uuid) { return uuid != 0u; }));
+            }) };
+
+            DL_BENCHMARK_LOG("{0} instances: AddSubmesh {1:.1f} ms ({2:.0f} ns per instance), AddSubmeshes {3:.1f} ms ({4:.0f} ns per instance, {5:.2f}x), "
+                "{6} and {7} registered",
+                count, oneByOneMS, oneByOneMS * 1.0e6f / static_cast<float>(count), bulkMS, bulkMS * 1.0e6f / static_cast<float>(count),
+                oneByOneMS / bulkMS, oneByOneUUIDsCount, bulkUUIDsCount
+            );
+
+            if (count > MAX_SCANNED_INSTANCES_COUNT)
+                continue;
+
+            // Only the lookup, every instance is new, so each one scans all the instances registered before it
+            std::unordered_map<MeshRegistry::MeshUUID, Ref<Instance>> uuidToInstance{};
+            uint32_t foundCount{ 0u };
+            const float scanMS{ Measure(1u, [&uuidToInstance] { uuidToInstance.clear(); }, [&] {
+                foundCount = 0u;
+                for (const MeshRegistry::SubmeshEntry& entry : entries)
+                {
+                    const auto it{ std::find_if(std::execution::par_unseq, uuidToInstance.begin(), uuidToInstance.end(),
+                        [&entry](const auto& pair) { return pair.second == entry.SubmeshInstance; }
+                    ) };
+                    foundCount += it != uuidToInstance.end() ? 1u : 0u;
+
+                    uuidToInstance.emplace(RandomGenerator::GenerateRandom<MeshRegistry::MeshUUID>(), entry.SubmeshInstance);
+                }
+            }) };
+
+            DL_BENCHMARK_LOG("{0} instances: the previous duplicate scan alone {1:.1f} ms ({2:.0f} ns per instance), {3} duplicates",
+                count, scanMS, scanMS * 1.0e6f / static_cast<float>(count), foundCount
+            );
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "Benchmark.h"
+#include "BenchmarkScenes.h"
+
+#include "DLEngine/Math/Intersections.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr uint32_t IMAGE_SIZE{ 256u };
+
+        constexpr std::array<std::string_view, 2u> MODELS{ "samurai/samurai.fbx", "flashlight/flashlight.fbx" };
+
+        void BenchmarkRays(const Submesh& submesh, std::string_view raysName, std::span<const Math::Ray> rays)
+        {
+            std::vector<Submesh::IntersectInfo> singleIntersectInfos(rays.size());
+            const float singleMS{ Measure(RUNS_COUNT, [&] {
+                for (size_t i{ 0u }; i < rays.size(); ++i)
+                {
+                    singleIntersectInfos[i] = Submesh::IntersectInfo{};
+                    Math::Intersects(rays[i], submesh, singleIntersectInfos[i]);
+                }
+            }) };
+
+            std::vector<Submesh::IntersectInfo> packetIntersectInfos(rays.size());
+            uint32_t hitsCount{ 0u };
+            const float packetMS{ Measure(RUNS_COUNT, [&] {
+                std::ranges::fill(packetIntersectInfos, Submesh::IntersectInfo{});
+                hitsCount = Math::Intersects(rays, submesh, packetIntersectInfos);
+            }) };
+
+            // Both paths must find the same closest triangle
+            const auto mismatchesCount{ std::ranges::count_if(std::views::iota(0u, static_cast<uint32_t>(rays.size())), [&](uint32_t i) {
+                return !SameHitDistance(packetIntersectInfos[i].TriangleIntersectInfo.T, singleIntersectInfos[i].TriangleIntersectInfo.T);
+            }) };
+
+            const float singleThroughput{ Throughput(rays.size(), singleMS) };
+            const float packetThroughput{ Throughput(rays.size(), packetMS) };
+
+            DL_BENCHMARK_LOG("[{0}] {1} rays: single {2:.3f} Mrays/s, packets {3:.3f} Mrays/s ({4:.2f}x), {5}/{6} rays hit, {7} disagree",
+                submesh.GetName(), raysName, singleThroughput, packetThroughput, packetThroughput / singleThroughput,
+                hitsCount, rays.size(), mismatchesCount
+            );
+        }
+
+        void BenchmarkSubmesh(const Submesh& submesh)
+        {
+            if (submesh.GetTriangles().empty())
+                return;
+
+            BenchmarkRays(submesh, "camera", CreateCameraRays(submesh.GetBoundingBox(), IMAGE_SIZE, IMAGE_SIZE));
+            BenchmarkRays(submesh, "random", CreateRays(submesh.GetBoundingBox(), IMAGE_SIZE * IMAGE_SIZE));
+        }
+    }
+
+    // Throughput of the 4-wide packet traversal against tracing the same rays one by one,
+    // for coherent camera rays where packets pay off and for incoherent rays where they diverge
+    DL_BENCHMARK(RayPacketTraversal)
+    {
+        for (const std::string_view model : MODELS)
+        {
+            for (const Submesh& submesh : LoadSubmeshes(context.AssetsDir / "models" / model))
+                BenchmarkSubmesh(submesh);
+        }
+
+        BenchmarkSubmesh(CreateGridSubmesh(512u));
+    }
+}
@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+
+#include "DLEngine/Renderer/SmokeParticlePool.h"
+#include "DLEngine/Utils/RandomStream.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 10u };
+        constexpr std::array<uint32_t, 2u> PARTICLES_COUNTS{ 100'000u, 1'000'000u };
+
+        // Particles live for up to two seconds and start at a random point of their lives, about one in twenty expires every frame
+        constexpr float FRAME_TIME_MS{ 16.0f };
+        constexpr float MAX_LIFETIME_MS{ 2000.0f };
+
+        std::vector<SmokeParticle> CreateParticles(uint32_t count)
+        {
+            RandomStream random{};
+
+            std::vector<Math::Vec3> positions(count), velocities(count);
+            random.GeneratePointsInSphere(positions, 10.0f);
+            random.GeneratePointsInSphere(velocities, 1.0f);
+
+            std::vector<float> lifetimes(count), lifetimeFractions(count), rotations(count);
+            random.GenerateFloats(lifetimes, 0.0f, MAX_LIFETIME_MS);
+            random.GenerateFloats(lifetimeFractions, 0.0f, 1.0f);
+            random.GenerateFloats(rotations, -Math::Numeric::Pi, Math::Numeric::Pi);
+
+            std::vector<SmokeParticle> particles(count);
+            for (uint32_t i{ 0u }; i < count; ++i)
+            {
+                particles[i] = SmokeParticle{
+                    .Position = positions[i],
+                    .VelocityPerSecond = velocities[i],
+                    .Rotation = rotations[i],
+                    .LifetimeMS = lifetimes[i],
+                    .LifetimePassedMS = lifetimes[i] * lifetimeFractions[i]
+                };
+            }
+
+            return particles;
+        }
+
+        // What UpdateSmokeEmitters did before the particles moved to SmokeParticlePool
+        void UpdateArrayOfStructs(std::vector<SmokeParticle>& particles, DeltaTime dt)
+        {
+            particles.erase(std::remove_if(std::execution::par_unseq, particles.begin(), particles.end(),
+                [dt](SmokeParticle& particle)
+                {
+                    particle.LifetimePassedMS += dt;
+                    particle.Position += particle.VelocityPerSecond * dt.GetSeconds();
+                    return particle.LifetimePassedMS > particle.LifetimeMS;
+                }),
+                particles.end()
+            );
+        }
+
+        bool SamePosition(const Math::Vec3& position, const Math::Vec3& referencePosition) noexcept
+        {
+            // The pool integrates with a fused multiply-add, which rounds once instead of twice
+            return Math::Length(position - referencePosition) <= 1.0e-5f * std::max(Math::Length(referencePosition), 1.0f);
+        }
+    }
+
+    // One frame of the smoke particle update: the structure of arrays pool against the array of structs it replaced
+    DL_BENCHMARK(SmokeParticleUpdate)
+    {
+#if defined(DL_MATH_BACKEND_AVX2)
+        DL_BENCHMARK_LOG("SmokeParticlePool with the AVX2 backend, eight particles per packet");
+#else
+        DL_BENCHMARK_LOG("SmokeParticlePool with the DirectXMath backend, four particles per packet");
+#endif
+
+        const DeltaTime dt{ FRAME_TIME_MS };
+
+        for (const uint32_t count : PARTICLES_COUNTS)
+        {
+            const std::vector<SmokeParticle> particles{ CreateParticles(count) };
+
+            std::vector<SmokeParticle> arrayOfStructs;
+            const float arrayOfStructsMS{ Measure(RUNS_COUNT,
+                [&] { arrayOfStructs = particles; },
+                [&] { UpdateArrayOfStructs(arrayOfStructs, dt); }
+            ) };
+
+            SmokeParticlePool pool{};
+            const float poolMS{ Measure(RUNS_COUNT,
+                [&] {
+                    pool.Clear();
+                    pool.Append(particles);
+                },
+                [&] { pool.Update(dt); }
+            ) };
+
+            // Both keep the survivors in order, so they have to agree particle by particle
+            size_t mismatchesCount{ std::max<size_t>(arrayOfStructs.size(), pool.GetSize()) };
+            if (arrayOfStructs.size() == pool.GetSize())
+            {
+                mismatchesCount = 0u;
+                for (uint32_t i{ 0u }; i < pool.GetSize(); ++i)
+                {
+                    const SmokeParticle& reference{ arrayOfStructs[i] };
+                    if (!SamePosition(pool.GetPosition(i), reference.Position) || pool.GetLifetimePassedMS(i) != reference.LifetimePassedMS ||
+                        pool.GetLifetimeMS(i) != reference.LifetimeMS || pool.GetRotation(i) != reference.Rotation)
+                        ++mismatchesCount;
+                }
+            }
+
+            DL_BENCHMARK_LOG("{0} particles, {1} survive: array of structs {2:.3f} ms, pool {3:.3f} ms ({4:.2f}x), {5} particles differ",
+                count, pool.GetSize(), arrayOfStructsMS, poolMS, arrayOfStructsMS / poolMS, mismatchesCount
+            );
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include "Benchmark.h"
+
+#include "DLEngine/Math/Math.h"
+#include "DLEngine/Math/Vec3.h"
+
+#include "DLEngine/Utils/RadixSort.h"
+#include "DLEngine/Utils/RandomStream.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr std::array<uint32_t, 2u> PARTICLES_COUNTS{ 100'000u, 1'000'000u };
+        constexpr uint32_t FRAMES_COUNT{ 60u };
+        constexpr float FRAME_TIME_S{ 1.0f / 60.0f };
+
+        constexpr float CAMERA_ORBIT_RADIUS{ 40.0f };
+        constexpr float SMOKE_RADIUS{ 10.0f };
+
+        // The camera orbits the smoke while the particles rise with some random drift
+        struct Motion
+        {
+            std::string_view Name;
+            float CameraDegreesPerFrame;
+            float RiseSpeed;
+        };
+
+        // From an almost still picture, where last frame order nearly holds, to the usual rising smoke,
+        // where the particles of a dense cloud pass each other every frame
+        constexpr std::array<Motion, 5u> MOTIONS{
+            Motion{ .Name = "still camera, still smoke", .CameraDegreesPerFrame = 0.0f, .RiseSpeed = 0.0f },
+            Motion{ .Name = "camera turning 0.001 degrees per frame, still smoke", .CameraDegreesPerFrame = 0.001f, .RiseSpeed = 0.0f },
+            Motion{ .Name = "camera turning 0.1 degrees per frame, still smoke", .CameraDegreesPerFrame = 0.1f, .RiseSpeed = 0.0f },
+            Motion{ .Name = "camera turning 1 degree per frame, rising smoke", .CameraDegreesPerFrame = 1.0f, .RiseSpeed = 1.0f },
+            Motion{ .Name = "camera turning 5 degrees per frame, rising smoke", .CameraDegreesPerFrame = 5.0f, .RiseSpeed = 1.0f }
+        };
+
+        // Same settings as the incremental smoke particle sort of the scene
+        constexpr size_t MAX_DISPLACEMENT{ 64u };
+        constexpr float MAX_SHIFTS_PER_PARTICLE{ 4.0f };
+        constexpr uint32_t RETRY_DELAY_FRAMES{ 8u };
+
+        struct SmokeCloud
+        {
+            std::vector<Math::Vec3> Positions;
+            std::vector<Math::Vec3> Velocities;
+        };
+
+        SmokeCloud CreateSmokeCloud(uint32_t count, float riseSpeed)
+        {
+            RandomStream random{};
+
+            SmokeCloud cloud{ .Positions = std::vector<Math::Vec3>(count), .Velocities = std::vector<Math::Vec3>(count) };
+            random.GeneratePointsInSphere(cloud.Positions, SMOKE_RADIUS);
+            random.GeneratePointsInSphere(cloud.Velocities, riseSpeed * 0.5f);
+
+            for (Math::Vec3& velocity : cloud.Velocities)
+                velocity.y += riseSpeed;
+
+            return cloud;
+        }
+
+        // Negated distance to the camera plane of every particle, the same key SortSmokeParticles uses
+        void ComputeSortKeys(const SmokeCloud& cloud, uint32_t frame, float degreesPerFrame, std::vector<float>& outKeys)
+        {
+            const float angle{ Math::ToRadians(degreesPerFrame * static_cast<float>(frame)) };
+            const Math::Vec3 cameraPosition{ CAMERA_ORBIT_RADIUS * std::sin(angle), 0.0f, -CAMERA_ORBIT_RADIUS * std::cos(angle) };
+            const Math::Vec3 particlePlaneNormal{ Math::Normalize(cameraPosition) };
+            const float cameraPlaneDistance{ Math::Dot(cameraPosition, particlePlaneNormal) };
+
+            outKeys.resize(cloud.Positions.size());
+            for (size_t i{ 0u }; i < cloud.Positions.size(); ++i)
+                outKeys[i] = Math::Dot(cloud.Positions[i], particlePlaneNormal) - cameraPlaneDistance;
+        }
+
+        void MoveSmokeCloud(SmokeCloud& cloud)
+        {
+            for (size_t i{ 0u }; i < cloud.Positions.size(); ++i)
+                cloud.Positions[i] += cloud.Velocities[i] * FRAME_TIME_S;
+        }
+
+        struct SortResult
+        {
+            float TotalMS{ 0.0f };
+            uint32_t FullSortsCount{ 0u };
+            uint32_t OutOfOrderFramesCount{ 0u };
+        };
+
+        // Plays the frames and times the sort of every one. The full sort orders the particles from scratch every frame,
+        // the incremental one repairs last frame order and falls back to the full sort the way the scene does
+        SortResult PlayFrames(uint32_t particlesCount, const Motion& motion, bool incremental)
+        {
+            SmokeCloud cloud{ CreateSmokeCloud(particlesCount, motion.RiseSpeed) };
+
+            std::vector<float> particleKeys;
+            std::vector<float> sortKeys, sortKeysScratch;
+            std::vector<uint32_t> sortedParticles, sortedParticlesScratch;
+
+            uint32_t retryCountdown{ 0u };
+
+            SortResult result{};
+            for (uint32_t frame{ 0u }; frame < FRAMES_COUNT; ++frame)
+            {
+                MoveSmokeCloud(cloud);
+                ComputeSortKeys(cloud, frame, motion.CameraDegreesPerFrame, particleKeys);
+
+                Timer timer{};
+
+                bool isRepaired{ false };
+                if (incremental && frame > 0u && retryCountdown == 0u)
+                {
+                    sortKeys.resize(sortedParticles.size());
+                    for (size_t i{ 0u }; i < sortedParticles.size(); ++i)
+                        sortKeys[i] = particleKeys[sortedParticles[i]];
+
+                    isRepaired = Utils::RepairSortedOrder<float, uint32_t>(sortKeys, sortedParticles, MAX_DISPLACEMENT, MAX_SHIFTS_PER_PARTICLE);
+
+                    if (!isRepaired)
+                        retryCountdown = RETRY_DELAY_FRAMES;
+                }
+                else if (retryCountdown > 0u)
+                {
+                    --retryCountdown;
+                }
+
+                if (!isRepaired)
+                {
+                    sortedParticles.resize(particlesCount);
+                    std::iota(sortedParticles.begin(), sortedParticles.end(), 0u);
+                    sortKeys = particleKeys;
+
+                    sortKeysScratch.resize(particlesCount);
+                    sortedParticlesScratch.resize(particlesCount);
+                    Utils::RadixSortParallel<float, uint32_t>(sortKeys, sortedParticles, sortKeysScratch, sortedParticlesScratch);
+
+                    ++result.FullSortsCount;
+                }
+
+                result.TotalMS += timer.ElapsedMS();
+
+                const bool isInOrder{ std::ranges::is_sorted(sortKeys) &&
+                    std::ranges::all_of(std::views::iota(size_t{ 0u }, sortKeys.size()), [&](size_t i) { return sortKeys[i] == particleKeys[sortedParticles[i]]; })
+                };
+                result.OutOfOrderFramesCount += isInOrder ? 0u : 1u;
+            }
+
+            return result;
+        }
+    }
+
+    // Smoke particle sort while the camera orbits the smoke: the repair of last frame order against sorting from scratch every frame.
+    // The first frame is a full sort in both
+    DL_BENCHMARK(SmokeSortMovingCamera)
+    {
+        for (const uint32_t count : PARTICLES_COUNTS)
+        {
+            for (const Motion& motion : MOTIONS)
+            {
+                const SortResult fullSort{ PlayFrames(count, motion, false) };
+                const SortResult incrementalSort{ PlayFrames(count, motion, true) };
+
+                const float fullMSPerFrame{ fullSort.TotalMS / static_cast<float>(FRAMES_COUNT) };
+                const float incrementalMSPerFrame{ incrementalSort.TotalMS / static_cast<float>(FRAMES_COUNT) };
+
+                DL_BENCHMARK_LOG("[{0}] {1} particles: full sort {2:.3f} ms, incremental {3:.3f} ms ({4:.2f}x), "
+                    "{5} of {6} frames sorted from scratch, {7} frames out of order",
+                    motion.Name, count, fullMSPerFrame, incrementalMSPerFrame, fullMSPerFrame / incrementalMSPerFrame,
+                    incrementalSort.FullSortsCount, FRAMES_COUNT, fullSort.OutOfOrderFramesCount + incrementalSort.OutOfOrderFramesCount
+                );
+            }
+        }
+    }
+}
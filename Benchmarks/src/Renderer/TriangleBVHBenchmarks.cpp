@@ -0,0 +1,108 @@
+#include "Benchmark.h"
+#include "BenchmarkScenes.h"
+
+#include "DLEngine/Math/Intersections.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr uint32_t RAYS_COUNT{ 1u << 16u };
+
+        // Brute force rays are limited to about this many ray-triangle tests per submesh
+        constexpr size_t BRUTE_FORCE_TESTS_BUDGET{ 1u << 25u };
+
+        constexpr std::array<std::string_view, 2u> MODELS{ "samurai/samurai.fbx", "flashlight/flashlight.fbx" };
+        constexpr std::array<uint32_t, 2u> GRID_RESOLUTIONS{ 256u, 1024u };
+
+        // Tests every triangle, the reference the BVH results are checked against
+        void IntersectsBruteForce(const Math::Ray& ray, const Submesh& submesh, Math::IntersectInfo& outIntersectInfo)
+        {
+            const auto& vertices{ submesh.GetVertices() };
+            for (const Submesh::Triangle& triangle : submesh.GetTriangles())
+            {
+                const Math::Triangle mathTriangle{
+                    .V0 = vertices[triangle.Indices[0]].Position,
+                    .V1 = vertices[triangle.Indices[1]].Position,
+                    .V2 = vertices[triangle.Indices[2]].Position
+                };
+
+                Math::Intersects(ray, mathTriangle, outIntersectInfo);
+            }
+        }
+
+        void BenchmarkSubmesh(Submesh& submesh)
+        {
+            const size_t trianglesCount{ submesh.GetTriangles().size() };
+            if (trianglesCount == 0u)
+                return;
+
+            const float buildMS{ Measure(RUNS_COUNT, [&submesh] { submesh.UpdateBVH(); }) };
+
+            const std::vector<Math::Ray> rays{ CreateRays(submesh.GetBoundingBox(), RAYS_COUNT) };
+
+            std::vector<float> closestT(rays.size());
+            const float bvhMS{ Measure(RUNS_COUNT, [&] {
+                for (size_t i{ 0u }; i < rays.size(); ++i)
+                {
+                    Submesh::IntersectInfo intersectInfo{};
+                    Math::Intersects(rays[i], submesh, intersectInfo);
+                    closestT[i] = intersectInfo.TriangleIntersectInfo.T;
+                }
+            }) };
+
+            const size_t referenceRaysCount{ std::clamp(BRUTE_FORCE_TESTS_BUDGET / trianglesCount, size_t{ 16u }, rays.size()) };
+
+            std::vector<float> referenceT(referenceRaysCount);
+            const float bruteForceMS{ Measure(1u, [&] {
+                for (size_t i{ 0u }; i < referenceRaysCount; ++i)
+                {
+                    Math::IntersectInfo intersectInfo{};
+                    IntersectsBruteForce(rays[i], submesh, intersectInfo);
+                    referenceT[i] = intersectInfo.T;
+                }
+            }) };
+
+            uint32_t hitsCount{ 0u };
+            uint32_t mismatchesCount{ 0u };
+            for (size_t i{ 0u }; i < rays.size(); ++i)
+            {
+                if (closestT[i] != Math::Numeric::Inf)
+                    ++hitsCount;
+
+                if (i < referenceRaysCount && !SameHitDistance(closestT[i], referenceT[i]))
+                    ++mismatchesCount;
+            }
+
+            const float bvhThroughput{ Throughput(rays.size(), bvhMS) };
+            const float bruteForceThroughput{ Throughput(referenceRaysCount, bruteForceMS) };
+
+            DL_BENCHMARK_LOG("[{0}] {1} triangles: build {2:.2f} ms, {3:.1f} bytes per triangle",
+                submesh.GetName(), trianglesCount, buildMS,
+                static_cast<float>(submesh.GetBVH().GetMemoryUsage()) / static_cast<float>(trianglesCount)
+            );
+            DL_BENCHMARK_LOG("[{0}] BVH {1:.3f} Mrays/s, brute force {2:.5f} Mrays/s ({3:.0f}x), {4}/{5} rays hit, {6} of {7} checked rays disagree",
+                submesh.GetName(), bvhThroughput, bruteForceThroughput, bvhThroughput / bruteForceThroughput,
+                hitsCount, rays.size(), mismatchesCount, referenceRaysCount
+            );
+        }
+    }
+
+    // Build time and closest-hit throughput of the submesh BVH against testing every triangle.
+    // The octree the BVH replaced is gone, the brute force loop is the baseline and the correctness reference
+    DL_BENCHMARK(TriangleBVHBuildAndQuery)
+    {
+        for (const std::string_view model : MODELS)
+        {
+            for (Submesh& submesh : LoadSubmeshes(context.AssetsDir / "models" / model))
+                BenchmarkSubmesh(submesh);
+        }
+
+        for (const uint32_t resolution : GRID_RESOLUTIONS)
+        {
+            Submesh submesh{ CreateGridSubmesh(resolution) };
+            BenchmarkSubmesh(submesh);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+#include "HeadlessRenderer.h"
+
+#include "DLEngine/Math/Mat4x4.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr std::array<uint32_t, 2u> INSTANCES_COUNTS{ 10'000u, 100'000u };
+    }
+
+    // Per-access cost of the instance data by uniform name against a handle resolved once, reading TRANSFORM and writing ELAPSED_TIME
+    // of every instance. Goes through the instance store the D3D11 instances forward to, the name path builds a std::string from
+    // the literal and looks the handle up every time, as Instance::Get and Instance::Set with a name do
+    DL_BENCHMARK(UniformAccess)
+    {
+        for (const uint32_t count : INSTANCES_COUNTS)
+        {
+            InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+
+            std::vector<InstanceStore::ID> ids(count);
+            for (InstanceStore::ID& id : ids)
+                id = store.Allocate();
+
+            float checksum{ 0.0f };
+            const float elapsedTime{ 1.0f };
+
+            const auto GetByName = [&store](InstanceStore::ID id, const std::string& name) { return store.Get(id, store.GetUniformHandle(name)); };
+            const auto SetByName = [&store](InstanceStore::ID id, const std::string& name, const Buffer& buffer) { store.Set(id, store.GetUniformHandle(name), buffer); };
+
+            const float nameMS{ Measure(RUNS_COUNT, [&] {
+                for (const InstanceStore::ID id : ids)
+                {
+                    checksum += GetByName(id, "TRANSFORM").Read<Math::Mat4x4>()._41;
+                    SetByName(id, "ELAPSED_TIME", Buffer{ &elapsedTime, sizeof(float) });
+                }
+            }) };
+
+            const UniformHandle transformHandle{ store.GetUniformHandle("TRANSFORM") };
+            const UniformHandle elapsedTimeHandle{ store.GetUniformHandle("ELAPSED_TIME") };
+
+            const float handleMS{ Measure(RUNS_COUNT, [&] {
+                for (const InstanceStore::ID id : ids)
+                {
+                    checksum += store.Get(id, transformHandle).Read<Math::Mat4x4>()._41;
+                    store.Set(id, elapsedTimeHandle, Buffer{ &elapsedTime, sizeof(float) });
+                }
+            }) };
+
+            const float accessesCount{ 2.0f * static_cast<float>(count) };
+            DL_BENCHMARK_LOG("{0} instances: by name {1:.2f} ns, by handle {2:.2f} ns per access ({3:.2f}x), checksum {4}",
+                count, nameMS * 1.0e6f / accessesCount, handleMS * 1.0e6f / accessesCount, nameMS / handleMS, checksum
+            );
+        }
+    }
+}
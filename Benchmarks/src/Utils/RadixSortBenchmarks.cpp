@@ -0,0 +1,178 @@
+#include "Benchmark.h"
+#include "CoresLimit.h"
+
+#include "DLEngine/Utils/RadixSort.h"
+#include "DLEngine/Utils/RandomGenerator.h"
+
+namespace DLEngine::Benchmarks
+{
+    namespace
+    {
+        constexpr uint32_t RUNS_COUNT{ 5u };
+        constexpr std::array<uint32_t, 3u> ELEMENTS_COUNTS{ 10'000u, 100'000u, 1'000'000u };
+        constexpr std::array<uint32_t, 2u> PARALLEL_ELEMENTS_COUNTS{ 1'000'000u, 2'000'000u };
+        constexpr uint32_t MAX_CORES_COUNT{ 32u };
+
+        // Smoke particles are sorted by their distance to the camera plane with an (emitter, particle) payload
+        constexpr float MAX_DISTANCE{ 100.0f };
+        constexpr uint32_t PARTICLES_PER_EMITTER{ 4096u };
+
+        using ParticleID = std::pair<uint32_t, uint32_t>;
+
+        template <typename Key>
+        std::vector<Key> CreateKeys(uint32_t count)
+        {
+            std::vector<Key> keys(count);
+            for (Key& key : keys)
+            {
+                if constexpr (std::is_floating_point_v<Key>)
+                    key = RandomGenerator::GenerateRandom<Key>(-MAX_DISTANCE, MAX_DISTANCE);
+                else
+                    key = RandomGenerator::GenerateRandom<Key>();
+            }
+
+            return keys;
+        }
+
+        template <typename Payload>
+        std::vector<Payload> CreatePayloads(uint32_t count)
+        {
+            std::vector<Payload> payloads(count);
+            for (uint32_t i{ 0u }; i < count; ++i)
+            {
+                if constexpr (std::is_same_v<Payload, ParticleID>)
+                    payloads[i] = ParticleID{ i / PARTICLES_PER_EMITTER, i % PARTICLES_PER_EMITTER };
+                else
+                    payloads[i] = static_cast<Payload>(i);
+            }
+
+            return payloads;
+        }
+
+        // What SortSmokeParticles did before the key-payload sort: sort the bare keys and find the payload of every key in a hash map.
+        // Particles at the same distance share one entry, so the last one inserted wins
+        float MeasureHashMapSort(std::span<const float> keys, std::span<const ParticleID> payloads)
+        {
+            std::vector<float> sortedKeys(keys.size());
+            std::vector<float> sortedKeysScratch(keys.size());
+            std::vector<ParticleID> sortedPayloads(payloads.size());
+
+            return Measure(RUNS_COUNT,
+                [&] { std::ranges::copy(keys, sortedKeys.begin()); },
+                [&] {
+                    std::unordered_map<float, ParticleID> keyToPayload{};
+                    for (size_t i{ 0u }; i < keys.size(); ++i)
+                        keyToPayload[keys[i]] = payloads[i];
+
+                    Utils::RadixSort11(sortedKeys.data(), sortedKeysScratch.data(), static_cast<uint32_t>(sortedKeys.size()));
+
+                    for (size_t i{ 0u }; i < sortedKeys.size(); ++i)
+                        sortedPayloads[i] = keyToPayload[sortedKeys[i]];
+                }
+            );
+        }
+
+        template <Utils::RadixSortable Key, typename Payload>
+        void BenchmarkSort(std::string_view name, uint32_t count)
+        {
+            const std::vector<Key> keys{ CreateKeys<Key>(count) };
+            const std::vector<Payload> payloads{ CreatePayloads<Payload>(count) };
+
+            std::vector<std::pair<Key, Payload>> input(count);
+            for (uint32_t i{ 0u }; i < count; ++i)
+                input[i] = std::pair{ keys[i], payloads[i] };
+
+            // RadixSort is stable, so it has to match the stable sort exactly
+            std::vector<std::pair<Key, Payload>> expected{ input };
+            std::ranges::stable_sort(expected, {}, &std::pair<Key, Payload>::first);
+
+            std::vector<std::pair<Key, Payload>> pairs(count);
+            const float stdSortMS{ Measure(RUNS_COUNT,
+                [&] { std::ranges::copy(input, pairs.begin()); },
+                [&] { std::ranges::sort(pairs, {}, &std::pair<Key, Payload>::first); }
+            ) };
+
+            std::vector<Key> sortedKeys(count), keysScratch(count);
+            std::vector<Payload> sortedPayloads(count), payloadsScratch(count);
+            const float radixSortMS{ Measure(RUNS_COUNT,
+                [&] {
+                    std::ranges::copy(keys, sortedKeys.begin());
+                    std::ranges::copy(payloads, sortedPayloads.begin());
+                },
+                [&] { Utils::RadixSort<Key, Payload>(sortedKeys, sortedPayloads, keysScratch, payloadsScratch); }
+            ) };
+
+            const auto mismatchesCount{ std::ranges::count_if(std::views::iota(uint32_t{ 0u }, count), [&](uint32_t i) {
+                return sortedKeys[i] != expected[i].first || sortedPayloads[i] != expected[i].second;
+            }) };
+
+            DL_BENCHMARK_LOG("[{0}] {1} elements: std::sort {2:.3f} ms, RadixSort {3:.3f} ms ({4:.2f}x), {5} elements out of order",
+                name, count, stdSortMS, radixSortMS, stdSortMS / radixSortMS, mismatchesCount
+            );
+
+            if constexpr (std::is_same_v<Key, float> && std::is_same_v<Payload, ParticleID>)
+            {
+                const float hashMapSortMS{ MeasureHashMapSort(keys, payloads) };
+                DL_BENCHMARK_LOG("[{0}] {1} elements: hash map + RadixSort11 {2:.3f} ms ({3:.2f}x slower than RadixSort)",
+                    name, count, hashMapSortMS, hashMapSortMS / radixSortMS
+                );
+            }
+        }
+    }
+
+    // Key-payload radix sort against std::sort of (key, payload) pairs, for the smoke particle layout and the integer keys.
+    // For the smoke particles also against the hash map lookup it replaced
+    DL_BENCHMARK(RadixSortKeyPayload)
+    {
+        for (const uint32_t count : ELEMENTS_COUNTS)
+        {
+            BenchmarkSort<float, ParticleID>("float, particle", count);
+            BenchmarkSort<uint32_t, uint32_t>("uint32, index", count);
+            BenchmarkSort<uint64_t, uint32_t>("uint64, index", count);
+        }
+    }
+
+    // Multi-threaded radix sort of the smoke particle layout with the process limited to 1, 2, 4... 32 cores, against the serial sort
+    DL_BENCHMARK(RadixSortParallelScaling)
+    {
+        for (const uint32_t count : PARALLEL_ELEMENTS_COUNTS)
+        {
+            const std::vector<float> keys{ CreateKeys<float>(count) };
+            const std::vector<ParticleID> payloads{ CreatePayloads<ParticleID>(count) };
+
+            std::vector<float> sortedKeys(count), keysScratch(count);
+            std::vector<ParticleID> sortedPayloads(count), payloadsScratch(count);
+            const auto Restore = [&]
+                {
+                    std::ranges::copy(keys, sortedKeys.begin());
+                    std::ranges::copy(payloads, sortedPayloads.begin());
+                };
+
+            const float serialMS{ Measure(RUNS_COUNT, Restore,
+                [&] { Utils::RadixSort<float, ParticleID>(sortedKeys, sortedPayloads, keysScratch, payloadsScratch); }
+            ) };
+
+            // Both sorts are stable, so they have to agree exactly
+            const std::vector<float> expectedKeys{ sortedKeys };
+            const std::vector<ParticleID> expectedPayloads{ sortedPayloads };
+
+            DL_BENCHMARK_LOG("{0} elements: RadixSort {1:.3f} ms", count, serialMS);
+
+            for (const uint32_t coresCount : GetCoresCountsToMeasure(MAX_CORES_COUNT))
+            {
+                float parallelMS{ 0.0f };
+                {
+                    const ScopedCoresLimit coresLimit{ coresCount };
+                    parallelMS = Measure(RUNS_COUNT, Restore,
+                        [&] { Utils::RadixSortParallel<float, ParticleID>(sortedKeys, sortedPayloads, keysScratch, payloadsScratch); }
+                    );
+                }
+
+                const bool matches{ sortedKeys == expectedKeys && sortedPayloads == expectedPayloads };
+                DL_BENCHMARK_LOG("{0} elements, {1} cores: RadixSortParallel {2:.3f} ms ({3:.2f}x the serial sort){4}",
+                    count, coresCount, parallelMS, serialMS / parallelMS, matches ? "" : ", differs from the serial sort"
+                );
+            }
+        }
+    }
+}
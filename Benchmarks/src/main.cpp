@@ -0,0 +1,25 @@
+#include "Benchmark.h"
+
+// Headless, nothing here creates a window or a device.
+// The first argument is the solution directory the assets are loaded from,
+// the optional second one runs only the benchmarks whose name contains it
+int main(int argc, char** argv)
+{
+    using namespace DLEngine::Benchmarks;
+
+    DLEngine::Log::Init();
+
+    const BenchmarkContext context{ .AssetsDir = std::filesystem::path{ argc > 1 ? argv[1] : "." } / "assets" };
+    const std::string_view filter{ argc > 2 ? argv[2] : "" };
+
+    for (const auto& [name, func] : DLEngine::Headless::GetSortedEntries<BenchmarkFunc>())
+    {
+        if (name.find(filter) == std::string_view::npos)
+            continue;
+
+        DL_BENCHMARK_LOG("---- {0} ----", name);
+        func(context);
+    }
+
+    return 0;
+}
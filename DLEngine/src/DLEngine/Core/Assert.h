@@ -1,11 +1,17 @@
 #pragma once
 #include "DLEngine/Core/Log.h"
 
+#if defined(_MSC_VER)
+#define DL_DEBUGBREAK() __debugbreak()
+#else
+#define DL_DEBUGBREAK() __builtin_trap()
+#endif
+
 #ifdef DL_ENABLE_ASSERTS
-#define DL_ASSERT(condition, ...) { if(!(condition)) { ::DLEngine::Log::PrintAssertMessage("Assertion Failed" __VA_OPT__(,) __VA_ARGS__); __debugbreak(); } }
+#define DL_ASSERT(condition, ...) { if(!(condition)) { ::DLEngine::Log::PrintAssertMessage("Assertion Failed" __VA_OPT__(,) __VA_ARGS__); DL_DEBUGBREAK(); } }
 
 #ifdef DL_DEBUG
-#define DL_VERIFY(expr, ...) { if(!(expr)) { ::DLEngine::Log::PrintAssertMessage("Verification Failed" __VA_OPT__(,) __VA_ARGS__); __debugbreak(); } }
+#define DL_VERIFY(expr, ...) { if(!(expr)) { ::DLEngine::Log::PrintAssertMessage("Verification Failed" __VA_OPT__(,) __VA_ARGS__); DL_DEBUGBREAK(); } }
 #else
 #define DL_VERIFY(expr, ...) (expr)
 #endif
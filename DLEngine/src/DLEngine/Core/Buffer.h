@@ -1,6 +1,8 @@
 #pragma once
 #include "DLEngine/Core/Assert.h"
 
+#include <cstring>
+
 namespace DLEngine
 {
     struct Buffer
@@ -18,7 +20,7 @@ namespace DLEngine
         {
             Buffer buffer;
             buffer.Allocate(other.Size);
-            memcpy_s(buffer.Data, buffer.Size, other.Data, other.Size);
+            std::memcpy(buffer.Data, other.Data, other.Size);
             return buffer;
         }
 
@@ -26,7 +28,7 @@ namespace DLEngine
         {
             Buffer buffer;
             buffer.Allocate(size);
-            memcpy_s(buffer.Data, buffer.Size, data, size);
+            std::memcpy(buffer.Data, data, size);
             return buffer;
         }
 
@@ -54,7 +56,7 @@ namespace DLEngine
         {
             DL_ASSERT(offset + size <= Size, "Buffer overflow");
 
-            memcpy_s(static_cast<uint8_t*>(Data) + offset, Size - offset, data, size);
+            std::memcpy(static_cast<uint8_t*>(Data) + offset, data, size);
         }
 
         template <typename T>
@@ -93,7 +95,7 @@ namespace DLEngine
             if (Size != other.Size)
                 return false;
 
-            return memcmp(Data, other.Data, Size) == 0;
+            return std::memcmp(Data, other.Data, Size) == 0;
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+// Shared by the headless executables (tests, benchmarks), they link the engine without its precompiled header,
+// so the standard headers the engine headers rely on are included here
+#include <algorithm>
+#include <array>
+#include <execution>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "DLEngine/Core/Assert.h"
+#include "DLEngine/Core/Base.h"
+#include "DLEngine/Core/Log.h"
+
+namespace DLEngine::Headless
+{
+    template <typename FuncType>
+    struct Entry
+    {
+        std::string_view Name;
+        FuncType* Func;
+    };
+
+    // One list per function type, filled by DL_HEADLESS_ENTRY before main runs
+    template <typename FuncType>
+    std::vector<Entry<FuncType>>& GetEntries()
+    {
+        static std::vector<Entry<FuncType>> s_Entries;
+        return s_Entries;
+    }
+
+    template <typename FuncType>
+    struct Registrar
+    {
+        Registrar(std::string_view name, FuncType* func)
+        {
+            GetEntries<FuncType>().push_back(Entry<FuncType>{ .Name = name, .Func = func });
+        }
+    };
+
+    // Registration order depends on the link order, sorting keeps the runs comparable
+    template <typename FuncType>
+    std::vector<Entry<FuncType>>& GetSortedEntries()
+    {
+        std::vector<Entry<FuncType>>& entries{ GetEntries<FuncType>() };
+        std::ranges::sort(entries, {}, &Entry<FuncType>::Name);
+        return entries;
+    }
+}
+
+// Declares a function of the given type, registers it under its own name and starts its definition
+#define DL_HEADLESS_ENTRY(FuncType, name, ...) \
+    static void name(__VA_ARGS__); \
+    static const ::DLEngine::Headless::Registrar<FuncType> name##Registrar{ #name, &name }; \
+    static void name(__VA_ARGS__)
@@ -3,7 +3,9 @@
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#if defined(_MSC_VER)
 #pragma comment(lib, "spdlog.lib")
+#endif
 
 namespace DLEngine
 {
@@ -25,7 +27,9 @@ namespace DLEngine
         auto logger{ Log::GetLogger() };
         logger->error("{0}", prefix);
 
+#if defined(_WIN32)
         MessageBoxA(nullptr, "No message :/", "DLEngine Assert", MB_OK | MB_ICONERROR);
+#endif
     }
 
 }
@@ -1,5 +1,7 @@
 #pragma once
+#if defined(_WIN32)
 #include "DLEngine/Core/DLWin.h"
+#endif
 #include <spdlog/spdlog.h>
 
 namespace DLEngine
@@ -69,7 +71,9 @@ namespace DLEngine
         std::string formatted{ std::format(message, std::forward<Args>(args)...) };
         logger->error("{0}: {1}", prefix, formatted);
 
+#if defined(_WIN32)
         MessageBoxA(nullptr, formatted.c_str(), "DLEngine Assert", MB_OK | MB_ICONERROR);
+#endif
     }
 }
 
@@ -1,105 +1,251 @@
 ﻿#pragma once
 #include "DLEngine/Core/Base.h"
 
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <tuple>
 #include <vector>
 
-template <typename T>
+// Handle to an element of a solid_vector, the same for all the element types
+struct solid_vector_id
+{
+    static constexpr uint32_t InvalidSlot{ std::numeric_limits<uint32_t>::max() };
+
+    uint32_t Slot{ InvalidSlot };
+    // Odd while the slot is occupied, so a default constructed ID is never valid
+    uint32_t Generation{ 0u };
+
+    bool operator==(const solid_vector_id&) const noexcept = default;
+};
+
+struct solid_vector_slot
+{
+    // Index of the element while the slot is occupied, the next free slot otherwise
+    uint32_t Position{ solid_vector_id::InvalidSlot };
+    uint32_t Generation{ 0u };
+};
+
+// Resolves the IDs of a solid_vector to indices into its columns, for code that is handed the columns as spans.
+// Valid until the next insert or erase
+class solid_vector_indices
+{
+public:
+    solid_vector_indices() noexcept = default;
+    explicit solid_vector_indices(std::span<const solid_vector_slot> slots) noexcept : m_Slots{ slots } {}
+
+    bool contains(solid_vector_id id) const noexcept { return id.Slot < m_Slots.size() && m_Slots[id.Slot].Generation == id.Generation; }
+    uint32_t getIndex(solid_vector_id id) const noexcept { DL_ASSERT(contains(id)); return m_Slots[id.Slot].Position; }
+
+private:
+    std::span<const solid_vector_slot> m_Slots;
+};
+
+// Densely packed parallel arrays addressed by stable IDs. Erasing moves the last element of every array into the erased place,
+// so the arrays stay contiguous and can be iterated directly, while IDs keep pointing to the same elements.
+// Every slot counts its generation, incremented on insert and on erase, so an ID is valid only while its generation matches
+template <typename... Ts>
+    requires (sizeof...(Ts) > 0u)
 class solid_vector
 {
 public:
-    using ID = uint32_t;
+    using ID = solid_vector_id;
     using Index = uint32_t;
 
-    bool occupied(ID id) const noexcept { DL_ASSERT(id < static_cast<ID>(m_Occupied.size())); return m_Occupied[id]; }
+    template <size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
 
-    Index size() const noexcept { return static_cast<Index>(m_Data.size()); }
-    Index capacity() const noexcept { return static_cast<Index>(m_Data.capacity()); }
+public:
+    bool contains(ID id) const noexcept { return indices().contains(id); }
 
-    const T* data() const noexcept { return m_Data.data(); }
-    T* data() noexcept { return m_Data.data(); }
+    Index size() const noexcept { return static_cast<Index>(m_IDs.size()); }
+    Index capacity() const noexcept { return static_cast<Index>(m_IDs.capacity()); }
+    bool empty() const noexcept { return m_IDs.empty(); }
 
-    const T& at(Index index) const noexcept { DL_ASSERT(index < size()); return m_Data[index]; }
-    T& at(Index index) noexcept { DL_ASSERT(index < size()); return m_Data[index]; }
+    Index getIndex(ID id) const noexcept { return indices().getIndex(id); }
+    ID getID(Index index) const noexcept { DL_ASSERT(index < size()); return m_IDs[index]; }
 
-    const T& operator[](ID id) const noexcept { DL_ASSERT(occupied(id)); return m_Data[m_ForwardMap[id]]; }
-    T& operator[](ID id) noexcept { DL_ASSERT(occupied(id)); return m_Data[m_ForwardMap[id]]; }
+    solid_vector_indices indices() const noexcept { return solid_vector_indices{ m_Slots }; }
 
-    Index getIndex(ID id) const noexcept { DL_ASSERT(occupied(id)); return m_ForwardMap[id]; }
+    template <size_t I = 0u>
+    const column_type<I>& get(ID id) const noexcept { return std::get<I>(m_Columns)[getIndex(id)]; }
+    template <size_t I = 0u>
+    column_type<I>& get(ID id) noexcept { return std::get<I>(m_Columns)[getIndex(id)]; }
 
-    ID insert(const T& value) noexcept
-    {
-        ID id{ m_NextUsed };
+    // The whole array of the column, element i belongs to getID(i)
+    template <size_t I = 0u>
+    std::span<const column_type<I>> column() const noexcept { return std::get<I>(m_Columns); }
+    template <size_t I = 0u>
+    std::span<column_type<I>> column() noexcept { return std::get<I>(m_Columns); }
 
-        DL_ASSERT(id <= static_cast<ID>(m_ForwardMap.size()) && m_ForwardMap.size() == m_Occupied.size());
+    const column_type<0u>& operator[](ID id) const noexcept requires (sizeof...(Ts) == 1u) { return get(id); }
+    column_type<0u>& operator[](ID id) noexcept requires (sizeof...(Ts) == 1u) { return get(id); }
 
-        if (id == m_ForwardMap.size())
-        {
-            m_ForwardMap.push_back(static_cast<Index>(m_ForwardMap.size()) + 1u);
-            m_Occupied.push_back(false);
-        }
+    const column_type<0u>& at(Index index) const noexcept requires (sizeof...(Ts) == 1u) { DL_ASSERT(index < size()); return std::get<0u>(m_Columns)[index]; }
+    column_type<0u>& at(Index index) noexcept requires (sizeof...(Ts) == 1u) { DL_ASSERT(index < size()); return std::get<0u>(m_Columns)[index]; }
 
-        DL_ASSERT(!m_Occupied[id]);
+    const column_type<0u>* data() const noexcept requires (sizeof...(Ts) == 1u) { return std::get<0u>(m_Columns).data(); }
+    column_type<0u>* data() noexcept requires (sizeof...(Ts) == 1u) { return std::get<0u>(m_Columns).data(); }
 
-        m_NextUsed = m_ForwardMap[id];
-        m_ForwardMap[id] = static_cast<Index>(m_Data.size());
-        m_Occupied[id] = true;
+    // Takes one argument per column
+    template <typename... Args>
+        requires (sizeof...(Args) == sizeof...(Ts))
+    ID emplace(Args&&... args)
+    {
+        const ID id{ AcquireSlot() };
 
-        m_Data.emplace_back(value);
-        m_BackwardMap.emplace_back(id);
+        EmplaceBack(std::index_sequence_for<Ts...>{}, std::forward<Args>(args)...);
+        m_IDs.emplace_back(id);
 
         return id;
     }
 
-    void erase(ID id) noexcept
+    ID insert(const Ts&... values) { return emplace(values...); }
+
+    // Same as calling insert for every element of the spans in order, which have to be of the same size. The storage grows only once
+    std::vector<ID> insert_range(std::span<const Ts>... values)
     {
-        DL_ASSERT(id <= static_cast<ID>(m_ForwardMap.size()) && m_ForwardMap.size() == m_Occupied.size());
-        DL_ASSERT(occupied(id));
+        const size_t count{ std::get<0u>(std::forward_as_tuple(values...)).size() };
+        DL_ASSERT(((values.size() == count) && ...));
 
-        Index& forwardIndex{ m_ForwardMap[id] };
+        reserve(size() + static_cast<Index>(count));
 
-        m_Data[forwardIndex] = std::move(m_Data.back());
-        m_Data.pop_back();
+        std::vector<ID> ids{};
+        ids.reserve(count);
+        for (size_t i{ 0u }; i < count; ++i)
+            ids.emplace_back(emplace(values[i]...));
 
-        ID backwardIndex{ m_BackwardMap.back() };
+        return ids;
+    }
+
+    void erase(ID id) noexcept
+    {
+        DL_ASSERT(contains(id));
 
-        m_BackwardMap[forwardIndex] = backwardIndex;
-        m_BackwardMap.pop_back();
+        const Index index{ m_Slots[id.Slot].Position };
+        const Index lastIndex{ size() - 1u };
 
-        m_ForwardMap[backwardIndex] = forwardIndex;
+        if (index != lastIndex)
+        {
+            SwapRemove(std::index_sequence_for<Ts...>{}, index);
+
+            const ID lastID{ m_IDs[lastIndex] };
+            m_IDs[index] = lastID;
+            m_Slots[lastID.Slot].Position = index;
+        }
 
-        forwardIndex = m_NextUsed;
-        m_Occupied[id] = false;
-        m_NextUsed = id;
+        std::apply([](auto&... columns) { (columns.pop_back(), ...); }, m_Columns);
+        m_IDs.pop_back();
+
+        ReleaseSlot(id.Slot);
     }
 
+    // All the IDs handed out so far become invalid
     void clear() noexcept
     {
-        m_Data.clear();
-        m_ForwardMap.clear();
-        m_BackwardMap.clear();
-        m_Occupied.clear();
-        m_NextUsed = 0u;
+        for (const ID id : m_IDs)
+            ReleaseSlot(id.Slot);
+
+        std::apply([](auto&... columns) { (columns.clear(), ...); }, m_Columns);
+        m_IDs.clear();
     }
 
-    void reserve(Index capacity) noexcept
+    void reserve(Index capacity)
     {
-        m_Data.reserve(capacity);
-        m_ForwardMap.reserve(capacity);
-        m_BackwardMap.reserve(capacity);
-        m_Occupied.reserve(capacity);
+        std::apply([capacity](auto&... columns) { (columns.reserve(capacity), ...); }, m_Columns);
+        m_IDs.reserve(capacity);
+        m_Slots.reserve(capacity);
     }
 
-    typename std::vector<T>::iterator begin() noexcept { return m_Data.begin(); }
-    typename std::vector<T>::iterator end() noexcept { return m_Data.end(); }
+    // Calls func with the elements of every column at the same index, or with the ID followed by them.
+    // The elements are visited in parallel, so func must not insert or erase
+    template <typename ExecutionPolicy, typename Func>
+    void for_each(ExecutionPolicy&& policy, Func&& func)
+    {
+        std::for_each(std::forward<ExecutionPolicy>(policy), m_IDs.begin(), m_IDs.end(),
+            [this, &func](const ID& id)
+            {
+                const Index index{ static_cast<Index>(&id - m_IDs.data()) };
+                std::apply([&func, &id, index](auto&... columns)
+                    {
+                        if constexpr (std::is_invocable_v<Func&, ID, Ts&...>)
+                            func(id, columns[index]...);
+                        else
+                            func(columns[index]...);
+                    }, m_Columns);
+            }
+        );
+    }
 
-    typename std::vector<T>::const_iterator begin() const noexcept { return m_Data.begin(); }
-    typename std::vector<T>::const_iterator end() const noexcept { return m_Data.end(); }
+    template <typename ExecutionPolicy, typename Func>
+    void for_each(ExecutionPolicy&& policy, Func&& func) const
+    {
+        std::for_each(std::forward<ExecutionPolicy>(policy), m_IDs.begin(), m_IDs.end(),
+            [this, &func](const ID& id)
+            {
+                const Index index{ static_cast<Index>(&id - m_IDs.data()) };
+                std::apply([&func, &id, index](const auto&... columns)
+                    {
+                        if constexpr (std::is_invocable_v<Func&, ID, const Ts&...>)
+                            func(id, columns[index]...);
+                        else
+                            func(columns[index]...);
+                    }, m_Columns);
+            }
+        );
+    }
 
-public:
-    std::vector<T> m_Data;
-    std::vector<Index> m_ForwardMap;
-    std::vector<ID> m_BackwardMap;
-    std::vector<bool> m_Occupied;
+    auto begin() noexcept requires (sizeof...(Ts) == 1u) { return std::get<0u>(m_Columns).begin(); }
+    auto end() noexcept requires (sizeof...(Ts) == 1u) { return std::get<0u>(m_Columns).end(); }
+
+    auto begin() const noexcept requires (sizeof...(Ts) == 1u) { return std::get<0u>(m_Columns).begin(); }
+    auto end() const noexcept requires (sizeof...(Ts) == 1u) { return std::get<0u>(m_Columns).end(); }
+
+private:
+    ID AcquireSlot()
+    {
+        if (m_FreeSlot == ID::InvalidSlot)
+        {
+            m_FreeSlot = static_cast<Index>(m_Slots.size());
+            m_Slots.emplace_back();
+        }
+
+        const Index slotIndex{ m_FreeSlot };
+        solid_vector_slot& slot{ m_Slots[slotIndex] };
+
+        m_FreeSlot = slot.Position;
+        slot.Position = size();
+        ++slot.Generation;
+
+        return ID{ .Slot = slotIndex, .Generation = slot.Generation };
+    }
+
+    void ReleaseSlot(Index slotIndex) noexcept
+    {
+        solid_vector_slot& slot{ m_Slots[slotIndex] };
+
+        slot.Position = m_FreeSlot;
+        ++slot.Generation;
+        m_FreeSlot = slotIndex;
+    }
+
+    template <size_t... Is, typename... Args>
+    void EmplaceBack(std::index_sequence<Is...>, Args&&... args)
+    {
+        (std::get<Is>(m_Columns).emplace_back(std::forward<Args>(args)), ...);
+    }
+
+    template <size_t... Is>
+    void SwapRemove(std::index_sequence<Is...>, Index index) noexcept
+    {
+        ((std::get<Is>(m_Columns)[index] = std::move(std::get<Is>(m_Columns).back())), ...);
+    }
+
+private:
+    std::tuple<std::vector<Ts>...> m_Columns;
+    // ID of the element at every index
+    std::vector<ID> m_IDs;
 
-    ID m_NextUsed{ 0u };
+    std::vector<solid_vector_slot> m_Slots;
+    Index m_FreeSlot{ ID::InvalidSlot };
 };
@@ -1,75 +1,66 @@
 #include "dlpch.h"
 #include "D3D11Instance.h"
 
+#include "DLEngine/Renderer/Renderer.h"
+
 namespace DLEngine
 {
-    D3D11Instance::D3D11Instance(const Ref<Shader>& shader, const std::string& name) noexcept
-        : m_Name(name), m_Shader(shader)
+    D3D11Instance::D3D11Instance(const Ref<Shader>& shader, const std::string& name)
+        : m_Name(name), m_Store(Renderer::GetInstanceStoreLibrary()->Get(shader))
     {
-        const auto& inputLayout{ shader->GetInputLayout() };
-        size_t instanceDataSize{ 0u };
-
-        for (const auto& [bindPoint, inputLayoutEntry] : inputLayout)
-        {
-            if (inputLayoutEntry.Type != InputLayoutType::PerInstance)
-                continue;
-            
-            GenerateElementMap(inputLayoutEntry.Layout, instanceDataSize);
-            instanceDataSize += inputLayoutEntry.Layout.GetStride();
-        }
-
-        m_InstanceData.Allocate(instanceDataSize);
+        m_ID = m_Store->Allocate();
     }
 
-    D3D11Instance::D3D11Instance(const Ref<Instance>& instance, const std::string& name) noexcept
-        : m_Name(name), m_Shader(instance->GetShader())
+    D3D11Instance::D3D11Instance(const Ref<InstanceStore>& store, InstanceStore::ID id, const std::string& name)
+        : m_Name(name), m_Store(store), m_ID(id), m_OwnsRow(false)
     {
-        const auto& d3d11Instance{ AsRef<D3D11Instance>(instance) };
+        DL_ASSERT(m_Store->Contains(m_ID), "Instance [{0}] views a row that does not exist", m_Name);
+    }
 
-        m_InstanceData = Buffer::Copy(d3d11Instance->m_InstanceData);
-        m_ElementMap = d3d11Instance->m_ElementMap;
+    D3D11Instance::D3D11Instance(const Ref<Instance>& instance, const std::string& name)
+        : m_Name(name), m_Store(instance->GetStore())
+    {
+        m_ID = m_Store->Allocate(instance->GetStoreID());
     }
 
-    D3D11Instance::D3D11Instance(const Ref<Instance>& instance, const Ref<Shader>& differentShader, const std::string& name) noexcept
+    D3D11Instance::D3D11Instance(const Ref<Instance>& instance, const Ref<Shader>& differentShader, const std::string& name)
         : D3D11Instance(differentShader, name)
     {
-        for (const auto& elementMapEntry : m_ElementMap)
+        for (const auto& [bindingPoint, inputLayoutEntry] : differentShader->GetInputLayout())
         {
-            const auto& [bufferElement, instanceBufferOffset] { elementMapEntry.second };
-            if (instance->HasUniform(bufferElement->Name))
-                Set(bufferElement->Name, instance->Get(bufferElement->Name));
+            if (inputLayoutEntry.Type != InputLayoutType::PerInstance)
+                continue;
+
+            for (const auto& element : inputLayoutEntry.Layout)
+            {
+                if (instance->HasUniform(element.Name))
+                    Set(element.Name, instance->Get(element.Name));
+            }
         }
     }
 
     D3D11Instance::~D3D11Instance()
     {
-        m_InstanceData.Release();
+        if (m_OwnsRow)
+            m_Store->Free(m_ID);
     }
 
     void D3D11Instance::Set(const std::string& name, const Buffer& buffer) noexcept
     {
-        const auto& it{ m_ElementMap.find(name) };
+        const UniformHandle handle{ GetUniformHandle(name) };
 
-        DL_ASSERT(it != m_ElementMap.end(), "Failed to find element with name [{0}] in the instance [{1}]", name, m_Name);
+        DL_ASSERT(handle.IsValid(), "Failed to find element with name [{0}] in the instance [{1}]", name, m_Name);
 
-        const auto& [element, instanceBufferOffset] { it->second };
-        m_InstanceData.Write(buffer.Data, buffer.Size, element->Offset + instanceBufferOffset);
+        Set(handle, buffer);
     }
 
     const Buffer D3D11Instance::Get(const std::string& name) const noexcept
     {
-        const auto& it{ m_ElementMap.find(name) };
+        const UniformHandle handle{ GetUniformHandle(name) };
 
-        DL_ASSERT(it != m_ElementMap.end(), "Failed to find element with name [{0}] in the instance [{1}]", name, m_Name);
+        DL_ASSERT(handle.IsValid(), "Failed to find element with name [{0}] in the instance [{1}]", name, m_Name);
 
-        const auto& [element, instanceBufferOffset] { it->second };
-        return Buffer{ m_InstanceData.ReadRaw(element->Offset + instanceBufferOffset), element->Size };
-    }
-
-    void D3D11Instance::GenerateElementMap(const VertexBufferLayout& instanceLayout, size_t offset) noexcept
-    {
-        for (const auto& element : instanceLayout)
-            m_ElementMap.emplace(element.Name, std::make_pair(&element, offset));
+        return Get(handle);
     }
 
 }
\ No newline at end of file
@@ -1,36 +1,47 @@
 #pragma once
 #include "DLEngine/Renderer/Instance.h"
+#include "DLEngine/Renderer/InstanceStore.h"
 
 namespace DLEngine
 {
+    // Handle to a row of the instance store of the shader, see Renderer::GetInstanceStoreLibrary. The instance owns no data of its own,
+    // only the row until it is released
     class D3D11Instance : public Instance
     {
     public:
-        D3D11Instance(const Ref<Shader>& shader, const std::string& name) noexcept;
-        D3D11Instance(const Ref<Instance>& instance, const std::string& name) noexcept;
-        D3D11Instance(const Ref<Instance>& instance, const Ref<Shader>& differentShader, const std::string& name) noexcept;
+        D3D11Instance(const Ref<Shader>& shader, const std::string& name);
+        D3D11Instance(const Ref<InstanceStore>& store, InstanceStore::ID id, const std::string& name);
+        D3D11Instance(const Ref<Instance>& instance, const std::string& name);
+        D3D11Instance(const Ref<Instance>& instance, const Ref<Shader>& differentShader, const std::string& name);
         ~D3D11Instance() override;
 
+        UniformHandle GetUniformHandle(const std::string& name) const noexcept override { return m_Store->GetUniformHandle(name); }
+
         void Set(const std::string& name, const Buffer& buffer) noexcept override;
+        void Set(UniformHandle handle, const Buffer& buffer) noexcept override { m_Store->Set(m_ID, handle, buffer); }
 
+        using Instance::Get;
         const Buffer Get(const std::string& name) const noexcept override;
+        const Buffer Get(UniformHandle handle) const noexcept override { return m_Store->Get(m_ID, handle); }
+
+        bool HasUniform(const std::string& name) const noexcept override { return m_Store->HasUniform(name); }
 
-        bool HasUniform(const std::string& name) const noexcept override { return m_ElementMap.contains(name); }
+        uint32_t GetTransformVersion() const noexcept override { return m_Store->GetTransformVersion(m_ID); }
+        uint32_t GetDataVersion() const noexcept override { return m_Store->GetDataVersion(m_ID); }
 
-        const Buffer& GetInstanceData() const noexcept override { return m_InstanceData; }
-        Ref<Shader> GetShader() const noexcept override { return m_Shader; }
+        const Buffer GetLayoutData(uint32_t bindingPoint) const noexcept override { return m_Store->GetRow(m_ID, bindingPoint); }
+        Ref<Shader> GetShader() const noexcept override { return m_Store->GetShader(); }
         const std::string& GetName() const noexcept override { return m_Name; }
 
-    private:
-        void GenerateElementMap(const VertexBufferLayout& instanceLayout, size_t offset) noexcept;
+        const Ref<InstanceStore>& GetStore() const noexcept override { return m_Store; }
+        InstanceStore::ID GetStoreID() const noexcept override { return m_ID; }
+        void ReleaseRow() noexcept override { m_OwnsRow = false; }
 
     private:
         std::string m_Name;
 
-        Ref<Shader> m_Shader;
-
-        Buffer m_InstanceData;
-
-        std::unordered_map<std::string, std::pair<const VertexBufferElement*, size_t>> m_ElementMap;
+        Ref<InstanceStore> m_Store;
+        InstanceStore::ID m_ID;
+        bool m_OwnsRow{ true };
     };
 }
\ No newline at end of file
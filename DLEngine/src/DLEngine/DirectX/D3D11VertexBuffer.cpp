@@ -33,13 +33,13 @@ namespace DLEngine
     {
         DL_ASSERT(layout.GetStride() > 0u, "Buffer layout must be set");
         DL_ASSERT(size > 0u, "Buffer size must be greater than 0");
-        DL_ASSERT(usage == VertexBufferUsage::Dynamic, "Static buffer must be initialized with data");
+        DL_ASSERT(usage != VertexBufferUsage::Static, "Static buffer must be initialized with data");
 
         D3D11_BUFFER_DESC vertexBufferDesc{};
         vertexBufferDesc.ByteWidth = static_cast<UINT>(size);
-        vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        vertexBufferDesc.Usage = usage == VertexBufferUsage::Dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
         vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        vertexBufferDesc.CPUAccessFlags = usage == VertexBufferUsage::Dynamic ? D3D11_CPU_ACCESS_WRITE : 0u;
         vertexBufferDesc.MiscFlags = 0u;
         vertexBufferDesc.StructureByteStride = static_cast<UINT>(layout.GetStride());
 
@@ -69,4 +69,21 @@ namespace DLEngine
         D3D11Context::Get()->GetDeviceContext4()->Unmap(m_D3D11VertexBuffer.Get(), 0u);
     }
 
+    void D3D11VertexBuffer::SetData(const Buffer& buffer, size_t offset)
+    {
+        DL_ASSERT(m_Usage == VertexBufferUsage::Updatable, "Vertex buffer must be updatable to set data");
+        DL_ASSERT(buffer, "Buffer must be valid");
+        DL_ASSERT(offset + buffer.Size <= m_Size, "Buffer overflow");
+
+        D3D11_BOX destinationBox{};
+        destinationBox.left = static_cast<UINT>(offset);
+        destinationBox.right = static_cast<UINT>(offset + buffer.Size);
+        destinationBox.top = 0u;
+        destinationBox.bottom = 1u;
+        destinationBox.front = 0u;
+        destinationBox.back = 1u;
+
+        D3D11Context::Get()->GetDeviceContext4()->UpdateSubresource(m_D3D11VertexBuffer.Get(), 0u, &destinationBox, buffer.Data, 0u, 0u);
+    }
+
 }
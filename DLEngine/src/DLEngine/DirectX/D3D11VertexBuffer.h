@@ -17,6 +17,8 @@ namespace DLEngine
         Buffer Map() override;
         void Unmap() override;
 
+        void SetData(const Buffer& buffer, size_t offset = 0u) override;
+
         const VertexBufferLayout& GetLayout() const noexcept override { return m_Layout; }
         size_t GetSize() const noexcept override { return m_Size; }
 
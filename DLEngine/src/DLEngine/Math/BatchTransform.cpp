@@ -0,0 +1,391 @@
+#include "dlpch.h"
+#include "BatchTransform.h"
+
+#include "DLEngine/Math/Mat4A.h"
+
+#if defined(DL_MATH_BACKEND_AVX2)
+    #include <immintrin.h>
+#endif
+
+namespace DLEngine::Math
+{
+#if defined(DL_MATH_BACKEND_AVX2)
+    namespace
+    {
+        static_assert(sizeof(Vec3) == 3u * sizeof(float) && sizeof(AABB) == 6u * sizeof(float) && sizeof(Mat4x4) == 16u * sizeof(float));
+
+        // The AVX2 kernels work on two elements at a time, the first one in the low 128-bit lane and the second one in the high lane
+        struct MatrixPair
+        {
+            std::array<__m256, 4u> Rows;
+        };
+
+        DL_FORCEINLINE __m256 Combine(__m128 low, __m128 high) noexcept
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+        }
+
+        template <int Element>
+        DL_FORCEINLINE __m256 Splat(__m256 v) noexcept
+        {
+            return _mm256_permute_ps(v, Element * 0x55);
+        }
+
+        // Vec3 is not padded, so only its three floats are read and written
+        DL_FORCEINLINE __m128 LoadFloat3(const Vec3& v) noexcept
+        {
+            const __m128 xy{ _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&v.x))) };
+            return _mm_insert_ps(xy, _mm_load_ss(&v.z), 0x20);
+        }
+
+        DL_FORCEINLINE void StoreFloat3(Vec3& v, __m128 value) noexcept
+        {
+            _mm_storel_pi(reinterpret_cast<__m64*>(&v.x), value);
+            _mm_store_ss(&v.z, _mm_movehl_ps(value, value));
+        }
+
+        // The six floats of a box are read by two overlapping loads
+        DL_FORCEINLINE void LoadAABB(const AABB& aabb, __m128& outCenter, __m128& outExtents) noexcept
+        {
+            const __m128 min{ _mm_loadu_ps(&aabb.Min.x) };
+            const __m128 minZMax{ _mm_loadu_ps(&aabb.Min.z) };
+            const __m128 max{ _mm_shuffle_ps(minZMax, minZMax, _MM_SHUFFLE(3, 3, 2, 1)) };
+
+            const __m128 half{ _mm_set1_ps(0.5f) };
+            outCenter = _mm_mul_ps(_mm_add_ps(min, max), half);
+            outExtents = _mm_mul_ps(_mm_sub_ps(max, min), half);
+        }
+
+        DL_FORCEINLINE void StoreAABB(AABB& aabb, __m128 min, __m128 max) noexcept
+        {
+            _mm_storeu_ps(&aabb.Min.x, _mm_blend_ps(min, _mm_shuffle_ps(max, max, _MM_SHUFFLE(0, 0, 0, 0)), 0b1000));
+            _mm_storel_pi(reinterpret_cast<__m64*>(&aabb.Max.y), _mm_shuffle_ps(max, max, _MM_SHUFFLE(3, 3, 2, 1)));
+        }
+
+        DL_FORCEINLINE MatrixPair LoadMatrixPair(const Mat4x4& first, const Mat4x4& second) noexcept
+        {
+            MatrixPair pair;
+            for (uint32_t row{ 0u }; row < 4u; ++row)
+                pair.Rows[row] = Combine(_mm_loadu_ps(first.m[row]), _mm_loadu_ps(second.m[row]));
+            return pair;
+        }
+
+        // The same matrix in both lanes
+        DL_FORCEINLINE MatrixPair BroadcastMatrix(const Mat4x4& matrix) noexcept
+        {
+            MatrixPair pair;
+            for (uint32_t row{ 0u }; row < 4u; ++row)
+                pair.Rows[row] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.m[row]));
+            return pair;
+        }
+
+        DL_FORCEINLINE MatrixPair AbsMatrixPair(const MatrixPair& pair) noexcept
+        {
+            const __m256 signMask{ _mm256_set1_ps(-0.0f) };
+
+            MatrixPair absPair;
+            for (uint32_t row{ 0u }; row < 4u; ++row)
+                absPair.Rows[row] = _mm256_andnot_ps(signMask, pair.Rows[row]);
+            return absPair;
+        }
+
+        DL_FORCEINLINE __m256 TransformDirectionPair(__m256 directions, const MatrixPair& pair) noexcept
+        {
+            __m256 result{ _mm256_mul_ps(Splat<0>(directions), pair.Rows[0]) };
+            result = _mm256_fmadd_ps(Splat<1>(directions), pair.Rows[1], result);
+            return _mm256_fmadd_ps(Splat<2>(directions), pair.Rows[2], result);
+        }
+
+        DL_FORCEINLINE __m256 TransformPointPair(__m256 points, const MatrixPair& pair) noexcept
+        {
+            return _mm256_add_ps(TransformDirectionPair(points, pair), pair.Rows[3]);
+        }
+
+        // Two rows of the lhs matrix times the rhs matrix, i.e. the same two rows of the product
+        DL_FORCEINLINE __m256 MultiplyRowPair(__m256 rows, const MatrixPair& rhs) noexcept
+        {
+            return _mm256_fmadd_ps(Splat<3>(rows), rhs.Rows[3], TransformDirectionPair(rows, rhs));
+        }
+
+        // Every load of a kernel comes before its stores, so the outputs may alias the inputs
+        DL_FORCEINLINE void TransformAABBPair(__m256 centers, __m256 extents, const MatrixPair& pair, AABB& outFirst, AABB& outSecond) noexcept
+        {
+            const __m256 transformedCenters{ TransformPointPair(centers, pair) };
+            const __m256 transformedExtents{ TransformDirectionPair(extents, AbsMatrixPair(pair)) };
+
+            const __m256 min{ _mm256_sub_ps(transformedCenters, transformedExtents) };
+            const __m256 max{ _mm256_add_ps(transformedCenters, transformedExtents) };
+            StoreAABB(outFirst, _mm256_castps256_ps128(min), _mm256_castps256_ps128(max));
+            StoreAABB(outSecond, _mm256_extractf128_ps(min, 1), _mm256_extractf128_ps(max, 1));
+        }
+
+        DL_FORCEINLINE void Multiply(const Mat4x4& lhs, const MatrixPair& rhs, Mat4x4& outMatrix) noexcept
+        {
+            const __m256 rows01{ _mm256_loadu_ps(lhs.m[0]) };
+            const __m256 rows23{ _mm256_loadu_ps(lhs.m[2]) };
+            _mm256_storeu_ps(outMatrix.m[0], MultiplyRowPair(rows01, rhs));
+            _mm256_storeu_ps(outMatrix.m[2], MultiplyRowPair(rows23, rhs));
+        }
+
+        // Calls kernel(first, second) for the pairs of the indices, an odd last index is paired with itself.
+        // Both lanes of that pair then hold the same element, so it is written twice with the same value
+        template <typename Kernel>
+        DL_FORCEINLINE void ForEachPair(size_t count, Kernel&& kernel)
+        {
+            size_t i{ 0u };
+            for (; i + 1u < count; i += 2u)
+                kernel(i, i + 1u);
+
+            if (i < count)
+                kernel(i, i);
+        }
+
+        template <bool IsPoint>
+        void TransformVec3s(std::span<const Vec3> vectors, const MatrixPair& pair, std::span<Vec3> outVectors) noexcept
+        {
+            ForEachPair(vectors.size(), [&](size_t first, size_t second)
+            {
+                const __m256 v{ Combine(LoadFloat3(vectors[first]), LoadFloat3(vectors[second])) };
+                const __m256 transformed{ IsPoint ? TransformPointPair(v, pair) : TransformDirectionPair(v, pair) };
+                StoreFloat3(outVectors[first], _mm256_castps256_ps128(transformed));
+                StoreFloat3(outVectors[second], _mm256_extractf128_ps(transformed, 1));
+            });
+        }
+
+        template <bool IsPoint>
+        void TransformVec3s(std::span<const Vec3> vectors, std::span<const Mat4x4> transformations, std::span<Vec3> outVectors) noexcept
+        {
+            ForEachPair(vectors.size(), [&](size_t first, size_t second)
+            {
+                const MatrixPair pair{ LoadMatrixPair(transformations[first], transformations[second]) };
+                const __m256 v{ Combine(LoadFloat3(vectors[first]), LoadFloat3(vectors[second])) };
+                const __m256 transformed{ IsPoint ? TransformPointPair(v, pair) : TransformDirectionPair(v, pair) };
+                StoreFloat3(outVectors[first], _mm256_castps256_ps128(transformed));
+                StoreFloat3(outVectors[second], _mm256_extractf128_ps(transformed, 1));
+            });
+        }
+    }
+
+    void TransformPoints(std::span<const Vec3> points, const Mat4x4& transformation, std::span<Vec3> outPoints) noexcept
+    {
+        DL_ASSERT(points.size() == outPoints.size(), "Output span size must match the input one");
+
+        TransformVec3s<true>(points, BroadcastMatrix(transformation), outPoints);
+    }
+
+    void TransformPoints(std::span<const Vec3> points, std::span<const Mat4x4> transformations, std::span<Vec3> outPoints) noexcept
+    {
+        DL_ASSERT(points.size() == transformations.size() && points.size() == outPoints.size(), "Span sizes must match");
+
+        TransformVec3s<true>(points, transformations, outPoints);
+    }
+
+    void TransformDirections(std::span<const Vec3> directions, const Mat4x4& transformation, std::span<Vec3> outDirections) noexcept
+    {
+        DL_ASSERT(directions.size() == outDirections.size(), "Output span size must match the input one");
+
+        TransformVec3s<false>(directions, BroadcastMatrix(transformation), outDirections);
+    }
+
+    void TransformDirections(std::span<const Vec3> directions, std::span<const Mat4x4> transformations, std::span<Vec3> outDirections) noexcept
+    {
+        DL_ASSERT(directions.size() == transformations.size() && directions.size() == outDirections.size(), "Span sizes must match");
+
+        TransformVec3s<false>(directions, transformations, outDirections);
+    }
+
+    void TransformAABBs(std::span<const AABB> aabbs, const Mat4x4& transformation, std::span<AABB> outAABBs) noexcept
+    {
+        DL_ASSERT(aabbs.size() == outAABBs.size(), "Output span size must match the input one");
+
+        const MatrixPair pair{ BroadcastMatrix(transformation) };
+        ForEachPair(aabbs.size(), [&](size_t first, size_t second)
+        {
+            __m128 firstCenter, firstExtents, secondCenter, secondExtents;
+            LoadAABB(aabbs[first], firstCenter, firstExtents);
+            LoadAABB(aabbs[second], secondCenter, secondExtents);
+            TransformAABBPair(Combine(firstCenter, secondCenter), Combine(firstExtents, secondExtents), pair, outAABBs[first], outAABBs[second]);
+        });
+    }
+
+    void TransformAABBs(std::span<const AABB> aabbs, std::span<const Mat4x4> transformations, std::span<AABB> outAABBs) noexcept
+    {
+        DL_ASSERT(aabbs.size() == transformations.size() && aabbs.size() == outAABBs.size(), "Span sizes must match");
+
+        ForEachPair(aabbs.size(), [&](size_t first, size_t second)
+        {
+            __m128 firstCenter, firstExtents, secondCenter, secondExtents;
+            LoadAABB(aabbs[first], firstCenter, firstExtents);
+            LoadAABB(aabbs[second], secondCenter, secondExtents);
+            const MatrixPair pair{ LoadMatrixPair(transformations[first], transformations[second]) };
+            TransformAABBPair(Combine(firstCenter, secondCenter), Combine(firstExtents, secondExtents), pair, outAABBs[first], outAABBs[second]);
+        });
+    }
+
+    void TransformAABB(const AABB& aabb, std::span<const Mat4x4> transformations, std::span<AABB> outAABBs) noexcept
+    {
+        DL_ASSERT(transformations.size() == outAABBs.size(), "Output span size must match the input one");
+
+        // The center and the extents of the box are shared by all the matrices
+        __m128 center, extents;
+        LoadAABB(aabb, center, extents);
+        const __m256 centers{ Combine(center, center) };
+        const __m256 extentsPair{ Combine(extents, extents) };
+
+        ForEachPair(transformations.size(), [&](size_t first, size_t second)
+        {
+            TransformAABBPair(centers, extentsPair, LoadMatrixPair(transformations[first], transformations[second]), outAABBs[first], outAABBs[second]);
+        });
+    }
+
+    void MultiplyMatrices(std::span<const Mat4x4> lhs, const Mat4x4& rhs, std::span<Mat4x4> outMatrices) noexcept
+    {
+        DL_ASSERT(lhs.size() == outMatrices.size(), "Output span size must match the input one");
+
+        const MatrixPair rhsPair{ BroadcastMatrix(rhs) };
+        for (size_t i{ 0u }; i < lhs.size(); ++i)
+            Multiply(lhs[i], rhsPair, outMatrices[i]);
+    }
+
+    void MultiplyMatrices(std::span<const Mat4x4> lhs, std::span<const Mat4x4> rhs, std::span<Mat4x4> outMatrices) noexcept
+    {
+        DL_ASSERT(lhs.size() == rhs.size() && lhs.size() == outMatrices.size(), "Span sizes must match");
+
+        for (size_t i{ 0u }; i < lhs.size(); ++i)
+            Multiply(lhs[i], BroadcastMatrix(rhs[i]), outMatrices[i]);
+    }
+#else
+    // The other backends go through Mat4A one element at a time
+
+    void TransformPoints(std::span<const Vec3> points, const Mat4x4& transformation, std::span<Vec3> outPoints) noexcept
+    {
+        DL_ASSERT(points.size() == outPoints.size(), "Output span size must match the input one");
+
+        const Mat4A transform{ transformation };
+        for (size_t i{ 0u }; i < points.size(); ++i)
+            outPoints[i] = transform.TransformPoint(Vec3A{ points[i] }).Store();
+    }
+
+    void TransformPoints(std::span<const Vec3> points, std::span<const Mat4x4> transformations, std::span<Vec3> outPoints) noexcept
+    {
+        DL_ASSERT(points.size() == transformations.size() && points.size() == outPoints.size(), "Span sizes must match");
+
+        for (size_t i{ 0u }; i < points.size(); ++i)
+            outPoints[i] = Mat4A{ transformations[i] }.TransformPoint(Vec3A{ points[i] }).Store();
+    }
+
+    void TransformDirections(std::span<const Vec3> directions, const Mat4x4& transformation, std::span<Vec3> outDirections) noexcept
+    {
+        DL_ASSERT(directions.size() == outDirections.size(), "Output span size must match the input one");
+
+        const Mat4A transform{ transformation };
+        for (size_t i{ 0u }; i < directions.size(); ++i)
+            outDirections[i] = transform.TransformDirection(Vec3A{ directions[i] }).Store();
+    }
+
+    void TransformDirections(std::span<const Vec3> directions, std::span<const Mat4x4> transformations, std::span<Vec3> outDirections) noexcept
+    {
+        DL_ASSERT(directions.size() == transformations.size() && directions.size() == outDirections.size(), "Span sizes must match");
+
+        for (size_t i{ 0u }; i < directions.size(); ++i)
+            outDirections[i] = Mat4A{ transformations[i] }.TransformDirection(Vec3A{ directions[i] }).Store();
+    }
+
+    void TransformAABBs(std::span<const AABB> aabbs, const Mat4x4& transformation, std::span<AABB> outAABBs) noexcept
+    {
+        DL_ASSERT(aabbs.size() == outAABBs.size(), "Output span size must match the input one");
+
+        using namespace DirectX;
+
+        // The absolute rows are shared by all the boxes, see Mat4A::TransformAABB
+        const XMMATRIX transform{ XMLoadFloat4x4(&transformation) };
+        const XMVECTOR absRow0{ XMVectorAbs(transform.r[0]) };
+        const XMVECTOR absRow1{ XMVectorAbs(transform.r[1]) };
+        const XMVECTOR absRow2{ XMVectorAbs(transform.r[2]) };
+
+        for (size_t i{ 0u }; i < aabbs.size(); ++i)
+        {
+            const XMVECTOR min{ XMLoadFloat3(&aabbs[i].Min) };
+            const XMVECTOR max{ XMLoadFloat3(&aabbs[i].Max) };
+            const XMVECTOR center{ XMVectorScale(XMVectorAdd(min, max), 0.5f) };
+            const XMVECTOR extents{ XMVectorScale(XMVectorSubtract(max, min), 0.5f) };
+
+            const XMVECTOR transformedCenter{ XMVector3Transform(center, transform) };
+            const XMVECTOR transformedExtents{
+                XMVectorMultiplyAdd(XMVectorSplatZ(extents), absRow2,
+                XMVectorMultiplyAdd(XMVectorSplatY(extents), absRow1,
+                XMVectorMultiply(XMVectorSplatX(extents), absRow0)))
+            };
+
+            XMStoreFloat3(&outAABBs[i].Min, XMVectorSubtract(transformedCenter, transformedExtents));
+            XMStoreFloat3(&outAABBs[i].Max, XMVectorAdd(transformedCenter, transformedExtents));
+        }
+    }
+
+    void TransformAABBs(std::span<const AABB> aabbs, std::span<const Mat4x4> transformations, std::span<AABB> outAABBs) noexcept
+    {
+        DL_ASSERT(aabbs.size() == transformations.size() && aabbs.size() == outAABBs.size(), "Span sizes must match");
+
+        for (size_t i{ 0u }; i < aabbs.size(); ++i)
+            outAABBs[i] = Mat4A{ transformations[i] }.TransformAABB(aabbs[i]);
+    }
+
+    void TransformAABB(const AABB& aabb, std::span<const Mat4x4> transformations, std::span<AABB> outAABBs) noexcept
+    {
+        DL_ASSERT(transformations.size() == outAABBs.size(), "Output span size must match the input one");
+
+        using namespace DirectX;
+
+        // The center and the extents of the box are shared by all the matrices
+        const XMVECTOR min{ XMLoadFloat3(&aabb.Min) };
+        const XMVECTOR max{ XMLoadFloat3(&aabb.Max) };
+        const XMVECTOR center{ XMVectorScale(XMVectorAdd(min, max), 0.5f) };
+        const XMVECTOR extents{ XMVectorScale(XMVectorSubtract(max, min), 0.5f) };
+        const XMVECTOR extentsX{ XMVectorSplatX(extents) };
+        const XMVECTOR extentsY{ XMVectorSplatY(extents) };
+        const XMVECTOR extentsZ{ XMVectorSplatZ(extents) };
+
+        for (size_t i{ 0u }; i < transformations.size(); ++i)
+        {
+            const XMMATRIX transform{ XMLoadFloat4x4(&transformations[i]) };
+
+            const XMVECTOR transformedCenter{ XMVector3Transform(center, transform) };
+            const XMVECTOR transformedExtents{
+                XMVectorMultiplyAdd(extentsZ, XMVectorAbs(transform.r[2]),
+                XMVectorMultiplyAdd(extentsY, XMVectorAbs(transform.r[1]),
+                XMVectorMultiply(extentsX, XMVectorAbs(transform.r[0]))))
+            };
+
+            XMStoreFloat3(&outAABBs[i].Min, XMVectorSubtract(transformedCenter, transformedExtents));
+            XMStoreFloat3(&outAABBs[i].Max, XMVectorAdd(transformedCenter, transformedExtents));
+        }
+    }
+
+    void MultiplyMatrices(std::span<const Mat4x4> lhs, const Mat4x4& rhs, std::span<Mat4x4> outMatrices) noexcept
+    {
+        DL_ASSERT(lhs.size() == outMatrices.size(), "Output span size must match the input one");
+
+        const Mat4A rhsMatrix{ rhs };
+        for (size_t i{ 0u }; i < lhs.size(); ++i)
+            outMatrices[i] = (Mat4A{ lhs[i] } * rhsMatrix).Store();
+    }
+
+    void MultiplyMatrices(std::span<const Mat4x4> lhs, std::span<const Mat4x4> rhs, std::span<Mat4x4> outMatrices) noexcept
+    {
+        DL_ASSERT(lhs.size() == rhs.size() && lhs.size() == outMatrices.size(), "Span sizes must match");
+
+        for (size_t i{ 0u }; i < lhs.size(); ++i)
+            outMatrices[i] = (Mat4A{ lhs[i] } * Mat4A{ rhs[i] }).Store();
+    }
+
+#endif
+
+    // Inverses keep the DirectXMath implementation on every backend
+    void InverseMatrices(std::span<const Mat4x4> matrices, std::span<Mat4x4> outMatrices) noexcept
+    {
+        DL_ASSERT(matrices.size() == outMatrices.size(), "Output span size must match the input one");
+
+        for (size_t i{ 0u }; i < matrices.size(); ++i)
+            outMatrices[i] = Mat4A::Inverse(Mat4A{ matrices[i] }).Store();
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "DLEngine/Math/Mat4x4.h"
+#include "DLEngine/Math/Primitives.h"
+#include "DLEngine/Math/Vec3.h"
+
+namespace DLEngine::Math
+{
+    // Batch kernels over spans. The shared matrix is loaded once and kept in registers for the whole span,
+    // the overloads taking a span of matrices pair the i-th element with the i-th matrix.
+    // The output spans must be as long as the input ones and may alias them.
+    // The AVX2 backend runs two elements per register with FMA, the inverses use DirectXMath on every backend
+
+    void TransformPoints(std::span<const Vec3> points, const Mat4x4& transformation, std::span<Vec3> outPoints) noexcept;
+    void TransformPoints(std::span<const Vec3> points, std::span<const Mat4x4> transformations, std::span<Vec3> outPoints) noexcept;
+
+    void TransformDirections(std::span<const Vec3> directions, const Mat4x4& transformation, std::span<Vec3> outDirections) noexcept;
+    void TransformDirections(std::span<const Vec3> directions, std::span<const Mat4x4> transformations, std::span<Vec3> outDirections) noexcept;
+
+    void TransformAABBs(std::span<const AABB> aabbs, const Mat4x4& transformation, std::span<AABB> outAABBs) noexcept;
+    void TransformAABBs(std::span<const AABB> aabbs, std::span<const Mat4x4> transformations, std::span<AABB> outAABBs) noexcept;
+
+    // One box placed by every matrix, e.g. the instances of a submesh
+    void TransformAABB(const AABB& aabb, std::span<const Mat4x4> transformations, std::span<AABB> outAABBs) noexcept;
+
+    void MultiplyMatrices(std::span<const Mat4x4> lhs, const Mat4x4& rhs, std::span<Mat4x4> outMatrices) noexcept;
+    void MultiplyMatrices(std::span<const Mat4x4> lhs, std::span<const Mat4x4> rhs, std::span<Mat4x4> outMatrices) noexcept;
+
+    void InverseMatrices(std::span<const Mat4x4> matrices, std::span<Mat4x4> outMatrices) noexcept;
+}
@@ -1,7 +0,0 @@
-#pragma once
-#include "DLEngine/Math/Primitives.h"
-
-namespace DLEngine::Math
-{
-    float Distance(const Vec3& point, const Plane& plane);
-}
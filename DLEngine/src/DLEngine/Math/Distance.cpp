@@ -7,4 +7,25 @@ namespace DLEngine::Math
     {
         return std::abs(Dot(plane.Normal, point - plane.Origin));
     }
+
+    float DistanceSquared(const Vec3& point, const AABB& aabb)
+    {
+        const Vec3 closestPoint{
+            std::clamp(point.x, aabb.Min.x, aabb.Max.x),
+            std::clamp(point.y, aabb.Min.y, aabb.Max.y),
+            std::clamp(point.z, aabb.Min.z, aabb.Max.z)
+        };
+
+        const Vec3 offset{ closestPoint - point };
+        return Dot(offset, offset);
+    }
+
+    float MinDistanceSquared(const Vec3& point, std::span<const AABB> aabbs, std::span<const uint32_t> indices)
+    {
+        float minDistanceSquared{ std::numeric_limits<float>::max() };
+        for (const uint32_t index : indices)
+            minDistanceSquared = std::min(minDistanceSquared, DistanceSquared(point, aabbs[index]));
+
+        return minDistanceSquared;
+    }
 }
\ No newline at end of file
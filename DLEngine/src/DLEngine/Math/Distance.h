@@ -0,0 +1,12 @@
+#pragma once
+#include "DLEngine/Math/Primitives.h"
+
+namespace DLEngine::Math
+{
+    float Distance(const Vec3& point, const Plane& plane);
+
+    // Zero for a point inside the box
+    float DistanceSquared(const Vec3& point, const AABB& aabb);
+    // Nearest of the boxes at the indices, the maximum float for no indices
+    float MinDistanceSquared(const Vec3& point, std::span<const AABB> aabbs, std::span<const uint32_t> indices);
+}
@@ -1,6 +1,12 @@
 #include "dlpch.h"
 #include "Intersections.h"
 
+#include "DLEngine/Math/Distance.h"
+
+#if defined(DL_MATH_BACKEND_AVX2)
+    #include <immintrin.h>
+#endif
+
 namespace DLEngine::Math
 {
     bool Intersects(const Ray& ray, const Sphere& sphere, IntersectInfo& outIntersectInfo)
@@ -66,7 +72,10 @@ namespace DLEngine::Math
         const float denominator = Dot(p, e1);
         constexpr float threshold{ 1e-5f };
 
-        if (std::abs(denominator) < threshold)
+        // The denominator is the cosine between the ray and the triangle plane scaled by the doubled triangle area,
+        // comparing the cosine keeps small triangles from being rejected as parallel
+        const Vec3 n = Cross(e1, e2);
+        if (denominator * denominator < threshold * threshold * Dot(n, n))
             return false;
 
         const float t = Dot(q, e2) / denominator;
@@ -78,7 +87,7 @@ namespace DLEngine::Math
 
         outIntersectInfo.T = t;
         outIntersectInfo.IntersectionPoint = ray.Origin + ray.Direction * t;
-        outIntersectInfo.Normal = Normalize(Cross(e1, e2));
+        outIntersectInfo.Normal = Normalize(n);
 
         return true;
     }
@@ -152,59 +161,250 @@ namespace DLEngine::Math
         return true;
     }
 
-    bool Intersects(const Ray& ray, const TriangleOctree& octree, const Submesh& targetSubmesh, uint32_t& outTriangleIndex)
+    bool Intersects(const Frustum& frustum, const AABB& aabb)
+    {
+        // Halving before adding keeps boxes that span the whole float range finite
+        const Vec3 center{ aabb.Min * 0.5f + aabb.Max * 0.5f };
+        const Vec3 extent{ aabb.Max * 0.5f - aabb.Min * 0.5f };
+
+        for (const Vec4& plane : frustum.Planes)
+        {
+            // Distance of the box corner that lies the furthest along the plane normal
+            const float distance{ plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w };
+            const float radius{ std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z };
+            if (distance + radius < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool Intersects(const Sphere& sphere, const AABB& aabb)
+    {
+        return DistanceSquared(sphere.Center, aabb) <= sphere.Radius * sphere.Radius;
+    }
+
+    namespace
     {
-        bool intersects{ false };
+        // Four boxes stored as centers and half extents along each axis
+        struct AABBPacket
+        {
+            DirectX::XMVECTOR CenterX, CenterY, CenterZ;
+            DirectX::XMVECTOR ExtentX, ExtentY, ExtentZ;
+
+            explicit AABBPacket(const AABB* boxes) noexcept
+            {
+                using namespace DirectX;
+
+                const XMVECTOR half{ XMVectorReplicate(0.5f) };
+                const XMVECTOR halfMinX{ XMVectorMultiply(XMVectorSet(boxes[0].Min.x, boxes[1].Min.x, boxes[2].Min.x, boxes[3].Min.x), half) };
+                const XMVECTOR halfMinY{ XMVectorMultiply(XMVectorSet(boxes[0].Min.y, boxes[1].Min.y, boxes[2].Min.y, boxes[3].Min.y), half) };
+                const XMVECTOR halfMinZ{ XMVectorMultiply(XMVectorSet(boxes[0].Min.z, boxes[1].Min.z, boxes[2].Min.z, boxes[3].Min.z), half) };
+                const XMVECTOR halfMaxX{ XMVectorMultiply(XMVectorSet(boxes[0].Max.x, boxes[1].Max.x, boxes[2].Max.x, boxes[3].Max.x), half) };
+                const XMVECTOR halfMaxY{ XMVectorMultiply(XMVectorSet(boxes[0].Max.y, boxes[1].Max.y, boxes[2].Max.y, boxes[3].Max.y), half) };
+                const XMVECTOR halfMaxZ{ XMVectorMultiply(XMVectorSet(boxes[0].Max.z, boxes[1].Max.z, boxes[2].Max.z, boxes[3].Max.z), half) };
+
+                CenterX = XMVectorAdd(halfMinX, halfMaxX);
+                CenterY = XMVectorAdd(halfMinY, halfMaxY);
+                CenterZ = XMVectorAdd(halfMinZ, halfMaxZ);
+                ExtentX = XMVectorSubtract(halfMaxX, halfMinX);
+                ExtentY = XMVectorSubtract(halfMaxY, halfMinY);
+                ExtentZ = XMVectorSubtract(halfMaxZ, halfMinZ);
+            }
+        };
+
+        DirectX::XMVECTOR IntersectsPacket(const Frustum& frustum, const AABBPacket& packet) noexcept
+        {
+            using namespace DirectX;
 
-        constexpr uint32_t rootIndex{ 0u };
-        std::stack<uint32_t> stack;
-        stack.push(rootIndex);
+            XMVECTOR inside{ XMVectorTrueInt() };
+            for (const Vec4& plane : frustum.Planes)
+            {
+                XMVECTOR distance{ XMVectorMultiplyAdd(XMVectorReplicate(plane.x), packet.CenterX, XMVectorReplicate(plane.w)) };
+                distance = XMVectorMultiplyAdd(XMVectorReplicate(plane.y), packet.CenterY, distance);
+                distance = XMVectorMultiplyAdd(XMVectorReplicate(plane.z), packet.CenterZ, distance);
 
-        const auto& triangles{ targetSubmesh.GetTriangles() };
-        const auto& vertices{ targetSubmesh.GetVertices() };
+                distance = XMVectorMultiplyAdd(XMVectorReplicate(std::abs(plane.x)), packet.ExtentX, distance);
+                distance = XMVectorMultiplyAdd(XMVectorReplicate(std::abs(plane.y)), packet.ExtentY, distance);
+                distance = XMVectorMultiplyAdd(XMVectorReplicate(std::abs(plane.z)), packet.ExtentZ, distance);
 
-        const auto& octreeNodes{ octree.GetNodes() };
-        const auto& octreeTriangleIndices{ octree.GetTriangleIndices() };
+                inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(distance, XMVectorZero()));
+            }
 
-        Math::IntersectInfo intersectInfo{};
+            return inside;
+        }
 
-        while (!stack.empty())
+        DirectX::XMVECTOR IntersectsPacket(const Sphere& sphere, const AABBPacket& packet) noexcept
         {
-            const uint32_t nodeIndex{ stack.top() };
-            stack.pop();
+            using namespace DirectX;
+
+            // Distance from the sphere center to the closest point of each box
+            const XMVECTOR dx{ XMVectorMax(XMVectorSubtract(XMVectorAbs(XMVectorSubtract(packet.CenterX, XMVectorReplicate(sphere.Center.x))), packet.ExtentX), XMVectorZero()) };
+            const XMVECTOR dy{ XMVectorMax(XMVectorSubtract(XMVectorAbs(XMVectorSubtract(packet.CenterY, XMVectorReplicate(sphere.Center.y))), packet.ExtentY), XMVectorZero()) };
+            const XMVECTOR dz{ XMVectorMax(XMVectorSubtract(XMVectorAbs(XMVectorSubtract(packet.CenterZ, XMVectorReplicate(sphere.Center.z))), packet.ExtentZ), XMVectorZero()) };
 
-            const TriangleOctree::OctreeNode& node{ octreeNodes[nodeIndex] };
+            XMVECTOR distanceSq{ XMVectorMultiply(dx, dx) };
+            distanceSq = XMVectorMultiplyAdd(dy, dy, distanceSq);
+            distanceSq = XMVectorMultiplyAdd(dz, dz, distanceSq);
 
-            if (!Math::Intersects(ray, node.BoundingBox))
-                continue;
+            return XMVectorLessOrEqual(distanceSq, XMVectorReplicate(sphere.Radius * sphere.Radius));
+        }
+
+#if defined(DL_MATH_BACKEND_AVX2)
+        // Eight boxes as above, the six floats of each box are gathered straight from the array
+        struct AABBPacket8
+        {
+            __m256 CenterX, CenterY, CenterZ;
+            __m256 ExtentX, ExtentY, ExtentZ;
 
-            if (node.TriangleCount > 0u)
+            explicit AABBPacket8(const AABB* boxes) noexcept
             {
-                for (uint32_t i{ node.FirstTriangle }; i < node.FirstTriangle + node.TriangleCount; ++i)
+                static_assert(sizeof(AABB) == 6u * sizeof(float));
+
+                const __m256i boxOffsets{ _mm256_setr_epi32(0, 6, 12, 18, 24, 30, 36, 42) };
+                const float* base{ &boxes[0].Min.x };
+
+                const __m256 half{ _mm256_set1_ps(0.5f) };
+                const __m256 halfMinX{ _mm256_mul_ps(_mm256_i32gather_ps(base + 0, boxOffsets, 4), half) };
+                const __m256 halfMinY{ _mm256_mul_ps(_mm256_i32gather_ps(base + 1, boxOffsets, 4), half) };
+                const __m256 halfMinZ{ _mm256_mul_ps(_mm256_i32gather_ps(base + 2, boxOffsets, 4), half) };
+                const __m256 halfMaxX{ _mm256_mul_ps(_mm256_i32gather_ps(base + 3, boxOffsets, 4), half) };
+                const __m256 halfMaxY{ _mm256_mul_ps(_mm256_i32gather_ps(base + 4, boxOffsets, 4), half) };
+                const __m256 halfMaxZ{ _mm256_mul_ps(_mm256_i32gather_ps(base + 5, boxOffsets, 4), half) };
+
+                CenterX = _mm256_add_ps(halfMinX, halfMaxX);
+                CenterY = _mm256_add_ps(halfMinY, halfMaxY);
+                CenterZ = _mm256_add_ps(halfMinZ, halfMaxZ);
+                ExtentX = _mm256_sub_ps(halfMaxX, halfMinX);
+                ExtentY = _mm256_sub_ps(halfMaxY, halfMinY);
+                ExtentZ = _mm256_sub_ps(halfMaxZ, halfMinZ);
+            }
+        };
+
+        // One bit per box, the first box in the lowest bit
+        uint32_t IntersectsPacket(const Frustum& frustum, const AABBPacket8& packet) noexcept
+        {
+            __m256 inside{ _mm256_castsi256_ps(_mm256_set1_epi32(-1)) };
+            for (const Vec4& plane : frustum.Planes)
+            {
+                __m256 distance{ _mm256_fmadd_ps(_mm256_set1_ps(plane.x), packet.CenterX, _mm256_set1_ps(plane.w)) };
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.y), packet.CenterY, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), packet.CenterZ, distance);
+
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(std::abs(plane.x)), packet.ExtentX, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(std::abs(plane.y)), packet.ExtentY, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(std::abs(plane.z)), packet.ExtentZ, distance);
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+
+            return static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        }
+
+        uint32_t IntersectsPacket(const Sphere& sphere, const AABBPacket8& packet) noexcept
+        {
+            const __m256 signMask{ _mm256_set1_ps(-0.0f) };
+            const auto closestDistance{ [signMask](__m256 center, __m256 extent, float sphereCenter)
+            {
+                const __m256 offset{ _mm256_andnot_ps(signMask, _mm256_sub_ps(center, _mm256_set1_ps(sphereCenter))) };
+                return _mm256_max_ps(_mm256_sub_ps(offset, extent), _mm256_setzero_ps());
+            } };
+
+            const __m256 dx{ closestDistance(packet.CenterX, packet.ExtentX, sphere.Center.x) };
+            const __m256 dy{ closestDistance(packet.CenterY, packet.ExtentY, sphere.Center.y) };
+            const __m256 dz{ closestDistance(packet.CenterZ, packet.ExtentZ, sphere.Center.z) };
+
+            __m256 distanceSq{ _mm256_mul_ps(dx, dx) };
+            distanceSq = _mm256_fmadd_ps(dy, dy, distanceSq);
+            distanceSq = _mm256_fmadd_ps(dz, dz, distanceSq);
+
+            return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distanceSq, _mm256_set1_ps(sphere.Radius * sphere.Radius), _CMP_LE_OQ)));
+        }
+#endif
+
+        template <typename Volume>
+        uint32_t IntersectsBatch(const Volume& volume, std::span<const AABB> aabbs, std::span<uint32_t> outVisibleIndices)
+        {
+            DL_ASSERT(outVisibleIndices.size() >= aabbs.size(), "Not enough space for the visible indices");
+
+            const uint32_t aabbCount{ static_cast<uint32_t>(aabbs.size()) };
+
+            uint32_t i{ 0u };
+            uint32_t visibleCount{ 0u };
+#if defined(DL_MATH_BACKEND_AVX2)
+            for (; i + 8u <= aabbCount; i += 8u)
+            {
+                const uint32_t lanes{ IntersectsPacket(volume, AABBPacket8{ &aabbs[i] }) };
+
+                // Same branchless compaction as the four wide packets below
+                for (uint32_t lane{ 0u }; lane < 8u; ++lane)
                 {
-                    const auto& triangle{ triangles[octreeTriangleIndices[i]] };
-                    Math::Triangle triangleToCheck{
-                        .V0 = vertices[triangle.Indices[0]].Position,
-                        .V1 = vertices[triangle.Indices[1]].Position,
-                        .V2 = vertices[triangle.Indices[2]].Position
-                    };
-
-                    if (Math::Intersects(ray, triangleToCheck, intersectInfo))
-                    {
-                        outTriangleIndex = octreeTriangleIndices[i];
-                        intersects = true;
-                    }
+                    outVisibleIndices[visibleCount] = i + lane;
+                    visibleCount += (lanes >> lane) & 1u;
                 }
             }
+#endif
+
+            for (; i + 4u <= aabbCount; i += 4u)
+            {
+                DirectX::XMUINT4 lanes;
+                DirectX::XMStoreUInt4(&lanes, IntersectsPacket(volume, AABBPacket{ &aabbs[i] }));
+
+                // Branchless compaction, visibleCount never runs ahead of the box index, so the writes stay in range
+                outVisibleIndices[visibleCount] = i;
+                visibleCount += lanes.x & 1u;
+                outVisibleIndices[visibleCount] = i + 1u;
+                visibleCount += lanes.y & 1u;
+                outVisibleIndices[visibleCount] = i + 2u;
+                visibleCount += lanes.z & 1u;
+                outVisibleIndices[visibleCount] = i + 3u;
+                visibleCount += lanes.w & 1u;
+            }
+
+            for (; i < aabbCount; ++i)
+                if (Intersects(volume, aabbs[i]))
+                    outVisibleIndices[visibleCount++] = i;
+
+            return visibleCount;
+        }
+    }
+
+    uint32_t Intersects(const Frustum& frustum, std::span<const AABB> aabbs, std::span<uint32_t> outVisibleIndices)
+    {
+        return IntersectsBatch(frustum, aabbs, outVisibleIndices);
+    }
+
+    uint32_t Intersects(const Sphere& sphere, std::span<const AABB> aabbs, std::span<uint32_t> outVisibleIndices)
+    {
+        return IntersectsBatch(sphere, aabbs, outVisibleIndices);
+    }
+
+    uint32_t FrustumsIntersectionMask(std::span<const Frustum> frustums, std::span<const AABB> aabbs, std::span<const uint32_t> indices)
+    {
+        DL_ASSERT(frustums.size() <= 32u, "Frustums mask can hold up to 32 frustums");
+
+        const uint32_t allFrustumsMask{ frustums.size() == 32u ? ~0u : (1u << frustums.size()) - 1u };
 
-            if (octree.NodeHasChildren(nodeIndex))
+        uint32_t mask{ 0u };
+        for (const uint32_t index : indices)
+        {
+            for (uint32_t frustumIndex{ 0u }; frustumIndex < frustums.size(); ++frustumIndex)
             {
-                for (uint32_t i{ 0u }; i < 8u; ++i)
-                    stack.push(node.FirstChild + i);
+                const uint32_t frustumBit{ 1u << frustumIndex };
+                if ((mask & frustumBit) == 0u && Intersects(frustums[frustumIndex], aabbs[index]))
+                    mask |= frustumBit;
             }
+
+            if (mask == allFrustumsMask)
+                break;
         }
 
-        return intersects;
+        return mask;
+    }
+
+    bool Intersects(const Ray& ray, const TriangleBVH& bvh, const Submesh& targetSubmesh, IntersectInfo& outIntersectInfo, uint32_t& outTriangleIndex)
+    {
+        return bvh.Intersects(targetSubmesh, ray, outIntersectInfo, outTriangleIndex);
     }
 
     bool Intersects(const Ray& ray, const Submesh& submesh, Submesh::IntersectInfo& outIntersectInfo)
@@ -212,94 +412,113 @@ namespace DLEngine::Math
         if (!Math::Intersects(ray, submesh.GetBoundingBox()))
             return false;
 
-        uint32_t intersectedTriangleIndex{ 0u };
-        if (Math::Intersects(ray, submesh.GetOctree(), submesh, intersectedTriangleIndex))
+        return Math::Intersects(ray, submesh.GetBVH(), submesh, outIntersectInfo.TriangleIntersectInfo, outIntersectInfo.TriangleIndex);
+    }
+
+    uint32_t Intersects(std::span<const Ray> rays, const Submesh& submesh, std::span<Submesh::IntersectInfo> outIntersectInfos)
+    {
+        DL_ASSERT(rays.size() == outIntersectInfos.size(),
+            "Rays count [{0}] does not match intersect infos count [{1}]",
+            rays.size(), outIntersectInfos.size()
+        );
+
+        constexpr uint32_t packetSize{ TriangleBVH::PacketSize };
+
+        const TriangleBVH& bvh{ submesh.GetBVH() };
+
+        uint32_t intersectionsCount{ 0u };
+
+        size_t rayIndex{ 0u };
+        for (; rayIndex + packetSize <= rays.size(); rayIndex += packetSize)
         {
-            const auto& triangles{ submesh.GetTriangles() };
-            const auto& vertices{ submesh.GetVertices() };
-            Math::Triangle triangleToCheck{
-                .V0 = vertices[triangles[intersectedTriangleIndex].Indices[0]].Position,
-                .V1 = vertices[triangles[intersectedTriangleIndex].Indices[1]].Position,
-                .V2 = vertices[triangles[intersectedTriangleIndex].Indices[2]].Position
-            };
-
-            Math::IntersectInfo triangleIntersectInfo{};
-            DL_VERIFY(Math::Intersects(ray, triangleToCheck, triangleIntersectInfo));
-
-            if (triangleIntersectInfo.T < outIntersectInfo.TriangleIntersectInfo.T)
+            std::array<IntersectInfo, packetSize> packetIntersectInfos{};
+            std::array<uint32_t, packetSize> packetTriangleIndices{};
+            for (uint32_t lane{ 0u }; lane < packetSize; ++lane)
+                packetIntersectInfos[lane] = outIntersectInfos[rayIndex + lane].TriangleIntersectInfo;
+
+            const uint32_t hitMask{ bvh.Intersects(submesh, rays.subspan(rayIndex).first<packetSize>(), packetIntersectInfos, packetTriangleIndices) };
+            for (uint32_t lane{ 0u }; lane < packetSize; ++lane)
             {
-                outIntersectInfo.TriangleIntersectInfo = triangleIntersectInfo;
-                outIntersectInfo.TriangleIndex = intersectedTriangleIndex;
-                return true;
+                if ((hitMask & (1u << lane)) == 0u)
+                    continue;
+
+                outIntersectInfos[rayIndex + lane].TriangleIntersectInfo = packetIntersectInfos[lane];
+                outIntersectInfos[rayIndex + lane].TriangleIndex = packetTriangleIndices[lane];
+                ++intersectionsCount;
             }
         }
 
-        return false;
+        for (; rayIndex < rays.size(); ++rayIndex)
+            if (Intersects(rays[rayIndex], submesh, outIntersectInfos[rayIndex]))
+                ++intersectionsCount;
+
+        return intersectionsCount;
     }
 
     bool Intersects(const Ray& ray, const MeshRegistry& meshRegistry, MeshRegistry::IntersectInfo& outIntersectInfo)
     {
-        bool intersects{ false };
-        for (const auto& meshBatch : meshRegistry | std::views::values)
-        {
-            for (const auto& [mesh, submeshBatch] : meshBatch.SubmeshBatches)
+        const InstanceBVH& instanceBVH{ meshRegistry.GetInstanceBVH() };
+
+        uint32_t intersectedLeafIndex{ 0u };
+        if (!instanceBVH.Intersects(ray, outIntersectInfo.SubmeshIntersectInfo, intersectedLeafIndex))
+            return false;
+
+        outIntersectInfo.UUID = instanceBVH.GetLeaves()[intersectedLeafIndex].UUID;
+
+        return true;
+    }
+
+    uint32_t Intersects(std::span<const Ray> rays, const MeshRegistry& meshRegistry, std::span<MeshRegistry::IntersectInfo> outIntersectInfos)
+    {
+        DL_ASSERT(rays.size() == outIntersectInfos.size(),
+            "Rays count [{0}] does not match intersect infos count [{1}]",
+            rays.size(), outIntersectInfos.size()
+        );
+
+        // Every worker writes only the results of its own rays, the hits are counted afterwards.
+        // Traversal stacks live on the stack of each worker, so no ray allocates
+        std::vector<uint8_t> hits(rays.size());
+        std::for_each(std::execution::par, hits.begin(), hits.end(),
+            [&rays, &meshRegistry, &hits, &outIntersectInfos](uint8_t& hit)
             {
-                for (uint32_t submeshIndex{ 0u }; submeshIndex < submeshBatch.MaterialBatches.size(); ++submeshIndex)
-                {
-                    const auto& submesh{ mesh->GetSubmeshes()[submeshIndex] };
-                    for (const auto& [material, instanceBatch] : submeshBatch.MaterialBatches[submeshIndex].InstanceBatches)
-                    {
-                        for (const auto& instance : instanceBatch.SubmeshInstances)
-                        {
-                            if (!instance->HasUniform("TRANSFORM"))
-                                continue;
-
-                            const auto& meshToWorld{ instance->Get<Math::Mat4x4>("TRANSFORM") };
-                            const auto& worldToMesh{ Math::Mat4x4::Inverse(meshToWorld) };
-
-                            if (!Math::Intersects(ray, AABBToSpace(submesh.GetBoundingBox(), meshToWorld)))
-                                continue;
-
-                            const Math::Ray rayMeshSpace{ RayToSpace(ray, worldToMesh) };
-
-                            Submesh::IntersectInfo meshSpaceIntersectInfo{};
-                            if (outIntersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo.T != Math::Numeric::Inf)
-                            {
-                                meshSpaceIntersectInfo.TriangleIntersectInfo.IntersectionPoint = Math::PointToSpace(
-                                    outIntersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo.IntersectionPoint,
-                                    worldToMesh
-                                );
-                                meshSpaceIntersectInfo.TriangleIntersectInfo.T = Math::Length(
-                                    meshSpaceIntersectInfo.TriangleIntersectInfo.IntersectionPoint - rayMeshSpace.Origin
-                                );
-                            }
-
-                            if (Math::Intersects(rayMeshSpace, submesh, meshSpaceIntersectInfo))
-                            {
-                                outIntersectInfo.SubmeshIntersectInfo.TriangleIndex = meshSpaceIntersectInfo.TriangleIndex;
-                                outIntersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo.IntersectionPoint = Math::PointToSpace(
-                                    meshSpaceIntersectInfo.TriangleIntersectInfo.IntersectionPoint,
-                                    meshToWorld
-                                );
-                                outIntersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo.Normal = Math::Normalize(Math::DirectionToSpace(
-                                    meshSpaceIntersectInfo.TriangleIntersectInfo.Normal,
-                                    meshToWorld
-                                ));
-                                outIntersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo.T = Math::Length(
-                                    outIntersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo.IntersectionPoint - ray.Origin
-                                );
-
-                                outIntersectInfo.UUID = instance->Get<uint64_t>("INSTANCE_UUID");
-
-                                intersects = true;
-                            }
-                        }
-                    }
-                }
+                const size_t rayIndex{ static_cast<size_t>(&hit - hits.data()) };
+                hit = Intersects(rays[rayIndex], meshRegistry, outIntersectInfos[rayIndex]) ? 1u : 0u;
             }
-        }
+        );
+
+        return static_cast<uint32_t>(std::count(hits.begin(), hits.end(), uint8_t{ 1u }));
+    }
+
+    bool Occluded(const Ray& ray, const Submesh& submesh, float maxDistance)
+    {
+        if (!Math::Intersects(ray, submesh.GetBoundingBox()))
+            return false;
+
+        return submesh.GetBVH().Occluded(submesh, ray, maxDistance);
+    }
+
+    bool Occluded(const Ray& ray, const MeshRegistry& meshRegistry, float maxDistance)
+    {
+        return meshRegistry.GetInstanceBVH().Occluded(ray, maxDistance);
+    }
+
+    uint32_t Occluded(std::span<const Ray> rays, std::span<const float> maxDistances, const MeshRegistry& meshRegistry, std::span<bool> outOccluded)
+    {
+        DL_ASSERT(rays.size() == maxDistances.size() && rays.size() == outOccluded.size(),
+            "Rays count [{0}] does not match max distances count [{1}] or occlusion results count [{2}]",
+            rays.size(), maxDistances.size(), outOccluded.size()
+        );
+
+        const InstanceBVH& instanceBVH{ meshRegistry.GetInstanceBVH() };
+
+        std::transform(std::execution::par, rays.begin(), rays.end(), maxDistances.begin(), outOccluded.begin(),
+            [&instanceBVH](const Ray& ray, float maxDistance)
+            {
+                return instanceBVH.Occluded(ray, maxDistance);
+            }
+        );
 
-        return intersects;
+        return static_cast<uint32_t>(std::count(outOccluded.begin(), outOccluded.end(), true));
     }
 
 }
\ No newline at end of file
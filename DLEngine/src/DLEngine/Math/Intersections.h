@@ -10,7 +10,31 @@ namespace DLEngine::Math
     bool Intersects(const Ray& ray, const Plane& plane, IntersectInfo& outIntersectInfo);
     bool Intersects(const Ray& ray, const Triangle& triangle, IntersectInfo& outIntersectInfo);
     bool Intersects(const Ray& ray, const AABB& aabb);
-    bool Intersects(const Ray& ray, const TriangleOctree& octree, const Submesh& targetSubmesh, uint32_t& outTriangleIndex);
+    bool Intersects(const Frustum& frustum, const AABB& aabb);
+    bool Intersects(const Sphere& sphere, const AABB& aabb);
+
+    // Tests the boxes four at a time with SIMD, writes the indices of the boxes that touch the volume
+    // into outVisibleIndices and returns their count
+    uint32_t Intersects(const Frustum& frustum, std::span<const AABB> aabbs, std::span<uint32_t> outVisibleIndices);
+    uint32_t Intersects(const Sphere& sphere, std::span<const AABB> aabbs, std::span<uint32_t> outVisibleIndices);
+
+    // Returns the mask of the frustums that touch at least one of the boxes referenced by indices
+    uint32_t FrustumsIntersectionMask(std::span<const Frustum> frustums, std::span<const AABB> aabbs, std::span<const uint32_t> indices);
+
+    bool Intersects(const Ray& ray, const TriangleBVH& bvh, const Submesh& targetSubmesh, IntersectInfo& outIntersectInfo, uint32_t& outTriangleIndex);
     bool Intersects(const Ray& ray, const Submesh& submesh, Submesh::IntersectInfo& outIntersectInfo);
+
+    // Traces the rays in SIMD packets, returns the number of rays that hit the submesh
+    uint32_t Intersects(std::span<const Ray> rays, const Submesh& submesh, std::span<Submesh::IntersectInfo> outIntersectInfos);
     bool Intersects(const Ray& ray, const MeshRegistry& meshRegistry, MeshRegistry::IntersectInfo& outIntersectInfo);
+
+    // Traces the rays on all available cores, returns the number of rays that hit something
+    uint32_t Intersects(std::span<const Ray> rays, const MeshRegistry& meshRegistry, std::span<MeshRegistry::IntersectInfo> outIntersectInfos);
+
+    // Any-hit queries for visibility tests, only tell whether something lies on the ray closer than maxDistance
+    bool Occluded(const Ray& ray, const Submesh& submesh, float maxDistance);
+    bool Occluded(const Ray& ray, const MeshRegistry& meshRegistry, float maxDistance);
+
+    // Tests the rays on all available cores, returns the number of occluded rays
+    uint32_t Occluded(std::span<const Ray> rays, std::span<const float> maxDistances, const MeshRegistry& meshRegistry, std::span<bool> outOccluded);
 }
@@ -0,0 +1,64 @@
+#pragma once
+#include "DLEngine/Math/MathBackend.h"
+
+#include "DLEngine/Math/Mat4x4.h"
+#include "DLEngine/Math/Primitives.h"
+#include "DLEngine/Math/Vec3A.h"
+#include "DLEngine/Math/Vec4A.h"
+
+namespace DLEngine::Math
+{
+    // Register resident counterpart of Mat4x4, the rows stay in an XMMATRIX. Points are row vectors, as with Mat4x4
+    class Mat4A
+    {
+    public:
+        Mat4A() noexcept
+            : m_Matrix{ DirectX::XMMatrixIdentity() }
+        {}
+        explicit Mat4A(DirectX::FXMMATRIX matrix) noexcept
+            : m_Matrix{ matrix }
+        {}
+        explicit Mat4A(const Mat4x4& matrix) noexcept
+            : m_Matrix{ DirectX::XMLoadFloat4x4(&matrix) }
+        {}
+
+        explicit operator DirectX::XMMATRIX() const noexcept { return m_Matrix; }
+
+        Mat4x4 Store() const noexcept { return Mat4x4{ m_Matrix }; }
+
+        static Mat4A Inverse(const Mat4A& mat) noexcept { return Mat4A{ DirectX::XMMatrixInverse(nullptr, mat.m_Matrix) }; }
+        static Mat4A Transpose(const Mat4A& mat) noexcept { return Mat4A{ DirectX::XMMatrixTranspose(mat.m_Matrix) }; }
+
+        Vec3A TransformPoint(Vec3A point) const noexcept { return Vec3A{ DirectX::XMVector3Transform(static_cast<DirectX::XMVECTOR>(point), m_Matrix) }; }
+        Vec3A TransformDirection(Vec3A direction) const noexcept { return Vec3A{ DirectX::XMVector3TransformNormal(static_cast<DirectX::XMVECTOR>(direction), m_Matrix) }; }
+
+        // Bounds of the transformed box, rotated boxes grow to keep all of their corners inside
+        AABB TransformAABB(const AABB& aabb) const noexcept
+        {
+            using namespace DirectX;
+
+            const XMVECTOR min{ XMLoadFloat3(&aabb.Min) };
+            const XMVECTOR max{ XMLoadFloat3(&aabb.Max) };
+            const XMVECTOR center{ XMVectorScale(XMVectorAdd(min, max), 0.5f) };
+            const XMVECTOR extents{ XMVectorScale(XMVectorSubtract(max, min), 0.5f) };
+
+            const XMVECTOR transformedCenter{ XMVector3Transform(center, m_Matrix) };
+            const XMVECTOR transformedExtents{
+                XMVectorMultiplyAdd(XMVectorSplatZ(extents), XMVectorAbs(m_Matrix.r[2]),
+                XMVectorMultiplyAdd(XMVectorSplatY(extents), XMVectorAbs(m_Matrix.r[1]),
+                XMVectorMultiply(XMVectorSplatX(extents), XMVectorAbs(m_Matrix.r[0]))))
+            };
+
+            return AABB{
+                .Min = Vec3{ XMVectorSubtract(transformedCenter, transformedExtents) },
+                .Max = Vec3{ XMVectorAdd(transformedCenter, transformedExtents) }
+            };
+        }
+
+    private:
+        DirectX::XMMATRIX m_Matrix;
+    };
+
+    inline Mat4A operator*(const Mat4A& lhs, const Mat4A& rhs) noexcept { return Mat4A{ DirectX::XMMatrixMultiply(static_cast<DirectX::XMMATRIX>(lhs), static_cast<DirectX::XMMATRIX>(rhs)) }; }
+    inline Vec4A operator*(Vec4A v, const Mat4A& m) noexcept { return Vec4A{ DirectX::XMVector4Transform(static_cast<DirectX::XMVECTOR>(v), static_cast<DirectX::XMMATRIX>(m)) }; }
+}
@@ -1,5 +1,5 @@
 ﻿#pragma once
-#include <DirectXMath.h>
+#include "DLEngine/Math/MathBackend.h"
 
 namespace DLEngine::Math
 {
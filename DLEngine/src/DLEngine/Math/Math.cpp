@@ -1,6 +1,7 @@
 #include "dlpch.h"
 #include "Math.h"
 
+#include "DLEngine/Math/Mat4A.h"
 #include "DLEngine/Math/Primitives.h"
 #include "DLEngine/Math/Vec3.h"
 #include "DLEngine/Math/Vec4.h"
@@ -34,7 +35,7 @@ namespace DLEngine::Math
 
     float Sqrt(float x) noexcept
     {
-        return std::sqrtf(x);
+        return std::sqrt(x);
     }
 
     float Pow(float base, float exponent) noexcept
@@ -126,36 +127,51 @@ namespace DLEngine::Math
 
     Vec3 DirectionToSpace(const Vec3& direction, const Mat4x4& spaceTransformation) noexcept
     {
-        const Vec4& transformedDirection{ Vec4{ direction.x, direction.y, direction.z, 0.0f } * spaceTransformation };
-        return Vec3{ transformedDirection.x, transformedDirection.y, transformedDirection.z };
+        return Mat4A{ spaceTransformation }.TransformDirection(Vec3A{ direction }).Store();
     }
 
     Vec3 PointToSpace(const Vec3& point, const Mat4x4& spaceTransformation) noexcept
     {
-        const Vec4& transformedPoint{ Vec4{ point.x, point.y, point.z, 1.0f } * spaceTransformation };
-        return Vec3{ transformedPoint.x, transformedPoint.y, transformedPoint.z };
+        return Mat4A{ spaceTransformation }.TransformPoint(Vec3A{ point }).Store();
     }
 
     Ray RayToSpace(const Ray& ray, const Mat4x4& spaceTransformation) noexcept
     {
-        return Ray{ PointToSpace(ray.Origin, spaceTransformation), Normalize(DirectionToSpace(ray.Direction, spaceTransformation)) };
+        const Mat4A transform{ spaceTransformation };
+        return Ray{ transform.TransformPoint(Vec3A{ ray.Origin }).Store(), Normalize(transform.TransformDirection(Vec3A{ ray.Direction })).Store() };
     }
 
     AABB AABBToSpace(const AABB& aabb, const Mat4x4& spaceTransformation) noexcept
     {
-        const Vec3& minTransformed{ PointToSpace(aabb.Min, spaceTransformation) };
-        const Vec3& maxTransformed{ PointToSpace(aabb.Max, spaceTransformation) };
+        return Mat4A{ spaceTransformation }.TransformAABB(aabb);
+    }
+
+    Frustum FrustumFromViewProjection(const Mat4x4& viewProjection) noexcept
+    {
+        // Points are row vectors, so the clip space coordinates are the dot products with the columns of the matrix
+        const auto column{ [&viewProjection](uint32_t col)
+            {
+                return Vec4{ viewProjection.m[0][col], viewProjection.m[1][col], viewProjection.m[2][col], viewProjection.m[3][col] };
+            }
+        };
+
+        const Vec4 x{ column(0u) };
+        const Vec4 y{ column(1u) };
+        const Vec4 z{ column(2u) };
+        const Vec4 w{ column(3u) };
+
+        // -w <= x <= w, -w <= y <= w, 0 <= z <= w
+        Frustum frustum{ .Planes = { w + x, w - x, w + y, w - y, z, w - z } };
+
+        for (Vec4& plane : frustum.Planes)
+            plane /= Length(Vec3{ plane.x, plane.y, plane.z });
 
-        AABB result{};
-        result.Min = Vec3{ Min(minTransformed.x, maxTransformed.x), Min(minTransformed.y, maxTransformed.y), Min(minTransformed.z, maxTransformed.z) };
-        result.Max = Vec3{ Max(minTransformed.x, maxTransformed.x), Max(minTransformed.y, maxTransformed.y), Max(minTransformed.z, maxTransformed.z) };
-        
-        return result;
+        return frustum;
     }
 
     void BranchlessONB(const Vec3& n, Vec3& b1, Vec3& b2) noexcept
     {
-        const float s{ std::copysignf(1.0f, n.z) };
+        const float s{ std::copysign(1.0f, n.z) };
         const float a{ -1.0f / (s + n.z) };
         const float b{ n.x * n.y * a };
 
@@ -6,6 +6,7 @@ namespace DLEngine::Math
     class Mat4x4;
     class Vec3;
     struct AABB;
+    struct Frustum;
     struct Ray;
 
     float ToRadians(float degrees) noexcept;
@@ -40,6 +41,9 @@ namespace DLEngine::Math
     Ray RayToSpace(const Ray& ray, const Mat4x4& spaceTransformation) noexcept;
     AABB AABBToSpace(const AABB& aabb, const Mat4x4& spaceTransformation) noexcept;
 
+    // Extracts the normalized clipping planes of a view-projection matrix, works for both regular and reversed depth
+    Frustum FrustumFromViewProjection(const Mat4x4& viewProjection) noexcept;
+
     void BranchlessONB(const Vec3& n, Vec3& b1, Vec3& b2) noexcept;
     
     std::vector<Vec3> GenerateFibonacciHemispherePoints(uint32_t numPoints);
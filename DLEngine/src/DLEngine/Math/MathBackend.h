@@ -0,0 +1,52 @@
+#pragma once
+
+// Selects the instruction set the DirectXMath based Math types are compiled for.
+// Define one of DL_MATH_BACKEND_SCALAR, DL_MATH_BACKEND_SSE2, DL_MATH_BACKEND_SSE4, DL_MATH_BACKEND_AVX2 or DL_MATH_BACKEND_NEON
+// project-wide to force a backend, otherwise it follows the instruction set the compiler targets.
+// Every translation unit must see the same backend, so DirectXMath is only ever included through this header.
+//
+// The backends are the scalar, SSE, AVX2 and NEON implementations DirectXMath itself ships, the Math types
+// do not have implementations of their own. The CMake build compiles the math and geometry sources into the standalone
+// DLEngineMath library on any platform, its DL_MATH_BACKEND option defines the macro and sets the matching compiler flags
+#if !defined(DL_MATH_BACKEND_SCALAR) && !defined(DL_MATH_BACKEND_SSE2) && !defined(DL_MATH_BACKEND_SSE4) && \
+    !defined(DL_MATH_BACKEND_AVX2) && !defined(DL_MATH_BACKEND_NEON)
+    #if defined(__AVX2__)
+        #define DL_MATH_BACKEND_AVX2
+    #elif defined(__SSE4_1__) || defined(__AVX__)
+        #define DL_MATH_BACKEND_SSE4
+    #elif defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        #define DL_MATH_BACKEND_SSE2
+    #elif defined(_M_ARM64) || defined(_M_ARM) || defined(__ARM_NEON)
+        #define DL_MATH_BACKEND_NEON
+    #else
+        #define DL_MATH_BACKEND_SCALAR
+    #endif
+#endif
+
+#if defined(DL_MATH_BACKEND_SCALAR)
+    #define _XM_NO_INTRINSICS_
+#elif defined(DL_MATH_BACKEND_AVX2)
+    #define _XM_AVX2_INTRINSICS_
+#elif defined(DL_MATH_BACKEND_SSE4)
+    #define _XM_SSE4_INTRINSICS_
+#elif defined(DL_MATH_BACKEND_NEON)
+    #define _XM_ARM_NEON_INTRINSICS_
+#endif
+
+// GCC and Clang builds take DirectXMath and the sal.h it needs from the DirectXMath and DirectX-Headers packages
+#include <DirectXMath.h>
+
+#if defined(_MSC_VER)
+    #define DL_FORCEINLINE __forceinline
+#else
+    #define DL_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+// Non-temporal prefetch, the data is streamed through once
+#if defined(_XM_SSE_INTRINSICS_)
+    #define DL_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_NTA)
+#elif defined(__GNUC__) || defined(__clang__)
+    #define DL_PREFETCH(address) __builtin_prefetch(address, 0, 0)
+#else
+    #define DL_PREFETCH(address)
+#endif
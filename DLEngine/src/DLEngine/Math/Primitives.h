@@ -1,6 +1,7 @@
 #pragma once
 #include "DLEngine/Math/Math.h"
 #include "DLEngine/Math/Vec3.h"
+#include "DLEngine/Math/Vec4.h"
 
 namespace DLEngine::Math
 {
@@ -41,4 +42,10 @@ namespace DLEngine::Math
         Vec3 Min;
         Vec3 Max;
     };
+
+    // Planes face inwards, a point p lies inside the frustum when Dot(plane.xyz, p) + plane.w >= 0 for every plane
+    struct Frustum
+    {
+        std::array<Vec4, 6u> Planes;
+    };
 }
@@ -0,0 +1,60 @@
+#pragma once
+#include "DLEngine/Math/MathBackend.h"
+
+#include "DLEngine/Math/Vec3.h"
+
+namespace DLEngine::Math
+{
+    // Register resident counterpart of Vec3. The value stays in an XMVECTOR, so a chain of operations
+    // is not loaded from and stored to memory at every step. Load from Vec3 and store back at the ends of the chain
+    class Vec3A
+    {
+    public:
+        Vec3A() noexcept
+            : m_Vector{ DirectX::XMVectorZero() }
+        {}
+        explicit Vec3A(DirectX::FXMVECTOR v) noexcept
+            : m_Vector{ v }
+        {}
+        explicit Vec3A(const Vec3& v) noexcept
+            : m_Vector{ DirectX::XMLoadFloat3(&v) }
+        {}
+        explicit Vec3A(float x, float y, float z) noexcept
+            : m_Vector{ DirectX::XMVectorSet(x, y, z, 0.0f) }
+        {}
+        explicit Vec3A(float v) noexcept
+            : m_Vector{ DirectX::XMVectorReplicate(v) }
+        {}
+
+        explicit operator DirectX::XMVECTOR() const noexcept { return m_Vector; }
+
+        Vec3 Store() const noexcept { return Vec3{ m_Vector }; }
+
+        float GetX() const noexcept { return DirectX::XMVectorGetX(m_Vector); }
+        float GetY() const noexcept { return DirectX::XMVectorGetY(m_Vector); }
+        float GetZ() const noexcept { return DirectX::XMVectorGetZ(m_Vector); }
+
+        Vec3A& operator+=(Vec3A v) noexcept { m_Vector = DirectX::XMVectorAdd(m_Vector, v.m_Vector); return *this; }
+        Vec3A& operator-=(Vec3A v) noexcept { m_Vector = DirectX::XMVectorSubtract(m_Vector, v.m_Vector); return *this; }
+        Vec3A& operator*=(float s) noexcept { m_Vector = DirectX::XMVectorScale(m_Vector, s); return *this; }
+
+    private:
+        DirectX::XMVECTOR m_Vector;
+    };
+
+    inline Vec3A operator+(Vec3A v1, Vec3A v2) noexcept { return Vec3A{ DirectX::XMVectorAdd(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec3A operator-(Vec3A v1, Vec3A v2) noexcept { return Vec3A{ DirectX::XMVectorSubtract(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec3A operator-(Vec3A v) noexcept { return Vec3A{ DirectX::XMVectorNegate(static_cast<DirectX::XMVECTOR>(v)) }; }
+    inline Vec3A operator*(Vec3A v1, Vec3A v2) noexcept { return Vec3A{ DirectX::XMVectorMultiply(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec3A operator*(Vec3A v, float s) noexcept { return Vec3A{ DirectX::XMVectorScale(static_cast<DirectX::XMVECTOR>(v), s) }; }
+    inline Vec3A operator*(float s, Vec3A v) noexcept { return v * s; }
+    inline Vec3A operator/(Vec3A v, float s) noexcept { return v * (1.0f / s); }
+
+    inline float Length(Vec3A v) noexcept { return DirectX::XMVectorGetX(DirectX::XMVector3Length(static_cast<DirectX::XMVECTOR>(v))); }
+    inline float Dot(Vec3A v1, Vec3A v2) noexcept { return DirectX::XMVectorGetX(DirectX::XMVector3Dot(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2))); }
+    inline Vec3A Cross(Vec3A v1, Vec3A v2) noexcept { return Vec3A{ DirectX::XMVector3Cross(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec3A Normalize(Vec3A v) noexcept { return Vec3A{ DirectX::XMVector3Normalize(static_cast<DirectX::XMVECTOR>(v)) }; }
+    inline Vec3A Abs(Vec3A v) noexcept { return Vec3A{ DirectX::XMVectorAbs(static_cast<DirectX::XMVECTOR>(v)) }; }
+    inline Vec3A Min(Vec3A v1, Vec3A v2) noexcept { return Vec3A{ DirectX::XMVectorMin(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec3A Max(Vec3A v1, Vec3A v2) noexcept { return Vec3A{ DirectX::XMVectorMax(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+}
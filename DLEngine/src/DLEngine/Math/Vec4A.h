@@ -0,0 +1,55 @@
+#pragma once
+#include "DLEngine/Math/MathBackend.h"
+
+#include "DLEngine/Math/Vec4.h"
+
+namespace DLEngine::Math
+{
+    // Register resident counterpart of Vec4, see Vec3A
+    class Vec4A
+    {
+    public:
+        Vec4A() noexcept
+            : m_Vector{ DirectX::XMVectorZero() }
+        {}
+        explicit Vec4A(DirectX::FXMVECTOR v) noexcept
+            : m_Vector{ v }
+        {}
+        explicit Vec4A(const Vec4& v) noexcept
+            : m_Vector{ DirectX::XMLoadFloat4(&v) }
+        {}
+        explicit Vec4A(float x, float y, float z, float w = 0.0f) noexcept
+            : m_Vector{ DirectX::XMVectorSet(x, y, z, w) }
+        {}
+        explicit Vec4A(float v) noexcept
+            : m_Vector{ DirectX::XMVectorReplicate(v) }
+        {}
+
+        explicit operator DirectX::XMVECTOR() const noexcept { return m_Vector; }
+
+        Vec4 Store() const noexcept { return Vec4{ m_Vector }; }
+
+        float GetX() const noexcept { return DirectX::XMVectorGetX(m_Vector); }
+        float GetY() const noexcept { return DirectX::XMVectorGetY(m_Vector); }
+        float GetZ() const noexcept { return DirectX::XMVectorGetZ(m_Vector); }
+        float GetW() const noexcept { return DirectX::XMVectorGetW(m_Vector); }
+
+        Vec4A& operator+=(Vec4A v) noexcept { m_Vector = DirectX::XMVectorAdd(m_Vector, v.m_Vector); return *this; }
+        Vec4A& operator-=(Vec4A v) noexcept { m_Vector = DirectX::XMVectorSubtract(m_Vector, v.m_Vector); return *this; }
+        Vec4A& operator*=(float s) noexcept { m_Vector = DirectX::XMVectorScale(m_Vector, s); return *this; }
+
+    private:
+        DirectX::XMVECTOR m_Vector;
+    };
+
+    inline Vec4A operator+(Vec4A v1, Vec4A v2) noexcept { return Vec4A{ DirectX::XMVectorAdd(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec4A operator-(Vec4A v1, Vec4A v2) noexcept { return Vec4A{ DirectX::XMVectorSubtract(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec4A operator*(Vec4A v1, Vec4A v2) noexcept { return Vec4A{ DirectX::XMVectorMultiply(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2)) }; }
+    inline Vec4A operator*(Vec4A v, float s) noexcept { return Vec4A{ DirectX::XMVectorScale(static_cast<DirectX::XMVECTOR>(v), s) }; }
+    inline Vec4A operator*(float s, Vec4A v) noexcept { return v * s; }
+    inline Vec4A operator/(Vec4A v, float s) noexcept { return v * (1.0f / s); }
+
+    inline float Length(Vec4A v) noexcept { return DirectX::XMVectorGetX(DirectX::XMVector4Length(static_cast<DirectX::XMVECTOR>(v))); }
+    inline float Dot(Vec4A v1, Vec4A v2) noexcept { return DirectX::XMVectorGetX(DirectX::XMVector4Dot(static_cast<DirectX::XMVECTOR>(v1), static_cast<DirectX::XMVECTOR>(v2))); }
+    inline Vec4A Normalize(Vec4A v) noexcept { return Vec4A{ DirectX::XMVector4Normalize(static_cast<DirectX::XMVECTOR>(v)) }; }
+}
@@ -134,4 +134,9 @@ namespace DLEngine
         return frustum;
     }
 
+    Math::Frustum Camera::ConstructFrustumPlanes() const noexcept
+    {
+        return Math::FrustumFromViewProjection(GetViewMatrix() * GetProjectionMatrix());
+    }
+
 }
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "DLEngine/Math/Mat4x4.h"
+#include "DLEngine/Math/Primitives.h"
 #include "DLEngine/Math/Vec2.h"
 #include "DLEngine/Math/Vec4.h"
 
@@ -73,6 +74,7 @@ namespace DLEngine
         Math::Vec3 ConstructFrustumPosNoTranslation(const Math::Vec3& ndc) const noexcept;
 
         Frustum ConstructFrustum() const noexcept;
+        Math::Frustum ConstructFrustumPlanes() const noexcept;
 
     private:
         Math::Vec3 m_Position{ 0.0f, 0.0f, 0.0f };
@@ -27,25 +27,35 @@ namespace DLEngine
     public:
         InstanceDragger(const Math::Vec3& startPoint, float distance, Ref<Instance> instance) noexcept
             : IDragger(startPoint, distance)
-            , m_Instance(instance)
         {
-            DL_ASSERT(m_Instance, "Instance is nullptr");
-            DL_ASSERT(m_Instance->HasUniform("TRANSFORM"), "Instance does not have a TRANSFORM uniform");
+            DL_ASSERT(instance, "Instance is nullptr");
+            DL_ASSERT(instance->HasUniform("TRANSFORM"), "Instance does not have a TRANSFORM uniform");
+
+            m_Store = instance->GetStore();
+            m_ID = instance->GetStoreID();
+            m_TransformHandle = m_Store->GetTransformHandle();
         }
 
         void Drag(const Math::Ray& endRay) override
         {
+            // The mesh may be removed while it is dragged
+            if (!m_Store->Contains(m_ID))
+                return;
+
             const Math::Vec3 endPoint{ endRay.Origin + endRay.Direction * m_Distance };
             const Math::Vec3 translation{ endPoint - m_StartPoint };
 
-            const auto& transform{ m_Instance->Get<Math::Mat4x4>("TRANSFORM") };
-            const auto& finalTransform{ transform * Math::Mat4x4::Translate(translation) };
-            m_Instance->Set("TRANSFORM", Buffer{ &finalTransform, sizeof(Math::Mat4x4) });
+            const Math::Mat4x4 transform{ m_Store->Get<Math::Mat4x4>(m_ID, m_TransformHandle) };
+            const Math::Mat4x4 finalTransform{ transform * Math::Mat4x4::Translate(translation) };
+            m_Store->Set(m_ID, m_TransformHandle, Buffer{ &finalTransform, sizeof(Math::Mat4x4) });
 
             m_StartPoint = endPoint;
         }
 
     protected:
-        Ref<Instance> m_Instance;
+        // The row, not the instance: the registry hands out views of the rows it owns
+        Ref<InstanceStore> m_Store;
+        InstanceStore::ID m_ID;
+        UniformHandle m_TransformHandle;
     };
 }
\ No newline at end of file
@@ -10,6 +10,11 @@ namespace DLEngine
         return CreateRef<D3D11Instance>(shader, name);
     }
 
+    Ref<Instance> Instance::Create(const Ref<InstanceStore>& store, InstanceStore::ID id, const std::string& name)
+    {
+        return CreateRef<D3D11Instance>(store, id, name);
+    }
+
     Ref<Instance> Instance::Copy(const Ref<Instance>& instance, const std::string& name)
     {
         return CreateRef<D3D11Instance>(instance, name);
@@ -2,6 +2,7 @@
 #include "DLEngine/Core/Base.h"
 #include "DLEngine/Core/Buffer.h"
 
+#include "DLEngine/Renderer/InstanceStore.h"
 #include "DLEngine/Renderer/Shader.h"
 
 #include <string>
@@ -13,12 +14,19 @@ namespace DLEngine
     public:
         virtual ~Instance() = default;
 
+        // Returns an invalid handle if the shader of the instance has no such uniform
+        virtual UniformHandle GetUniformHandle(const std::string& name) const noexcept = 0;
+
+        // The string keyed accessors look the uniform up on every call, hot paths should resolve a handle once instead
         virtual void Set(const std::string& name, const Buffer& buffer) noexcept = 0;
+        virtual void Set(UniformHandle handle, const Buffer& buffer) noexcept = 0;
 
+        // The returned data is a view into the instance store of the shader, valid until an instance of the shader is created or destroyed
         virtual const Buffer Get(const std::string& name) const noexcept = 0;
+        virtual const Buffer Get(UniformHandle handle) const noexcept = 0;
 
         template <typename T>
-        const T& Get(const std::string& name) const noexcept
+        T Get(const std::string& name) const noexcept
         {
             const auto& buffer{ Get(name) };
 
@@ -27,13 +35,36 @@ namespace DLEngine
             return buffer.Read<T>();
         }
 
+        template <typename T>
+        T Get(UniformHandle handle) const noexcept
+        {
+            DL_ASSERT(handle.Size == sizeof(T), "Element size mismatch for the uniform handle in the instance [{0}]", GetName());
+
+            return Get(handle).Read<T>();
+        }
+
         virtual bool HasUniform(const std::string& name) const noexcept = 0;
 
-        virtual const Buffer& GetInstanceData() const noexcept = 0;
+        // Incremented by every Set of the TRANSFORM uniform, caches compare it against the version they were built from
+        virtual uint32_t GetTransformVersion() const noexcept = 0;
+        // Incremented by every Set of any uniform
+        virtual uint32_t GetDataVersion() const noexcept = 0;
+
+        // Data of the instance laid out as the per-instance input layout at the binding point, i.e. one row of its instance buffer
+        virtual const Buffer GetLayoutData(uint32_t bindingPoint) const noexcept = 0;
         virtual Ref<Shader> GetShader() const noexcept = 0;
         virtual const std::string& GetName() const noexcept = 0;
 
+        // Row of the instance in the store of its shader
+        virtual const Ref<InstanceStore>& GetStore() const noexcept = 0;
+        virtual InstanceStore::ID GetStoreID() const noexcept = 0;
+        // Hands the row over to the caller, which frees it through the store, as the mesh registry does with the instances it is given.
+        // The instance stays a view of the row until then
+        virtual void ReleaseRow() noexcept = 0;
+
         static Ref<Instance> Create(const Ref<Shader>& shader, const std::string& name = "");
+        // A view of a row owned by someone else, e.g. an instance held by the mesh registry
+        static Ref<Instance> Create(const Ref<InstanceStore>& store, InstanceStore::ID id, const std::string& name = "");
         static Ref<Instance> Copy(const Ref<Instance>& instance, const std::string& name = "");
         static Ref<Instance> Copy(const Ref<Instance>& instance, const Ref<Shader>& differentShader, const std::string& name = "");
     };
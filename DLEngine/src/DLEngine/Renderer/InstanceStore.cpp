@@ -0,0 +1,138 @@
+#include "dlpch.h"
+#include "InstanceStore.h"
+
+namespace DLEngine
+{
+    InstanceStore::InstanceStore(const Ref<Shader>& shader)
+        : m_Shader(shader)
+    {
+        for (const auto& [bindingPoint, inputLayoutEntry] : shader->GetInputLayout())
+        {
+            if (inputLayoutEntry.Type != InputLayoutType::PerInstance)
+                continue;
+
+            const uint32_t columnIndex{ static_cast<uint32_t>(m_Columns.size()) };
+            for (const auto& element : inputLayoutEntry.Layout)
+            {
+                m_UniformHandles.emplace(element.Name, UniformHandle{
+                    .Column = columnIndex,
+                    .Offset = static_cast<uint32_t>(element.Offset),
+                    .Size = static_cast<uint32_t>(element.Size)
+                });
+            }
+
+            m_Columns.emplace_back(Column{ .BindingPoint = bindingPoint, .Stride = inputLayoutEntry.Layout.GetStride() });
+        }
+
+        m_TransformHandle = GetUniformHandle("TRANSFORM");
+    }
+
+    InstanceStore::ID InstanceStore::Allocate()
+    {
+        for (Column& column : m_Columns)
+            column.Data.resize(column.Data.size() + column.Stride);
+
+        return m_Rows.insert(0u, 0u);
+    }
+
+    InstanceStore::ID InstanceStore::Allocate(ID source)
+    {
+        const uint32_t sourceRow{ GetRowIndex(source) };
+        for (Column& column : m_Columns)
+        {
+            column.Data.resize(column.Data.size() + column.Stride);
+            std::copy_n(column.Data.begin() + sourceRow * column.Stride, column.Stride, column.Data.end() - column.Stride);
+        }
+
+        return m_Rows.insert(0u, 0u);
+    }
+
+    void InstanceStore::Free(ID id) noexcept
+    {
+        // The last row takes the place of the freed one, as the versions do in m_Rows
+        const uint32_t row{ GetRowIndex(id) };
+        const uint32_t lastRow{ GetInstanceCount() - 1u };
+        for (Column& column : m_Columns)
+        {
+            if (row != lastRow)
+                std::copy_n(column.Data.begin() + lastRow * column.Stride, column.Stride, column.Data.begin() + row * column.Stride);
+
+            column.Data.resize(column.Data.size() - column.Stride);
+        }
+
+        m_Rows.erase(id);
+    }
+
+    UniformHandle InstanceStore::GetUniformHandle(const std::string& name) const noexcept
+    {
+        const auto it{ m_UniformHandles.find(name) };
+        return it == m_UniformHandles.end() ? UniformHandle{} : it->second;
+    }
+
+    void InstanceStore::Set(ID id, UniformHandle handle, const Buffer& buffer) noexcept
+    {
+        DL_ASSERT(handle.IsValid(), "Invalid uniform handle for the instance store of the shader [{0}]", m_Shader->GetName());
+        DL_ASSERT(buffer.Size <= handle.Size, "Element size mismatch for the uniform handle in the instance store of the shader [{0}]", m_Shader->GetName());
+
+        Column& column{ m_Columns[handle.Column] };
+        const uint32_t row{ GetRowIndex(id) };
+        std::copy_n(static_cast<const uint8_t*>(buffer.Data), buffer.Size, column.Data.begin() + row * column.Stride + handle.Offset);
+
+        ++m_Rows.get<DATA_VERSION_COLUMN>(id);
+        if (handle == m_TransformHandle)
+            ++m_Rows.get<TRANSFORM_VERSION_COLUMN>(id);
+    }
+
+    const Buffer InstanceStore::Get(ID id, UniformHandle handle) const noexcept
+    {
+        DL_ASSERT(handle.IsValid(), "Invalid uniform handle for the instance store of the shader [{0}]", m_Shader->GetName());
+
+        const Column& column{ m_Columns[handle.Column] };
+        return Buffer{ column.Data.data() + GetRowIndex(id) * column.Stride + handle.Offset, handle.Size };
+    }
+
+    const Buffer InstanceStore::GetRow(ID id, uint32_t bindingPoint) const noexcept
+    {
+        const Column& column{ GetColumnByBindingPoint(bindingPoint) };
+        return Buffer{ column.Data.data() + GetRowIndex(id) * column.Stride, column.Stride };
+    }
+
+    const Buffer InstanceStore::GetColumnData(uint32_t bindingPoint) const noexcept
+    {
+        const Column& column{ GetColumnByBindingPoint(bindingPoint) };
+        return Buffer{ column.Data.data(), column.Data.size() };
+    }
+
+    const InstanceStore::Column& InstanceStore::GetColumnByBindingPoint(uint32_t bindingPoint) const noexcept
+    {
+        const auto it{ std::ranges::find(m_Columns, bindingPoint, &Column::BindingPoint) };
+
+        DL_ASSERT(it != m_Columns.end(), "Shader [{0}] has no per-instance input layout at the binding point [{1}]", m_Shader->GetName(), bindingPoint);
+
+        return *it;
+    }
+
+    InstanceStore::Column& InstanceStore::GetColumnByBindingPoint(uint32_t bindingPoint) noexcept
+    {
+        return const_cast<Column&>(std::as_const(*this).GetColumnByBindingPoint(bindingPoint));
+    }
+
+    Ref<InstanceStore> InstanceStoreLibrary::Get(const Ref<Shader>& shader)
+    {
+        // A shader loaded again under the same name gets a store of its own, the instances of the old one keep theirs
+        const auto it{ m_Stores.find(shader->GetName()) };
+        if (it != m_Stores.end())
+        {
+            if (Ref<InstanceStore> store{ it->second.lock() }; store && store->GetShader() == shader)
+                return store;
+        }
+
+        std::erase_if(m_Stores, [](const auto& entry) { return entry.second.expired(); });
+
+        Ref<InstanceStore> store{ CreateRef<InstanceStore>(shader) };
+        m_Stores[shader->GetName()] = store;
+
+        return store;
+    }
+
+}
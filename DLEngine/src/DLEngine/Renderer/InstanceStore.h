@@ -0,0 +1,148 @@
+#pragma once
+#include "DLEngine/Core/Buffer.h"
+#include "DLEngine/Core/solid_vector.h"
+
+#include "DLEngine/Renderer/Shader.h"
+
+#include <limits>
+#include <string>
+
+namespace DLEngine
+{
+    // Location of a uniform in the instance data, the per-instance input layout holding it and the offset within its row.
+    // The layout of the instance data depends only on the shader, so a handle resolved once is valid for all the instances of that shader
+    struct UniformHandle
+    {
+        static constexpr uint32_t InvalidOffset{ std::numeric_limits<uint32_t>::max() };
+
+        uint32_t Column{ 0u };
+        uint32_t Offset{ InvalidOffset };
+        uint32_t Size{ 0u };
+
+        bool IsValid() const noexcept { return Offset != InvalidOffset; }
+
+        bool operator==(const UniformHandle&) const noexcept = default;
+    };
+
+    // Per-instance data of the instances of a shader. Every per-instance input layout of the shader is a column holding one row per instance,
+    // laid out as the instance buffer of the binding point expects it. Rows are densely packed, freeing an instance moves the last row into its place,
+    // so a column is always a single array of GetInstanceCount() rows that can be copied into an instance buffer as is.
+    // IDs keep addressing the same instance across the moves, GetRowIndex resolves them to rows.
+    // A store is not synchronized: instances are allocated, set and freed on the main thread, parallel passes only read the store in between
+    class InstanceStore
+    {
+    public:
+        using ID = solid_vector_id;
+
+    public:
+        explicit InstanceStore(const Ref<Shader>& shader);
+
+        // Appends a zeroed row, or a copy of the source row
+        ID Allocate();
+        ID Allocate(ID source);
+        void Free(ID id) noexcept;
+
+        bool Contains(ID id) const noexcept { return m_Rows.contains(id); }
+
+        // Returns an invalid handle if the shader has no such uniform
+        UniformHandle GetUniformHandle(const std::string& name) const noexcept;
+        bool HasUniform(const std::string& name) const noexcept { return m_UniformHandles.contains(name); }
+        UniformHandle GetTransformHandle() const noexcept { return m_TransformHandle; }
+
+        void Set(ID id, UniformHandle handle, const Buffer& buffer) noexcept;
+
+        // The views returned by Get, GetRow and GetColumnData are valid until the next Allocate or Free
+        const Buffer Get(ID id, UniformHandle handle) const noexcept;
+
+        template <typename T>
+        T Get(ID id, UniformHandle handle) const noexcept
+        {
+            DL_ASSERT(handle.Size == sizeof(T), "Element size mismatch for the uniform handle in the instance store of the shader [{0}]", m_Shader->GetName());
+
+            return Get(id, handle).Read<T>();
+        }
+
+        // Row of the instance in the column of the binding point
+        const Buffer GetRow(ID id, uint32_t bindingPoint) const noexcept;
+        // All the rows of the column of the binding point, row i belongs to GetID(i)
+        const Buffer GetColumnData(uint32_t bindingPoint) const noexcept;
+
+        // The column viewed as T, which must be as large as a row, e.g. Math::Mat4x4 for TRANSFORM. EditColumn counts as a Set of every row
+        template <typename T>
+        std::span<const T> GetColumn(uint32_t bindingPoint) const noexcept
+        {
+            const Column& column{ GetColumnByBindingPoint(bindingPoint) };
+            DL_ASSERT(column.Stride == sizeof(T), "Column of the binding point [{0}] is not an array of the requested type", bindingPoint);
+
+            return std::span<const T>{ reinterpret_cast<const T*>(column.Data.data()), GetInstanceCount() };
+        }
+
+        template <typename T>
+        std::span<T> EditColumn(uint32_t bindingPoint) noexcept
+        {
+            Column& column{ GetColumnByBindingPoint(bindingPoint) };
+            DL_ASSERT(column.Stride == sizeof(T), "Column of the binding point [{0}] is not an array of the requested type", bindingPoint);
+
+            for (uint32_t& dataVersion : m_Rows.column<DATA_VERSION_COLUMN>())
+                ++dataVersion;
+
+            if (m_TransformHandle.IsValid() && &column == &m_Columns[m_TransformHandle.Column])
+                for (uint32_t& transformVersion : m_Rows.column<TRANSFORM_VERSION_COLUMN>())
+                    ++transformVersion;
+
+            return std::span<T>{ reinterpret_cast<T*>(column.Data.data()), GetInstanceCount() };
+        }
+
+        // Incremented by every Set of the row, see Instance::GetDataVersion and Instance::GetTransformVersion
+        uint32_t GetDataVersion(ID id) const noexcept { return m_Rows.get<DATA_VERSION_COLUMN>(id); }
+        uint32_t GetTransformVersion(ID id) const noexcept { return m_Rows.get<TRANSFORM_VERSION_COLUMN>(id); }
+        // Versions of all the rows, indexed as the columns
+        std::span<const uint32_t> GetDataVersions() const noexcept { return m_Rows.column<DATA_VERSION_COLUMN>(); }
+        std::span<const uint32_t> GetTransformVersions() const noexcept { return m_Rows.column<TRANSFORM_VERSION_COLUMN>(); }
+
+        // Rows move when other instances are freed, resolve the IDs again after every Free
+        uint32_t GetRowIndex(ID id) const noexcept { return m_Rows.getIndex(id); }
+        solid_vector_indices GetRowIndices() const noexcept { return m_Rows.indices(); }
+        ID GetID(uint32_t rowIndex) const noexcept { return m_Rows.getID(rowIndex); }
+        uint32_t GetInstanceCount() const noexcept { return m_Rows.size(); }
+
+        const Ref<Shader>& GetShader() const noexcept { return m_Shader; }
+
+    private:
+        struct Column
+        {
+            uint32_t BindingPoint{ 0u };
+            size_t Stride{ 0u };
+            std::vector<uint8_t> Data{};
+        };
+
+        static constexpr size_t DATA_VERSION_COLUMN{ 0u };
+        static constexpr size_t TRANSFORM_VERSION_COLUMN{ 1u };
+
+    private:
+        const Column& GetColumnByBindingPoint(uint32_t bindingPoint) const noexcept;
+        Column& GetColumnByBindingPoint(uint32_t bindingPoint) noexcept;
+
+    private:
+        Ref<Shader> m_Shader;
+
+        std::vector<Column> m_Columns;
+        std::unordered_map<std::string, UniformHandle> m_UniformHandles;
+        UniformHandle m_TransformHandle;
+
+        // Versions of every row, kept in the order of the columns. The solid_vector moves them with the rows and maps the IDs
+        solid_vector<uint32_t, uint32_t> m_Rows;
+    };
+
+    // Hands out the store of a shader to the instances created for it, one store per shader at a time.
+    // The library does not own the stores: a store lives as long as the instances and the registries holding its rows,
+    // and releases its shader with it. Entries of released stores are dropped whenever a new store is created
+    class InstanceStoreLibrary
+    {
+    public:
+        Ref<InstanceStore> Get(const Ref<Shader>& shader);
+
+    private:
+        std::unordered_map<std::string, std::weak_ptr<InstanceStore>> m_Stores;
+    };
+}
@@ -0,0 +1,207 @@
+#include "dlpch.h"
+#include "LightClusters.h"
+
+#include "DLEngine/Math/Intersections.h"
+
+namespace DLEngine
+{
+    namespace
+    {
+        constexpr uint32_t CLUSTERS_PER_SLICE{ LightClusters::ClustersCountX * LightClusters::ClustersCountY };
+
+        // The first slice covers everything up to this fraction of the view distance,
+        // so the exponential slices are not wasted on the space right in front of the camera
+        constexpr float FIRST_SLICE_DEPTH_FRACTION{ 0.005f };
+
+        // Cones wider than this are bounded better by a sphere centered on the cone cap
+        constexpr float COS_QUARTER_PI{ std::numbers::sqrt2_v<float> * 0.5f };
+
+        // Tightest sphere around the cone of the spot light, the whole range sphere for wide cones
+        Math::Sphere SpotLightBoundingSphere(const Math::Vec3& position, const Math::Vec3& direction, float range, float cutoffCos) noexcept
+        {
+            if (cutoffCos <= 0.0f)
+                return Math::Sphere{ position, range };
+
+            if (cutoffCos <= COS_QUARTER_PI)
+            {
+                const float cutoffSin{ Math::Sqrt(1.0f - cutoffCos * cutoffCos) };
+                return Math::Sphere{ position + direction * (range * cutoffCos), range * cutoffSin };
+            }
+
+            const float radius{ range / (2.0f * cutoffCos) };
+            return Math::Sphere{ position + direction * radius, radius };
+        }
+    }
+
+    LightClusters::LightClusters()
+    {
+        m_ClusterBoundingBoxes.resize(ClustersCount);
+        m_ClusterLightRanges.resize(ClustersCount);
+
+        for (auto& slice : m_Slices)
+        {
+            slice.PointLightsCount.resize(CLUSTERS_PER_SLICE);
+            slice.SpotLightsCount.resize(CLUSTERS_PER_SLICE);
+            slice.LightOffsets.resize(CLUSTERS_PER_SLICE);
+            slice.VisibleClusters.resize(CLUSTERS_PER_SLICE);
+        }
+    }
+
+    void LightClusters::Build(const Camera& camera, std::span<const PointLight> pointLights, std::span<const SpotLight> spotLights, float contributionThreshold)
+    {
+        BuildClusterBoundingBoxes(camera);
+
+        const Math::Mat4x4 view{ camera.GetViewMatrix() };
+        const uint32_t pointLightsCount{ static_cast<uint32_t>(pointLights.size()) };
+
+        m_LightBoundingSpheres.resize(pointLights.size() + spotLights.size());
+        for (uint32_t i{ 0u }; i < pointLightsCount; ++i)
+        {
+            const auto& light{ pointLights[i] };
+            m_LightBoundingSpheres[i] = Math::Sphere{
+                Math::PointToSpace(light.Position, view),
+                Utils::SphereLightContributionDistance(contributionThreshold, light.Radius)
+            };
+        }
+        for (size_t i{ 0u }; i < spotLights.size(); ++i)
+        {
+            const auto& light{ spotLights[i] };
+            m_LightBoundingSpheres[pointLightsCount + i] = SpotLightBoundingSphere(
+                Math::PointToSpace(light.Position, view),
+                Math::DirectionToSpace(light.Direction, view),
+                Utils::SphereLightContributionDistance(contributionThreshold, light.Radius),
+                light.OuterCutoffCos
+            );
+        }
+
+        // Every slice owns its clusters, so the slices are filled independently
+        std::for_each(std::execution::par, m_Slices.begin(), m_Slices.end(),
+            [this, pointLightsCount](ClusterSlice& slice)
+            {
+                const size_t sliceIndex{ static_cast<size_t>(&slice - m_Slices.data()) };
+                const std::span<const Math::AABB> sliceBoundingBoxes{ m_ClusterBoundingBoxes.data() + sliceIndex * CLUSTERS_PER_SLICE, CLUSTERS_PER_SLICE };
+
+                std::ranges::fill(slice.PointLightsCount, 0u);
+                std::ranges::fill(slice.SpotLightsCount, 0u);
+                slice.Assignments.clear();
+
+                // Point lights are assigned before the spot lights, the stable counting sort below keeps that order in every cluster
+                for (uint32_t lightIndex{ 0u }; lightIndex < static_cast<uint32_t>(m_LightBoundingSpheres.size()); ++lightIndex)
+                {
+                    const auto& sphere{ m_LightBoundingSpheres[lightIndex] };
+                    if (sphere.Center.z + sphere.Radius < slice.NearZ || sphere.Center.z - sphere.Radius > slice.FarZ)
+                        continue;
+
+                    const uint32_t visibleCount{ Math::Intersects(sphere, sliceBoundingBoxes, slice.VisibleClusters) };
+
+                    const bool isPointLight{ lightIndex < pointLightsCount };
+                    auto& lightsCount{ isPointLight ? slice.PointLightsCount : slice.SpotLightsCount };
+                    const uint32_t typeLightIndex{ isPointLight ? lightIndex : lightIndex - pointLightsCount };
+
+                    for (uint32_t i{ 0u }; i < visibleCount; ++i)
+                    {
+                        const uint32_t clusterIndex{ slice.VisibleClusters[i] };
+                        ++lightsCount[clusterIndex];
+                        slice.Assignments.emplace_back(clusterIndex, typeLightIndex);
+                    }
+                }
+
+                uint32_t offset{ 0u };
+                for (uint32_t clusterIndex{ 0u }; clusterIndex < CLUSTERS_PER_SLICE; ++clusterIndex)
+                {
+                    slice.LightOffsets[clusterIndex] = offset;
+                    offset += slice.PointLightsCount[clusterIndex] + slice.SpotLightsCount[clusterIndex];
+                }
+
+                slice.LightIndices.resize(slice.Assignments.size());
+
+                std::array<uint32_t, CLUSTERS_PER_SLICE> writeOffsets{};
+                std::ranges::copy(slice.LightOffsets, writeOffsets.begin());
+                for (const auto& [clusterIndex, lightIndex] : slice.Assignments)
+                    slice.LightIndices[writeOffsets[clusterIndex]++] = lightIndex;
+            }
+        );
+
+        uint32_t lightIndicesCount{ 0u };
+        for (auto& slice : m_Slices)
+        {
+            slice.GlobalOffset = lightIndicesCount;
+            lightIndicesCount += static_cast<uint32_t>(slice.LightIndices.size());
+        }
+
+        m_LightIndices.resize(lightIndicesCount);
+
+        std::for_each(std::execution::par, m_Slices.begin(), m_Slices.end(),
+            [this](const ClusterSlice& slice)
+            {
+                const size_t sliceIndex{ static_cast<size_t>(&slice - m_Slices.data()) };
+
+                std::ranges::copy(slice.LightIndices, m_LightIndices.begin() + slice.GlobalOffset);
+
+                for (uint32_t clusterIndex{ 0u }; clusterIndex < CLUSTERS_PER_SLICE; ++clusterIndex)
+                {
+                    auto& range{ m_ClusterLightRanges[sliceIndex * CLUSTERS_PER_SLICE + clusterIndex] };
+                    range.Offset = slice.GlobalOffset + slice.LightOffsets[clusterIndex];
+                    range.PointLightsCount = slice.PointLightsCount[clusterIndex];
+                    range.SpotLightsCount = slice.SpotLightsCount[clusterIndex];
+                }
+            }
+        );
+    }
+
+    void LightClusters::BuildClusterBoundingBoxes(const Camera& camera) noexcept
+    {
+        // The reversed depth cameras pass the far distance as nearZ
+        const float viewNearZ{ Math::Min(camera.GetNearZ(), camera.GetFarZ()) };
+        const float viewFarZ{ Math::Max(camera.GetNearZ(), camera.GetFarZ()) };
+        const float firstSliceFarZ{ Math::Max(viewNearZ, viewFarZ * FIRST_SLICE_DEPTH_FRACTION) };
+
+        // The first slice starts at the camera, the rest split [firstSliceFarZ, viewFarZ] exponentially
+        m_SliceScale = static_cast<float>(ClustersCountZ - 1u) / Math::Log(viewFarZ / firstSliceFarZ);
+        m_SliceBias = 1.0f - Math::Log(firstSliceFarZ) * m_SliceScale;
+
+        m_Slices[0u].NearZ = 0.0f;
+        m_Slices[0u].FarZ = firstSliceFarZ;
+        for (uint32_t z{ 1u }; z < ClustersCountZ; ++z)
+        {
+            m_Slices[z].NearZ = m_Slices[z - 1u].FarZ;
+            m_Slices[z].FarZ = firstSliceFarZ * Math::Pow(viewFarZ / firstSliceFarZ, static_cast<float>(z) / static_cast<float>(ClustersCountZ - 1u));
+        }
+
+        // View space extents of the NDC square at unit depth
+        const Math::Mat4x4 projection{ camera.GetProjectionMatrix() };
+        const float unitDepthHalfWidth{ 1.0f / projection._11 };
+        const float unitDepthHalfHeight{ 1.0f / projection._22 };
+
+        for (uint32_t z{ 0u }; z < ClustersCountZ; ++z)
+        {
+            const float nearZ{ m_Slices[z].NearZ };
+            const float farZ{ m_Slices[z].FarZ };
+
+            for (uint32_t y{ 0u }; y < ClustersCountY; ++y)
+            {
+                // Rows go from the top of the screen to the bottom, as the texture coordinates do
+                const float tileTop{ (1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(ClustersCountY)) * unitDepthHalfHeight };
+                const float tileBottom{ (1.0f - 2.0f * static_cast<float>(y + 1u) / static_cast<float>(ClustersCountY)) * unitDepthHalfHeight };
+
+                for (uint32_t x{ 0u }; x < ClustersCountX; ++x)
+                {
+                    const float tileLeft{ (2.0f * static_cast<float>(x) / static_cast<float>(ClustersCountX) - 1.0f) * unitDepthHalfWidth };
+                    const float tileRight{ (2.0f * static_cast<float>(x + 1u) / static_cast<float>(ClustersCountX) - 1.0f) * unitDepthHalfWidth };
+
+                    auto& aabb{ m_ClusterBoundingBoxes[(z * ClustersCountY + y) * ClustersCountX + x] };
+                    aabb.Min = Math::Vec3{
+                        Math::Min(Math::Min(tileLeft * nearZ, tileLeft * farZ), Math::Min(tileRight * nearZ, tileRight * farZ)),
+                        Math::Min(Math::Min(tileBottom * nearZ, tileBottom * farZ), Math::Min(tileTop * nearZ, tileTop * farZ)),
+                        nearZ
+                    };
+                    aabb.Max = Math::Vec3{
+                        Math::Max(Math::Max(tileLeft * nearZ, tileLeft * farZ), Math::Max(tileRight * nearZ, tileRight * farZ)),
+                        Math::Max(Math::Max(tileBottom * nearZ, tileBottom * farZ), Math::Max(tileTop * nearZ, tileTop * farZ)),
+                        farZ
+                    };
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "DLEngine/Renderer/Camera.h"
+#include "DLEngine/Renderer/Scene.h"
+
+namespace DLEngine
+{
+    // Clustered light assignment. The camera frustum is sliced into a grid of view space clusters,
+    // screen aligned tiles in XY and exponential slices in depth, and every point and spot light
+    // is assigned to the clusters its contribution bounds touch.
+    // The result is a compact list of light indices and a table with the range of the list for every cluster
+    class LightClusters
+    {
+    public:
+        static constexpr uint32_t ClustersCountX{ 16u };
+        static constexpr uint32_t ClustersCountY{ 9u };
+        static constexpr uint32_t ClustersCountZ{ 24u };
+        static constexpr uint32_t ClustersCount{ ClustersCountX * ClustersCountY * ClustersCountZ };
+
+        // Point lights of the cluster go first, then its spot lights
+        struct ClusterLightRange
+        {
+            uint32_t Offset{ 0u };
+            uint32_t PointLightsCount{ 0u };
+            uint32_t SpotLightsCount{ 0u };
+        };
+
+    public:
+        LightClusters();
+
+        // Lights are expected in world space, their influence is bounded by the distance where
+        // the contribution falls below contributionThreshold
+        void Build(const Camera& camera, std::span<const PointLight> pointLights, std::span<const SpotLight> spotLights, float contributionThreshold);
+
+        std::span<const ClusterLightRange> GetClusterLightRanges() const noexcept { return m_ClusterLightRanges; }
+        std::span<const uint32_t> GetLightIndices() const noexcept { return m_LightIndices; }
+
+        // Depth slice of a view space depth z is floor(log(z) * scale + bias), clamped to the slices count
+        float GetSliceScale() const noexcept { return m_SliceScale; }
+        float GetSliceBias() const noexcept { return m_SliceBias; }
+
+    private:
+        void BuildClusterBoundingBoxes(const Camera& camera) noexcept;
+
+    private:
+        struct ClusterSlice
+        {
+            float NearZ{ 0.0f };
+            float FarZ{ 0.0f };
+
+            std::vector<uint32_t> PointLightsCount;
+            std::vector<uint32_t> SpotLightsCount;
+            std::vector<uint32_t> LightOffsets;
+
+            // Local cluster index and light index of every light to cluster assignment in the slice
+            std::vector<std::pair<uint32_t, uint32_t>> Assignments;
+            std::vector<uint32_t> LightIndices;
+            std::vector<uint32_t> VisibleClusters;
+
+            uint32_t GlobalOffset{ 0u };
+        };
+
+        std::array<ClusterSlice, ClustersCountZ> m_Slices;
+
+        // View space bounds of the clusters, slice by slice
+        std::vector<Math::AABB> m_ClusterBoundingBoxes;
+        std::vector<Math::Sphere> m_LightBoundingSpheres;
+
+        std::vector<ClusterLightRange> m_ClusterLightRanges;
+        std::vector<uint32_t> m_LightIndices;
+
+        float m_SliceScale{ 0.0f };
+        float m_SliceBias{ 0.0f };
+    };
+}
@@ -0,0 +1,442 @@
+#include "dlpch.h"
+#include "BVHBuilder.h"
+
+#include <bit>
+#include <numeric>
+
+namespace DLEngine
+{
+    namespace
+    {
+        constexpr uint32_t BIN_COUNT{ 16u };
+
+        constexpr float TRAVERSAL_COST{ 1.0f };
+        constexpr float PRIMITIVE_INTERSECTION_COST{ 1.0f };
+
+        // Below these sizes the synchronization costs more than the work itself
+        constexpr uint32_t PARALLEL_BINNING_THRESHOLD{ 1u << 16u };
+        constexpr uint32_t PARALLEL_BINNING_CHUNK_SIZE{ 1u << 14u };
+        constexpr uint32_t PARALLEL_SUBTREE_THRESHOLD{ 1u << 12u };
+
+        // PrimitiveCount of an upper level node whose subtree is built by a task, Offset is the index of the task
+        constexpr uint32_t DEFERRED_SUBTREE{ std::numeric_limits<uint32_t>::max() };
+
+        struct Bin
+        {
+            Math::AABB BoundingBox{ BVHBuilder::EmptyAABB() };
+            uint32_t PrimitiveCount{ 0u };
+        };
+
+        using AxisBins = std::array<std::array<Bin, BIN_COUNT>, 3u>;
+
+        struct RangeBounds
+        {
+            Math::AABB BoundingBox{ BVHBuilder::EmptyAABB() };
+            Math::AABB CentroidBoundingBox{ BVHBuilder::EmptyAABB() };
+        };
+
+        float SurfaceArea(const Math::AABB& aabb) noexcept
+        {
+            const float dx{ aabb.Max.x - aabb.Min.x };
+            const float dy{ aabb.Max.y - aabb.Min.y };
+            const float dz{ aabb.Max.z - aabb.Min.z };
+
+            if (dx < 0.0f || dy < 0.0f || dz < 0.0f)
+                return 0.0f;
+
+            return 2.0f * (dx * dy + dy * dz + dz * dx);
+        }
+
+        float Component(const Math::Vec3& v, uint32_t axis) noexcept
+        {
+            return reinterpret_cast<const float*>(&v)[axis];
+        }
+
+        RangeBounds MergeBounds(const RangeBounds& lhs, const RangeBounds& rhs) noexcept
+        {
+            RangeBounds merged{ lhs };
+            BVHBuilder::Grow(merged.BoundingBox, rhs.BoundingBox);
+            BVHBuilder::Grow(merged.CentroidBoundingBox, rhs.CentroidBoundingBox);
+            return merged;
+        }
+
+        void BinPrimitives(
+            AxisBins& bins,
+            const std::vector<BVHBuilder::Primitive>& primitives,
+            const uint32_t* firstIndex,
+            const uint32_t* lastIndex,
+            const Math::AABB& centroidBounds
+        ) noexcept
+        {
+            for (uint32_t axis{ 0u }; axis < 3u; ++axis)
+            {
+                const float axisMin{ Component(centroidBounds.Min, axis) };
+                const float axisExtent{ Component(centroidBounds.Max, axis) - axisMin };
+                if (axisExtent <= 0.0f)
+                    continue;
+
+                const float binScale{ static_cast<float>(BIN_COUNT) / axisExtent };
+
+                for (const uint32_t* index{ firstIndex }; index != lastIndex; ++index)
+                {
+                    const BVHBuilder::Primitive& primitive{ primitives[*index] };
+                    const uint32_t binIndex{ std::min(BIN_COUNT - 1u,
+                        static_cast<uint32_t>((Component(primitive.Centroid, axis) - axisMin) * binScale)) };
+
+                    BVHBuilder::Grow(bins[axis][binIndex].BoundingBox, primitive.BoundingBox);
+                    ++bins[axis][binIndex].PrimitiveCount;
+                }
+            }
+        }
+
+        void AppendSubtree(std::vector<BVHNode>& nodes, const std::vector<BVHNode>& subtree)
+        {
+            const uint32_t baseIndex{ static_cast<uint32_t>(nodes.size()) };
+            for (BVHNode node : subtree)
+            {
+                // Leaves address the shared primitive indices, only the child links have to move
+                if (!node.IsLeaf())
+                    node.Offset += baseIndex;
+
+                nodes.push_back(node);
+            }
+        }
+    }
+
+    void BVHBuilder::Build(
+        const std::vector<Primitive>& primitives,
+        uint32_t maxPrimitivesPerLeaf,
+        std::vector<BVHNode>& outNodes,
+        std::vector<uint32_t>& outPrimitiveIndices
+    )
+    {
+        outNodes.clear();
+        outPrimitiveIndices.clear();
+
+        if (primitives.empty())
+            return;
+
+        outPrimitiveIndices.resize(primitives.size());
+        std::iota(outPrimitiveIndices.begin(), outPrimitiveIndices.end(), 0u);
+
+        outNodes.reserve(2u * primitives.size() - 1u);
+
+        const uint32_t primitiveCount{ static_cast<uint32_t>(primitives.size()) };
+
+        BVHBuilder builder{ primitives, maxPrimitivesPerLeaf, outPrimitiveIndices };
+        if (primitiveCount < 2u * PARALLEL_SUBTREE_THRESHOLD)
+        {
+            builder.BuildNode(outNodes, 0u, primitiveCount, 0u);
+            outNodes.shrink_to_fit();
+            return;
+        }
+
+        // The upper levels are split first, the subtrees below them go to one parallel loop. Builds nested in other
+        // parallel loops, e.g. the submeshes of a mesh, share the executor of the parallel algorithms instead of starting threads
+        std::vector<BVHNode> upperNodes{};
+        builder.m_IsDeferringSubtrees = true;
+        builder.BuildNode(upperNodes, 0u, primitiveCount, 0u);
+        builder.m_IsDeferringSubtrees = false;
+
+        std::for_each(std::execution::par, builder.m_SubtreeTasks.begin(), builder.m_SubtreeTasks.end(),
+            [&builder](SubtreeTask& task)
+            {
+                task.Nodes.reserve(2u * task.PrimitiveCount - 1u);
+                builder.BuildNode(task.Nodes, task.FirstPrimitive, task.PrimitiveCount, task.Depth);
+            }
+        );
+
+        builder.AssembleNode(outNodes, upperNodes, 0u);
+        outNodes.shrink_to_fit();
+    }
+
+    void BVHBuilder::Compact(const std::vector<BVHNode>& nodes, std::vector<CompactBVHNode>& outCompactNodes)
+    {
+        outCompactNodes.clear();
+        outCompactNodes.resize(nodes.size());
+
+        if (nodes.empty())
+            return;
+
+        // Children are quantized against the dequantized parent, exactly as the traversal will decode them
+        std::vector<Math::AABB> dequantizedBoundingBoxes(nodes.size());
+        dequantizedBoundingBoxes[0u] = nodes[0u].BoundingBox;
+        outCompactNodes[0u].QuantizedMin = { 0u, 0u, 0u };
+        outCompactNodes[0u].QuantizedMax = { 255u, 255u, 255u };
+
+        for (uint32_t nodeIndex{ 0u }; nodeIndex < nodes.size(); ++nodeIndex)
+        {
+            const BVHNode& node{ nodes[nodeIndex] };
+            CompactBVHNode& compactNode{ outCompactNodes[nodeIndex] };
+            compactNode.Offset = node.Offset;
+            compactNode.PrimitiveCount = node.PrimitiveCount;
+
+            if (node.IsLeaf())
+                continue;
+
+            const Math::AABB& parentBoundingBox{ dequantizedBoundingBoxes[nodeIndex] };
+            for (const uint32_t childIndex : { nodeIndex + 1u, node.Offset })
+            {
+                const Math::AABB& childBoundingBox{ nodes[childIndex].BoundingBox };
+                CompactBVHNode& compactChild{ outCompactNodes[childIndex] };
+
+                for (uint32_t axis{ 0u }; axis < 3u; ++axis)
+                {
+                    const float parentMin{ Component(parentBoundingBox.Min, axis) };
+                    const float parentExtent{ Component(parentBoundingBox.Max, axis) - parentMin };
+                    const float scale{ parentExtent > 0.0f ? 255.0f / parentExtent : 0.0f };
+
+                    const float childMin{ Component(childBoundingBox.Min, axis) };
+                    const float childMax{ Component(childBoundingBox.Max, axis) };
+
+                    int32_t quantizedMin{ std::clamp(static_cast<int32_t>(std::floor((childMin - parentMin) * scale)), 0, 255) };
+                    int32_t quantizedMax{ std::clamp(static_cast<int32_t>(std::ceil((childMax - parentMin) * scale)), 0, 255) };
+
+                    // Step outwards until the decoded planes enclose the child despite the rounding
+                    const auto DecodedPlane = [&compactChild, &parentBoundingBox, axis](bool isMax, int32_t quantized)
+                        {
+                            CompactBVHNode probe{ compactChild };
+                            probe.QuantizedMin[axis] = static_cast<uint8_t>(quantized);
+                            probe.QuantizedMax[axis] = static_cast<uint8_t>(quantized);
+                            const Math::AABB decoded{ probe.Dequantize(parentBoundingBox) };
+                            return Component(isMax ? decoded.Max : decoded.Min, axis);
+                        };
+
+                    while (quantizedMin > 0 && DecodedPlane(false, quantizedMin) > childMin)
+                        --quantizedMin;
+                    while (quantizedMax < 255 && DecodedPlane(true, quantizedMax) < childMax)
+                        ++quantizedMax;
+
+                    compactChild.QuantizedMin[axis] = static_cast<uint8_t>(quantizedMin);
+                    compactChild.QuantizedMax[axis] = static_cast<uint8_t>(quantizedMax);
+                }
+
+                dequantizedBoundingBoxes[childIndex] = compactChild.Dequantize(parentBoundingBox);
+            }
+        }
+    }
+
+    Math::AABB BVHBuilder::EmptyAABB() noexcept
+    {
+        return Math::AABB{ .Min = Math::Vec3{ Math::Numeric::Max }, .Max = Math::Vec3{ -Math::Numeric::Max } };
+    }
+
+    void BVHBuilder::Grow(Math::AABB& aabb, const Math::AABB& other) noexcept
+    {
+        aabb.Min.x = std::min(aabb.Min.x, other.Min.x);
+        aabb.Min.y = std::min(aabb.Min.y, other.Min.y);
+        aabb.Min.z = std::min(aabb.Min.z, other.Min.z);
+        aabb.Max.x = std::max(aabb.Max.x, other.Max.x);
+        aabb.Max.y = std::max(aabb.Max.y, other.Max.y);
+        aabb.Max.z = std::max(aabb.Max.z, other.Max.z);
+    }
+
+    void BVHBuilder::Grow(Math::AABB& aabb, const Math::Vec3& point) noexcept
+    {
+        aabb.Min.x = std::min(aabb.Min.x, point.x);
+        aabb.Min.y = std::min(aabb.Min.y, point.y);
+        aabb.Min.z = std::min(aabb.Min.z, point.z);
+        aabb.Max.x = std::max(aabb.Max.x, point.x);
+        aabb.Max.y = std::max(aabb.Max.y, point.y);
+        aabb.Max.z = std::max(aabb.Max.z, point.z);
+    }
+
+    BVHBuilder::BVHBuilder(const std::vector<Primitive>& primitives, uint32_t maxPrimitivesPerLeaf, std::vector<uint32_t>& primitiveIndices)
+        : m_Primitives(primitives)
+        , m_PrimitiveIndices(primitiveIndices)
+        , m_MaxPrimitivesPerLeaf(maxPrimitivesPerLeaf)
+        // A few more tasks than cores keeps the workers busy when the splits are uneven
+        , m_MaxTaskDepth(static_cast<uint32_t>(std::bit_width(std::max(std::thread::hardware_concurrency(), 1u))) + 1u)
+    {}
+
+    uint32_t BVHBuilder::BuildNode(std::vector<BVHNode>& nodes, uint32_t firstPrimitive, uint32_t primitiveCount, uint32_t depth)
+    {
+        const uint32_t nodeIndex{ static_cast<uint32_t>(nodes.size()) };
+
+        if (m_IsDeferringSubtrees && (depth >= m_MaxTaskDepth || primitiveCount < PARALLEL_SUBTREE_THRESHOLD))
+        {
+            nodes.push_back(BVHNode{ .Offset = static_cast<uint32_t>(m_SubtreeTasks.size()), .PrimitiveCount = DEFERRED_SUBTREE });
+            m_SubtreeTasks.push_back(SubtreeTask{ .FirstPrimitive = firstPrimitive, .PrimitiveCount = primitiveCount, .Depth = depth });
+            return nodeIndex;
+        }
+
+        nodes.emplace_back();
+
+        const bool isParallel{ primitiveCount >= PARALLEL_BINNING_THRESHOLD };
+
+        const uint32_t* firstIndex{ m_PrimitiveIndices.data() + firstPrimitive };
+        const uint32_t* lastIndex{ firstIndex + primitiveCount };
+
+        const auto PrimitiveBounds = [this](uint32_t primitiveIndex)
+            {
+                const Primitive& primitive{ m_Primitives[primitiveIndex] };
+                return RangeBounds{
+                    .BoundingBox = primitive.BoundingBox,
+                    .CentroidBoundingBox = Math::AABB{ .Min = primitive.Centroid, .Max = primitive.Centroid }
+                };
+            };
+
+        const RangeBounds rangeBounds{ isParallel ?
+            std::transform_reduce(std::execution::par_unseq, firstIndex, lastIndex, RangeBounds{}, &MergeBounds, PrimitiveBounds) :
+            std::transform_reduce(firstIndex, lastIndex, RangeBounds{}, &MergeBounds, PrimitiveBounds)
+        };
+
+        const Math::AABB& bounds{ rangeBounds.BoundingBox };
+        const Math::AABB& centroidBounds{ rangeBounds.CentroidBoundingBox };
+
+        nodes[nodeIndex].BoundingBox = bounds;
+
+        const auto MakeLeaf = [&nodes, nodeIndex, firstPrimitive, primitiveCount]()
+            {
+                nodes[nodeIndex].Offset = firstPrimitive;
+                nodes[nodeIndex].PrimitiveCount = primitiveCount;
+                return nodeIndex;
+            };
+
+        if (primitiveCount == 1u || depth + 1u >= MaxDepth)
+            return MakeLeaf();
+
+        AxisBins bins{};
+        if (isParallel)
+        {
+            // Every chunk fills its own bins, which are merged afterwards
+            const uint32_t chunkCount{ (primitiveCount + PARALLEL_BINNING_CHUNK_SIZE - 1u) / PARALLEL_BINNING_CHUNK_SIZE };
+            std::vector<AxisBins> chunkBins(chunkCount);
+            std::for_each(std::execution::par, chunkBins.begin(), chunkBins.end(),
+                [this, &chunkBins, &centroidBounds, firstIndex, lastIndex](AxisBins& chunk)
+                {
+                    const size_t chunkIndex{ static_cast<size_t>(&chunk - chunkBins.data()) };
+                    const uint32_t* chunkFirst{ firstIndex + chunkIndex * PARALLEL_BINNING_CHUNK_SIZE };
+                    const uint32_t* chunkLast{ std::min(chunkFirst + PARALLEL_BINNING_CHUNK_SIZE, lastIndex) };
+                    BinPrimitives(chunk, m_Primitives, chunkFirst, chunkLast, centroidBounds);
+                }
+            );
+
+            for (const AxisBins& chunk : chunkBins)
+            {
+                for (uint32_t axis{ 0u }; axis < 3u; ++axis)
+                {
+                    for (uint32_t i{ 0u }; i < BIN_COUNT; ++i)
+                    {
+                        Grow(bins[axis][i].BoundingBox, chunk[axis][i].BoundingBox);
+                        bins[axis][i].PrimitiveCount += chunk[axis][i].PrimitiveCount;
+                    }
+                }
+            }
+        }
+        else
+        {
+            BinPrimitives(bins, m_Primitives, firstIndex, lastIndex, centroidBounds);
+        }
+
+        float bestCost{ Math::Numeric::Max };
+        uint32_t bestAxis{ 0u };
+        uint32_t bestSplit{ 0u };
+
+        for (uint32_t axis{ 0u }; axis < 3u; ++axis)
+        {
+            const std::array<Bin, BIN_COUNT>& axisBins{ bins[axis] };
+
+            // Sweep from the right to gather the area and count of every right partition
+            std::array<float, BIN_COUNT - 1u> rightAreas{};
+            std::array<uint32_t, BIN_COUNT - 1u> rightCounts{};
+            Math::AABB rightBounds{ EmptyAABB() };
+            uint32_t rightCount{ 0u };
+            for (uint32_t i{ BIN_COUNT - 1u }; i > 0u; --i)
+            {
+                Grow(rightBounds, axisBins[i].BoundingBox);
+                rightCount += axisBins[i].PrimitiveCount;
+                rightAreas[i - 1u] = SurfaceArea(rightBounds);
+                rightCounts[i - 1u] = rightCount;
+            }
+
+            Math::AABB leftBounds{ EmptyAABB() };
+            uint32_t leftCount{ 0u };
+            for (uint32_t i{ 0u }; i < BIN_COUNT - 1u; ++i)
+            {
+                Grow(leftBounds, axisBins[i].BoundingBox);
+                leftCount += axisBins[i].PrimitiveCount;
+
+                if (leftCount == 0u || rightCounts[i] == 0u)
+                    continue;
+
+                const float cost{ SurfaceArea(leftBounds) * static_cast<float>(leftCount) + rightAreas[i] * static_cast<float>(rightCounts[i]) };
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        uint32_t splitIndex{ firstPrimitive + primitiveCount / 2u };
+
+        const bool hasSplit{ bestCost != Math::Numeric::Max };
+        if (hasSplit)
+        {
+            const float nodeArea{ SurfaceArea(bounds) };
+            const float splitCost{ TRAVERSAL_COST + PRIMITIVE_INTERSECTION_COST * (nodeArea > 0.0f ? bestCost / nodeArea : static_cast<float>(primitiveCount)) };
+            const float leafCost{ PRIMITIVE_INTERSECTION_COST * static_cast<float>(primitiveCount) };
+
+            if (splitCost >= leafCost && primitiveCount <= m_MaxPrimitivesPerLeaf)
+                return MakeLeaf();
+
+            const float axisMin{ Component(centroidBounds.Min, bestAxis) };
+            const float binScale{ static_cast<float>(BIN_COUNT) / (Component(centroidBounds.Max, bestAxis) - axisMin) };
+
+            const auto IsLeft = [this, bestAxis, bestSplit, axisMin, binScale](uint32_t primitiveIndex)
+                {
+                    const uint32_t binIndex{ std::min(BIN_COUNT - 1u,
+                        static_cast<uint32_t>((Component(m_Primitives[primitiveIndex].Centroid, bestAxis) - axisMin) * binScale)) };
+                    return binIndex <= bestSplit;
+                };
+
+            const auto first{ m_PrimitiveIndices.begin() + firstPrimitive };
+            const auto middle{ isParallel ?
+                std::partition(std::execution::par, first, first + primitiveCount, IsLeft) :
+                std::partition(first, first + primitiveCount, IsLeft)
+            };
+
+            splitIndex = static_cast<uint32_t>(std::distance(m_PrimitiveIndices.begin(), middle));
+        }
+        else if (primitiveCount <= m_MaxPrimitivesPerLeaf)
+        {
+            // All centroids coincide, the primitives can't be separated by a plane
+            return MakeLeaf();
+        }
+
+        const uint32_t leftCount{ splitIndex - firstPrimitive };
+        const uint32_t rightCount{ primitiveCount - leftCount };
+
+        BuildNode(nodes, firstPrimitive, leftCount, depth + 1u);
+        const uint32_t secondChild{ BuildNode(nodes, splitIndex, rightCount, depth + 1u) };
+
+        nodes[nodeIndex].Offset = secondChild;
+        nodes[nodeIndex].PrimitiveCount = 0u;
+
+        return nodeIndex;
+    }
+
+    uint32_t BVHBuilder::AssembleNode(std::vector<BVHNode>& outNodes, const std::vector<BVHNode>& upperNodes, uint32_t upperIndex) const
+    {
+        const BVHNode& upperNode{ upperNodes[upperIndex] };
+        const uint32_t nodeIndex{ static_cast<uint32_t>(outNodes.size()) };
+
+        if (upperNode.PrimitiveCount == DEFERRED_SUBTREE)
+        {
+            AppendSubtree(outNodes, m_SubtreeTasks[upperNode.Offset].Nodes);
+            return nodeIndex;
+        }
+
+        outNodes.push_back(upperNode);
+        if (upperNode.IsLeaf())
+            return nodeIndex;
+
+        AssembleNode(outNodes, upperNodes, upperIndex + 1u);
+        outNodes[nodeIndex].Offset = AssembleNode(outNodes, upperNodes, upperNode.Offset);
+
+        return nodeIndex;
+    }
+
+}
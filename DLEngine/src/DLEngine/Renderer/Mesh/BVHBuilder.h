@@ -0,0 +1,132 @@
+#pragma once
+#include "DLEngine/Math/Primitives.h"
+
+namespace DLEngine
+{
+    // Slab test against the ray segment [0, tMax], returns the entry distance on hit
+    inline bool IntersectsSlabs(const Math::AABB& aabb, const Math::Vec3& origin, const Math::Vec3& invDirection, float tMax, float& outTNear) noexcept
+    {
+        const float tx1{ (aabb.Min.x - origin.x) * invDirection.x };
+        const float tx2{ (aabb.Max.x - origin.x) * invDirection.x };
+        float tNear{ std::min(tx1, tx2) };
+        float tFar{ std::max(tx1, tx2) };
+
+        const float ty1{ (aabb.Min.y - origin.y) * invDirection.y };
+        const float ty2{ (aabb.Max.y - origin.y) * invDirection.y };
+        tNear = std::max(tNear, std::min(ty1, ty2));
+        tFar = std::min(tFar, std::max(ty1, ty2));
+
+        const float tz1{ (aabb.Min.z - origin.z) * invDirection.z };
+        const float tz2{ (aabb.Max.z - origin.z) * invDirection.z };
+        tNear = std::max(tNear, std::min(tz1, tz2));
+        tFar = std::min(tFar, std::max(tz1, tz2));
+
+        outTNear = tNear;
+        return tNear <= tFar && tFar >= 0.0f && tNear <= tMax;
+    }
+
+    // Nodes are stored in depth-first order: the first child of an interior node
+    // always follows its parent, so only the second child index has to be stored
+    struct BVHNode
+    {
+        Math::AABB BoundingBox;
+        uint32_t Offset{ 0u }; // Second child index for interior nodes, first primitive for leaves
+        uint32_t PrimitiveCount{ 0u };
+
+        bool IsLeaf() const noexcept { return PrimitiveCount > 0u; }
+
+        bool Intersects(const Math::Vec3& origin, const Math::Vec3& invDirection, float tMax, float& outTNear) const noexcept
+        {
+            return IntersectsSlabs(BoundingBox, origin, invDirection, tMax, outTNear);
+        }
+    };
+
+    // Same layout as BVHNode with the bounds quantized to 8 bits inside the bounds of the parent,
+    // so four nodes share a cache line. The bounds are rounded outwards and never lose a primitive
+    struct CompactBVHNode
+    {
+        uint32_t Offset{ 0u };
+        uint32_t PrimitiveCount{ 0u };
+        std::array<uint8_t, 3u> QuantizedMin{};
+        std::array<uint8_t, 3u> QuantizedMax{};
+
+        bool IsLeaf() const noexcept { return PrimitiveCount > 0u; }
+
+        Math::AABB Dequantize(const Math::AABB& parentBoundingBox) const noexcept
+        {
+            // Interpolating from both ends keeps 0 and 255 exactly on the parent bounds
+            const auto Decode = [](float min, float max, uint8_t quantized)
+                {
+                    const float t{ static_cast<float>(quantized) * (1.0f / 255.0f) };
+                    return min * (1.0f - t) + max * t;
+                };
+
+            const Math::Vec3& min{ parentBoundingBox.Min };
+            const Math::Vec3& max{ parentBoundingBox.Max };
+
+            return Math::AABB{
+                .Min = Math::Vec3{ Decode(min.x, max.x, QuantizedMin[0]), Decode(min.y, max.y, QuantizedMin[1]), Decode(min.z, max.z, QuantizedMin[2]) },
+                .Max = Math::Vec3{ Decode(min.x, max.x, QuantizedMax[0]), Decode(min.y, max.y, QuantizedMax[1]), Decode(min.z, max.z, QuantizedMax[2]) }
+            };
+        }
+    };
+
+    static_assert(sizeof(CompactBVHNode) == 16u);
+
+    class BVHBuilder
+    {
+    public:
+        struct Primitive
+        {
+            Math::AABB BoundingBox;
+            Math::Vec3 Centroid;
+        };
+
+        static constexpr uint32_t MaxDepth{ 64u };
+
+    public:
+        // Binned SAH build, outPrimitiveIndices maps leaf ranges to the indices of the input primitives.
+        // Large ranges are binned and partitioned in parallel, and the subtrees below the upper levels are built in parallel
+        static void Build(
+            const std::vector<Primitive>& primitives,
+            uint32_t maxPrimitivesPerLeaf,
+            std::vector<BVHNode>& outNodes,
+            std::vector<uint32_t>& outPrimitiveIndices
+        );
+
+        // Quantizes every node against its parent, the full precision root bounds have to be kept by the caller
+        static void Compact(const std::vector<BVHNode>& nodes, std::vector<CompactBVHNode>& outCompactNodes);
+
+        static Math::AABB EmptyAABB() noexcept;
+        static void Grow(Math::AABB& aabb, const Math::AABB& other) noexcept;
+        static void Grow(Math::AABB& aabb, const Math::Vec3& point) noexcept;
+
+    private:
+        BVHBuilder(const std::vector<Primitive>& primitives, uint32_t maxPrimitivesPerLeaf, std::vector<uint32_t>& primitiveIndices);
+
+        // Appends the subtree to nodes and returns the index of its root
+        uint32_t BuildNode(std::vector<BVHNode>& nodes, uint32_t firstPrimitive, uint32_t primitiveCount, uint32_t depth);
+
+        // Copies the upper levels to outNodes in depth-first order with the built subtrees spliced in, returns the index of the copy
+        uint32_t AssembleNode(std::vector<BVHNode>& outNodes, const std::vector<BVHNode>& upperNodes, uint32_t upperIndex) const;
+
+    private:
+        struct SubtreeTask
+        {
+            uint32_t FirstPrimitive;
+            uint32_t PrimitiveCount;
+            uint32_t Depth;
+            std::vector<BVHNode> Nodes;
+        };
+
+        const std::vector<Primitive>& m_Primitives;
+        std::vector<uint32_t>& m_PrimitiveIndices;
+
+        uint32_t m_MaxPrimitivesPerLeaf;
+        uint32_t m_MaxTaskDepth;
+
+        // While set, ranges at the task depth or below the subtree threshold are recorded as tasks instead of being built
+        bool m_IsDeferringSubtrees{ false };
+        std::vector<SubtreeTask> m_SubtreeTasks;
+    };
+}
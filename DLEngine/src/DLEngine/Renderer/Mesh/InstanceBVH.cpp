@@ -0,0 +1,266 @@
+#include "dlpch.h"
+#include "InstanceBVH.h"
+
+#include "DLEngine/Math/Intersections.h"
+#include "DLEngine/Math/Mat4A.h"
+
+namespace DLEngine
+{
+    namespace
+    {
+        // Instances are cheap to refit and expensive to descend into, so keep the leaves small
+        constexpr uint32_t MAX_INSTANCES_PER_LEAF{ 2u };
+    }
+
+    void InstanceBVH::Rebuild(std::vector<Leaf>&& leaves, const TransformSource& transforms)
+    {
+        std::for_each(std::execution::par_unseq, leaves.begin(), leaves.end(),
+            [&transforms](Leaf& leaf)
+            {
+                UpdateLeafTransform(leaf, transforms);
+            }
+        );
+
+        std::vector<BVHBuilder::Primitive> primitives(leaves.size());
+        std::transform(std::execution::par_unseq, leaves.begin(), leaves.end(), primitives.begin(),
+            [](const Leaf& leaf)
+            {
+                return BVHBuilder::Primitive{
+                    .BoundingBox = leaf.WorldBoundingBox,
+                    .Centroid = (leaf.WorldBoundingBox.Min + leaf.WorldBoundingBox.Max) * 0.5f
+                };
+            }
+        );
+
+        std::vector<uint32_t> leafIndices{};
+        BVHBuilder::Build(primitives, MAX_INSTANCES_PER_LEAF, m_Nodes, leafIndices);
+
+        // Store the leaves in the tree order, so the leaf nodes can address them directly
+        m_Leaves.clear();
+        m_Leaves.reserve(leafIndices.size());
+        for (const uint32_t leafIndex : leafIndices)
+            m_Leaves.emplace_back(std::move(leaves[leafIndex]));
+    }
+
+    uint32_t InstanceBVH::Refit(const TransformSource& transforms)
+    {
+        const auto isLeafMoved{ [&transforms](const Leaf& leaf)
+            {
+                return transforms.Indices.contains(leaf.TransformID) && leaf.TransformVersion != transforms.Versions[transforms.Indices.getIndex(leaf.TransformID)];
+            }
+        };
+
+        // Counted before the update, the predicate of a parallel algorithm must not modify the leaves
+        const uint32_t changedLeaves{ static_cast<uint32_t>(std::count_if(std::execution::par_unseq, m_Leaves.begin(), m_Leaves.end(), isLeafMoved)) };
+
+        if (changedLeaves == 0u)
+            return 0u;
+
+        std::for_each(std::execution::par_unseq, m_Leaves.begin(), m_Leaves.end(),
+            [&transforms, &isLeafMoved](Leaf& leaf)
+            {
+                if (isLeafMoved(leaf))
+                    UpdateLeafTransform(leaf, transforms);
+            }
+        );
+
+        // Children are always stored after their parent
+        for (auto nodeIt{ m_Nodes.rbegin() }; nodeIt != m_Nodes.rend(); ++nodeIt)
+        {
+            BVHNode& node{ *nodeIt };
+            node.BoundingBox = BVHBuilder::EmptyAABB();
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                    BVHBuilder::Grow(node.BoundingBox, m_Leaves[i].WorldBoundingBox);
+            }
+            else
+            {
+                const uint32_t nodeIndex{ static_cast<uint32_t>(std::distance(m_Nodes.begin(), nodeIt.base())) - 1u };
+                BVHBuilder::Grow(node.BoundingBox, m_Nodes[nodeIndex + 1u].BoundingBox);
+                BVHBuilder::Grow(node.BoundingBox, m_Nodes[node.Offset].BoundingBox);
+            }
+        }
+
+        return changedLeaves;
+    }
+
+    bool InstanceBVH::Intersects(const Math::Ray& ray, Submesh::IntersectInfo& outIntersectInfo, uint32_t& outLeafIndex) const noexcept
+    {
+        if (m_Nodes.empty())
+            return false;
+
+        const Math::Vec3 invDirection{ 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z };
+
+        struct StackEntry
+        {
+            uint32_t NodeIndex;
+            float TNear;
+        };
+
+        std::array<StackEntry, BVHBuilder::MaxDepth> stack;
+        uint32_t stackSize{ 0u };
+
+        float& closestT{ outIntersectInfo.TriangleIntersectInfo.T };
+
+        float rootTNear{ 0.0f };
+        if (!m_Nodes[0u].Intersects(ray.Origin, invDirection, closestT, rootTNear))
+            return false;
+
+        bool intersects{ false };
+        uint32_t nodeIndex{ 0u };
+
+        while (true)
+        {
+            const BVHNode& node{ m_Nodes[nodeIndex] };
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                {
+                    const Leaf& leaf{ m_Leaves[i] };
+
+                    // The direction is left unnormalized, so T is the same in both spaces
+                    const Math::Ray rayMeshSpace{
+                        .Origin = Math::PointToSpace(ray.Origin, leaf.WorldToMesh),
+                        .Direction = Math::DirectionToSpace(ray.Direction, leaf.WorldToMesh)
+                    };
+
+                    Submesh::IntersectInfo meshSpaceIntersectInfo{};
+                    meshSpaceIntersectInfo.TriangleIntersectInfo.T = closestT;
+
+                    const Submesh& submesh{ leaf.SourceMesh->GetSubmeshes()[leaf.SubmeshIndex] };
+                    if (!Math::Intersects(rayMeshSpace, submesh, meshSpaceIntersectInfo))
+                        continue;
+
+                    outIntersectInfo.TriangleIndex = meshSpaceIntersectInfo.TriangleIndex;
+                    outIntersectInfo.TriangleIntersectInfo.IntersectionPoint = Math::PointToSpace(
+                        meshSpaceIntersectInfo.TriangleIntersectInfo.IntersectionPoint,
+                        leaf.MeshToWorld
+                    );
+                    outIntersectInfo.TriangleIntersectInfo.Normal = Math::Normalize(Math::DirectionToSpace(
+                        meshSpaceIntersectInfo.TriangleIntersectInfo.Normal,
+                        leaf.MeshToWorld
+                    ));
+                    outIntersectInfo.TriangleIntersectInfo.T = meshSpaceIntersectInfo.TriangleIntersectInfo.T;
+
+                    outLeafIndex = i;
+                    intersects = true;
+                }
+            }
+            else
+            {
+                uint32_t nearChild{ nodeIndex + 1u };
+                uint32_t farChild{ node.Offset };
+
+                float tNear{ 0.0f }, tFar{ 0.0f };
+                const bool hitsNear{ m_Nodes[nearChild].Intersects(ray.Origin, invDirection, closestT, tNear) };
+                const bool hitsFar{ m_Nodes[farChild].Intersects(ray.Origin, invDirection, closestT, tFar) };
+
+                if (hitsNear && hitsFar)
+                {
+                    if (tFar < tNear)
+                    {
+                        std::swap(nearChild, farChild);
+                        std::swap(tNear, tFar);
+                    }
+
+                    stack[stackSize++] = StackEntry{ .NodeIndex = farChild, .TNear = tFar };
+                    nodeIndex = nearChild;
+                    continue;
+                }
+
+                if (hitsNear || hitsFar)
+                {
+                    nodeIndex = hitsNear ? nearChild : farChild;
+                    continue;
+                }
+            }
+
+            while (stackSize > 0u && stack[stackSize - 1u].TNear > closestT)
+                --stackSize;
+
+            if (stackSize == 0u)
+                break;
+
+            nodeIndex = stack[--stackSize].NodeIndex;
+        }
+
+        return intersects;
+    }
+
+    bool InstanceBVH::Occluded(const Math::Ray& ray, float maxDistance) const noexcept
+    {
+        if (m_Nodes.empty())
+            return false;
+
+        const Math::Vec3 invDirection{ 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z };
+
+        std::array<uint32_t, BVHBuilder::MaxDepth> stack;
+        uint32_t stackSize{ 0u };
+
+        float tNear{ 0.0f };
+        if (!m_Nodes[0u].Intersects(ray.Origin, invDirection, maxDistance, tNear))
+            return false;
+
+        uint32_t nodeIndex{ 0u };
+
+        while (true)
+        {
+            const BVHNode& node{ m_Nodes[nodeIndex] };
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                {
+                    const Leaf& leaf{ m_Leaves[i] };
+
+                    const Math::Ray rayMeshSpace{
+                        .Origin = Math::PointToSpace(ray.Origin, leaf.WorldToMesh),
+                        .Direction = Math::DirectionToSpace(ray.Direction, leaf.WorldToMesh)
+                    };
+
+                    const Submesh& submesh{ leaf.SourceMesh->GetSubmeshes()[leaf.SubmeshIndex] };
+                    if (Math::Occluded(rayMeshSpace, submesh, maxDistance))
+                        return true;
+                }
+            }
+            else
+            {
+                const uint32_t firstChild{ nodeIndex + 1u };
+                const uint32_t secondChild{ node.Offset };
+
+                const bool hitsFirst{ m_Nodes[firstChild].Intersects(ray.Origin, invDirection, maxDistance, tNear) };
+                const bool hitsSecond{ m_Nodes[secondChild].Intersects(ray.Origin, invDirection, maxDistance, tNear) };
+
+                if (hitsFirst && hitsSecond)
+                    stack[stackSize++] = secondChild;
+
+                if (hitsFirst || hitsSecond)
+                {
+                    nodeIndex = hitsFirst ? firstChild : secondChild;
+                    continue;
+                }
+            }
+
+            if (stackSize == 0u)
+                break;
+
+            nodeIndex = stack[--stackSize];
+        }
+
+        return false;
+    }
+
+    void InstanceBVH::UpdateLeafTransform(Leaf& leaf, const TransformSource& transforms)
+    {
+        // The inverse comes from the owner, only the box of the submesh is transformed here
+        const uint32_t transformIndex{ transforms.Indices.getIndex(leaf.TransformID) };
+        leaf.MeshToWorld = transforms.MeshToWorld[transformIndex];
+        leaf.WorldToMesh = transforms.WorldToMesh[transformIndex];
+        leaf.TransformVersion = transforms.Versions[transformIndex];
+        leaf.WorldBoundingBox = Math::Mat4A{ leaf.MeshToWorld }.TransformAABB(leaf.SourceMesh->GetSubmeshes()[leaf.SubmeshIndex].GetBoundingBox());
+    }
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "DLEngine/Core/solid_vector.h"
+
+#include "DLEngine/Math/Mat4x4.h"
+
+#include "DLEngine/Renderer/Mesh/BVHBuilder.h"
+#include "DLEngine/Renderer/Mesh/Mesh.h"
+
+namespace DLEngine
+{
+    // Top-level acceleration structure over submesh instances
+    class InstanceBVH
+    {
+    public:
+        struct Leaf
+        {
+            Math::Mat4x4 MeshToWorld;
+            Math::Mat4x4 WorldToMesh;
+            Math::AABB WorldBoundingBox;
+
+            Ref<Mesh> SourceMesh;
+
+            uint64_t UUID{ 0u };
+            uint32_t SubmeshIndex{ 0u };
+
+            // Entry of the instance in the TransformSource and its version the leaf was built from.
+            // The entry is checked by generation, so a leaf of a removed instance never reads the entry that took its place
+            solid_vector_id TransformID;
+            uint32_t TransformVersion{ 0u };
+        };
+
+        // Transforms of the instances kept by the owner of the tree, the spans are indexed through Indices by Leaf::TransformID
+        struct TransformSource
+        {
+            solid_vector_indices Indices;
+            std::span<const Math::Mat4x4> MeshToWorld;
+            std::span<const Math::Mat4x4> WorldToMesh;
+            std::span<const uint32_t> Versions;
+        };
+
+    public:
+        void Rebuild(std::vector<Leaf>&& leaves, const TransformSource& transforms);
+
+        // Copies the transforms of the moved instances and refits the tree, returns the number of leaves that have changed.
+        // Leaves of the instances removed from the source keep their last transform until the next Rebuild
+        uint32_t Refit(const TransformSource& transforms);
+
+        const std::vector<BVHNode>& GetNodes() const noexcept { return m_Nodes; }
+        const std::vector<Leaf>& GetLeaves() const noexcept { return m_Leaves; }
+
+        // outIntersectInfo.T is used as the maximum distance of the ray
+        bool Intersects(const Math::Ray& ray, Submesh::IntersectInfo& outIntersectInfo, uint32_t& outLeafIndex) const noexcept;
+
+        // Any-hit query, stops at the first instance that blocks the ray closer than maxDistance
+        bool Occluded(const Math::Ray& ray, float maxDistance) const noexcept;
+
+    private:
+        static void UpdateLeafTransform(Leaf& leaf, const TransformSource& transforms);
+
+    private:
+        std::vector<BVHNode> m_Nodes;
+        std::vector<uint32_t> m_LeafIndices;
+        std::vector<Leaf> m_Leaves;
+    };
+}
@@ -21,6 +21,15 @@ namespace DLEngine
         LoadFromFile(path);
     }
 
+    Mesh::Mesh(std::string name, std::vector<Submesh> submeshes)
+        : m_Name(std::move(name))
+        , m_Submeshes(std::move(submeshes))
+        , m_BoundingBox(BVHBuilder::EmptyAABB())
+    {
+        for (const Submesh& submesh : m_Submeshes)
+            BVHBuilder::Grow(m_BoundingBox, submesh.GetBoundingBox());
+    }
+
     VertexBufferLayout Mesh::GetCommonVertexBufferLayout() noexcept
     {
         static const VertexBufferLayout bufferLayout{
@@ -139,7 +148,7 @@ namespace DLEngine
 
         submesh.m_BoundingBox.Min = Math::Vec3{ -1.0f, -1.0f, -1.0f };
         submesh.m_BoundingBox.Max = Math::Vec3{ 1.0f, 1.0f, 1.0f };
-        submesh.UpdateOctree();
+        submesh.UpdateBVH();
 
         mesh->m_VertexBuffer = VertexBuffer::Create(
             Mesh::GetCommonVertexBufferLayout(),
@@ -246,10 +255,22 @@ namespace DLEngine
                 indices.push_back(triangle.Indices[1]);
                 indices.push_back(triangle.Indices[2]);
             }
-
-            dstMesh.UpdateOctree();
         }
 
+        // Every submesh owns its BVH, so they can all be built at once
+        Timer bvhBuildTimer{};
+        std::for_each(std::execution::par, m_Submeshes.begin(), m_Submeshes.end(), [](Submesh& submesh) { submesh.UpdateBVH(); });
+
+        const size_t triangleCount{ indices.size() / 3u };
+        const size_t bvhMemoryUsage{ std::transform_reduce(m_Submeshes.begin(), m_Submeshes.end(), size_t{ 0u }, std::plus<>{},
+            [](const Submesh& submesh) { return submesh.GetBVH().GetMemoryUsage(); }
+        ) };
+
+        DL_LOG_INFO_TAG("Mesh", "Built BVHs for mesh [{0}] with [{1}] triangles in {2} ms, {3:.1f} bytes per triangle",
+            m_Name, triangleCount, bvhBuildTimer.ElapsedMS(),
+            static_cast<float>(bvhMemoryUsage) / static_cast<float>(std::max(triangleCount, size_t{ 1u }))
+        );
+
         m_VertexBuffer = VertexBuffer::Create(Mesh::GetCommonVertexBufferLayout(), Buffer{ vertices.data(), vertices.size() * sizeof(Submesh::Vertex) });
         m_IndexBuffer = IndexBuffer::Create(Buffer{ indices.data(), indices.size() * sizeof(uint32_t) });
 
@@ -3,7 +3,7 @@
 #include "DLEngine/Math/Primitives.h"
 #include "DLEngine/Math/Vec2.h"
 
-#include "DLEngine/Renderer/Mesh/TriangleOctree.h"
+#include "DLEngine/Renderer/Mesh/TriangleBVH.h"
 
 #include "DLEngine/Renderer/IndexBuffer.h"
 #include "DLEngine/Renderer/VertexBuffer.h"
@@ -36,7 +36,11 @@ namespace DLEngine
         };
 
     public:
-        void UpdateOctree() { m_Octree.Rebuild(*this); }
+        Submesh() noexcept = default;
+        // Standalone submesh with a single identity instance, e.g. for geometry that never reaches the GPU
+        Submesh(std::string name, std::vector<Vertex> vertices, std::vector<Triangle> triangles);
+
+        void UpdateBVH() { m_BVH.Rebuild(*this); }
 
         const std::string& GetName() const noexcept { return m_Name; }
         
@@ -45,12 +49,12 @@ namespace DLEngine
         const std::vector<Math::Mat4x4>& GetInstances() const noexcept { return m_Instances; }
         const std::vector<Math::Mat4x4>& GetInvInstances() const noexcept { return m_InvInstances; }
 
-        const TriangleOctree& GetOctree() const noexcept { return m_Octree; }
+        const TriangleBVH& GetBVH() const noexcept { return m_BVH; }
 
         const Math::AABB& GetBoundingBox() const noexcept { return m_BoundingBox; }
 
     private:
-        TriangleOctree m_Octree;
+        TriangleBVH m_BVH;
 
         std::string m_Name;
         
@@ -79,6 +83,8 @@ namespace DLEngine
     public:
         Mesh() noexcept = default;
         Mesh(const std::filesystem::path& path) noexcept;
+        // Standalone mesh without GPU buffers, e.g. for geometry that never reaches the GPU
+        Mesh(std::string name, std::vector<Submesh> submeshes);
 
         const std::string& GetName() const noexcept { return m_Name; }
 
@@ -1,123 +1,202 @@
 #include "dlpch.h"
 #include "MeshRegistry.h"
 
+#include "DLEngine/Math/BatchTransform.h"
+#include "DLEngine/Math/Distance.h"
+#include "DLEngine/Math/Intersections.h"
+
+#include "DLEngine/Renderer/OcclusionBuffer.h"
+
+#include "DLEngine/Utils/RadixSort.h"
 #include "DLEngine/Utils/RandomGenerator.h"
 
 namespace DLEngine
 {
-    MeshRegistry::MeshUUID MeshRegistry::AddSubmesh(
-        const Ref<Mesh>& mesh,
-        uint32_t submeshIndex,
-        const Ref<Material>& material,
-        const Ref<Instance>& instance
-    )
+    namespace
     {
-        const auto& shader{ material->GetShader() };
+        // Large batches are split, so a single batch with many instances still spreads across all cores
+        constexpr uint32_t CULLING_CHUNK_SIZE{ 1024u };
 
-        DL_ASSERT(shader == instance->GetShader(),
-            "Material [{0}] and instance [{1}] are made for different shaders",
-            material->GetName(), instance->GetName()
-        );
+        // Dirty rows closer than this are sent in one range, re-sending a few clean rows is cheaper than another update call
+        constexpr uint32_t UPLOAD_RANGE_MERGE_GAP{ 16u };
 
-        DL_ASSERT(instance->HasUniform("INSTANCE_UUID"),
-            "Instance [{0}] does not have an 'INSTANCE_UUID' uniform",
-            instance->GetName()
-        );
+        // Views of a batch not uploaded into for this many frames give their buffers back. They belong to lights that are gone,
+        // or to passes that no longer see the batch and recreate the buffers once when it comes back into sight
+        constexpr uint64_t VIEW_RELEASE_FRAMES{ 120u };
 
-        MeshBatch* meshBatch{ nullptr };
-        const auto meshBatchIt{ m_MeshBatches.find(shader->GetName()) };
-        if (meshBatchIt == m_MeshBatches.end())
-            meshBatch = &m_MeshBatches[shader->GetName()];
-        else
-            meshBatch = &meshBatchIt->second;
+        constexpr uint32_t SORT_KEY_MATERIAL_BITS{ 20u };
+        constexpr uint32_t SORT_KEY_DEPTH_BITS{ 12u };
+        constexpr uint32_t SORT_KEY_MESH_BITS{ 20u };
+        constexpr uint32_t SORT_KEY_SUBMESH_BITS{ 12u };
 
-        SubmeshBatch* submeshBatch{ nullptr };
-        const auto submeshBatchIt{ meshBatch->SubmeshBatches.find(mesh) };
-        if (submeshBatchIt == meshBatch->SubmeshBatches.end())
+        // Depth buckets are logarithmic in the distance, so nearby batches are told apart more finely than distant ones
+        constexpr float SORT_KEY_DEPTH_BUCKETS_PER_OCTAVE{ 256.0f };
+
+        constexpr uint32_t SortKeyFieldMask(uint32_t bits) noexcept { return (1u << bits) - 1u; }
+
+        uint64_t MakeSortKey(const MeshRegistry::DrawBatch& drawBatch, float distance) noexcept
         {
-            submeshBatch = &meshBatch->SubmeshBatches[mesh];
-            submeshBatch->MaterialBatches.resize(mesh->GetSubmeshes().size());
+            DL_ASSERT(drawBatch.MaterialID <= SortKeyFieldMask(SORT_KEY_MATERIAL_BITS) &&
+                drawBatch.MeshID <= SortKeyFieldMask(SORT_KEY_MESH_BITS) &&
+                drawBatch.SubmeshIndex <= SortKeyFieldMask(SORT_KEY_SUBMESH_BITS),
+                "Draw batch of the mesh [{0}] does not fit into the sort key fields (material [{1}], mesh [{2}], submesh [{3}])",
+                drawBatch.SourceMesh->GetName(), drawBatch.MaterialID, drawBatch.MeshID, drawBatch.SubmeshIndex
+            );
+
+            const uint32_t depthBucket{ std::min(static_cast<uint32_t>(std::log2(1.0f + distance) * SORT_KEY_DEPTH_BUCKETS_PER_OCTAVE), SortKeyFieldMask(SORT_KEY_DEPTH_BITS)) };
+
+            // Fields are masked as well, so an out of range one can not spill into its neighbours and break the order of the others
+            uint64_t key{ drawBatch.MaterialID & SortKeyFieldMask(SORT_KEY_MATERIAL_BITS) };
+            key = (key << SORT_KEY_DEPTH_BITS) | depthBucket;
+            key = (key << SORT_KEY_MESH_BITS) | (drawBatch.MeshID & SortKeyFieldMask(SORT_KEY_MESH_BITS));
+            key = (key << SORT_KEY_SUBMESH_BITS) | (drawBatch.SubmeshIndex & SortKeyFieldMask(SORT_KEY_SUBMESH_BITS));
+            return key;
         }
-        else
-            submeshBatch = &submeshBatchIt->second;
 
-        DL_ASSERT(submeshIndex < submeshBatch->MaterialBatches.size(),
-            "Submesh index [{0}] is out of range for mesh [{1}]",
-            submeshIndex, mesh->GetName()
-        );
-        MaterialBatch* materialBatch{ &submeshBatch->MaterialBatches[submeshIndex] };
-
-        InstanceBatch* instanceBatch{ nullptr };
-        const auto instanceBatchIt{ materialBatch->InstanceBatches.find(material) };
-        if (instanceBatchIt == materialBatch->InstanceBatches.end())
+        struct CullingChunk
+        {
+            MeshRegistry::InstanceBatch* Batch{ nullptr };
+            uint32_t Begin{ 0u };
+            uint32_t End{ 0u };
+            uint32_t VisibleCount{ 0u };
+            float NearestVisibleDistanceSquared{ 0.0f };
+        };
+
+        // End of the run of visible instances from begin on whose rows follow each other in the store, the run is copied from its columns at once
+        uint32_t ConsecutiveRowsEnd(std::span<const uint32_t> storeRows, uint32_t begin, uint32_t end) noexcept
         {
-            instanceBatch = &materialBatch->InstanceBatches[material];
+            uint32_t runEnd{ begin + 1u };
+            while (runEnd < end && storeRows[runEnd] == storeRows[runEnd - 1u] + 1u)
+                ++runEnd;
 
-            const auto& inputLayout{ instance->GetShader()->GetInputLayout() };
-            for (const auto& [bindingPoint, inputLayoutEntry] : inputLayout)
+            return runEnd;
+        }
+
+        // Rows of the transform cache refreshed per parallel task, a task runs the batch kernels over the stale runs of its rows
+        constexpr uint32_t TRANSFORM_REFRESH_CHUNK_SIZE{ 1024u };
+
+        // Calls refreshRow(index) for every index in [begin, end), it returns whether the row was stale and took its new matrix.
+        // Every run of consecutive stale rows is then finished by a single refreshRun(runBegin, runEnd), so the batch kernels
+        // see the moved rows in as few spans as possible. Returns the number of stale rows
+        template <typename RowFunc, typename RunFunc>
+        uint32_t RefreshStaleRuns(uint32_t begin, uint32_t end, RowFunc&& refreshRow, RunFunc&& refreshRun)
+        {
+            uint32_t staleRows{ 0u };
+            uint32_t runBegin{ begin };
+            for (uint32_t index{ begin }; index < end; ++index)
             {
-                if (inputLayoutEntry.Type == InputLayoutType::PerVertex)
+                if (refreshRow(index))
+                {
+                    ++staleRows;
                     continue;
+                }
 
-                const auto& instanceBufferLayout{ inputLayoutEntry.Layout };
-                instanceBatch->InstanceBuffers.emplace(bindingPoint, VertexBuffer::Create(instanceBufferLayout, instanceBufferLayout.GetStride()));
+                if (runBegin < index)
+                    refreshRun(runBegin, index);
+                runBegin = index + 1u;
             }
+
+            if (runBegin < end)
+                refreshRun(runBegin, end);
+
+            return staleRows;
         }
-        else
-            instanceBatch = &instanceBatchIt->second;
 
-        instanceBatch->SubmeshInstances.push_back(instance);
+        using TransformCache = MeshRegistry::TransformCache;
 
-        const auto& it{ std::find_if(std::execution::par_unseq, m_UUID_ToIntsance.begin(), m_UUID_ToIntsance.end(),
-            [&instance = std::as_const(instance)](auto&& storedInstance)
-            {
-                return storedInstance.second == instance;
-            }
-        ) };
-        if (it != m_UUID_ToIntsance.end())
+        uint32_t RefreshCachedTransforms(TransformCache::Entries& transforms, uint32_t begin, uint32_t end)
         {
-            const auto& [uuid, storedInstance]{ *it };
-            
-            if (m_UUID_ToMesh[uuid] != mesh)
-            {
-                DL_LOG_ERROR_TAG(
-                    "MeshRegistry",
-                    "Instance [{0}] is already assigned to a different mesh [{1}]",
-                    instance->GetName(), m_UUID_ToMesh[uuid]->GetName()
-                );
+            const std::span<const MeshRegistry::InstanceRow> instanceRows{ transforms.column<TransformCache::INSTANCE_COLUMN>() };
+            const std::span<uint32_t> versions{ transforms.column<TransformCache::VERSION_COLUMN>() };
+            const std::span<Math::Mat4x4> meshToWorld{ transforms.column<TransformCache::MESH_TO_WORLD_COLUMN>() };
+            const std::span<Math::Mat4x4> worldToMesh{ transforms.column<TransformCache::WORLD_TO_MESH_COLUMN>() };
+            const std::span<Math::AABB> worldBoundingBoxes{ transforms.column<TransformCache::WORLD_BOUNDING_BOX_COLUMN>() };
+            const std::span<const Math::AABB> meshBoundingBoxes{ transforms.column<TransformCache::MESH_BOUNDING_BOX_COLUMN>() };
+
+            return RefreshStaleRuns(begin, end,
+                [&](uint32_t index)
+                {
+                    const auto& [store, id] { instanceRows[index] };
+                    const uint32_t transformVersion{ store->GetTransformVersion(id) };
+                    if (versions[index] == transformVersion)
+                        return false;
+
+                    versions[index] = transformVersion;
+                    meshToWorld[index] = store->Get<Math::Mat4x4>(id, store->GetTransformHandle());
+                    return true;
+                },
+                [&](uint32_t runBegin, uint32_t runEnd)
+                {
+                    const uint32_t count{ runEnd - runBegin };
+                    Math::InverseMatrices(meshToWorld.subspan(runBegin, count), worldToMesh.subspan(runBegin, count));
+                    Math::TransformAABBs(meshBoundingBoxes.subspan(runBegin, count), meshToWorld.subspan(runBegin, count), worldBoundingBoxes.subspan(runBegin, count));
+                }
+            );
+        }
+    }
 
-                instanceBatch->SubmeshInstances.pop_back();
-                return 0u;
-            }
+    MeshRegistry::~MeshRegistry()
+    {
+        for (const InstanceRow& instanceRow : m_UUID_ToIntsance | std::views::values)
+            instanceRow.Store->Free(instanceRow.ID);
+    }
 
-            if (m_UUID_ToMaterials[uuid][submeshIndex] && m_UUID_ToMaterials[uuid][submeshIndex] != material)
-            {
-                DL_LOG_ERROR_TAG(
-                    "MeshRegistry",
-                    "Instance [{0}] is already assigned to a different material [{1}]",
-                    instance->GetName(), m_UUID_ToMaterials[uuid][submeshIndex]->GetName()
-                );
+    MeshRegistry::MeshUUID MeshRegistry::AddSubmesh(
+        const Ref<Mesh>& mesh,
+        uint32_t submeshIndex,
+        const Ref<Material>& material,
+        const Ref<Instance>& instance
+    )
+    {
+        InstanceBatch& instanceBatch{ GetOrCreateInstanceBatch(mesh, submeshIndex, material) };
+        const MeshUUID uuid{ RegisterSubmesh(instanceBatch, mesh, submeshIndex, material, instance) };
 
-                instanceBatch->SubmeshInstances.pop_back();
-                return 0u;
-            }
+        // New transforms are added stale, AddSubmeshes refreshes them all at once in parallel
+        if (const auto cachedTransformIt{ m_TransformCache.UUID_ToID.find(uuid) }; cachedTransformIt != m_TransformCache.UUID_ToID.end())
+        {
+            const uint32_t index{ m_TransformCache.Transforms.getIndex(cachedTransformIt->second) };
+            RefreshCachedTransforms(m_TransformCache.Transforms, index, index + 1u);
+        }
 
-            m_UUID_ToMaterials[uuid][submeshIndex] = material;
+        return uuid;
+    }
 
-            return uuid;
+    std::vector<MeshRegistry::MeshUUID> MeshRegistry::AddSubmeshes(std::span<const SubmeshEntry> submeshes)
+    {
+        // Spawned submeshes mostly go into the same batch as the previous one, so the batch is looked up only when the entry differs
+        std::vector<InstanceBatch*> instanceBatches(submeshes.size());
+        std::unordered_map<InstanceBatch*, size_t> addedInstances{};
+        for (size_t i{ 0u }; i < submeshes.size(); ++i)
+        {
+            const SubmeshEntry& entry{ submeshes[i] };
+            if (i > 0u && entry.SourceMesh == submeshes[i - 1u].SourceMesh && entry.SubmeshIndex == submeshes[i - 1u].SubmeshIndex &&
+                entry.SourceMaterial == submeshes[i - 1u].SourceMaterial)
+                instanceBatches[i] = instanceBatches[i - 1u];
+            else
+                instanceBatches[i] = &GetOrCreateInstanceBatch(entry.SourceMesh, entry.SubmeshIndex, entry.SourceMaterial);
+
+            ++addedInstances[instanceBatches[i]];
         }
 
-        const MeshUUID uuid{ RandomGenerator::GenerateRandom<MeshUUID>() };
-        instance->Set("INSTANCE_UUID", Buffer{ &uuid, sizeof(MeshUUID) });
-        
-        m_UUID_ToMesh[uuid] = mesh;
-        
-        m_UUID_ToMaterials[uuid].resize(mesh->GetSubmeshes().size());
-        m_UUID_ToMaterials[uuid][submeshIndex] = material;
-        
-        m_UUID_ToIntsance[uuid] = instance;
+        for (const auto& [instanceBatch, count] : addedInstances)
+            instanceBatch->SubmeshInstances.reserve(instanceBatch->SubmeshInstances.size() + count);
 
-        return uuid;
+        m_UUID_ToMesh.reserve(m_UUID_ToMesh.size() + submeshes.size());
+        m_UUID_ToMaterials.reserve(m_UUID_ToMaterials.size() + submeshes.size());
+        m_UUID_ToIntsance.reserve(m_UUID_ToIntsance.size() + submeshes.size());
+        m_TransformCache.UUID_ToID.reserve(m_TransformCache.UUID_ToID.size() + submeshes.size());
+        m_TransformCache.Transforms.reserve(m_TransformCache.Transforms.size() + static_cast<uint32_t>(submeshes.size()));
+
+        std::vector<MeshUUID> uuids(submeshes.size());
+        for (size_t i{ 0u }; i < submeshes.size(); ++i)
+        {
+            const SubmeshEntry& entry{ submeshes[i] };
+            uuids[i] = RegisterSubmesh(*instanceBatches[i], entry.SourceMesh, entry.SubmeshIndex, entry.SourceMaterial, entry.SubmeshInstance);
+        }
+
+        UpdateTransforms();
+
+        return uuids;
     }
 
     void MeshRegistry::RemoveMesh(MeshUUID meshUUID)
@@ -127,9 +206,8 @@ namespace DLEngine
 
         const Ref<Mesh>& mesh{ m_UUID_ToMesh[meshUUID] };
         const std::vector<Ref<Material>>& materials{ m_UUID_ToMaterials[meshUUID] };
-        const Ref<Instance>& instance{ m_UUID_ToIntsance[meshUUID] };
-        const Ref<Shader>& shader{ instance->GetShader() };
-        const std::string_view shaderName{ shader->GetName() };
+        const InstanceRow instanceRow{ m_UUID_ToIntsance[meshUUID] };
+        const std::string_view shaderName{ instanceRow.Store->GetShader()->GetName() };
 
         MeshBatch& meshBatch{ m_MeshBatches[shaderName] };
         SubmeshBatch& submeshBatch{ meshBatch.SubmeshBatches[mesh] };
@@ -139,24 +217,229 @@ namespace DLEngine
             {
                 const uint32_t submeshIndex{ static_cast<uint32_t>(&materialBatch - submeshBatch.MaterialBatches.data()) };
                 auto& instanceBatch{ materialBatch.InstanceBatches[materials[submeshIndex]] };
-                std::erase(instanceBatch.SubmeshInstances, instance);
+                std::erase(instanceBatch.SubmeshInstances, instanceRow.ID);
+                instanceBatch.InstancesChanged = true;
             }
         );
 
+        RemoveCachedTransform(meshUUID);
+
+        // The last row of the store takes the place of the freed one, the other instances keep their IDs
+        instanceRow.Store->Free(instanceRow.ID);
+
         m_UUID_ToMesh.erase(meshUUID);
         m_UUID_ToMaterials.erase(meshUUID);
         m_UUID_ToIntsance.erase(meshUUID);
+
+        m_InstanceBVHDirty = true;
     }
 
     void MeshRegistry::UpdateInstanceBuffers()
     {
+        m_UploadStatistics = UploadStatistics{};
+        ++m_FrameIndex;
+
         ClearEmptyBatches();
+        UpdateDrawBatches();
+        UpdateTransforms();
+
+        for (const auto& drawBatches : m_DrawBatches | std::views::values)
+        {
+            for (const DrawBatch& drawBatch : drawBatches)
+            {
+                UpdateInstanceBuffer(*drawBatch.Batch, drawBatch.SourceMesh->GetSubmeshes()[drawBatch.SubmeshIndex].GetBoundingBox());
+                ReleaseUnusedViews(*drawBatch.Batch);
+            }
+        }
+    }
+
+    uint32_t MeshRegistry::UpdateTransforms()
+    {
+        auto& transforms{ m_TransformCache.Transforms };
+        const uint32_t rowCount{ transforms.size() };
+
+        std::vector<uint32_t> chunks((rowCount + TRANSFORM_REFRESH_CHUNK_SIZE - 1u) / TRANSFORM_REFRESH_CHUNK_SIZE);
+        std::iota(chunks.begin(), chunks.end(), 0u);
+
+        // Chunks cover disjoint rows, so they are refreshed in parallel
+        return std::transform_reduce(std::execution::par, chunks.begin(), chunks.end(), 0u, std::plus<>{},
+            [&transforms, rowCount](uint32_t chunk)
+            {
+                const uint32_t begin{ chunk * TRANSFORM_REFRESH_CHUNK_SIZE };
+                return RefreshCachedTransforms(transforms, begin, std::min(begin + TRANSFORM_REFRESH_CHUNK_SIZE, rowCount));
+            }
+        );
+    }
+
+    MeshRegistry::CullingStatistics MeshRegistry::CullInstances(std::string_view shaderName, ViewID view, const Math::Frustum& frustum)
+    {
+        return CullInstancesInVolume(shaderName, view, frustum, nullptr, nullptr);
+    }
+
+    MeshRegistry::CullingStatistics MeshRegistry::CullInstances(std::string_view shaderName, ViewID view, const Math::Frustum& frustum, const Math::Vec3& viewPosition)
+    {
+        return CullInstancesInVolume(shaderName, view, frustum, nullptr, &viewPosition);
+    }
+
+    MeshRegistry::CullingStatistics MeshRegistry::CullInstances(std::string_view shaderName, ViewID view, const Math::Frustum& frustum, const OcclusionBuffer& occlusionBuffer, const Math::Vec3& viewPosition)
+    {
+        return CullInstancesInVolume(shaderName, view, frustum, &occlusionBuffer, &viewPosition);
+    }
+
+    MeshRegistry::CullingStatistics MeshRegistry::CullInstances(std::string_view shaderName, ViewID view, const Math::Sphere& sphere)
+    {
+        return CullInstancesInVolume(shaderName, view, sphere, nullptr, nullptr);
+    }
+
+    uint32_t MeshRegistry::GetVisibleInstancesMask(std::string_view shaderName, std::span<const Math::Frustum> frustums) const
+    {
+        uint32_t mask{ 0u };
+        for (const DrawBatch& drawBatch : GetDrawBatches(shaderName))
+        {
+            const InstanceBatch& instanceBatch{ *drawBatch.Batch };
+            const std::span<const uint32_t> visibleInstances{ instanceBatch.VisibleInstances.data(), instanceBatch.VisibleInstanceCount };
+            mask |= Math::FrustumsIntersectionMask(frustums, instanceBatch.WorldBoundingBoxes, visibleInstances);
+        }
+
+        return mask;
+    }
+
+    const MeshRegistry::DrawList& MeshRegistry::BuildDrawList(std::string_view shaderName)
+    {
+        BuildDrawList(GetDrawBatches(shaderName), m_DrawList, m_SortKeysScratch, m_DrawsScratch);
+        return m_DrawList;
+    }
+
+    void MeshRegistry::BuildDrawList(std::span<const DrawBatch> drawBatches, DrawList& outDrawList,
+        std::vector<uint64_t>& sortKeysScratch, std::vector<const DrawBatch*>& drawsScratch)
+    {
+        outDrawList.Draws.clear();
+        for (const DrawBatch& drawBatch : drawBatches)
+        {
+            if (drawBatch.Batch->VisibleInstanceCount > 0u)
+                outDrawList.Draws.push_back(&drawBatch);
+        }
+
+        // The distance to the nearest visible instance, recorded by the cull, places the batch among the others of its material
+        outDrawList.SortKeys.resize(outDrawList.Draws.size());
+        std::ranges::transform(outDrawList.Draws, outDrawList.SortKeys.begin(),
+            [](const DrawBatch* drawBatch) { return MakeSortKey(*drawBatch, std::sqrt(drawBatch->Batch->NearestVisibleDistanceSquared)); }
+        );
+
+        sortKeysScratch.resize(outDrawList.SortKeys.size());
+        drawsScratch.resize(outDrawList.Draws.size());
+        Utils::RadixSort<uint64_t, const DrawBatch*>(outDrawList.SortKeys, outDrawList.Draws, sortKeysScratch, drawsScratch);
+    }
+
+    template <typename Volume>
+    MeshRegistry::CullingStatistics MeshRegistry::CullInstancesInVolume(std::string_view shaderName, ViewID view, const Volume& volume, const OcclusionBuffer* occlusionBuffer, const Math::Vec3* viewPosition)
+    {
+        UpdateDrawBatches();
+
+        std::vector<CullingChunk> chunks{};
+        for (const DrawBatch& drawBatch : GetDrawBatches(shaderName))
+        {
+            InstanceBatch& instanceBatch{ *drawBatch.Batch };
+
+            const uint32_t instanceCount{ static_cast<uint32_t>(instanceBatch.WorldBoundingBoxes.size()) };
+            instanceBatch.VisibleInstances.resize(instanceCount);
+            instanceBatch.VisibleInstanceCount = 0u;
+            instanceBatch.VisibleView = view;
+            instanceBatch.NearestVisibleDistanceSquared = viewPosition ? std::numeric_limits<float>::max() : 0.0f;
+
+            for (uint32_t begin{ 0u }; begin < instanceCount; begin += CULLING_CHUNK_SIZE)
+                chunks.push_back(CullingChunk{ .Batch = &instanceBatch, .Begin = begin, .End = std::min(begin + CULLING_CHUNK_SIZE, instanceCount) });
+        }
+
+        std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+            [&volume, occlusionBuffer, viewPosition](CullingChunk& chunk)
+            {
+                const std::span<const Math::AABB> boundingBoxes{ std::span<const Math::AABB>{ chunk.Batch->WorldBoundingBoxes }.subspan(chunk.Begin, chunk.End - chunk.Begin) };
+                const std::span<uint32_t> visibleInstances{ std::span<uint32_t>{ chunk.Batch->VisibleInstances }.subspan(chunk.Begin, chunk.End - chunk.Begin) };
+
+                chunk.VisibleCount = Math::Intersects(volume, boundingBoxes, visibleInstances);
+                if (occlusionBuffer)
+                    chunk.VisibleCount = occlusionBuffer->RemoveOccluded(boundingBoxes, visibleInstances.first(chunk.VisibleCount));
+
+                if (viewPosition)
+                    chunk.NearestVisibleDistanceSquared = Math::MinDistanceSquared(*viewPosition, boundingBoxes, visibleInstances.first(chunk.VisibleCount));
+
+                for (uint32_t& visibleInstance : visibleInstances.first(chunk.VisibleCount))
+                    visibleInstance += chunk.Begin;
+            }
+        );
 
-        for (auto& meshBatch : m_MeshBatches | std::views::values)
-            for (auto& submeshBatch : meshBatch.SubmeshBatches | std::views::values)
-                for (auto& materialBatch : submeshBatch.MaterialBatches)
-                    for (auto& instanceBatch : materialBatch.InstanceBatches | std::views::values)
-                        UpdateInstanceBuffer(instanceBatch);
+        // Chunks of a batch are stored in order, so moving them to the front keeps the batch sorted
+        for (const CullingChunk& chunk : chunks)
+        {
+            InstanceBatch& instanceBatch{ *chunk.Batch };
+            if (chunk.Begin != instanceBatch.VisibleInstanceCount)
+            {
+                const auto chunkBegin{ instanceBatch.VisibleInstances.begin() + chunk.Begin };
+                std::copy(chunkBegin, chunkBegin + chunk.VisibleCount, instanceBatch.VisibleInstances.begin() + instanceBatch.VisibleInstanceCount);
+            }
+
+            instanceBatch.VisibleInstanceCount += chunk.VisibleCount;
+            instanceBatch.NearestVisibleDistanceSquared = std::min(instanceBatch.NearestVisibleDistanceSquared, chunk.NearestVisibleDistanceSquared);
+        }
+
+        // Updates go through the immediate context, so the uploads stay on this thread
+        CullingStatistics statistics{};
+        for (const DrawBatch& drawBatch : GetDrawBatches(shaderName))
+        {
+            const InstanceBatch& instanceBatch{ *drawBatch.Batch };
+            statistics.VisibleInstances += instanceBatch.VisibleInstanceCount;
+            statistics.TotalInstances += static_cast<uint32_t>(instanceBatch.WorldBoundingBoxes.size());
+
+            if (instanceBatch.VisibleInstanceCount > 0u)
+                UploadVisibleInstances(drawBatch, view);
+        }
+
+        return statistics;
+    }
+
+    void MeshRegistry::UpdateInstanceBVH()
+    {
+        UpdateTransforms();
+
+        if (!m_InstanceBVHDirty)
+        {
+            m_InstanceBVH.Refit(GetTransformSource());
+            return;
+        }
+
+        std::vector<InstanceBVH::Leaf> leaves{};
+        for (const auto& meshBatch : m_MeshBatches | std::views::values)
+        {
+            for (const auto& [mesh, submeshBatch] : meshBatch.SubmeshBatches)
+            {
+                for (uint32_t submeshIndex{ 0u }; submeshIndex < submeshBatch.MaterialBatches.size(); ++submeshIndex)
+                {
+                    for (const auto& instanceBatch : submeshBatch.MaterialBatches[submeshIndex].InstanceBatches | std::views::values)
+                    {
+                        // All the instances of a batch share the store, so do their uniform handles
+                        if (instanceBatch.SubmeshInstances.empty() || !instanceBatch.Store->HasUniform("TRANSFORM"))
+                            continue;
+
+                        const InstanceStore& store{ *instanceBatch.Store };
+                        const UniformHandle uuidHandle{ store.GetUniformHandle("INSTANCE_UUID") };
+                        for (const InstanceStore::ID instanceID : instanceBatch.SubmeshInstances)
+                        {
+                            InstanceBVH::Leaf leaf{};
+                            leaf.SourceMesh = mesh;
+                            leaf.UUID = store.Get<MeshUUID>(instanceID, uuidHandle);
+                            leaf.SubmeshIndex = submeshIndex;
+                            leaf.TransformID = GetCachedTransformID(leaf.UUID);
+
+                            leaves.emplace_back(std::move(leaf));
+                        }
+                    }
+                }
+            }
+        }
+
+        m_InstanceBVH.Rebuild(std::move(leaves), GetTransformSource());
+        m_InstanceBVHDirty = false;
     }
 
     void MeshRegistry::ReplaceUUID(MeshUUID oldUUID, MeshUUID newUUID)
@@ -166,17 +449,26 @@ namespace DLEngine
 
         const Ref<Mesh>& mesh{ m_UUID_ToMesh[oldUUID] };
         const std::vector<Ref<Material>>& materials{ m_UUID_ToMaterials[oldUUID] };
-        const Ref<Instance>& instance{ m_UUID_ToIntsance[oldUUID] };
+        const InstanceRow instanceRow{ m_UUID_ToIntsance[oldUUID] };
 
-        instance->Set("INSTANCE_UUID", Buffer{ &newUUID, sizeof(MeshUUID) });
+        instanceRow.Store->Set(instanceRow.ID, instanceRow.Store->GetUniformHandle("INSTANCE_UUID"), Buffer{ &newUUID, sizeof(MeshUUID) });
 
         m_UUID_ToMesh[newUUID] = mesh;
         m_UUID_ToMaterials[newUUID] = materials;
-        m_UUID_ToIntsance[newUUID] = instance;
+        m_UUID_ToIntsance[newUUID] = instanceRow;
+
+        if (const auto cachedTransformIt{ m_TransformCache.UUID_ToID.find(oldUUID) }; cachedTransformIt != m_TransformCache.UUID_ToID.end())
+        {
+            const TransformCache::Entries::ID id{ cachedTransformIt->second };
+            m_TransformCache.UUID_ToID.erase(cachedTransformIt);
+            m_TransformCache.UUID_ToID[newUUID] = id;
+        }
 
         m_UUID_ToMesh.erase(oldUUID);
         m_UUID_ToMaterials.erase(oldUUID);
         m_UUID_ToIntsance.erase(oldUUID);
+
+        m_InstanceBVHDirty = true;
     }
 
     void MeshRegistry::SwapShadingGroup(MeshUUID meshUUID, const Ref<Shader>& newShader)
@@ -186,7 +478,7 @@ namespace DLEngine
 
         const Ref<Mesh> mesh{ m_UUID_ToMesh[meshUUID] };
         const std::vector<Ref<Material>> materials{ m_UUID_ToMaterials[meshUUID] };
-        const Ref<Instance> instance{ m_UUID_ToIntsance[meshUUID] };
+        const Ref<Instance> instance{ GetInstance(meshUUID) };
 
         const std::string_view oldShaderName{ instance->GetShader()->GetName() };
         const std::string_view newShaderName{ newShader->GetName() };
@@ -194,7 +486,7 @@ namespace DLEngine
         if (oldShaderName == newShaderName)
             return;
 
-        const std::string& newInstanceName{ std::format("{0} to {1} Instance", instance->GetName(), newShaderName).c_str() };
+        const std::string& newInstanceName{ std::format("{0} to {1} Instance", oldShaderName, newShaderName).c_str() };
         Ref<Instance> newInstance{ Instance::Copy(instance, newShader, newInstanceName) };
         std::vector<Ref<Material>> newMaterials{};
         newMaterials.reserve(materials.size());
@@ -231,8 +523,8 @@ namespace DLEngine
 
         const Ref<Mesh>& mesh{ m_UUID_ToMesh[meshUUID] };
         const Ref<Material>& oldMaterial{ materials[submeshIndex] };
-        const Ref<Instance>& instance{ m_UUID_ToIntsance[meshUUID] };
-        const std::string_view shaderName{ instance->GetShader()->GetName() };
+        const InstanceRow& instanceRow{ m_UUID_ToIntsance[meshUUID] };
+        const std::string_view shaderName{ instanceRow.Store->GetShader()->GetName() };
 
         MeshBatch& meshBatch{ m_MeshBatches[shaderName] };
         SubmeshBatch& submeshBatch{ meshBatch.SubmeshBatches[mesh] };
@@ -240,29 +532,14 @@ namespace DLEngine
 
         // Remove old instance
         InstanceBatch& oldInstanceBatch{ materialBatch.InstanceBatches[oldMaterial] };
-        std::erase(oldInstanceBatch.SubmeshInstances, instance);
+        std::erase(oldInstanceBatch.SubmeshInstances, instanceRow.ID);
+        oldInstanceBatch.InstancesChanged = true;
 
         // Add new instance
-        InstanceBatch* newInstanceBatch{ nullptr };
-        const auto instanceBatchIt{ materialBatch.InstanceBatches.find(newMaterial) };
-        if (instanceBatchIt == materialBatch.InstanceBatches.end())
-        {
-            newInstanceBatch = &materialBatch.InstanceBatches[newMaterial];
-
-            const auto& inputLayout{ instance->GetShader()->GetInputLayout() };
-            for (const auto& [bindingPoint, inputLayoutEntry] : inputLayout)
-            {
-                if (inputLayoutEntry.Type == InputLayoutType::PerVertex)
-                    continue;
-
-                const auto& instanceBufferLayout{ inputLayoutEntry.Layout };
-                newInstanceBatch->InstanceBuffers.emplace(bindingPoint, VertexBuffer::Create(instanceBufferLayout, instanceBufferLayout.GetStride()));
-            }
-        }
-        else
-            newInstanceBatch = &instanceBatchIt->second;
-
-        newInstanceBatch->SubmeshInstances.push_back(instance);
+        InstanceBatch& newInstanceBatch{ GetOrCreateInstanceBatch(mesh, submeshIndex, newMaterial) };
+        newInstanceBatch.Store = instanceRow.Store;
+        newInstanceBatch.SubmeshInstances.push_back(instanceRow.ID);
+        newInstanceBatch.InstancesChanged = true;
         materials[submeshIndex] = newMaterial;
     }
 
@@ -300,7 +577,23 @@ namespace DLEngine
             meshUUID
         );
 
-        return m_UUID_ToIntsance.at(meshUUID);
+        const InstanceRow& instanceRow{ m_UUID_ToIntsance.at(meshUUID) };
+        return Instance::Create(instanceRow.Store, instanceRow.ID);
+    }
+
+    const Math::Mat4x4& MeshRegistry::GetMeshToWorld(MeshUUID meshUUID) const
+    {
+        return m_TransformCache.Transforms.get<TransformCache::MESH_TO_WORLD_COLUMN>(GetCachedTransformID(meshUUID));
+    }
+
+    const Math::Mat4x4& MeshRegistry::GetWorldToMesh(MeshUUID meshUUID) const
+    {
+        return m_TransformCache.Transforms.get<TransformCache::WORLD_TO_MESH_COLUMN>(GetCachedTransformID(meshUUID));
+    }
+
+    const Math::AABB& MeshRegistry::GetWorldBoundingBox(MeshUUID meshUUID) const
+    {
+        return m_TransformCache.Transforms.get<TransformCache::WORLD_BOUNDING_BOX_COLUMN>(GetCachedTransformID(meshUUID));
     }
 
     const MeshRegistry::MeshBatch& MeshRegistry::GetMeshBatch(std::string_view shaderName) const noexcept
@@ -315,58 +608,391 @@ namespace DLEngine
         return meshBatchIt == m_MeshBatches.end() ? m_EmptyMeshBatch : meshBatchIt->second;
     }
 
-    void MeshRegistry::UpdateInstanceBuffer(InstanceBatch& instanceBatch)
+    const std::vector<MeshRegistry::DrawBatch>& MeshRegistry::GetDrawBatches(std::string_view shaderName) const noexcept
+    {
+        const auto drawBatchesIt{ m_DrawBatches.find(shaderName) };
+        return drawBatchesIt == m_DrawBatches.end() ? m_EmptyDrawBatches : drawBatchesIt->second;
+    }
+
+    void MeshRegistry::UpdateDrawBatches()
+    {
+        if (!m_DrawBatchesDirty)
+            return;
+
+        m_DrawBatches.clear();
+        for (auto& [shaderName, meshBatch] : m_MeshBatches)
+        {
+            std::vector<DrawBatch>& drawBatches{ m_DrawBatches[shaderName] };
+
+            std::unordered_map<Ref<Material>, uint32_t, MaterialHash, MaterialEqual> materialIDs{};
+            uint32_t meshID{ 0u };
+            for (auto& [mesh, submeshBatch] : meshBatch.SubmeshBatches)
+            {
+                DL_ASSERT(submeshBatch.MaterialBatches.size() <= (1u << SORT_KEY_SUBMESH_BITS),
+                    "Mesh [{0}] has more submeshes than the sort keys can address",
+                    mesh->GetName()
+                );
+
+                for (uint32_t submeshIndex{ 0u }; submeshIndex < submeshBatch.MaterialBatches.size(); ++submeshIndex)
+                {
+                    for (auto& [material, instanceBatch] : submeshBatch.MaterialBatches[submeshIndex].InstanceBatches)
+                    {
+                        const uint32_t materialID{ materialIDs.try_emplace(material, static_cast<uint32_t>(materialIDs.size())).first->second };
+                        drawBatches.emplace_back(DrawBatch{
+                            .SourceMesh = mesh,
+                            .SubmeshIndex = submeshIndex,
+                            .SourceMaterial = material,
+                            .Batch = &instanceBatch,
+                            .MeshID = meshID,
+                            .MaterialID = materialID
+                        });
+                    }
+                }
+
+                ++meshID;
+            }
+
+            DL_ASSERT(materialIDs.size() <= (1u << SORT_KEY_MATERIAL_BITS) && meshID <= (1u << SORT_KEY_MESH_BITS),
+                "Shader [{0}] has more materials or meshes than the sort keys can address",
+                shaderName
+            );
+        }
+
+        m_DrawBatchesDirty = false;
+    }
+
+    void MeshRegistry::UpdateInstanceBuffer(InstanceBatch& instanceBatch, const Math::AABB& submeshBoundingBox)
     {
         if (instanceBatch.SubmeshInstances.empty())
             return;
 
-        const auto& inputLayout{ instanceBatch.SubmeshInstances.front()->GetShader()->GetInputLayout() };
-        std::map<uint32_t, Buffer> mapBuffers{};
+        // All the instances of a batch share the store, so the uniforms are looked up once for the whole batch
+        const InstanceStore& store{ *instanceBatch.Store };
+        const UniformHandle transformHandle{ store.GetTransformHandle() };
+        const bool hasTransform{ transformHandle.IsValid() };
+        const size_t instanceCount{ instanceBatch.SubmeshInstances.size() };
+
+        if (instanceBatch.InstancesChanged)
+        {
+            // The boxes of all the instances are transformed in one batch, the submesh box is loaded only once
+            instanceBatch.WorldTransforms.resize(instanceCount);
+            instanceBatch.TransformVersions.resize(instanceCount);
+            for (uint32_t submeshInstanceIndex{ 0u }; submeshInstanceIndex < instanceCount; ++submeshInstanceIndex)
+            {
+                const InstanceStore::ID instanceID{ instanceBatch.SubmeshInstances[submeshInstanceIndex] };
+                instanceBatch.WorldTransforms[submeshInstanceIndex] = hasTransform ?
+                    store.Get<Math::Mat4x4>(instanceID, transformHandle) : Math::Mat4x4::Identity();
+                instanceBatch.TransformVersions[submeshInstanceIndex] = store.GetTransformVersion(instanceID);
+            }
+
+            instanceBatch.WorldBoundingBoxes.resize(instanceCount);
+            Math::TransformAABB(submeshBoundingBox, instanceBatch.WorldTransforms, instanceBatch.WorldBoundingBoxes);
+
+            // Instances without a transform can not be placed in the world, so they are never culled
+            if (!hasTransform)
+                std::fill(instanceBatch.WorldBoundingBoxes.begin(), instanceBatch.WorldBoundingBoxes.end(),
+                    Math::AABB{ .Min = Math::Vec3{ -Math::Numeric::Max }, .Max = Math::Vec3{ Math::Numeric::Max } }
+                );
+
+            instanceBatch.InstancesChanged = false;
+        }
+        else
+        {
+            // The version of the instances without a transform never changes, so they keep their unbounded boxes
+            const std::span<Math::Mat4x4> worldTransforms{ instanceBatch.WorldTransforms };
+            const std::span<Math::AABB> worldBoundingBoxes{ instanceBatch.WorldBoundingBoxes };
+            RefreshStaleRuns(0u, static_cast<uint32_t>(instanceCount),
+                [&instanceBatch, &store, transformHandle](uint32_t submeshInstanceIndex)
+                {
+                    const InstanceStore::ID instanceID{ instanceBatch.SubmeshInstances[submeshInstanceIndex] };
+                    const uint32_t transformVersion{ store.GetTransformVersion(instanceID) };
+                    if (instanceBatch.TransformVersions[submeshInstanceIndex] == transformVersion)
+                        return false;
+
+                    instanceBatch.WorldTransforms[submeshInstanceIndex] = store.Get<Math::Mat4x4>(instanceID, transformHandle);
+                    instanceBatch.TransformVersions[submeshInstanceIndex] = transformVersion;
+                    return true;
+                },
+                [&submeshBoundingBox, worldTransforms, worldBoundingBoxes](uint32_t runBegin, uint32_t runEnd)
+                {
+                    Math::TransformAABB(submeshBoundingBox, worldTransforms.subspan(runBegin, runEnd - runBegin), worldBoundingBoxes.subspan(runBegin, runEnd - runBegin));
+                }
+            );
+        }
+
+        instanceBatch.VisibleInstanceCount = 0u;
+    }
+
+    void MeshRegistry::UploadVisibleInstances(const DrawBatch& drawBatch, ViewID view)
+    {
+        InstanceBatch& instanceBatch{ *drawBatch.Batch };
+        const uint32_t visibleCount{ instanceBatch.VisibleInstanceCount };
+
+        if (instanceBatch.Views.size() <= view)
+            instanceBatch.Views.resize(view + 1u);
 
+        InstanceView& instanceView{ instanceBatch.Views[view] };
+        instanceView.LastUsedFrame = m_FrameIndex;
+
+        auto& uploadedInstances{ instanceView.UploadedInstances };
+        auto& uploadedVersions{ instanceView.UploadedVersions };
+
+        // The buffers of a view hold only its visible instances. Grow geometrically, so a view that sees more instances every frame
+        // does not recreate its buffers every time
+        const auto& inputLayout{ drawBatch.SourceMaterial->GetShader()->GetInputLayout() };
         for (const auto& [bindingPoint, inputLayoutEntry] : inputLayout)
         {
             if (inputLayoutEntry.Type == InputLayoutType::PerVertex)
                 continue;
 
             const auto& instanceBufferLayout{ inputLayoutEntry.Layout };
-            const size_t instanceBufferStride{ instanceBufferLayout.GetStride() };
-            const size_t requiredInstanceBufferSize{ instanceBufferStride * instanceBatch.SubmeshInstances.size() };
-            if (instanceBatch.InstanceBuffers[bindingPoint]->GetSize() != requiredInstanceBufferSize)
-                instanceBatch.InstanceBuffers[bindingPoint] = VertexBuffer::Create(instanceBufferLayout, requiredInstanceBufferSize);
+            const size_t requiredInstanceBufferSize{ instanceBufferLayout.GetStride() * visibleCount };
+
+            auto& instanceBuffer{ instanceView.InstanceBuffers[bindingPoint] };
+            const size_t instanceBufferSize{ instanceBuffer ? instanceBuffer->GetSize() : 0u };
+            if (instanceBufferSize < requiredInstanceBufferSize)
+            {
+                const size_t instanceBufferCapacity{ std::max(requiredInstanceBufferSize, instanceBufferSize * 2u) };
+                instanceBuffer = VertexBuffer::Create(instanceBufferLayout, instanceBufferCapacity, VertexBufferUsage::Updatable);
+                uploadedInstances.clear();
+                ++m_UploadStatistics.ReallocatedBuffers;
+            }
+        }
+
+        const InstanceStore& store{ *instanceBatch.Store };
+        const solid_vector_indices storeRows{ store.GetRowIndices() };
+        const std::span<const uint32_t> dataVersions{ store.GetDataVersions() };
+
+        // Row of every visible instance in the columns of the store
+        m_UploadStoreRows.resize(visibleCount);
+        for (uint32_t i{ 0u }; i < visibleCount; ++i)
+            m_UploadStoreRows[i] = storeRows.getIndex(instanceBatch.SubmeshInstances[instanceBatch.VisibleInstances[i]]);
+
+        const uint32_t uploadedCount{ static_cast<uint32_t>(uploadedInstances.size()) };
 
-            mapBuffers.emplace(bindingPoint, instanceBatch.InstanceBuffers[bindingPoint]->Map());
+        // A row is sent only if it holds another instance than the last upload of the view left there or the data of the instance has changed since,
+        // so culls that keep the same instances visible upload nothing
+        std::vector<std::pair<uint32_t, uint32_t>> dirtyRanges{};
+        for (uint32_t i{ 0u }; i < visibleCount; ++i)
+        {
+            const InstanceStore::ID instanceID{ instanceBatch.SubmeshInstances[instanceBatch.VisibleInstances[i]] };
+            if (i < uploadedCount && uploadedInstances[i] == instanceID && uploadedVersions[i] == dataVersions[m_UploadStoreRows[i]])
+                continue;
+
+            if (!dirtyRanges.empty() && i - dirtyRanges.back().second <= UPLOAD_RANGE_MERGE_GAP)
+                dirtyRanges.back().second = i + 1u;
+            else
+                dirtyRanges.emplace_back(i, i + 1u);
         }
 
-        for (uint32_t submeshInstanceIndex{ 0u }; submeshInstanceIndex < instanceBatch.SubmeshInstances.size(); ++submeshInstanceIndex)
+        if (dirtyRanges.empty())
+            return;
+
+        for (const auto& [bindingPoint, instanceBuffer] : instanceView.InstanceBuffers)
         {
-            for (auto& [bindingPoint, mapBuffer] : mapBuffers)
+            const size_t instanceBufferStride{ instanceBuffer->GetLayout().GetStride() };
+            const Buffer column{ store.GetColumnData(bindingPoint) };
+            const uint8_t* columnData{ static_cast<const uint8_t*>(column.Data) };
+
+            DL_ASSERT(column.Size == instanceBufferStride * store.GetInstanceCount(),
+                "Column of the binding point [{0}] does not match the instance buffer layout", bindingPoint
+            );
+
+            for (const auto& [begin, end] : dirtyRanges)
             {
-                const auto& instanceBufferLayout{ inputLayout.at(bindingPoint).Layout };
-                const size_t instanceBufferStride{ instanceBufferLayout.GetStride() };
-                for (const auto& bufferElement : instanceBufferLayout)
+                // Instances spawned together sit in consecutive rows of the store, a range of them is sent straight from the column.
+                // Otherwise every run of consecutive rows is a single copy into the staging data
+                Buffer uploadBuffer{ columnData + instanceBufferStride * m_UploadStoreRows[begin], instanceBufferStride * (end - begin) };
+                if (ConsecutiveRowsEnd(m_UploadStoreRows, begin, end) != end)
                 {
-                    const Buffer instanceData{ instanceBatch.SubmeshInstances[submeshInstanceIndex]->Get(bufferElement.Name) };
-                    const size_t offset{ instanceBufferStride * submeshInstanceIndex + bufferElement.Offset };
-                    mapBuffer.Write(instanceData.Data, instanceData.Size, offset);
+                    m_UploadStagingData.resize(uploadBuffer.Size);
+                    for (uint32_t runBegin{ begin }, runEnd{ begin }; runBegin < end; runBegin = runEnd)
+                    {
+                        runEnd = ConsecutiveRowsEnd(m_UploadStoreRows, runBegin, end);
+                        std::copy_n(columnData + instanceBufferStride * m_UploadStoreRows[runBegin], instanceBufferStride * (runEnd - runBegin),
+                            m_UploadStagingData.begin() + instanceBufferStride * (runBegin - begin)
+                        );
+                    }
+
+                    uploadBuffer = Buffer{ m_UploadStagingData.data(), m_UploadStagingData.size() };
+                    ++m_UploadStatistics.GatheredRanges;
                 }
+
+                instanceBuffer->SetData(uploadBuffer, instanceBufferStride * begin);
+
+                m_UploadStatistics.UploadedBytes += uploadBuffer.Size;
+                ++m_UploadStatistics.UploadedRanges;
             }
         }
 
-        for (const auto& [bindingPoint, instanceBuffer] : instanceBatch.InstanceBuffers)
-            instanceBuffer->Unmap();
+        // Rows past the visible ones keep what was uploaded there before, later culls of the view may still reuse them
+        uploadedInstances.resize(std::max(uploadedCount, visibleCount));
+        uploadedVersions.resize(uploadedInstances.size());
+        for (const auto& [begin, end] : dirtyRanges)
+        {
+            for (uint32_t i{ begin }; i < end; ++i)
+            {
+                uploadedInstances[i] = instanceBatch.SubmeshInstances[instanceBatch.VisibleInstances[i]];
+                uploadedVersions[i] = dataVersions[m_UploadStoreRows[i]];
+            }
+        }
+    }
+
+    void MeshRegistry::ReleaseUnusedViews(InstanceBatch& instanceBatch)
+    {
+        for (InstanceView& instanceView : instanceBatch.Views)
+        {
+            if (instanceView.InstanceBuffers.empty() || m_FrameIndex - instanceView.LastUsedFrame < VIEW_RELEASE_FRAMES)
+                continue;
+
+            instanceView = InstanceView{};
+            ++m_UploadStatistics.ReleasedViews;
+        }
+
+        // The released views at the end are dropped, the views before them keep their IDs
+        while (!instanceBatch.Views.empty() && instanceBatch.Views.back().InstanceBuffers.empty())
+            instanceBatch.Views.pop_back();
+    }
+
+    MeshRegistry::InstanceBatch& MeshRegistry::GetOrCreateInstanceBatch(const Ref<Mesh>& mesh, uint32_t submeshIndex, const Ref<Material>& material)
+    {
+        const auto& shader{ material->GetShader() };
+
+        MeshBatch* meshBatch{ nullptr };
+        const auto meshBatchIt{ m_MeshBatches.find(shader->GetName()) };
+        if (meshBatchIt == m_MeshBatches.end())
+            meshBatch = &m_MeshBatches[shader->GetName()];
+        else
+            meshBatch = &meshBatchIt->second;
+
+        SubmeshBatch* submeshBatch{ nullptr };
+        const auto submeshBatchIt{ meshBatch->SubmeshBatches.find(mesh) };
+        if (submeshBatchIt == meshBatch->SubmeshBatches.end())
+        {
+            submeshBatch = &meshBatch->SubmeshBatches[mesh];
+            submeshBatch->MaterialBatches.resize(mesh->GetSubmeshes().size());
+        }
+        else
+            submeshBatch = &submeshBatchIt->second;
+
+        DL_ASSERT(submeshIndex < submeshBatch->MaterialBatches.size(),
+            "Submesh index [{0}] is out of range for mesh [{1}]",
+            submeshIndex, mesh->GetName()
+        );
+        MaterialBatch* materialBatch{ &submeshBatch->MaterialBatches[submeshIndex] };
+
+        const auto instanceBatchIt{ materialBatch->InstanceBatches.find(material) };
+        if (instanceBatchIt != materialBatch->InstanceBatches.end())
+            return instanceBatchIt->second;
+
+        InstanceBatch& instanceBatch{ materialBatch->InstanceBatches[material] };
+
+        m_DrawBatchesDirty = true;
+
+        return instanceBatch;
+    }
+
+    MeshRegistry::MeshUUID MeshRegistry::RegisterSubmesh(
+        InstanceBatch& instanceBatch,
+        const Ref<Mesh>& mesh,
+        uint32_t submeshIndex,
+        const Ref<Material>& material,
+        const Ref<Instance>& instance
+    )
+    {
+        DL_ASSERT(material->GetShader() == instance->GetShader(),
+            "Material [{0}] and instance [{1}] are made for different shaders",
+            material->GetName(), instance->GetName()
+        );
+
+        DL_ASSERT(instance->HasUniform("INSTANCE_UUID"),
+            "Instance [{0}] does not have an 'INSTANCE_UUID' uniform",
+            instance->GetName()
+        );
+
+        const Ref<InstanceStore>& store{ instance->GetStore() };
+        const InstanceStore::ID instanceID{ instance->GetStoreID() };
+
+        DL_ASSERT(!instanceBatch.Store || instanceBatch.Store == store,
+            "Instance [{0}] is not in the store of the other instances of its batch",
+            instance->GetName()
+        );
+        instanceBatch.Store = store;
+
+        // A registered instance carries its UUID in its row. Copies carry it too, but they have rows of their own
+        const auto registeredIt{ m_UUID_ToIntsance.find(instance->Get<MeshUUID>("INSTANCE_UUID")) };
+        if (registeredIt != m_UUID_ToIntsance.end() && registeredIt->second.Store == store && registeredIt->second.ID == instanceID)
+        {
+            const MeshUUID uuid{ registeredIt->first };
+            
+            if (m_UUID_ToMesh[uuid] != mesh)
+            {
+                DL_LOG_ERROR_TAG(
+                    "MeshRegistry",
+                    "Instance [{0}] is already assigned to a different mesh [{1}]",
+                    instance->GetName(), m_UUID_ToMesh[uuid]->GetName()
+                );
+
+                return 0u;
+            }
+
+            if (m_UUID_ToMaterials[uuid][submeshIndex] && m_UUID_ToMaterials[uuid][submeshIndex] != material)
+            {
+                DL_LOG_ERROR_TAG(
+                    "MeshRegistry",
+                    "Instance [{0}] is already assigned to a different material [{1}]",
+                    instance->GetName(), m_UUID_ToMaterials[uuid][submeshIndex]->GetName()
+                );
+
+                return 0u;
+            }
+
+            m_UUID_ToMaterials[uuid][submeshIndex] = material;
+
+            instanceBatch.SubmeshInstances.push_back(instanceID);
+            instanceBatch.InstancesChanged = true;
+
+            m_InstanceBVHDirty = true;
+
+            return uuid;
+        }
+
+        const MeshUUID uuid{ RandomGenerator::GenerateRandom<MeshUUID>() };
+        instance->Set("INSTANCE_UUID", Buffer{ &uuid, sizeof(MeshUUID) });
+
+        // The registry frees the row from now on, the instance is left a view of it
+        instance->ReleaseRow();
+        
+        m_UUID_ToMesh[uuid] = mesh;
+        
+        m_UUID_ToMaterials[uuid].resize(mesh->GetSubmeshes().size());
+        m_UUID_ToMaterials[uuid][submeshIndex] = material;
+        
+        const InstanceRow& instanceRow{ m_UUID_ToIntsance[uuid] = InstanceRow{ .Store = store, .ID = instanceID } };
+
+        if (store->HasUniform("TRANSFORM"))
+            AddCachedTransform(uuid, instanceRow, mesh->GetBoundingBox());
+
+        instanceBatch.SubmeshInstances.push_back(instanceID);
+        instanceBatch.InstancesChanged = true;
+
+        m_InstanceBVHDirty = true;
+
+        return uuid;
     }
 
     void MeshRegistry::ClearEmptyBatches()
     {
-        std::erase_if(m_MeshBatches, [](auto& meshBatch)
+        size_t erasedInstanceBatches{ 0u };
+        std::erase_if(m_MeshBatches, [&erasedInstanceBatches](auto& meshBatch)
             {
                 auto& submeshBatches{ meshBatch.second.SubmeshBatches };
-                std::erase_if(submeshBatches, [](auto& submeshBatch)
+                std::erase_if(submeshBatches, [&erasedInstanceBatches](auto& submeshBatch)
                     {
                         auto& materialBatches{ submeshBatch.second.MaterialBatches };
                         for (auto& materialBatch : materialBatches)
                         {
-                            std::erase_if(materialBatch.InstanceBatches, [](const auto& instanceBatch)
+                            erasedInstanceBatches += std::erase_if(materialBatch.InstanceBatches, [](const auto& instanceBatch)
                                 {
                                     return instanceBatch.second.SubmeshInstances.empty();
                                 });
@@ -381,6 +1007,49 @@ namespace DLEngine
 
                 return submeshBatches.empty();
             });
+
+        // The flat lists point into the erased batches
+        m_DrawBatchesDirty |= erasedInstanceBatches > 0u;
+    }
+
+    void MeshRegistry::AddCachedTransform(MeshUUID meshUUID, const InstanceRow& instanceRow, const Math::AABB& meshBoundingBox)
+    {
+        // The version never matches the one of the instance, so the entry is stale until refreshed
+        m_TransformCache.UUID_ToID[meshUUID] = m_TransformCache.Transforms.emplace(instanceRow,
+            instanceRow.Store->GetTransformVersion(instanceRow.ID) + 1u, Math::Mat4x4{}, Math::Mat4x4{}, Math::AABB{}, meshBoundingBox
+        );
+    }
+
+    void MeshRegistry::RemoveCachedTransform(MeshUUID meshUUID)
+    {
+        const auto it{ m_TransformCache.UUID_ToID.find(meshUUID) };
+        if (it == m_TransformCache.UUID_ToID.end())
+            return;
+
+        // The last entry is moved into the hole, the IDs of the other instances stay valid
+        m_TransformCache.Transforms.erase(it->second);
+        m_TransformCache.UUID_ToID.erase(it);
+    }
+
+    MeshRegistry::TransformCache::Entries::ID MeshRegistry::GetCachedTransformID(MeshUUID meshUUID) const
+    {
+        DL_ASSERT(m_TransformCache.UUID_ToID.contains(meshUUID),
+            "Instance with UUID [{0}] does not have a transform",
+            meshUUID
+        );
+
+        return m_TransformCache.UUID_ToID.at(meshUUID);
+    }
+
+    InstanceBVH::TransformSource MeshRegistry::GetTransformSource() const noexcept
+    {
+        const auto& transforms{ m_TransformCache.Transforms };
+        return InstanceBVH::TransformSource{
+            .Indices = transforms.indices(),
+            .MeshToWorld = transforms.column<TransformCache::MESH_TO_WORLD_COLUMN>(),
+            .WorldToMesh = transforms.column<TransformCache::WORLD_TO_MESH_COLUMN>(),
+            .Versions = transforms.column<TransformCache::VERSION_COLUMN>()
+        };
     }
 
 }
\ No newline at end of file
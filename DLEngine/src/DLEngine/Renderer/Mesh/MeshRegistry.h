@@ -1,16 +1,26 @@
 #pragma once
+#include "DLEngine/Core/solid_vector.h"
+
+#include "DLEngine/Renderer/Mesh/InstanceBVH.h"
 #include "DLEngine/Renderer/Mesh/Mesh.h"
 
 #include "DLEngine/Renderer/Instance.h"
+#include "DLEngine/Renderer/InstanceStore.h"
 #include "DLEngine/Renderer/Material.h"
 #include "DLEngine/Renderer/VertexBuffer.h"
 
 namespace DLEngine
 {
+    class OcclusionBuffer;
+
     class MeshRegistry
     {
     public:
         using MeshUUID = uint64_t;
+        // Passes that cull the same shader into different sets of instances use different views.
+        // Every view keeps its own instance buffers, so the uploads of one pass are not overwritten by another.
+        // Views are indexed densely, the callers are expected to number their passes from zero without gaps
+        using ViewID = uint32_t;
 
     public:
         struct IntersectInfo
@@ -19,10 +29,58 @@ namespace DLEngine
             MeshUUID UUID;
         };
 
-        struct InstanceBatch
+        struct SubmeshEntry
+        {
+            Ref<Mesh> SourceMesh;
+            uint32_t SubmeshIndex{ 0u };
+            Ref<Material> SourceMaterial;
+            Ref<Instance> SubmeshInstance;
+        };
+
+        // Row of a registered instance in the store of its shader, the registry owns the row and frees it when the mesh is removed
+        struct InstanceRow
+        {
+            Ref<InstanceStore> Store;
+            InstanceStore::ID ID;
+        };
+
+        struct InstanceView
         {
-            std::vector<Ref<Instance>> SubmeshInstances;
             std::map<uint32_t, Ref<VertexBuffer>> InstanceBuffers;
+
+            // Instance and its data version held by every row of InstanceBuffers, only the rows that differ are uploaded
+            std::vector<InstanceStore::ID> UploadedInstances;
+            std::vector<uint32_t> UploadedVersions;
+
+            // Frame of the last upload into the view, the buffers of views left unused for a while are released
+            uint64_t LastUsedFrame{ 0u };
+        };
+
+        struct InstanceBatch
+        {
+            // All the instances of a batch share the shader and so the store, whose columns are copied into the instance buffers of the views
+            Ref<InstanceStore> Store;
+            std::vector<InstanceStore::ID> SubmeshInstances;
+
+            // Indexed by ViewID, created by the first cull of the view that leaves instances of the batch visible
+            std::vector<InstanceView> Views;
+
+            std::vector<Math::Mat4x4> WorldTransforms;
+            std::vector<Math::AABB> WorldBoundingBoxes;
+
+            // Only the boxes of the moved instances are recomputed, unless instances were added to or removed from the batch
+            std::vector<uint32_t> TransformVersions;
+            bool InstancesChanged{ true };
+
+            std::vector<uint32_t> VisibleInstances;
+            uint32_t VisibleInstanceCount{ 0u };
+            // View of the last CullInstances call, its instance buffers hold the visible instances
+            ViewID VisibleView{ 0u };
+            // Squared distance from the view position of the last CullInstances call to the nearest visible instance,
+            // zero when that call had no view position
+            float NearestVisibleDistanceSquared{ 0.0f };
+
+            const std::map<uint32_t, Ref<VertexBuffer>>& GetVisibleInstanceBuffers() const noexcept { return Views[VisibleView].InstanceBuffers; }
         };
 
         struct MaterialBatch
@@ -40,12 +98,112 @@ namespace DLEngine
             std::unordered_map<Ref<Mesh>, SubmeshBatch> SubmeshBatches;
         };
 
+        // One instanced draw, the instances of a submesh that share a material.
+        // The batches of a shader are kept in a flat list, so the per-frame passes do not walk the hash tables above
+        struct DrawBatch
+        {
+            Ref<Mesh> SourceMesh;
+            uint32_t SubmeshIndex{ 0u };
+            Ref<Material> SourceMaterial;
+            InstanceBatch* Batch{ nullptr };
+
+            // Dense within the shader, equal materials share an ID
+            uint32_t MeshID{ 0u };
+            uint32_t MaterialID{ 0u };
+        };
+
+        // Batches left visible by the last CullInstances call of a shader, in ascending order of their sort keys.
+        // Key bits from the highest: material ID (20), depth bucket (12), mesh ID (20), submesh index (12).
+        // The depth bucket is zero after a cull without a view position
+        struct DrawList
+        {
+            std::vector<uint64_t> SortKeys;
+            std::vector<const DrawBatch*> Draws;
+        };
+
+        // World transforms, their inverses and the world bounds of the whole meshes, one entry per instance with a TRANSFORM uniform.
+        // Entries are refreshed by UpdateTransforms only when the transform version of the instance has changed.
+        // They stay densely packed for the refresh, while the IDs held by the instance BVH keep addressing them across removals
+        struct TransformCache
+        {
+            static constexpr size_t INSTANCE_COLUMN{ 0u };
+            static constexpr size_t VERSION_COLUMN{ 1u };
+            static constexpr size_t MESH_TO_WORLD_COLUMN{ 2u };
+            static constexpr size_t WORLD_TO_MESH_COLUMN{ 3u };
+            static constexpr size_t WORLD_BOUNDING_BOX_COLUMN{ 4u };
+            static constexpr size_t MESH_BOUNDING_BOX_COLUMN{ 5u };
+
+            using Entries = solid_vector<InstanceRow, uint32_t, Math::Mat4x4, Math::Mat4x4, Math::AABB, Math::AABB>;
+
+            Entries Transforms;
+            std::unordered_map<MeshUUID, Entries::ID> UUID_ToID;
+        };
+
+        // Reset by UpdateInstanceBuffers, so it covers the uploads of one frame
+        struct UploadStatistics
+        {
+            uint64_t UploadedBytes{ 0u };
+            uint32_t UploadedRanges{ 0u };
+            // Ranges whose instances are not in consecutive rows of the store, they are gathered before the upload instead of sent from the columns
+            uint32_t GatheredRanges{ 0u };
+            uint32_t ReallocatedBuffers{ 0u };
+            uint32_t ReleasedViews{ 0u };
+        };
+
+        struct CullingStatistics
+        {
+            uint32_t VisibleInstances{ 0u };
+            uint32_t TotalInstances{ 0u };
+
+            CullingStatistics& operator+=(const CullingStatistics& other) noexcept
+            {
+                VisibleInstances += other.VisibleInstances;
+                TotalInstances += other.TotalInstances;
+                return *this;
+            }
+        };
+
     public:
+        MeshRegistry() = default;
+        MeshRegistry(const MeshRegistry&) = delete;
+        MeshRegistry& operator=(const MeshRegistry&) = delete;
+        ~MeshRegistry();
+
+        // The registry takes the row of the instance, see Instance::ReleaseRow. The instance given stays a view of the row until the mesh is removed
         MeshUUID AddSubmesh(const Ref<Mesh>& mesh, uint32_t submeshIndex, const Ref<Material>& material, const Ref<Instance>& instance);
+        // Same as calling AddSubmesh for every entry in order, returns their UUIDs.
+        // The storage is grown once for all the entries and the transforms are cached in parallel
+        std::vector<MeshUUID> AddSubmeshes(std::span<const SubmeshEntry> submeshes);
         void RemoveMesh(MeshUUID meshUUID);
 
         void UpdateInstanceBuffers();
 
+        // Refreshes the cached transforms of the moved instances, returns the number of refreshed entries
+        uint32_t UpdateTransforms();
+
+        // Tests the instances of the shader against the frustum in parallel across the batches and uploads only the visible ones
+        // into the instance buffers of the view, draws have to use InstanceBatch::GetVisibleInstanceBuffers and VisibleInstanceCount afterwards.
+        // The culls without a view position are for the depth-only passes, their draw lists are not ordered by depth
+        CullingStatistics CullInstances(std::string_view shaderName, ViewID view, const Math::Frustum& frustum);
+        // Additionally records the distance to the nearest visible instance of every batch, while its boxes are still in the cache
+        CullingStatistics CullInstances(std::string_view shaderName, ViewID view, const Math::Frustum& frustum, const Math::Vec3& viewPosition);
+        // Additionally drops the instances hidden behind the occluders rasterized into the occlusion buffer
+        CullingStatistics CullInstances(std::string_view shaderName, ViewID view, const Math::Frustum& frustum, const OcclusionBuffer& occlusionBuffer, const Math::Vec3& viewPosition);
+        CullingStatistics CullInstances(std::string_view shaderName, ViewID view, const Math::Sphere& sphere);
+
+        // Returns the mask of the frustums that contain at least one instance left visible by the last CullInstances call
+        uint32_t GetVisibleInstancesMask(std::string_view shaderName, std::span<const Math::Frustum> frustums) const;
+
+        // Sorts the batches left visible by the last CullInstances call of the shader by material
+        // and then front to back by InstanceBatch::NearestVisibleDistanceSquared, the list is valid until the next call
+        const DrawList& BuildDrawList(std::string_view shaderName);
+        // Same for any batches, the scratch vectors are kept between the calls to avoid reallocations
+        static void BuildDrawList(std::span<const DrawBatch> drawBatches, DrawList& outDrawList,
+            std::vector<uint64_t>& sortKeysScratch, std::vector<const DrawBatch*>& drawsScratch);
+
+        // Rebuilds the instance BVH if instances were added or removed, refits it otherwise
+        void UpdateInstanceBVH();
+
         void ReplaceUUID(MeshUUID oldUUID, MeshUUID newUUID);
         void SwapShadingGroup(MeshUUID meshUUID, const Ref<Shader>& newShader);
         void SwapMaterial(MeshUUID meshUUID, uint32_t submeshIndex, const Ref<Material>& newMaterial);
@@ -53,25 +211,71 @@ namespace DLEngine
         bool HasInstance(MeshUUID meshUUID) const { return m_UUID_ToIntsance.contains(meshUUID); }
         Ref<Mesh> GetMesh(MeshUUID meshUUID) const;
         const Ref<Material>& GetMaterial(MeshUUID meshUUID, uint32_t submeshIndex) const;
+        // A view of the row held by the registry, valid until the mesh is removed
         Ref<Instance> GetInstance(MeshUUID meshUUID) const;
 
+        bool HasTransform(MeshUUID meshUUID) const { return m_TransformCache.UUID_ToID.contains(meshUUID); }
+        const Math::Mat4x4& GetMeshToWorld(MeshUUID meshUUID) const;
+        const Math::Mat4x4& GetWorldToMesh(MeshUUID meshUUID) const;
+        const Math::AABB& GetWorldBoundingBox(MeshUUID meshUUID) const;
+
+        const TransformCache& GetTransformCache() const noexcept { return m_TransformCache; }
+        const UploadStatistics& GetUploadStatistics() const noexcept { return m_UploadStatistics; }
+        const InstanceBVH& GetInstanceBVH() const noexcept { return m_InstanceBVH; }
+
+        const std::vector<DrawBatch>& GetDrawBatches(std::string_view shaderName) const noexcept;
+
+    private:
         MeshBatch& GetMeshBatch(std::string_view shaderName) noexcept;
         const MeshBatch& GetMeshBatch(std::string_view shaderName) const noexcept;
 
-        [[nodiscard]] std::unordered_map<std::string_view, MeshBatch>::const_iterator begin() const noexcept { return m_MeshBatches.begin(); }
-        [[nodiscard]] std::unordered_map<std::string_view, MeshBatch>::const_iterator end() const noexcept { return m_MeshBatches.end(); }
+        // Rebuilds the flat lists after batches were created or erased
+        void UpdateDrawBatches();
 
-    private:
-        void UpdateInstanceBuffer(InstanceBatch& instanceBatch);
+        InstanceBatch& GetOrCreateInstanceBatch(const Ref<Mesh>& mesh, uint32_t submeshIndex, const Ref<Material>& material);
+        // Adds the instance to the batch, the instance gets its UUID with its first submesh.
+        // Returns 0 if the instance is already assigned to another mesh or material
+        MeshUUID RegisterSubmesh(InstanceBatch& instanceBatch, const Ref<Mesh>& mesh, uint32_t submeshIndex, const Ref<Material>& material, const Ref<Instance>& instance);
+
+        void UpdateInstanceBuffer(InstanceBatch& instanceBatch, const Math::AABB& submeshBoundingBox);
+        void UploadVisibleInstances(const DrawBatch& drawBatch, ViewID view);
+        void ReleaseUnusedViews(InstanceBatch& instanceBatch);
+
+        template <typename Volume>
+        CullingStatistics CullInstancesInVolume(std::string_view shaderName, ViewID view, const Volume& volume, const OcclusionBuffer* occlusionBuffer, const Math::Vec3* viewPosition);
         void ClearEmptyBatches();
 
+        void AddCachedTransform(MeshUUID meshUUID, const InstanceRow& instanceRow, const Math::AABB& meshBoundingBox);
+        void RemoveCachedTransform(MeshUUID meshUUID);
+        TransformCache::Entries::ID GetCachedTransformID(MeshUUID meshUUID) const;
+        InstanceBVH::TransformSource GetTransformSource() const noexcept;
+
     private:
         std::unordered_map<std::string_view, MeshBatch> m_MeshBatches;
 
         std::unordered_map<MeshUUID, Ref<Mesh>> m_UUID_ToMesh;
         std::unordered_map<MeshUUID, std::vector<Ref<Material>>> m_UUID_ToMaterials;
-        std::unordered_map<MeshUUID, Ref<Instance>> m_UUID_ToIntsance;
+        std::unordered_map<MeshUUID, InstanceRow> m_UUID_ToIntsance;
 
         MeshBatch m_EmptyMeshBatch;
+
+        std::unordered_map<std::string_view, std::vector<DrawBatch>> m_DrawBatches;
+        std::vector<DrawBatch> m_EmptyDrawBatches;
+        bool m_DrawBatchesDirty{ true };
+
+        DrawList m_DrawList;
+        std::vector<uint64_t> m_SortKeysScratch;
+        std::vector<const DrawBatch*> m_DrawsScratch;
+
+        TransformCache m_TransformCache;
+
+        UploadStatistics m_UploadStatistics;
+        std::vector<uint8_t> m_UploadStagingData;
+        std::vector<uint32_t> m_UploadStoreRows;
+        // Advanced by UpdateInstanceBuffers
+        uint64_t m_FrameIndex{ 0u };
+
+        InstanceBVH m_InstanceBVH;
+        bool m_InstanceBVHDirty{ true };
     };
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "dlpch.h"
+#include "Mesh.h"
+
+// Kept apart from the importer and the GPU buffers of Mesh.cpp, the math and geometry library builds it without them
+namespace DLEngine
+{
+    Submesh::Submesh(std::string name, std::vector<Vertex> vertices, std::vector<Triangle> triangles)
+        : m_Name(std::move(name))
+        , m_Vertices(std::move(vertices))
+        , m_Triangles(std::move(triangles))
+        , m_Instances({ Math::Mat4x4::Identity() })
+        , m_InvInstances({ Math::Mat4x4::Identity() })
+        , m_BoundingBox(BVHBuilder::EmptyAABB())
+    {
+        for (const Vertex& vertex : m_Vertices)
+            BVHBuilder::Grow(m_BoundingBox, vertex.Position);
+
+        UpdateBVH();
+    }
+}
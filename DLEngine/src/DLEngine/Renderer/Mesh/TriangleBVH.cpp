@@ -0,0 +1,554 @@
+#include "dlpch.h"
+#include "TriangleBVH.h"
+
+#include "DLEngine/Math/Intersections.h"
+
+#include "DLEngine/Renderer/Mesh/Mesh.h"
+
+#include <bit>
+
+namespace DLEngine
+{
+    namespace
+    {
+        struct RayPacket
+        {
+            DirectX::XMVECTOR OriginX, OriginY, OriginZ;
+            DirectX::XMVECTOR DirectionX, DirectionY, DirectionZ;
+            DirectX::XMVECTOR InvDirectionX, InvDirectionY, InvDirectionZ;
+
+            explicit RayPacket(std::span<const Math::Ray, TriangleBVH::PacketSize> rays) noexcept
+            {
+                using namespace DirectX;
+
+                OriginX = XMVectorSet(rays[0].Origin.x, rays[1].Origin.x, rays[2].Origin.x, rays[3].Origin.x);
+                OriginY = XMVectorSet(rays[0].Origin.y, rays[1].Origin.y, rays[2].Origin.y, rays[3].Origin.y);
+                OriginZ = XMVectorSet(rays[0].Origin.z, rays[1].Origin.z, rays[2].Origin.z, rays[3].Origin.z);
+
+                DirectionX = XMVectorSet(rays[0].Direction.x, rays[1].Direction.x, rays[2].Direction.x, rays[3].Direction.x);
+                DirectionY = XMVectorSet(rays[0].Direction.y, rays[1].Direction.y, rays[2].Direction.y, rays[3].Direction.y);
+                DirectionZ = XMVectorSet(rays[0].Direction.z, rays[1].Direction.z, rays[2].Direction.z, rays[3].Direction.z);
+
+                InvDirectionX = XMVectorReciprocal(DirectionX);
+                InvDirectionY = XMVectorReciprocal(DirectionY);
+                InvDirectionZ = XMVectorReciprocal(DirectionZ);
+            }
+        };
+
+        uint32_t LaneMask(DirectX::FXMVECTOR lanes) noexcept
+        {
+#if defined(_XM_SSE_INTRINSICS_)
+            return static_cast<uint32_t>(_mm_movemask_ps(lanes));
+#else
+            DirectX::XMUINT4 bits;
+            DirectX::XMStoreUInt4(&bits, lanes);
+            return (bits.x >> 31u) | ((bits.y >> 31u) << 1u) | ((bits.z >> 31u) << 2u) | ((bits.w >> 31u) << 3u);
+#endif
+        }
+
+        DirectX::XMVECTOR LanesFromMask(uint32_t mask) noexcept
+        {
+            return DirectX::XMVectorSetInt(
+                (mask & 1u) ? 0xFFFFFFFFu : 0u,
+                (mask & 2u) ? 0xFFFFFFFFu : 0u,
+                (mask & 4u) ? 0xFFFFFFFFu : 0u,
+                (mask & 8u) ? 0xFFFFFFFFu : 0u
+            );
+        }
+
+        float MinActiveLane(DirectX::FXMVECTOR values, uint32_t mask) noexcept
+        {
+            alignas(16) float lanes[TriangleBVH::PacketSize];
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(lanes), values);
+
+            float minValue{ Math::Numeric::Inf };
+            for (uint32_t lane{ 0u }; lane < TriangleBVH::PacketSize; ++lane)
+                if (mask & (1u << lane))
+                    minValue = std::min(minValue, lanes[lane]);
+
+            return minValue;
+        }
+
+        bool ShareDirectionOctant(std::span<const Math::Ray, TriangleBVH::PacketSize> rays) noexcept
+        {
+            const auto Octant = [](const Math::Vec3& direction)
+                {
+                    return (std::signbit(direction.x) ? 1u : 0u) | (std::signbit(direction.y) ? 2u : 0u) | (std::signbit(direction.z) ? 4u : 0u);
+                };
+
+            const uint32_t octant{ Octant(rays[0].Direction) };
+            return std::all_of(rays.begin() + 1, rays.end(), [&Octant, octant](const Math::Ray& ray) { return Octant(ray.Direction) == octant; });
+        }
+
+        DirectX::XMVECTOR IntersectsNode(const Math::AABB& nodeBoundingBox, const RayPacket& packet, DirectX::FXMVECTOR tMax, DirectX::XMVECTOR& outTNear) noexcept
+        {
+            using namespace DirectX;
+
+            const XMVECTOR tx1{ XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(nodeBoundingBox.Min.x), packet.OriginX), packet.InvDirectionX) };
+            const XMVECTOR tx2{ XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(nodeBoundingBox.Max.x), packet.OriginX), packet.InvDirectionX) };
+            XMVECTOR tNear{ XMVectorMin(tx1, tx2) };
+            XMVECTOR tFar{ XMVectorMax(tx1, tx2) };
+
+            const XMVECTOR ty1{ XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(nodeBoundingBox.Min.y), packet.OriginY), packet.InvDirectionY) };
+            const XMVECTOR ty2{ XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(nodeBoundingBox.Max.y), packet.OriginY), packet.InvDirectionY) };
+            tNear = XMVectorMax(tNear, XMVectorMin(ty1, ty2));
+            tFar = XMVectorMin(tFar, XMVectorMax(ty1, ty2));
+
+            const XMVECTOR tz1{ XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(nodeBoundingBox.Min.z), packet.OriginZ), packet.InvDirectionZ) };
+            const XMVECTOR tz2{ XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(nodeBoundingBox.Max.z), packet.OriginZ), packet.InvDirectionZ) };
+            tNear = XMVectorMax(tNear, XMVectorMin(tz1, tz2));
+            tFar = XMVectorMin(tFar, XMVectorMax(tz1, tz2));
+
+            outTNear = tNear;
+            return XMVectorAndInt(
+                XMVectorAndInt(XMVectorLessOrEqual(tNear, tFar), XMVectorGreaterOrEqual(tFar, XMVectorZero())),
+                XMVectorLessOrEqual(tNear, tMax)
+            );
+        }
+
+        // Moller-Trumbore for one triangle against every ray of the packet
+        DirectX::XMVECTOR IntersectsTriangle(const Math::Triangle& triangle, const RayPacket& packet, DirectX::FXMVECTOR tMax, DirectX::XMVECTOR& outT) noexcept
+        {
+            using namespace DirectX;
+
+            const Math::Vec3 e1{ triangle.V1 - triangle.V0 };
+            const Math::Vec3 e2{ triangle.V2 - triangle.V0 };
+
+            // Same parallel test as Math::Intersects, on the cosine between the rays and the triangle plane
+            const Math::Vec3 n{ Math::Cross(e1, e2) };
+            const XMVECTOR minDenominator{ XMVectorReplicate(1e-5f * Math::Length(n)) };
+
+            const XMVECTOR e1x{ XMVectorReplicate(e1.x) }, e1y{ XMVectorReplicate(e1.y) }, e1z{ XMVectorReplicate(e1.z) };
+            const XMVECTOR e2x{ XMVectorReplicate(e2.x) }, e2y{ XMVectorReplicate(e2.y) }, e2z{ XMVectorReplicate(e2.z) };
+
+            const XMVECTOR sx{ XMVectorSubtract(packet.OriginX, XMVectorReplicate(triangle.V0.x)) };
+            const XMVECTOR sy{ XMVectorSubtract(packet.OriginY, XMVectorReplicate(triangle.V0.y)) };
+            const XMVECTOR sz{ XMVectorSubtract(packet.OriginZ, XMVectorReplicate(triangle.V0.z)) };
+
+            // p = cross(direction, e2)
+            const XMVECTOR px{ XMVectorSubtract(XMVectorMultiply(packet.DirectionY, e2z), XMVectorMultiply(packet.DirectionZ, e2y)) };
+            const XMVECTOR py{ XMVectorSubtract(XMVectorMultiply(packet.DirectionZ, e2x), XMVectorMultiply(packet.DirectionX, e2z)) };
+            const XMVECTOR pz{ XMVectorSubtract(XMVectorMultiply(packet.DirectionX, e2y), XMVectorMultiply(packet.DirectionY, e2x)) };
+
+            // q = cross(s, e1)
+            const XMVECTOR qx{ XMVectorSubtract(XMVectorMultiply(sy, e1z), XMVectorMultiply(sz, e1y)) };
+            const XMVECTOR qy{ XMVectorSubtract(XMVectorMultiply(sz, e1x), XMVectorMultiply(sx, e1z)) };
+            const XMVECTOR qz{ XMVectorSubtract(XMVectorMultiply(sx, e1y), XMVectorMultiply(sy, e1x)) };
+
+            const XMVECTOR denominator{ XMVectorMultiplyAdd(px, e1x, XMVectorMultiplyAdd(py, e1y, XMVectorMultiply(pz, e1z))) };
+            const XMVECTOR invDenominator{ XMVectorReciprocal(denominator) };
+
+            const XMVECTOR t{ XMVectorMultiply(XMVectorMultiplyAdd(qx, e2x, XMVectorMultiplyAdd(qy, e2y, XMVectorMultiply(qz, e2z))), invDenominator) };
+            const XMVECTOR u{ XMVectorMultiply(XMVectorMultiplyAdd(px, sx, XMVectorMultiplyAdd(py, sy, XMVectorMultiply(pz, sz))), invDenominator) };
+            const XMVECTOR v{ XMVectorMultiply(XMVectorMultiplyAdd(qx, packet.DirectionX, XMVectorMultiplyAdd(qy, packet.DirectionY, XMVectorMultiply(qz, packet.DirectionZ))), invDenominator) };
+
+            const XMVECTOR zero{ XMVectorZero() };
+
+            XMVECTOR hit{ XMVectorGreaterOrEqual(XMVectorAbs(denominator), minDenominator) };
+            hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(t, zero));
+            hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(u, zero));
+            hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(v, zero));
+            hit = XMVectorAndInt(hit, XMVectorLessOrEqual(XMVectorAdd(u, v), XMVectorSplatOne()));
+            hit = XMVectorAndInt(hit, XMVectorLessOrEqual(t, tMax));
+
+            outT = t;
+            return hit;
+        }
+    }
+
+    void TriangleBVH::Rebuild(const Submesh& targetSubmesh) noexcept
+    {
+        const auto& triangles{ targetSubmesh.GetTriangles() };
+        const auto& vertices{ targetSubmesh.GetVertices() };
+
+        std::vector<BVHBuilder::Primitive> primitives(triangles.size());
+        for (size_t i{ 0u }; i < triangles.size(); ++i)
+        {
+            const auto& triangle{ triangles[i] };
+
+            BVHBuilder::Primitive& primitive{ primitives[i] };
+            primitive.BoundingBox = BVHBuilder::EmptyAABB();
+            BVHBuilder::Grow(primitive.BoundingBox, vertices[triangle.Indices[0]].Position);
+            BVHBuilder::Grow(primitive.BoundingBox, vertices[triangle.Indices[1]].Position);
+            BVHBuilder::Grow(primitive.BoundingBox, vertices[triangle.Indices[2]].Position);
+            primitive.Centroid = (primitive.BoundingBox.Min + primitive.BoundingBox.Max) * 0.5f;
+        }
+
+        std::vector<BVHNode> nodes{};
+        BVHBuilder::Build(primitives, MaxTrianglesPerLeaf, nodes, m_TriangleIndices);
+        BVHBuilder::Compact(nodes, m_Nodes);
+
+        m_BoundingBox = nodes.empty() ? BVHBuilder::EmptyAABB() : nodes[0u].BoundingBox;
+    }
+
+    bool TriangleBVH::Intersects(const Submesh& targetSubmesh, const Math::Ray& ray, Math::IntersectInfo& outIntersectInfo, uint32_t& outTriangleIndex) const noexcept
+    {
+        if (m_Nodes.empty())
+            return false;
+
+        return IntersectsSubtree(0u, m_BoundingBox, targetSubmesh, ray, outIntersectInfo, outTriangleIndex);
+    }
+
+    uint32_t TriangleBVH::Intersects(
+        const Submesh& targetSubmesh,
+        std::span<const Math::Ray, PacketSize> rays,
+        std::span<Math::IntersectInfo, PacketSize> outIntersectInfos,
+        std::span<uint32_t, PacketSize> outTriangleIndices
+    ) const noexcept
+    {
+        using namespace DirectX;
+
+        if (m_Nodes.empty())
+            return 0u;
+
+        // Rays from different octants visit the children in different orders
+        if (!ShareDirectionOctant(rays))
+        {
+            uint32_t hitMask{ 0u };
+            for (uint32_t lane{ 0u }; lane < PacketSize; ++lane)
+                if (IntersectsSubtree(0u, m_BoundingBox, targetSubmesh, rays[lane], outIntersectInfos[lane], outTriangleIndices[lane]))
+                    hitMask |= 1u << lane;
+
+            return hitMask;
+        }
+
+        const auto& triangles{ targetSubmesh.GetTriangles() };
+        const auto& vertices{ targetSubmesh.GetVertices() };
+
+        const RayPacket packet{ rays };
+
+        alignas(16) float closestT[PacketSize];
+        alignas(16) uint32_t closestTriangle[PacketSize];
+        for (uint32_t lane{ 0u }; lane < PacketSize; ++lane)
+        {
+            closestT[lane] = outIntersectInfos[lane].T;
+            closestTriangle[lane] = 0u;
+        }
+
+        XMVECTOR tMax{ XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(closestT)) };
+        XMVECTOR triangleIndices{ XMVectorZero() };
+        uint32_t hitMask{ 0u };
+
+        struct StackEntry
+        {
+            XMVECTOR TNear;
+            Math::AABB BoundingBox;
+            uint32_t NodeIndex;
+            uint32_t ActiveMask;
+        };
+
+        std::array<StackEntry, BVHBuilder::MaxDepth> stack;
+        uint32_t stackSize{ 0u };
+
+        XMVECTOR rootTNear{};
+        uint32_t activeMask{ LaneMask(IntersectsNode(m_BoundingBox, packet, tMax, rootTNear)) };
+        if (activeMask == 0u)
+            return 0u;
+
+        uint32_t nodeIndex{ 0u };
+        Math::AABB nodeBoundingBox{ m_BoundingBox };
+
+        while (true)
+        {
+            const CompactBVHNode& node{ m_Nodes[nodeIndex] };
+
+            if (std::has_single_bit(activeMask))
+            {
+                // The packet has diverged, the last active ray finishes the subtree alone
+                const uint32_t lane{ static_cast<uint32_t>(std::countr_zero(activeMask)) };
+
+                XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(closestT), tMax);
+                XMStoreUInt4(reinterpret_cast<XMUINT4*>(closestTriangle), triangleIndices);
+
+                Math::IntersectInfo laneIntersectInfo{};
+                laneIntersectInfo.T = closestT[lane];
+                if (IntersectsSubtree(nodeIndex, nodeBoundingBox, targetSubmesh, rays[lane], laneIntersectInfo, closestTriangle[lane]))
+                {
+                    closestT[lane] = laneIntersectInfo.T;
+                    hitMask |= 1u << lane;
+
+                    tMax = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(closestT));
+                    triangleIndices = XMLoadUInt4(reinterpret_cast<const XMUINT4*>(closestTriangle));
+                }
+            }
+            else if (node.IsLeaf())
+            {
+                const XMVECTOR activeLanes{ LanesFromMask(activeMask) };
+                for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                {
+                    const auto& triangle{ triangles[m_TriangleIndices[i]] };
+                    const Math::Triangle triangleToCheck{
+                        .V0 = vertices[triangle.Indices[0]].Position,
+                        .V1 = vertices[triangle.Indices[1]].Position,
+                        .V2 = vertices[triangle.Indices[2]].Position
+                    };
+
+                    XMVECTOR t{};
+                    const XMVECTOR hitLanes{ XMVectorAndInt(IntersectsTriangle(triangleToCheck, packet, tMax, t), activeLanes) };
+
+                    tMax = XMVectorSelect(tMax, t, hitLanes);
+                    triangleIndices = XMVectorSelect(triangleIndices, XMVectorReplicateInt(m_TriangleIndices[i]), hitLanes);
+                    hitMask |= LaneMask(hitLanes);
+                }
+            }
+            else
+            {
+                uint32_t nearChild{ nodeIndex + 1u };
+                uint32_t farChild{ node.Offset };
+
+                Math::AABB nearBoundingBox{ m_Nodes[nearChild].Dequantize(nodeBoundingBox) };
+                Math::AABB farBoundingBox{ m_Nodes[farChild].Dequantize(nodeBoundingBox) };
+
+                XMVECTOR tNear{}, tFar{};
+                uint32_t nearMask{ activeMask & LaneMask(IntersectsNode(nearBoundingBox, packet, tMax, tNear)) };
+                uint32_t farMask{ activeMask & LaneMask(IntersectsNode(farBoundingBox, packet, tMax, tFar)) };
+
+                if (nearMask != 0u && farMask != 0u)
+                {
+                    if (MinActiveLane(tFar, farMask) < MinActiveLane(tNear, nearMask))
+                    {
+                        std::swap(nearChild, farChild);
+                        std::swap(nearMask, farMask);
+                        std::swap(tNear, tFar);
+                        std::swap(nearBoundingBox, farBoundingBox);
+                    }
+
+                    stack[stackSize++] = StackEntry{
+                        .TNear = tFar,
+                        .BoundingBox = farBoundingBox,
+                        .NodeIndex = farChild,
+                        .ActiveMask = farMask
+                    };
+
+                    nodeIndex = nearChild;
+                    nodeBoundingBox = nearBoundingBox;
+                    activeMask = nearMask;
+                    continue;
+                }
+
+                if (nearMask != 0u || farMask != 0u)
+                {
+                    nodeIndex = nearMask != 0u ? nearChild : farChild;
+                    nodeBoundingBox = nearMask != 0u ? nearBoundingBox : farBoundingBox;
+                    activeMask = nearMask != 0u ? nearMask : farMask;
+                    continue;
+                }
+            }
+
+            activeMask = 0u;
+            while (stackSize > 0u && activeMask == 0u)
+            {
+                const StackEntry& entry{ stack[--stackSize] };
+                // Lanes that missed the deferred child stay off, their tNear means nothing and a lane without a hit still has an infinite tMax
+                activeMask = entry.ActiveMask & LaneMask(XMVectorLessOrEqual(entry.TNear, tMax));
+                nodeIndex = entry.NodeIndex;
+                nodeBoundingBox = entry.BoundingBox;
+            }
+
+            if (activeMask == 0u)
+                break;
+        }
+
+        XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(closestT), tMax);
+        XMStoreUInt4(reinterpret_cast<XMUINT4*>(closestTriangle), triangleIndices);
+
+        for (uint32_t lane{ 0u }; lane < PacketSize; ++lane)
+        {
+            if ((hitMask & (1u << lane)) == 0u)
+                continue;
+
+            const auto& triangle{ triangles[closestTriangle[lane]] };
+            const Math::Vec3& v0{ vertices[triangle.Indices[0]].Position };
+            const Math::Vec3& v1{ vertices[triangle.Indices[1]].Position };
+            const Math::Vec3& v2{ vertices[triangle.Indices[2]].Position };
+
+            Math::IntersectInfo& intersectInfo{ outIntersectInfos[lane] };
+            intersectInfo.T = closestT[lane];
+            intersectInfo.IntersectionPoint = rays[lane].Origin + rays[lane].Direction * closestT[lane];
+            intersectInfo.Normal = Math::Normalize(Math::Cross(v1 - v0, v2 - v0));
+
+            outTriangleIndices[lane] = closestTriangle[lane];
+        }
+
+        return hitMask;
+    }
+
+    bool TriangleBVH::Occluded(const Submesh& targetSubmesh, const Math::Ray& ray, float maxDistance) const noexcept
+    {
+        if (m_Nodes.empty())
+            return false;
+
+        const auto& triangles{ targetSubmesh.GetTriangles() };
+        const auto& vertices{ targetSubmesh.GetVertices() };
+
+        const Math::Vec3 invDirection{ 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z };
+
+        struct StackEntry
+        {
+            Math::AABB BoundingBox;
+            uint32_t NodeIndex;
+        };
+
+        // Any hit ends the query, so the children are visited without sorting them by distance
+        std::array<StackEntry, BVHBuilder::MaxDepth> stack;
+        uint32_t stackSize{ 0u };
+
+        float tNear{ 0.0f };
+        if (!IntersectsSlabs(m_BoundingBox, ray.Origin, invDirection, maxDistance, tNear))
+            return false;
+
+        uint32_t nodeIndex{ 0u };
+        Math::AABB nodeBoundingBox{ m_BoundingBox };
+
+        while (true)
+        {
+            const CompactBVHNode& node{ m_Nodes[nodeIndex] };
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                {
+                    const auto& triangle{ triangles[m_TriangleIndices[i]] };
+                    const Math::Triangle triangleToCheck{
+                        .V0 = vertices[triangle.Indices[0]].Position,
+                        .V1 = vertices[triangle.Indices[1]].Position,
+                        .V2 = vertices[triangle.Indices[2]].Position
+                    };
+
+                    Math::IntersectInfo intersectInfo{};
+                    intersectInfo.T = maxDistance;
+                    if (Math::Intersects(ray, triangleToCheck, intersectInfo))
+                        return true;
+                }
+            }
+            else
+            {
+                const uint32_t firstChild{ nodeIndex + 1u };
+                const uint32_t secondChild{ node.Offset };
+
+                const Math::AABB firstBoundingBox{ m_Nodes[firstChild].Dequantize(nodeBoundingBox) };
+                const Math::AABB secondBoundingBox{ m_Nodes[secondChild].Dequantize(nodeBoundingBox) };
+
+                const bool hitsFirst{ IntersectsSlabs(firstBoundingBox, ray.Origin, invDirection, maxDistance, tNear) };
+                const bool hitsSecond{ IntersectsSlabs(secondBoundingBox, ray.Origin, invDirection, maxDistance, tNear) };
+
+                if (hitsFirst && hitsSecond)
+                    stack[stackSize++] = StackEntry{ .BoundingBox = secondBoundingBox, .NodeIndex = secondChild };
+
+                if (hitsFirst || hitsSecond)
+                {
+                    nodeIndex = hitsFirst ? firstChild : secondChild;
+                    nodeBoundingBox = hitsFirst ? firstBoundingBox : secondBoundingBox;
+                    continue;
+                }
+            }
+
+            if (stackSize == 0u)
+                break;
+
+            --stackSize;
+            nodeIndex = stack[stackSize].NodeIndex;
+            nodeBoundingBox = stack[stackSize].BoundingBox;
+        }
+
+        return false;
+    }
+
+    bool TriangleBVH::IntersectsSubtree(uint32_t rootNodeIndex, const Math::AABB& rootBoundingBox, const Submesh& targetSubmesh, const Math::Ray& ray, Math::IntersectInfo& outIntersectInfo, uint32_t& outTriangleIndex) const noexcept
+    {
+        const auto& triangles{ targetSubmesh.GetTriangles() };
+        const auto& vertices{ targetSubmesh.GetVertices() };
+
+        const Math::Vec3 invDirection{ 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z };
+
+        struct StackEntry
+        {
+            Math::AABB BoundingBox;
+            uint32_t NodeIndex;
+            float TNear;
+        };
+
+        std::array<StackEntry, BVHBuilder::MaxDepth> stack;
+        uint32_t stackSize{ 0u };
+
+        float rootTNear{ 0.0f };
+        if (!IntersectsSlabs(rootBoundingBox, ray.Origin, invDirection, outIntersectInfo.T, rootTNear))
+            return false;
+
+        bool intersects{ false };
+        uint32_t nodeIndex{ rootNodeIndex };
+        Math::AABB nodeBoundingBox{ rootBoundingBox };
+
+        while (true)
+        {
+            const CompactBVHNode& node{ m_Nodes[nodeIndex] };
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i{ node.Offset }; i < node.Offset + node.PrimitiveCount; ++i)
+                {
+                    const auto& triangle{ triangles[m_TriangleIndices[i]] };
+                    const Math::Triangle triangleToCheck{
+                        .V0 = vertices[triangle.Indices[0]].Position,
+                        .V1 = vertices[triangle.Indices[1]].Position,
+                        .V2 = vertices[triangle.Indices[2]].Position
+                    };
+
+                    if (Math::Intersects(ray, triangleToCheck, outIntersectInfo))
+                    {
+                        outTriangleIndex = m_TriangleIndices[i];
+                        intersects = true;
+                    }
+                }
+            }
+            else
+            {
+                uint32_t nearChild{ nodeIndex + 1u };
+                uint32_t farChild{ node.Offset };
+
+                Math::AABB nearBoundingBox{ m_Nodes[nearChild].Dequantize(nodeBoundingBox) };
+                Math::AABB farBoundingBox{ m_Nodes[farChild].Dequantize(nodeBoundingBox) };
+
+                float tNear{ 0.0f }, tFar{ 0.0f };
+                const bool hitsNear{ IntersectsSlabs(nearBoundingBox, ray.Origin, invDirection, outIntersectInfo.T, tNear) };
+                const bool hitsFar{ IntersectsSlabs(farBoundingBox, ray.Origin, invDirection, outIntersectInfo.T, tFar) };
+
+                if (hitsNear && hitsFar)
+                {
+                    if (tFar < tNear)
+                    {
+                        std::swap(nearChild, farChild);
+                        std::swap(tNear, tFar);
+                        std::swap(nearBoundingBox, farBoundingBox);
+                    }
+
+                    stack[stackSize++] = StackEntry{ .BoundingBox = farBoundingBox, .NodeIndex = farChild, .TNear = tFar };
+                    nodeIndex = nearChild;
+                    nodeBoundingBox = nearBoundingBox;
+                    continue;
+                }
+
+                if (hitsNear || hitsFar)
+                {
+                    nodeIndex = hitsNear ? nearChild : farChild;
+                    nodeBoundingBox = hitsNear ? nearBoundingBox : farBoundingBox;
+                    continue;
+                }
+            }
+
+            // Skip the deferred nodes that start beyond the closest hit found so far
+            while (stackSize > 0u && stack[stackSize - 1u].TNear > outIntersectInfo.T)
+                --stackSize;
+
+            if (stackSize == 0u)
+                break;
+
+            --stackSize;
+            nodeIndex = stack[stackSize].NodeIndex;
+            nodeBoundingBox = stack[stackSize].BoundingBox;
+        }
+
+        return intersects;
+    }
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "DLEngine/Renderer/Mesh/BVHBuilder.h"
+
+namespace DLEngine
+{
+    class Submesh;
+
+    class TriangleBVH
+    {
+    public:
+        static constexpr uint32_t PacketSize{ 4u };
+        static constexpr uint32_t MaxTrianglesPerLeaf{ 8u };
+
+    public:
+        void Rebuild(const Submesh& targetSubmesh) noexcept;
+
+        const std::vector<CompactBVHNode>& GetNodes() const noexcept { return m_Nodes; }
+        const std::vector<uint32_t>& GetTriangleIndices() const noexcept { return m_TriangleIndices; }
+
+        size_t GetMemoryUsage() const noexcept { return m_Nodes.size() * sizeof(CompactBVHNode) + m_TriangleIndices.size() * sizeof(uint32_t); }
+
+        // outIntersectInfo.T is used as the maximum distance of the ray
+        bool Intersects(const Submesh& targetSubmesh, const Math::Ray& ray, Math::IntersectInfo& outIntersectInfo, uint32_t& outTriangleIndex) const noexcept;
+
+        // Traces the rays together with SIMD while they agree on the visited nodes,
+        // rays that diverge from the packet finish their subtree on their own.
+        // Returns the mask of the rays that hit the submesh
+        uint32_t Intersects(
+            const Submesh& targetSubmesh,
+            std::span<const Math::Ray, PacketSize> rays,
+            std::span<Math::IntersectInfo, PacketSize> outIntersectInfos,
+            std::span<uint32_t, PacketSize> outTriangleIndices
+        ) const noexcept;
+
+        // Any-hit query, stops at the first triangle closer than maxDistance
+        bool Occluded(const Submesh& targetSubmesh, const Math::Ray& ray, float maxDistance) const noexcept;
+
+    private:
+        bool IntersectsSubtree(uint32_t rootNodeIndex, const Math::AABB& rootBoundingBox, const Submesh& targetSubmesh, const Math::Ray& ray, Math::IntersectInfo& outIntersectInfo, uint32_t& outTriangleIndex) const noexcept;
+
+    private:
+        std::vector<CompactBVHNode> m_Nodes;
+        std::vector<uint32_t> m_TriangleIndices;
+
+        // Bounds of the root node, every other node is decoded relative to its parent
+        Math::AABB m_BoundingBox;
+    };
+}
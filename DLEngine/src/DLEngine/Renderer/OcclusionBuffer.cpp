@@ -0,0 +1,333 @@
+#include "dlpch.h"
+#include "OcclusionBuffer.h"
+
+#include "DLEngine/Renderer/Mesh/Mesh.h"
+
+#include <numeric>
+
+namespace DLEngine
+{
+    namespace
+    {
+        // Rows rasterized by one task, every band owns its rows so no synchronization is needed
+        constexpr uint32_t BAND_HEIGHT{ 8u };
+        constexpr uint32_t BAND_COUNT{ OcclusionBuffer::Height / BAND_HEIGHT };
+
+        // Vertices closer than this are clipped, occluders that cross the near plane are skipped instead
+        constexpr float NEAR_W{ 1.0e-3f };
+
+        // Relative margin, so occluders never hide the surfaces they were rasterized from
+        constexpr float DEPTH_BIAS{ 1.0e-3f };
+
+        static_assert(OcclusionBuffer::Width % 4u == 0u, "Rows are rasterized four pixels at a time");
+        static_assert(OcclusionBuffer::Height % BAND_HEIGHT == 0u, "Bands have to cover the whole buffer");
+
+        // Edge functions and 1/w are linear in screen space: value = A * x + B * y + C
+        struct ScreenTriangle
+        {
+            std::array<float, 3u> EdgeA, EdgeB, EdgeC;
+            float DepthA, DepthB, DepthC;
+
+            float MinX, MinY, MaxX, MaxY;
+        };
+
+        struct ClipVertex
+        {
+            float X{ 0.0f };
+            float Y{ 0.0f };
+            float InvW{ 0.0f };
+            bool Clipped{ false };
+        };
+
+        ClipVertex ToScreen(const Math::Vec4& clip) noexcept
+        {
+            if (clip.w <= NEAR_W)
+                return ClipVertex{ .Clipped = true };
+
+            const float invW{ 1.0f / clip.w };
+            return ClipVertex{
+                .X = (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(OcclusionBuffer::Width),
+                .Y = (0.5f - clip.y * invW * 0.5f) * static_cast<float>(OcclusionBuffer::Height),
+                .InvW = invW,
+                .Clipped = false
+            };
+        }
+
+        bool SetupTriangle(ClipVertex v0, ClipVertex v1, ClipVertex v2, ScreenTriangle& outTriangle) noexcept
+        {
+            if (v0.Clipped || v1.Clipped || v2.Clipped)
+                return false;
+
+            float area{ (v1.X - v0.X) * (v2.Y - v0.Y) - (v2.X - v0.X) * (v1.Y - v0.Y) };
+            if (std::abs(area) < 1.0e-6f)
+                return false;
+
+            // Both windings are rasterized, occluders are not required to be closed or consistently wound
+            if (area < 0.0f)
+            {
+                std::swap(v1, v2);
+                area = -area;
+            }
+
+            outTriangle.MinX = std::min({ v0.X, v1.X, v2.X });
+            outTriangle.MinY = std::min({ v0.Y, v1.Y, v2.Y });
+            outTriangle.MaxX = std::max({ v0.X, v1.X, v2.X });
+            outTriangle.MaxY = std::max({ v0.Y, v1.Y, v2.Y });
+
+            if (outTriangle.MaxX < 0.0f || outTriangle.MaxY < 0.0f ||
+                outTriangle.MinX >= static_cast<float>(OcclusionBuffer::Width) || outTriangle.MinY >= static_cast<float>(OcclusionBuffer::Height))
+                return false;
+
+            const std::array<const ClipVertex*, 3u> vertices{ &v0, &v1, &v2 };
+            const float invArea{ 1.0f / area };
+
+            outTriangle.DepthA = outTriangle.DepthB = outTriangle.DepthC = 0.0f;
+            for (uint32_t edge{ 0u }; edge < 3u; ++edge)
+            {
+                // The edge opposite to the vertex, its function is the unnormalized barycentric of that vertex
+                const ClipVertex& a{ *vertices[(edge + 1u) % 3u] };
+                const ClipVertex& b{ *vertices[(edge + 2u) % 3u] };
+
+                outTriangle.EdgeA[edge] = a.Y - b.Y;
+                outTriangle.EdgeB[edge] = b.X - a.X;
+                outTriangle.EdgeC[edge] = a.X * b.Y - a.Y * b.X;
+
+                const float depthWeight{ vertices[edge]->InvW * invArea };
+                outTriangle.DepthA += outTriangle.EdgeA[edge] * depthWeight;
+                outTriangle.DepthB += outTriangle.EdgeB[edge] * depthWeight;
+                outTriangle.DepthC += outTriangle.EdgeC[edge] * depthWeight;
+            }
+
+            return true;
+        }
+
+        void RasterizeTriangle(const ScreenTriangle& triangle, uint32_t firstRow, uint32_t lastRow, float* depth) noexcept
+        {
+            using namespace DirectX;
+
+            const uint32_t minY{ std::max(firstRow, static_cast<uint32_t>(std::max(triangle.MinY, 0.0f))) };
+            const uint32_t maxY{ std::min(lastRow, static_cast<uint32_t>(std::min(triangle.MaxY, static_cast<float>(OcclusionBuffer::Height - 1u)))) };
+            const uint32_t minX{ static_cast<uint32_t>(std::max(triangle.MinX, 0.0f)) & ~3u };
+            const uint32_t maxX{ static_cast<uint32_t>(std::min(triangle.MaxX, static_cast<float>(OcclusionBuffer::Width - 1u))) };
+
+            const XMVECTOR laneOffsets{ XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f) };
+            const XMVECTOR blockStartX{ XMVectorAdd(XMVectorReplicate(static_cast<float>(minX)), laneOffsets) };
+
+            const XMVECTOR edgeA0{ XMVectorReplicate(triangle.EdgeA[0u]) };
+            const XMVECTOR edgeA1{ XMVectorReplicate(triangle.EdgeA[1u]) };
+            const XMVECTOR edgeA2{ XMVectorReplicate(triangle.EdgeA[2u]) };
+            const XMVECTOR depthA{ XMVectorReplicate(triangle.DepthA) };
+
+            const XMVECTOR edgeStep0{ XMVectorReplicate(triangle.EdgeA[0u] * 4.0f) };
+            const XMVECTOR edgeStep1{ XMVectorReplicate(triangle.EdgeA[1u] * 4.0f) };
+            const XMVECTOR edgeStep2{ XMVectorReplicate(triangle.EdgeA[2u] * 4.0f) };
+            const XMVECTOR depthStep{ XMVectorReplicate(triangle.DepthA * 4.0f) };
+
+            for (uint32_t y{ minY }; y <= maxY; ++y)
+            {
+                const float centerY{ static_cast<float>(y) + 0.5f };
+
+                XMVECTOR edge0{ XMVectorMultiplyAdd(edgeA0, blockStartX, XMVectorReplicate(triangle.EdgeB[0u] * centerY + triangle.EdgeC[0u])) };
+                XMVECTOR edge1{ XMVectorMultiplyAdd(edgeA1, blockStartX, XMVectorReplicate(triangle.EdgeB[1u] * centerY + triangle.EdgeC[1u])) };
+                XMVECTOR edge2{ XMVectorMultiplyAdd(edgeA2, blockStartX, XMVectorReplicate(triangle.EdgeB[2u] * centerY + triangle.EdgeC[2u])) };
+                XMVECTOR triangleDepth{ XMVectorMultiplyAdd(depthA, blockStartX, XMVectorReplicate(triangle.DepthB * centerY + triangle.DepthC)) };
+
+                float* row{ depth + static_cast<size_t>(y) * OcclusionBuffer::Width };
+                for (uint32_t x{ minX }; x <= maxX; x += 4u)
+                {
+                    const XMVECTOR inside{ XMVectorAndInt(
+                        XMVectorAndInt(XMVectorGreaterOrEqual(edge0, XMVectorZero()), XMVectorGreaterOrEqual(edge1, XMVectorZero())),
+                        XMVectorGreaterOrEqual(edge2, XMVectorZero())
+                    ) };
+
+                    XMFLOAT4* pixels{ reinterpret_cast<XMFLOAT4*>(row + x) };
+                    const XMVECTOR storedDepth{ XMLoadFloat4(pixels) };
+                    XMStoreFloat4(pixels, XMVectorSelect(storedDepth, XMVectorMax(storedDepth, triangleDepth), inside));
+
+                    edge0 = XMVectorAdd(edge0, edgeStep0);
+                    edge1 = XMVectorAdd(edge1, edgeStep1);
+                    edge2 = XMVectorAdd(edge2, edgeStep2);
+                    triangleDepth = XMVectorAdd(triangleDepth, depthStep);
+                }
+            }
+        }
+    }
+
+    OcclusionBuffer::OcclusionBuffer()
+    {
+        for (uint32_t width{ Width }, height{ Height }; ; width = std::max(width / 2u, 1u), height = std::max(height / 2u, 1u))
+        {
+            m_HierarchicalDepth.emplace_back(static_cast<size_t>(width) * height, 0.0f);
+            if (width == 1u && height == 1u)
+                break;
+        }
+    }
+
+    void OcclusionBuffer::Clear(const Math::Mat4x4& viewProjection) noexcept
+    {
+        m_ViewProjection = viewProjection;
+
+        for (auto& mip : m_HierarchicalDepth)
+            std::fill(mip.begin(), mip.end(), 0.0f);
+    }
+
+    void OcclusionBuffer::RasterizeOccluders(std::span<const Occluder> occluders)
+    {
+        std::vector<std::vector<ScreenTriangle>> occluderTriangles(occluders.size());
+        std::transform(std::execution::par, occluders.begin(), occluders.end(), occluderTriangles.begin(),
+            [this](const Occluder& occluder)
+            {
+                const Submesh& submesh{ *occluder.SourceSubmesh };
+                const Math::Mat4x4 meshToClip{ occluder.MeshToWorld * m_ViewProjection };
+
+                std::vector<ClipVertex> vertices(submesh.GetVertices().size());
+                std::transform(submesh.GetVertices().begin(), submesh.GetVertices().end(), vertices.begin(),
+                    [&meshToClip](const Submesh::Vertex& vertex)
+                    {
+                        return ToScreen(Math::Vec4{ vertex.Position.x, vertex.Position.y, vertex.Position.z, 1.0f } * meshToClip);
+                    }
+                );
+
+                std::vector<ScreenTriangle> triangles{};
+                triangles.reserve(submesh.GetTriangles().size());
+                for (const auto& triangle : submesh.GetTriangles())
+                {
+                    ScreenTriangle screenTriangle;
+                    if (SetupTriangle(vertices[triangle.Indices[0u]], vertices[triangle.Indices[1u]], vertices[triangle.Indices[2u]], screenTriangle))
+                        triangles.push_back(screenTriangle);
+                }
+
+                return triangles;
+            }
+        );
+
+        std::array<uint32_t, BAND_COUNT> bands{};
+        std::iota(bands.begin(), bands.end(), 0u);
+
+        float* depth{ m_HierarchicalDepth.front().data() };
+        std::for_each(std::execution::par, bands.begin(), bands.end(),
+            [&occluderTriangles, depth](uint32_t band)
+            {
+                const uint32_t firstRow{ band * BAND_HEIGHT };
+                const uint32_t lastRow{ firstRow + BAND_HEIGHT - 1u };
+
+                for (const auto& triangles : occluderTriangles)
+                    for (const ScreenTriangle& triangle : triangles)
+                        if (triangle.MaxY >= static_cast<float>(firstRow) && triangle.MinY < static_cast<float>(lastRow + 1u))
+                            RasterizeTriangle(triangle, firstRow, lastRow, depth);
+            }
+        );
+
+        BuildHierarchy();
+    }
+
+    bool OcclusionBuffer::IsOccluded(const Math::AABB& aabb) const noexcept
+    {
+        using namespace DirectX;
+
+        const XMMATRIX viewProjection{ XMLoadFloat4x4(&m_ViewProjection) };
+
+        // The corners share their coordinates, so transform every coordinate once and add them up per corner
+        const std::array<XMVECTOR, 2u> clipX{ XMVectorScale(viewProjection.r[0], aabb.Min.x), XMVectorScale(viewProjection.r[0], aabb.Max.x) };
+        const std::array<XMVECTOR, 2u> clipY{ XMVectorScale(viewProjection.r[1], aabb.Min.y), XMVectorScale(viewProjection.r[1], aabb.Max.y) };
+        const std::array<XMVECTOR, 2u> clipZ{
+            XMVectorMultiplyAdd(viewProjection.r[2], XMVectorReplicate(aabb.Min.z), viewProjection.r[3]),
+            XMVectorMultiplyAdd(viewProjection.r[2], XMVectorReplicate(aabb.Max.z), viewProjection.r[3])
+        };
+
+        XMVECTOR screenMin{ XMVectorReplicate(Math::Numeric::Max) };
+        XMVECTOR screenMax{ XMVectorReplicate(-Math::Numeric::Max) };
+        for (uint32_t corner{ 0u }; corner < 8u; ++corner)
+        {
+            const XMVECTOR clip{ XMVectorAdd(XMVectorAdd(clipX[corner & 1u], clipY[(corner >> 1u) & 1u]), clipZ[(corner >> 2u) & 1u]) };
+            const float w{ XMVectorGetW(clip) };
+            if (w <= NEAR_W)
+                return false;
+
+            // (x / w, y / w, 1 / w)
+            const XMVECTOR invW{ XMVectorReciprocal(XMVectorSplatW(clip)) };
+            const XMVECTOR projected{ XMVectorSelect(XMVectorMultiply(clip, invW), invW, g_XMSelect0010) };
+
+            screenMin = XMVectorMin(screenMin, projected);
+            screenMax = XMVectorMax(screenMax, projected);
+        }
+
+        XMFLOAT3 ndcMin, ndcMax;
+        XMStoreFloat3(&ndcMin, screenMin);
+        XMStoreFloat3(&ndcMax, screenMax);
+
+        if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+            return false;
+
+        // Grow the rectangle by a pixel, depth is only known at the pixel centers
+        const auto toPixel{ [](float value, uint32_t size)
+            {
+                return static_cast<int32_t>(std::floor(std::clamp(value, 0.0f, static_cast<float>(size - 1u))));
+            }
+        };
+        const int32_t minX{ std::max(toPixel((ndcMin.x * 0.5f + 0.5f) * Width, Width) - 1, 0) };
+        const int32_t maxX{ std::min(toPixel((ndcMax.x * 0.5f + 0.5f) * Width, Width) + 1, static_cast<int32_t>(Width - 1u)) };
+        const int32_t minY{ std::max(toPixel((0.5f - ndcMax.y * 0.5f) * Height, Height) - 1, 0) };
+        const int32_t maxY{ std::min(toPixel((0.5f - ndcMin.y * 0.5f) * Height, Height) + 1, static_cast<int32_t>(Height - 1u)) };
+
+        // The closest point of the box has to be behind the furthest occluder of every texel it covers
+        const float closestDepth{ ndcMax.z * (1.0f + DEPTH_BIAS) };
+
+        // Pick the mip where the rectangle covers at most 2x2 texels
+        uint32_t mip{ 0u };
+        while (mip + 1u < m_HierarchicalDepth.size() && ((maxX >> mip) - (minX >> mip) > 1 || (maxY >> mip) - (minY >> mip) > 1))
+            ++mip;
+
+        const uint32_t mipWidth{ std::max(Width >> mip, 1u) };
+        const auto& mipDepth{ m_HierarchicalDepth[mip] };
+        for (int32_t y{ minY >> mip }; y <= (maxY >> mip); ++y)
+            for (int32_t x{ minX >> mip }; x <= (maxX >> mip); ++x)
+                if (mipDepth[static_cast<size_t>(y) * mipWidth + x] <= closestDepth)
+                    return false;
+
+        return true;
+    }
+
+    uint32_t OcclusionBuffer::RemoveOccluded(std::span<const Math::AABB> aabbs, std::span<uint32_t> indices) const noexcept
+    {
+        uint32_t visibleCount{ 0u };
+        for (const uint32_t index : indices)
+            if (!IsOccluded(aabbs[index]))
+                indices[visibleCount++] = index;
+
+        return visibleCount;
+    }
+
+    void OcclusionBuffer::BuildHierarchy() noexcept
+    {
+        for (uint32_t mip{ 1u }; mip < m_HierarchicalDepth.size(); ++mip)
+        {
+            const uint32_t sourceWidth{ std::max(Width >> (mip - 1u), 1u) };
+            const uint32_t sourceHeight{ std::max(Height >> (mip - 1u), 1u) };
+            const uint32_t width{ std::max(Width >> mip, 1u) };
+            const uint32_t height{ std::max(Height >> mip, 1u) };
+
+            const auto& source{ m_HierarchicalDepth[mip - 1u] };
+            auto& destination{ m_HierarchicalDepth[mip] };
+
+            for (uint32_t y{ 0u }; y < height; ++y)
+            {
+                const uint32_t sourceY0{ std::min(y * 2u, sourceHeight - 1u) };
+                const uint32_t sourceY1{ std::min(y * 2u + 1u, sourceHeight - 1u) };
+
+                for (uint32_t x{ 0u }; x < width; ++x)
+                {
+                    const uint32_t sourceX0{ std::min(x * 2u, sourceWidth - 1u) };
+                    const uint32_t sourceX1{ std::min(x * 2u + 1u, sourceWidth - 1u) };
+
+                    destination[static_cast<size_t>(y) * width + x] = std::min({
+                        source[static_cast<size_t>(sourceY0) * sourceWidth + sourceX0],
+                        source[static_cast<size_t>(sourceY0) * sourceWidth + sourceX1],
+                        source[static_cast<size_t>(sourceY1) * sourceWidth + sourceX0],
+                        source[static_cast<size_t>(sourceY1) * sourceWidth + sourceX1]
+                    });
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "DLEngine/Math/Mat4x4.h"
+#include "DLEngine/Math/Primitives.h"
+
+namespace DLEngine
+{
+    class Submesh;
+
+    // Low resolution CPU depth buffer for occlusion culling. Occluders are rasterized on the CPU
+    // and instance bounds are tested against a hierarchical-Z pyramid built from it.
+    // The buffer stores 1/w instead of the projected depth, so it does not depend on the depth convention
+    // of the projection: larger values are closer and 0 means that nothing was drawn
+    class OcclusionBuffer
+    {
+    public:
+        static constexpr uint32_t Width{ 256u };
+        static constexpr uint32_t Height{ 128u };
+
+        struct Occluder
+        {
+            const Submesh* SourceSubmesh{ nullptr };
+            Math::Mat4x4 MeshToWorld;
+        };
+
+    public:
+        OcclusionBuffer();
+
+        void Clear(const Math::Mat4x4& viewProjection) noexcept;
+
+        // Rasterizes the occluders in parallel horizontal bands and rebuilds the depth hierarchy
+        void RasterizeOccluders(std::span<const Occluder> occluders);
+
+        // Conservative, boxes that cross the near plane or leave the screen are never occluded
+        bool IsOccluded(const Math::AABB& aabb) const noexcept;
+
+        // Compacts the indices of the boxes that are not occluded to the front and returns their count
+        uint32_t RemoveOccluded(std::span<const Math::AABB> aabbs, std::span<uint32_t> indices) const noexcept;
+
+        uint32_t GetMipCount() const noexcept { return static_cast<uint32_t>(m_HierarchicalDepth.size()); }
+        std::span<const float> GetDepth(uint32_t mip = 0u) const noexcept { return m_HierarchicalDepth[mip]; }
+
+    private:
+        void BuildHierarchy() noexcept;
+
+    private:
+        Math::Mat4x4 m_ViewProjection;
+
+        // Mip 0 keeps the closest occluder per pixel, every other mip keeps the furthest value of its 2x2 block
+        std::vector<std::vector<float>> m_HierarchicalDepth;
+    };
+}
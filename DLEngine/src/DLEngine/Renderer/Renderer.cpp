@@ -23,6 +23,7 @@ namespace DLEngine
             Ref<MeshLibrary> MeshLib;
             Ref<ShaderLibrary> ShaderLib;
             Ref<TextureLibrary> TextureLib;
+            Ref<InstanceStoreLibrary> InstanceStoreLib;
 
             Ref<Framebuffer> SwapChainFB;
 
@@ -46,6 +47,7 @@ namespace DLEngine
         s_RendererData->ShaderLib->Init();
 
         s_RendererData->TextureLib = CreateRef<TextureLibrary>();
+        s_RendererData->InstanceStoreLib = CreateRef<InstanceStoreLibrary>();
 
         FramebufferSpecification framebufferSpec{};
         framebufferSpec.DebugName = "Swap chain target";
@@ -88,6 +90,11 @@ namespace DLEngine
         return s_RendererData->TextureLib;
     }
 
+    Ref<InstanceStoreLibrary> Renderer::GetInstanceStoreLibrary() noexcept
+    {
+        return s_RendererData->InstanceStoreLib;
+    }
+
     Ref<Texture2D> Renderer::GetBRDFLUT() noexcept
     {
         return s_RendererData->BRDFLUT;
@@ -4,6 +4,7 @@
 #include "DLEngine/Renderer/ConstantBuffer.h"
 #include "DLEngine/Renderer/StructuredBuffer.h"
 #include "DLEngine/Renderer/Framebuffer.h"
+#include "DLEngine/Renderer/InstanceStore.h"
 #include "DLEngine/Renderer/Material.h"
 #include "DLEngine/Renderer/Pipeline.h"
 #include "DLEngine/Renderer/PipelineCompute.h"
@@ -24,6 +25,7 @@ namespace DLEngine
         static Ref<MeshLibrary> GetMeshLibrary() noexcept;
         static Ref<ShaderLibrary> GetShaderLibrary() noexcept;
         static Ref<TextureLibrary> GetTextureLibrary() noexcept;
+        static Ref<InstanceStoreLibrary> GetInstanceStoreLibrary() noexcept;
 
         static Ref<Texture2D> GetBRDFLUT() noexcept;
 
@@ -1,6 +1,8 @@
 #include "dlpch.h"
 #include "Scene.h"
 
+#include "DLEngine/Math/BatchTransform.h"
+
 #include "DLEngine/Renderer/Renderer.h"
 #include "DLEngine/Renderer/SceneRenderer.h"
 
@@ -8,6 +10,53 @@
 
 namespace DLEngine
 {
+    namespace
+    {
+        // Bounds of the incremental sort, beyond them it gives way to the full one: places a particle may move from
+        // last frame order, and places all the particles may move together per particle
+        constexpr size_t INCREMENTAL_SORT_MAX_DISPLACEMENT{ 64u };
+        constexpr float INCREMENTAL_SORT_MAX_SHIFTS_PER_PARTICLE{ 4.0f };
+
+        // Frames the full sort is used for after the incremental one gave up, the camera usually keeps moving for a while
+        constexpr uint32_t INCREMENTAL_SORT_RETRY_DELAY_FRAMES{ 8u };
+
+        // Moves the last frame order of the smoke particles to their indices after the update and appends the spawned ones.
+        // Returns false if the order does not cover all the particles, e.g. on the first frame or after the emitters changed
+        bool CarrySmokeParticlesOrder(SmokeEnvironment& smokeEnvironment)
+        {
+            auto& sortedParticles{ smokeEnvironment.SortedSmokeParticles };
+            const auto& smokeEmitters{ smokeEnvironment.SmokeEmitters };
+
+            size_t carriedCount{ 0u };
+            for (size_t i{ 0u }; i < sortedParticles.size(); ++i)
+            {
+                const auto [emitterIndex, particleIndex] { sortedParticles[i] };
+                if (emitterIndex >= smokeEmitters.size())
+                    continue;
+
+                const auto& smokeParticles{ smokeEmitters[emitterIndex].first.Particles };
+                if (particleIndex >= smokeParticles.GetSizeBeforeUpdate())
+                    continue;
+
+                const uint32_t updatedIndex{ smokeParticles.GetUpdatedIndex(particleIndex) };
+                if (updatedIndex != SmokeParticlePool::RemovedIndex)
+                    sortedParticles[carriedCount++] = std::make_pair(emitterIndex, updatedIndex);
+            }
+            sortedParticles.resize(carriedCount);
+
+            size_t particlesCount{ 0u };
+            for (uint32_t emitterIndex{ 0u }; emitterIndex < smokeEmitters.size(); ++emitterIndex)
+            {
+                const auto& smokeParticles{ smokeEmitters[emitterIndex].first.Particles };
+                for (uint32_t particleIndex{ smokeParticles.GetSizeAfterUpdate() }; particleIndex < smokeParticles.GetSize(); ++particleIndex)
+                    sortedParticles.emplace_back(emitterIndex, particleIndex);
+
+                particlesCount += smokeParticles.GetSize();
+            }
+
+            return sortedParticles.size() == particlesCount;
+        }
+    }
 
     Scene::Scene(const SceneSpecification& specification)
         : m_SceneName(specification.SceneName)
@@ -15,6 +64,8 @@ namespace DLEngine
         , m_ViewportHeight(specification.ViewportHeight)
     {
         m_SceneCameraController.SetCameraResizeCallback(specification.CameraResizeCallback);
+
+        m_SmokeEnvironment.RandomSeed = specification.RandomSeed;
         
         WindowResizeEvent e{ m_ViewportWidth, m_ViewportHeight };
         m_SceneCameraController.OnEvent(e);
@@ -44,27 +95,58 @@ namespace DLEngine
             m_Dragger->Drag(ray);
         }
 
-        m_Decals.erase(std::remove_if(m_Decals.begin(), m_Decals.end(),
-            [this](const Decal& decal)
-            {
-                if (!m_MeshRegistry.HasInstance(decal.ParentMeshUUID))
-                    return true;
+        m_MeshRegistry.UpdateTransforms();
 
-                const auto& parentMeshInstance{ m_MeshRegistry.GetInstance(decal.ParentMeshUUID) };
-                const auto& parentMeshTransform{ parentMeshInstance->Get<Math::Mat4x4>("TRANSFORM") };
+        UpdateDecals();
 
-                const auto& decalToWorld{ decal.DecalToMesh * parentMeshTransform };
-                const auto& worldToDecal{ Math::Mat4x4::Inverse(decalToWorld) };
+        UpdateSmokeEmitters(dt);
+        SortSmokeParticles();
 
-                decal.DecalInstance->Set("DECAL_TO_WORLD", Buffer{ &decalToWorld, sizeof(Math::Mat4x4) });
-                decal.DecalInstance->Set("WORLD_TO_DECAL", Buffer{ &worldToDecal, sizeof(Math::Mat4x4) });
+        m_MeshRegistry.UpdateInstanceBVH();
+    }
+
+    void Scene::UpdateDecals()
+    {
+        std::erase_if(m_Decals, [this](const Decal& decal)
+            {
+                if (m_MeshRegistry.HasInstance(decal.ParentMeshUUID))
+                    return false;
 
-                return false;
+                m_DecalStore->Free(decal.DecalID);
+                return true;
             }
-        ), m_Decals.end());
+        );
+        if (m_Decals.empty())
+            return;
 
-        UpdateSmokeEmitters(dt);
-        SortSmokeParticles();
+        // Both directions are composed from the cached parent transforms, so nothing is inverted per frame.
+        // The factors are gathered into one array for the batch kernel, the products overwrite the decal side factors
+        const size_t decalCount{ m_Decals.size() };
+        m_DecalTransformsScratch.resize(4u * decalCount);
+        const std::span<Math::Mat4x4> decalToWorld{ std::span{ m_DecalTransformsScratch }.subspan(0u, decalCount) };
+        const std::span<Math::Mat4x4> meshToWorld{ std::span{ m_DecalTransformsScratch }.subspan(decalCount, decalCount) };
+        const std::span<Math::Mat4x4> worldToMesh{ std::span{ m_DecalTransformsScratch }.subspan(2u * decalCount, decalCount) };
+        const std::span<Math::Mat4x4> worldToDecal{ std::span{ m_DecalTransformsScratch }.subspan(3u * decalCount, decalCount) };
+
+        for (size_t i{ 0u }; i < decalCount; ++i)
+        {
+            const Decal& decal{ m_Decals[i] };
+            decalToWorld[i] = decal.DecalToMesh;
+            meshToWorld[i] = m_MeshRegistry.GetMeshToWorld(decal.ParentMeshUUID);
+            worldToMesh[i] = m_MeshRegistry.GetWorldToMesh(decal.ParentMeshUUID);
+            worldToDecal[i] = decal.MeshToDecal;
+        }
+
+        Math::MultiplyMatrices(decalToWorld, meshToWorld, decalToWorld);
+        Math::MultiplyMatrices(worldToMesh, worldToDecal, worldToDecal);
+
+        const UniformHandle decalToWorldHandle{ m_DecalStore->GetUniformHandle("DECAL_TO_WORLD") };
+        const UniformHandle worldToDecalHandle{ m_DecalStore->GetUniformHandle("WORLD_TO_DECAL") };
+        for (size_t i{ 0u }; i < decalCount; ++i)
+        {
+            m_DecalStore->Set(m_Decals[i].DecalID, decalToWorldHandle, Buffer{ &decalToWorld[i], sizeof(Math::Mat4x4) });
+            m_DecalStore->Set(m_Decals[i].DecalID, worldToDecalHandle, Buffer{ &worldToDecal[i], sizeof(Math::Mat4x4) });
+        }
     }
 
     void Scene::OnEvent(Event& e)
@@ -169,7 +251,11 @@ namespace DLEngine
 
     void Scene::AddSmokeEmitter(const SmokeEmitter& emitter, const MeshRegistry::MeshUUID& meshInstance)
     {
-        m_SmokeEnvironment.SmokeEmitters.emplace_back(emitter, meshInstance);
+        auto& smokeEmitter{ m_SmokeEnvironment.SmokeEmitters.emplace_back(emitter, meshInstance).first };
+
+        // The stream depends only on the seed and the order the emitters were added in,
+        // so the spawning replays exactly however the emitters are scheduled for update
+        smokeEmitter.ParticleRandom = RandomStream{ m_SmokeEnvironment.RandomSeed, m_SmokeEnvironment.AddedEmittersCount++ };
     }
 
     void Scene::ClearSmokeEmitters()
@@ -182,14 +268,15 @@ namespace DLEngine
 
     void Scene::SpawnDecal(const Math::Ray& ray, const Math::Vec3& tintColor, float rotation)
     {
+        m_MeshRegistry.UpdateInstanceBVH();
+
         MeshRegistry::IntersectInfo intersectInfo{};
         if (!Math::Intersects(ray, m_MeshRegistry, intersectInfo))
             return;
 
         const auto& triangleIntersectInfo{ intersectInfo.SubmeshIntersectInfo.TriangleIntersectInfo };
 
-        const auto& parentInstance{ m_MeshRegistry.GetInstance(intersectInfo.UUID) };
-        const Math::Mat4x4& parentInverseTransform{ Math::Mat4x4::Inverse(parentInstance->Get<Math::Mat4x4>("TRANSFORM")) };
+        const Math::Mat4x4& parentInverseTransform{ m_MeshRegistry.GetWorldToMesh(intersectInfo.UUID) };
 
         const auto& camera{ m_SceneCameraController.GetCamera() };
 
@@ -205,11 +292,15 @@ namespace DLEngine
 
         Decal decal{};
         decal.DecalToMesh = decalToWorld * parentInverseTransform;
+        decal.MeshToDecal = Math::Mat4x4::Inverse(decal.DecalToMesh);
         decal.ParentMeshUUID = intersectInfo.UUID;
 
-        decal.DecalInstance = Instance::Create(Renderer::GetShaderLibrary()->Get("GBuffer_Decal"), "Decal Instance");
-        decal.DecalInstance->Set("DECAL_TINT_COLOR", Buffer{ &tintColor, sizeof(Math::Vec3) });
-        decal.DecalInstance->Set("PARENT_INSTANCE_UUID", Buffer{ &intersectInfo.UUID, sizeof(MeshRegistry::MeshUUID) });
+        if (!m_DecalStore)
+            m_DecalStore = CreateRef<InstanceStore>(Renderer::GetShaderLibrary()->Get("GBuffer_Decal"));
+
+        decal.DecalID = m_DecalStore->Allocate();
+        m_DecalStore->Set(decal.DecalID, m_DecalStore->GetUniformHandle("DECAL_TINT_COLOR"), Buffer{ &tintColor, sizeof(Math::Vec3) });
+        m_DecalStore->Set(decal.DecalID, m_DecalStore->GetUniformHandle("PARENT_INSTANCE_UUID"), Buffer{ &intersectInfo.UUID, sizeof(MeshRegistry::MeshUUID) });
 
         m_Decals.emplace_back(decal);
     }
@@ -223,110 +314,142 @@ namespace DLEngine
                 SmokeEmitter& smokeEmitter{ smokeEmitterData.first };
                 const MeshRegistry::MeshUUID meshUUID{ smokeEmitterData.second };
 
-                smokeEmitter.Particles.erase(std::remove_if(std::execution::par_unseq, smokeEmitter.Particles.begin(), smokeEmitter.Particles.end(),
-                    [dt](SmokeParticle& particle)
-                    {
-                        particle.LifetimePassedMS += dt;
-                        particle.Position += particle.VelocityPerSecond * dt.GetSeconds();
-                        return particle.LifetimePassedMS > particle.LifetimeMS;
-                    }),
-                    smokeEmitter.Particles.end()
-                );
+                smokeEmitter.Particles.Update(dt);
 
                 const uint32_t particlesToSpawn{ static_cast<uint32_t>(dt.GetSeconds() * static_cast<float>(smokeEmitter.ParticleSpawnRatePerSecond)) };
 
-                const auto& transform{ m_MeshRegistry.GetInstance(meshUUID)->Get<Math::Mat4x4>("TRANSFORM") };
+                const auto& transform{ m_MeshRegistry.GetMeshToWorld(meshUUID) };
                 const auto& smokeEmitterWorldPos{ Math::PointToSpace(smokeEmitter.Position, transform) };
 
-                const uint32_t beginSpawnIndex{ static_cast<uint32_t>(smokeEmitter.Particles.size()) };
-                smokeEmitter.Particles.resize(smokeEmitter.Particles.size() + particlesToSpawn);
-                std::generate(std::execution::par_unseq, smokeEmitter.Particles.begin() + beginSpawnIndex, smokeEmitter.Particles.end(),
-                    [&smokeEmitter{ std::as_const(smokeEmitter) }, &smokeEmitterWorldPos{ std::as_const(smokeEmitterWorldPos) }]()
-                    {
-                        SmokeParticle particle{};
-
-                        const float theta{ RandomGenerator::GenerateRandom(0.0f, 2.0f * Math::Numeric::Pi) };
-                        const float phi{ RandomGenerator::GenerateRandom(0.0f, Math::Numeric::Pi) };
-                        const float distance{ RandomGenerator::GenerateRandom(0.0f, smokeEmitter.ParticleSpawnRadius) };
-
-                        const Math::Vec3 emitterRelativePos{
-                            distance * Math::SinEst(phi) * Math::CosEst(theta),
-                            distance * Math::SinEst(phi) * Math::SinEst(theta),
-                            distance * Math::CosEst(phi)
-                        };
-
-                        particle.Position = smokeEmitterWorldPos + emitterRelativePos;
-
-                        constexpr Math::Vec3 worldUp{ 0.0f, 1.0f, 0.0f };
-                        constexpr Math::Vec3 worldRight{ 1.0f, 0.0f, 0.0f };
-                        constexpr Math::Vec3 worldForward{ 0.0f, 0.0f, 1.0f };
-
-                        const float particleRightVelocity{
-                            RandomGenerator::GenerateRandom(-smokeEmitter.ParticleHorizontalVelocity, smokeEmitter.ParticleHorizontalVelocity)
-                        };
-                        const float particleForwardVelocity{
-                            RandomGenerator::GenerateRandom(-smokeEmitter.ParticleHorizontalVelocity, smokeEmitter.ParticleHorizontalVelocity)
-                        };
-
-                        particle.VelocityPerSecond = worldUp * smokeEmitter.ParticleVerticalVelocity +
-                            worldRight * particleRightVelocity +
-                            worldForward * particleForwardVelocity;
-
-                        particle.LifetimeMS = RandomGenerator::GenerateRandom(
-                            smokeEmitter.MinParticleLifetimeMS,
-                            smokeEmitter.MaxParticleLifetimeMS
-                        );
-
-                        return particle;
-                    }
-                );
+                auto& random{ smokeEmitter.ParticleRandom };
+
+                std::vector<Math::Vec3> spawnPositions(particlesToSpawn);
+                random.GeneratePointsInSphere(spawnPositions, smokeEmitter.ParticleSpawnRadius);
+
+                std::vector<float> horizontalVelocities(2u * particlesToSpawn);
+                random.GenerateFloats(horizontalVelocities, -smokeEmitter.ParticleHorizontalVelocity, smokeEmitter.ParticleHorizontalVelocity);
+
+                std::vector<float> lifetimes(particlesToSpawn);
+                random.GenerateFloats(lifetimes, smokeEmitter.MinParticleLifetimeMS, smokeEmitter.MaxParticleLifetimeMS);
+
+                std::vector<float> rotations(particlesToSpawn);
+                random.GenerateFloats(rotations, -Math::Numeric::Pi, Math::Numeric::Pi);
+
+                constexpr Math::Vec3 worldUp{ 0.0f, 1.0f, 0.0f };
+                constexpr Math::Vec3 worldRight{ 1.0f, 0.0f, 0.0f };
+                constexpr Math::Vec3 worldForward{ 0.0f, 0.0f, 1.0f };
+
+                std::vector<SmokeParticle> spawnedParticles(particlesToSpawn);
+                for (uint32_t i{ 0u }; i < particlesToSpawn; ++i)
+                {
+                    auto& particle{ spawnedParticles[i] };
+                    particle.Position = smokeEmitterWorldPos + spawnPositions[i];
+                    particle.VelocityPerSecond = worldUp * smokeEmitter.ParticleVerticalVelocity +
+                        worldRight * horizontalVelocities[2u * i] +
+                        worldForward * horizontalVelocities[2u * i + 1u];
+                    particle.LifetimeMS = lifetimes[i];
+                    particle.Rotation = rotations[i];
+                }
+
+                smokeEmitter.Particles.Append(spawnedParticles);
             }
         );
     }
 
     void Scene::SortSmokeParticles()
     {
-        using SmokeParticleID = std::pair<SmokeEnvironment::EmitterIndex, SmokeEnvironment::ParticleIndex>;
-
         const auto& camera{ m_SceneCameraController.GetCamera() };
-        const auto& cameraPos{ camera.GetPosition() };
         const Math::Vec3& particlePlaneNormal{ -camera.GetForward() };
-        
-        std::unordered_map<float, SmokeParticleID> distancesToParticles{};
-        std::vector<float> particleDistances{};
+        const float cameraPlaneDistance{ Math::Dot(camera.GetPosition(), particlePlaneNormal) };
+
+        auto& sortKeys{ m_SmokeEnvironment.SortKeys };
+        auto& sortedParticles{ m_SmokeEnvironment.SortedSmokeParticles };
+        auto& particleSortKeys{ m_SmokeEnvironment.ParticleSortKeys };
+        auto& emitterSortKeysOffsets{ m_SmokeEnvironment.EmitterSortKeysOffsets };
+
+        emitterSortKeysOffsets.resize(m_SmokeEnvironment.SmokeEmitters.size());
+
+        uint32_t particlesCount{ 0u };
         for (uint32_t emitterIndex{ 0u }; emitterIndex < m_SmokeEnvironment.SmokeEmitters.size(); ++emitterIndex)
         {
-            const auto& smokeEmitter{ m_SmokeEnvironment.SmokeEmitters[emitterIndex].first };
-
-            distancesToParticles.reserve(distancesToParticles.size() + smokeEmitter.Particles.size());
-            particleDistances.reserve(particleDistances.size() + smokeEmitter.Particles.size());
+            emitterSortKeysOffsets[emitterIndex] = particlesCount;
+            particlesCount += m_SmokeEnvironment.SmokeEmitters[emitterIndex].first.Particles.GetSize();
+        }
 
-            for (uint32_t particleIndex{ 0u }; particleIndex < smokeEmitter.Particles.size(); ++particleIndex)
+        // Negated distance to the camera plane, so the ascending sort puts the furthest particles first.
+        // The keys are computed in the pool order, walking the position streams front to back
+        particleSortKeys.resize(particlesCount);
+        std::for_each(std::execution::par, m_SmokeEnvironment.SmokeEmitters.begin(), m_SmokeEnvironment.SmokeEmitters.end(),
+            [this, &particleSortKeys, &emitterSortKeysOffsets, &particlePlaneNormal, cameraPlaneDistance](const auto& smokeEmitterData)
             {
-                const auto& particle{ smokeEmitter.Particles[particleIndex] };
-
-                // Plane equation: Ax + By + Cz + D = 0, where (A, B, C) is its normal.
-                const float D{ -Math::Dot(particle.Position, particlePlaneNormal) };
-                const float distanceToPlane{ Math::Dot(cameraPos, particlePlaneNormal) + D };
+                const size_t emitterIndex{ static_cast<size_t>(&smokeEmitterData - m_SmokeEnvironment.SmokeEmitters.data()) };
+                const auto& smokeParticles{ smokeEmitterData.first.Particles };
+
+                const auto positionsX{ smokeParticles.GetPositionsX() };
+                const auto positionsY{ smokeParticles.GetPositionsY() };
+                const auto positionsZ{ smokeParticles.GetPositionsZ() };
+
+                float* keys{ particleSortKeys.data() + emitterSortKeysOffsets[emitterIndex] };
+                for (uint32_t particleIndex{ 0u }; particleIndex < smokeParticles.GetSize(); ++particleIndex)
+                {
+                    keys[particleIndex] = positionsX[particleIndex] * particlePlaneNormal.x +
+                        positionsY[particleIndex] * particlePlaneNormal.y +
+                        positionsZ[particleIndex] * particlePlaneNormal.z - cameraPlaneDistance;
+                }
+            }
+        );
 
-                if (distanceToPlane < 0.0f)
-                    continue;
+        bool isIncremental{ m_SmokeEnvironment.IncrementalSort && m_SmokeEnvironment.IncrementalSortRetryCountdown == 0u };
+        if (m_SmokeEnvironment.IncrementalSortRetryCountdown > 0u)
+            --m_SmokeEnvironment.IncrementalSortRetryCountdown;
 
-                particleDistances.emplace_back(distanceToPlane);
-                distancesToParticles[distanceToPlane] = std::make_pair(emitterIndex, particleIndex);
+        isIncremental = isIncremental && CarrySmokeParticlesOrder(m_SmokeEnvironment);
+        if (isIncremental)
+        {
+            sortKeys.resize(sortedParticles.size());
+            std::for_each(std::execution::par, sortedParticles.begin(), sortedParticles.end(),
+                [&sortKeys, &sortedParticles, &particleSortKeys, &emitterSortKeysOffsets](const auto& smokeParticleID)
+                {
+                    const size_t sortedParticleIndex{ static_cast<size_t>(&smokeParticleID - sortedParticles.data()) };
+                    sortKeys[sortedParticleIndex] = particleSortKeys[emitterSortKeysOffsets[smokeParticleID.first] + smokeParticleID.second];
+                }
+            );
+
+            const bool isRepaired{ Utils::RepairSortedOrder<float, std::pair<SmokeEnvironment::EmitterIndex, SmokeEnvironment::ParticleIndex>>(
+                sortKeys, sortedParticles, INCREMENTAL_SORT_MAX_DISPLACEMENT, INCREMENTAL_SORT_MAX_SHIFTS_PER_PARTICLE
+            ) };
+
+            if (!isRepaired)
+            {
+                m_SmokeEnvironment.IncrementalSortRetryCountdown = INCREMENTAL_SORT_RETRY_DELAY_FRAMES;
+                isIncremental = false;
             }
         }
 
-        const uint32_t particlesCount{ static_cast<uint32_t>(particleDistances.size()) };
-        
-        std::vector<float> sortedParticleDistances(particlesCount);
-        Utils::RadixSort11(particleDistances.data(), sortedParticleDistances.data(), particlesCount);
+        if (!isIncremental)
+        {
+            sortedParticles.clear();
+            for (uint32_t emitterIndex{ 0u }; emitterIndex < m_SmokeEnvironment.SmokeEmitters.size(); ++emitterIndex)
+            {
+                const auto& smokeParticles{ m_SmokeEnvironment.SmokeEmitters[emitterIndex].first.Particles };
+                for (uint32_t particleIndex{ 0u }; particleIndex < smokeParticles.GetSize(); ++particleIndex)
+                    sortedParticles.emplace_back(emitterIndex, particleIndex);
+            }
 
-        m_SmokeEnvironment.SortedSmokeParticles.reserve(particlesCount);
-        m_SmokeEnvironment.SortedSmokeParticles.clear();
+            // The keys are in the pool order as well, and are recomputed every frame
+            std::swap(sortKeys, particleSortKeys);
 
-        for (const auto& paricleDistance : sortedParticleDistances | std::views::reverse)
-            m_SmokeEnvironment.SortedSmokeParticles.emplace_back(distancesToParticles[paricleDistance]);
+            m_SmokeEnvironment.SortKeysScratch.resize(sortKeys.size());
+            m_SmokeEnvironment.SortedSmokeParticlesScratch.resize(sortedParticles.size());
+
+            Utils::RadixSortParallel<float, std::pair<SmokeEnvironment::EmitterIndex, SmokeEnvironment::ParticleIndex>>(
+                sortKeys, sortedParticles,
+                m_SmokeEnvironment.SortKeysScratch, m_SmokeEnvironment.SortedSmokeParticlesScratch
+            );
+        }
+
+        // Particles behind the camera plane have positive keys
+        m_SmokeEnvironment.VisibleSmokeParticlesCount = static_cast<uint32_t>(std::ranges::upper_bound(sortKeys, 0.0f) - sortKeys.begin());
     }
 
     bool Scene::OnWindowResize(WindowResizeEvent& e)
@@ -355,6 +478,8 @@ namespace DLEngine
             ray.Origin = camera.ConstructFrustumPos(cursorPosNDC);
             ray.Direction = Math::Normalize(camera.ConstructFrustumPosNoTranslation(cursorPosNDC));
 
+            m_MeshRegistry.UpdateInstanceBVH();
+
             MeshRegistry::IntersectInfo intersectInfo{};
             if (Math::Intersects(ray, m_MeshRegistry, intersectInfo))
             {
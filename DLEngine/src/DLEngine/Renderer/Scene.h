@@ -5,9 +5,11 @@
 
 #include "DLEngine/Renderer/CameraController.h"
 #include "DLEngine/Renderer/IDragger.h"
+#include "DLEngine/Renderer/SmokeParticlePool.h"
 
 #include "DLEngine/Utils/DeltaTime.h"
 #include "DLEngine/Utils/RandomGenerator.h"
+#include "DLEngine/Utils/RandomStream.h"
 
 namespace DLEngine
 {
@@ -42,18 +44,9 @@ namespace DLEngine
         std::vector<std::pair<SpotLight, MeshRegistry::MeshUUID>> SpotLights;
     };
 
-    struct SmokeParticle
-    {
-        Math::Vec3 Position{ 0.0f };
-        Math::Vec3 VelocityPerSecond{ 0.0f };
-        float Rotation{ RandomGenerator::GenerateRandom(-Math::Numeric::Pi, Math::Numeric::Pi) };
-        float LifetimeMS{ Math::Numeric::Max };
-        float LifetimePassedMS{ 0.0f };
-    };
-
     struct SmokeEmitter
     {
-        std::vector<SmokeParticle> Particles;
+        SmokeParticlePool Particles;
         Math::Vec3 Position;
         Math::Vec3 SpawnedParticleTintColor;
         Math::Vec2 InitialParticleSize;
@@ -65,6 +58,9 @@ namespace DLEngine
         float ParticleVerticalVelocity;
         float ParticleHorizontalVelocity;
         uint32_t ParticleSpawnRatePerSecond;
+
+        // Assigned by the scene, every emitter spawns its particles from its own stream
+        RandomStream ParticleRandom;
     };
 
     struct SmokeEnvironment
@@ -73,7 +69,27 @@ namespace DLEngine
         using ParticleIndex = uint32_t;
 
         std::vector<std::pair<SmokeEmitter, MeshRegistry::MeshUUID>> SmokeEmitters;
+
+        // All the particles from the furthest to the closest, the ones behind the camera plane go last
         std::vector<std::pair<EmitterIndex, ParticleIndex>> SortedSmokeParticles;
+        uint32_t VisibleSmokeParticlesCount{ 0u };
+
+        // The incremental sort repairs the order of the last frame instead of sorting from scratch.
+        // After it gives up, the full sort is used for a few frames before the next attempt
+        bool IncrementalSort{ true };
+        uint32_t IncrementalSortRetryCountdown{ 0u };
+
+        // Sort keys of the particles of every emitter in their pool order, the emitters one after another
+        std::vector<float> ParticleSortKeys;
+        std::vector<uint32_t> EmitterSortKeysOffsets;
+
+        // Sort keys and radix sort scratch buffers, kept between frames to avoid reallocations
+        std::vector<float> SortKeys;
+        std::vector<float> SortKeysScratch;
+        std::vector<std::pair<EmitterIndex, ParticleIndex>> SortedSmokeParticlesScratch;
+
+        uint64_t RandomSeed{ 0u };
+        uint64_t AddedEmittersCount{ 0u };
     };
 
     struct SceneSpecification
@@ -82,12 +98,17 @@ namespace DLEngine
         std::string SceneName{ "Untitled Scene" };
         uint32_t ViewportWidth{ 0u };
         uint32_t ViewportHeight{ 0u };
+
+        // Scenes with the same seed spawn the same particles
+        uint64_t RandomSeed{ 0u };
     };
 
     struct Decal
     {
         Math::Mat4x4 DecalToMesh;
-        Ref<Instance> DecalInstance;
+        Math::Mat4x4 MeshToDecal;
+        // Row of the decal in the decal store of the scene
+        InstanceStore::ID DecalID;
         MeshRegistry::MeshUUID ParentMeshUUID;
     };
 
@@ -122,9 +143,13 @@ namespace DLEngine
         MeshRegistry& GetMeshRegistry() noexcept { return m_MeshRegistry; }
         const MeshRegistry& GetMeshRegistry() const noexcept { return m_MeshRegistry; }
 
-        uint32_t GetOverallParticlesCount() const noexcept { return static_cast<uint32_t>(m_SmokeEnvironment.SortedSmokeParticles.size()); }
+        uint32_t GetOverallParticlesCount() const noexcept { return m_SmokeEnvironment.VisibleSmokeParticlesCount; }
+
+        bool IsSmokeSortIncremental() const noexcept { return m_SmokeEnvironment.IncrementalSort; }
+        void SetSmokeSortIncremental(bool incremental) noexcept { m_SmokeEnvironment.IncrementalSort = incremental; }
 
     private:
+        void UpdateDecals();
         void UpdateSmokeEmitters(DeltaTime dt);
         void SortSmokeParticles();
 
@@ -141,6 +166,9 @@ namespace DLEngine
         SmokeEnvironment m_SmokeEnvironment;
 
         std::vector<Decal> m_Decals;
+        std::vector<Math::Mat4x4> m_DecalTransformsScratch;
+        // Holds the rows of the decals only, created with the first one. Its columns are the decal instance buffers as they are
+        Ref<InstanceStore> m_DecalStore;
 
         std::string m_SceneName;
 
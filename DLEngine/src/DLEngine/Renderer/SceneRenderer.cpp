@@ -1,6 +1,9 @@
 #include "dlpch.h"
 #include "SceneRenderer.h"
 
+#include <bit>
+
+#include "DLEngine/Math/BatchTransform.h"
 #include "DLEngine/Math/Intersections.h"
 
 #include "DLEngine/Renderer/Renderer.h"
@@ -11,29 +14,52 @@ namespace DLEngine
     {
         namespace
         {
-            void SubmitMeshBatch(const MeshRegistry& meshRegistry, std::string_view shaderName, bool setMaterial)
+            // Draws the instances left visible by the last MeshRegistry::CullInstances call for the shader.
+            // The draw list is sorted by material, so a material is bound once for all its consecutive draws
+            void SubmitVisibleInstances(MeshRegistry& meshRegistry, std::string_view shaderName, bool setMaterial)
             {
-                const auto& meshBatch{ meshRegistry.GetMeshBatch(shaderName) };
-                for (const auto& [mesh, submeshBatch] : meshBatch.SubmeshBatches)
+                const MeshRegistry::DrawList& drawList{ meshRegistry.BuildDrawList(shaderName) };
+
+                uint32_t boundMaterialID{ std::numeric_limits<uint32_t>::max() };
+                for (const MeshRegistry::DrawBatch* drawBatch : drawList.Draws)
                 {
-                    for (uint32_t submeshIndex{ 0u }; submeshIndex < mesh->GetSubmeshes().size(); ++submeshIndex)
+                    if (setMaterial && boundMaterialID != drawBatch->MaterialID)
                     {
-                        for (const auto& [material, instanceBatch] : submeshBatch.MaterialBatches[submeshIndex].InstanceBatches)
-                        {
-                            if (setMaterial)
-                                Renderer::SetMaterial(material);
-                            
-                            const uint32_t instanceCount{ static_cast<uint32_t>(instanceBatch.SubmeshInstances.size()) };
-                            Renderer::SubmitStaticMeshInstanced(mesh, submeshIndex, instanceBatch.InstanceBuffers, instanceCount);
-                        }
+                        Renderer::SetMaterial(drawBatch->SourceMaterial);
+                        boundMaterialID = drawBatch->MaterialID;
                     }
+
+                    const MeshRegistry::InstanceBatch& instanceBatch{ *drawBatch->Batch };
+                    Renderer::SubmitStaticMeshInstanced(drawBatch->SourceMesh, drawBatch->SubmeshIndex, instanceBatch.GetVisibleInstanceBuffers(), instanceBatch.VisibleInstanceCount);
                 }
             }
+
+            // Shadow passes write depth only, their draws are not ordered by depth
+            MeshRegistry::CullingStatistics SubmitMeshBatch(MeshRegistry& meshRegistry, std::string_view shaderName, MeshRegistry::ViewID view, const Math::Frustum& frustum, bool setMaterial)
+            {
+                const MeshRegistry::CullingStatistics statistics{ meshRegistry.CullInstances(shaderName, view, frustum) };
+                SubmitVisibleInstances(meshRegistry, shaderName, setMaterial);
+                return statistics;
+            }
+
+            // The draws of a material go front to back from the view position
+            MeshRegistry::CullingStatistics SubmitMeshBatch(MeshRegistry& meshRegistry, std::string_view shaderName, MeshRegistry::ViewID view, const Math::Frustum& frustum, const OcclusionBuffer& occlusionBuffer, const Math::Vec3& viewPosition, bool setMaterial)
+            {
+                const MeshRegistry::CullingStatistics statistics{ meshRegistry.CullInstances(shaderName, view, frustum, occlusionBuffer, viewPosition) };
+                SubmitVisibleInstances(meshRegistry, shaderName, setMaterial);
+                return statistics;
+            }
         }
     }
 
     namespace
     {
+        // Views of the mesh registry, every pass culls into its own instance buffers, so the passes of a static scene upload nothing.
+        // The shadow passes of a frame take the views right after the camera one, the directional lights first, then the point and the spot ones,
+        // so the registry keeps no more views than there are lights. The views left over when lights are removed are released by the registry
+        constexpr MeshRegistry::ViewID CAMERA_VIEW{ 0u };
+        constexpr MeshRegistry::ViewID FIRST_LIGHT_VIEW{ CAMERA_VIEW + 1u };
+
         enum BindingPoint : uint32_t
         {
             // Constant buffers
@@ -116,7 +142,11 @@ namespace DLEngine
             uint32_t DirectionalLightsCount{ 0u };
             uint32_t PointLightsCount{ 0u };
             uint32_t SpotLightsCount{ 0u };
-            float _padding{ 0.0f };
+            float ClusterSliceScale{ 0.0f };
+            uint32_t ClustersCountX{ LightClusters::ClustersCountX };
+            uint32_t ClustersCountY{ LightClusters::ClustersCountY };
+            uint32_t ClustersCountZ{ LightClusters::ClustersCountZ };
+            float ClusterSliceBias{ 0.0f };
         };
 
         struct CBPBRSettings
@@ -142,6 +172,8 @@ namespace DLEngine
         struct CBOmnidirectionalLightShadowData
         {
             std::array<Math::Mat4x4, 6u> LightViewProjections;
+            uint32_t VisibleFacesMask{ 0u };
+            float _padding[3u]{};
         };
 
         struct CBShadowMappingData
@@ -199,6 +231,14 @@ namespace DLEngine
             float LifetimeMS;
             float LifetimePassedMS;
         };
+
+        // Occluders are picked among the low poly opaque instances that cover the most of the screen
+        constexpr uint32_t MAX_OCCLUDERS{ 64u };
+        constexpr size_t MAX_OCCLUDER_TRIANGLES{ 2048u };
+        constexpr float MIN_OCCLUDER_SCREEN_SIZE{ 0.05f };
+
+        // Lights are clustered by the same range that their shadow maps cover
+        constexpr float LIGHT_CONTRIBUTION_THRESHOLD{ 1e-5f };
     }
 
     SceneRenderer::SceneRenderer(const SceneRendererSpecification& specification)
@@ -216,6 +256,8 @@ namespace DLEngine
         m_ViewportWidth = m_Scene->m_ViewportWidth;
         m_ViewportHeight = m_Scene->m_ViewportHeight;
 
+        m_Statistics = SceneRendererStatistics{};
+
         PreRender();
 
         ShadowPass();
@@ -292,6 +334,8 @@ namespace DLEngine
         m_SBDirectionalLights = StructuredBuffer::Create(sizeof(DirectionalLight), 100u);
         m_SBPointLights = StructuredBuffer::Create(sizeof(PointLight), 100u);
         m_SBSpotLights = StructuredBuffer::Create(sizeof(SpotLight), 100u);
+        m_SBClusterLightRanges = StructuredBuffer::Create(sizeof(LightClusters::ClusterLightRange), LightClusters::ClustersCount);
+        m_SBClusterLightIndices = StructuredBuffer::Create(sizeof(uint32_t), LightClusters::ClustersCount);
         m_SceneShadowEnvironment.SBDirectionalLightsPOVs = StructuredBuffer::Create(sizeof(Math::Mat4x4), 100u);
         m_SceneShadowEnvironment.SBPointLightsPOVs = StructuredBuffer::Create(sizeof(Math::Mat4x4), 100u);
         m_SceneShadowEnvironment.SBSpotLightsPOVs = StructuredBuffer::Create(sizeof(Math::Mat4x4), 100u);
@@ -875,6 +919,7 @@ namespace DLEngine
         UpdateDirectionalLightsData();
         UpdatePointLightsData();
         UpdateSpotLightsData();
+        UpdateLightClusters(m_Scene->m_SceneCameraController.GetCamera());
         UpdateDecalsData();
         UpdateSmokeParticlesData();
 
@@ -1021,12 +1066,17 @@ namespace DLEngine
     {
         const auto& lightsCount{ m_CBLightsCount->GetLocalData().As<CBLightsCount>() };
 
+        const MeshRegistry::ViewID firstDirectionalLightView{ FIRST_LIGHT_VIEW };
+        const MeshRegistry::ViewID firstPointLightView{ firstDirectionalLightView + lightsCount->DirectionalLightsCount };
+        const MeshRegistry::ViewID firstSpotLightView{ firstPointLightView + lightsCount->PointLightsCount };
+
         // Building directional shadow maps
         for (uint32_t i{ 0u }; i < lightsCount->DirectionalLightsCount; ++i)
         {
             const auto& directionalLightData{ m_SceneShadowEnvironment.DirectionalLightsData[i] };
 
             UpdateCBCamera(directionalLightData.POV);
+            const Math::Frustum lightFrustum{ directionalLightData.POV.ConstructFrustumPlanes() };
 
             TextureViewSpecification depthAttachmentWriteViewSpecification{};
             depthAttachmentWriteViewSpecification.Format = TextureFormat::DEPTH24STENCIL8;
@@ -1037,13 +1087,13 @@ namespace DLEngine
             m_DirectionalShadowMapFramebuffer->SetDepthAttachmentViewSpecification(depthAttachmentWriteViewSpecification);
 
             Renderer::SetPipeline(m_DirectionalShadowMapPipeline, DL_CLEAR_DEPTH_ATTACHMENT);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", false);
+            m_Statistics.DirectionalShadowPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", firstDirectionalLightView + i, lightFrustum, false);
 
             Renderer::SetPipeline(m_DirectionalShadowMapDissolutionPipeline, DL_CLEAR_NONE);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", true);
+            m_Statistics.DirectionalShadowPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", firstDirectionalLightView + i, lightFrustum, true);
 
             Renderer::SetPipeline(m_DirectionalShadowMapIncinirationPipeline, DL_CLEAR_NONE);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", true);
+            m_Statistics.DirectionalShadowPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", firstDirectionalLightView + i, lightFrustum, true);
         }
 
         // Building point shadow maps
@@ -1053,12 +1103,35 @@ namespace DLEngine
             const auto& pointLightData{ m_SceneShadowEnvironment.PointLightsData[i] };
 
             CBOmnidirectionalLightShadowData pointLightShadowData{};
+            std::array<Math::Frustum, 6u> faceFrustums{};
             for (uint32_t face{ 0u }; face < 6u; ++face)
             {
                 const auto& facePOV{ pointLightData.POVs[face] };
                 pointLightShadowData.LightViewProjections[face] = facePOV.GetViewMatrix() * facePOV.GetProjectionMatrix();
+                faceFrustums[face] = facePOV.ConstructFrustumPlanes();
             }
-            m_SceneShadowEnvironment.CBPointLightData->SetData(Buffer{ &pointLightShadowData, sizeof(CBOmnidirectionalLightShadowData) });
+
+            const auto& lightPOV{ pointLightData.POVs[0u] };
+            const Math::Sphere lightSphere{ .Center = lightPOV.GetPosition(), .Radius = std::max(lightPOV.GetNearZ(), lightPOV.GetFarZ()) };
+
+            // Only the casters inside the light radius are drawn, and the geometry shader
+            // skips the cube faces that none of them reach
+            uint32_t renderedFacesMask{ 0u };
+            const auto submitCasters{ [&](std::string_view shaderName, bool setMaterial)
+                {
+                    auto& meshRegistry{ m_Scene->m_MeshRegistry };
+                    m_Statistics.PointShadowPass += meshRegistry.CullInstances(shaderName, firstPointLightView + i, lightSphere);
+
+                    pointLightShadowData.VisibleFacesMask = meshRegistry.GetVisibleInstancesMask(shaderName, faceFrustums);
+                    if (pointLightShadowData.VisibleFacesMask == 0u)
+                        return;
+
+                    renderedFacesMask |= pointLightShadowData.VisibleFacesMask;
+                    m_SceneShadowEnvironment.CBPointLightData->SetData(Buffer{ &pointLightShadowData, sizeof(CBOmnidirectionalLightShadowData) });
+
+                    Utils::SubmitVisibleInstances(meshRegistry, shaderName, setMaterial);
+                }
+            };
 
             TextureViewSpecification depthAttachmentWriteViewSpecification{};
             depthAttachmentWriteViewSpecification.Format = TextureFormat::DEPTH24STENCIL8;
@@ -1069,13 +1142,16 @@ namespace DLEngine
             m_PointShadowMapFramebuffer->SetDepthAttachmentViewSpecification(depthAttachmentWriteViewSpecification);
 
             Renderer::SetPipeline(m_PointShadowMapPipeline, DL_CLEAR_DEPTH_ATTACHMENT);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", false);
+            submitCasters("GBuffer_PBR_Static", false);
 
             Renderer::SetPipeline(m_PointShadowMapDissolutionPipeline, DL_CLEAR_NONE);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", true);
+            submitCasters("GBuffer_PBR_Static_Dissolution", true);
 
             Renderer::SetPipeline(m_PointShadowMapIncinirationPipeline, DL_CLEAR_NONE);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", true);
+            submitCasters("GBuffer_PBR_Static_Incineration", true);
+
+            m_Statistics.RenderedPointShadowFaces += static_cast<uint32_t>(std::popcount(renderedFacesMask));
+            m_Statistics.TotalPointShadowFaces += 6u;
         }
 
         // Building spot shadow maps
@@ -1084,6 +1160,7 @@ namespace DLEngine
             const auto& spotLightData{ m_SceneShadowEnvironment.SpotLightsData[i] };
 
             UpdateCBCamera(spotLightData.POV);
+            const Math::Frustum lightFrustum{ spotLightData.POV.ConstructFrustumPlanes() };
 
             TextureViewSpecification depthAttachmentWriteViewSpecification{};
             depthAttachmentWriteViewSpecification.Format = TextureFormat::DEPTH24STENCIL8;
@@ -1094,36 +1171,40 @@ namespace DLEngine
             m_SpotShadowMapFramebuffer->SetDepthAttachmentViewSpecification(depthAttachmentWriteViewSpecification);
 
             Renderer::SetPipeline(m_SpotShadowMapPipeline, DL_CLEAR_DEPTH_ATTACHMENT);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", false);
+            m_Statistics.SpotShadowPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", firstSpotLightView + i, lightFrustum, false);
 
             Renderer::SetPipeline(m_SpotShadowMapDissolutionPipeline, DL_CLEAR_NONE);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", true);
+            m_Statistics.SpotShadowPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", firstSpotLightView + i, lightFrustum, true);
 
             Renderer::SetPipeline(m_SpotShadowMapIncinirationPipeline, DL_CLEAR_NONE);
-            Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", true);
+            m_Statistics.SpotShadowPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", firstSpotLightView + i, lightFrustum, true);
         }
     }
 
     void SceneRenderer::GBufferPass()
     {
-        UpdateCBCamera(m_Scene->m_SceneCameraController.GetCamera());
+        const Camera& camera{ m_Scene->m_SceneCameraController.GetCamera() };
+        const Math::Frustum cameraFrustum{ camera.ConstructFrustumPlanes() };
+
+        UpdateCBCamera(camera);
+        RasterizeOccluders(camera, cameraFrustum);
 
         TextureViewSpecification depthAttachmentWriteSpecification{};
         depthAttachmentWriteSpecification.Format = TextureFormat::DEPTH24STENCIL8;
 
         m_GBuffer_EmissionFramebuffer->SetDepthAttachmentViewSpecification(depthAttachmentWriteSpecification);
         Renderer::SetPipeline(m_GBuffer_EmissionPipeline, DL_CLEAR_COLOR_ATTACHMENT | DL_CLEAR_DEPTH_ATTACHMENT | DL_CLEAR_STENCIL_ATTACHMENT);
-        Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_Emission", true);
+        m_Statistics.GBufferPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_Emission", CAMERA_VIEW, cameraFrustum, m_OcclusionBuffer, camera.GetPosition(), true);
 
         m_GBuffer_PBR_StaticFramebuffer->SetDepthAttachmentViewSpecification(depthAttachmentWriteSpecification);
         Renderer::SetPipeline(m_GBuffer_PBR_Static_DissolutionPipeline, DL_CLEAR_NONE);
-        Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", true);
+        m_Statistics.GBufferPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Dissolution", CAMERA_VIEW, cameraFrustum, m_OcclusionBuffer, camera.GetPosition(), true);
 
         Renderer::SetPipeline(m_GBuffer_PBR_Static_IncinerationPipeline, DL_CLEAR_NONE);
-        Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", true);
+        m_Statistics.GBufferPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static_Incineration", CAMERA_VIEW, cameraFrustum, m_OcclusionBuffer, camera.GetPosition(), true);
         
         Renderer::SetPipeline(m_GBuffer_PBR_StaticPipeline, DL_CLEAR_NONE);
-        Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", true);
+        m_Statistics.GBufferPass += Utils::SubmitMeshBatch(m_Scene->m_MeshRegistry, "GBuffer_PBR_Static", CAMERA_VIEW, cameraFrustum, m_OcclusionBuffer, camera.GetPosition(), true);
 
         m_GBufferGeometrySurfaceNormalsCopy = Texture2D::Copy(m_GBufferGeometrySurfaceNormals);
         m_GBufferInstanceUUIDCopy = Texture2D::Copy(m_GBufferInstanceUUID);
@@ -1202,6 +1283,21 @@ namespace DLEngine
 
         m_HDR_ResolvePBR_StaticFramebuffer->SetDepthAttachmentViewSpecification(depthAttachmentWriteViewSpecification);
         Renderer::SetPipeline(m_GBufferResolve_PBR_StaticPipeline, DL_CLEAR_COLOR_ATTACHMENT);
+
+        BufferViewSpecification clusterLightRangesViewSpecification{};
+        clusterLightRangesViewSpecification.FirstElementIndex = 0u;
+        clusterLightRangesViewSpecification.ElementCount = LightClusters::ClustersCount;
+        Renderer::SetStructuredBuffers(BP_TEX_NEXT_FREE + 1u, DL_PIXEL_SHADER_BIT, { m_SBClusterLightRanges }, { clusterLightRangesViewSpecification });
+
+        const uint32_t clusterLightIndicesCount{ static_cast<uint32_t>(m_LightClusters.GetLightIndices().size()) };
+        if (clusterLightIndicesCount > 0u)
+        {
+            BufferViewSpecification clusterLightIndicesViewSpecification{};
+            clusterLightIndicesViewSpecification.FirstElementIndex = 0u;
+            clusterLightIndicesViewSpecification.ElementCount = clusterLightIndicesCount;
+            Renderer::SetStructuredBuffers(BP_TEX_NEXT_FREE + 2u, DL_PIXEL_SHADER_BIT, { m_SBClusterLightIndices }, { clusterLightIndicesViewSpecification });
+        }
+
         Renderer::SetTexture2Ds(BP_TEX_GBUFFER_ALBEDO, DL_PIXEL_SHADER_BIT,
             {
                 m_GBufferAlbedo,
@@ -1318,7 +1414,7 @@ namespace DLEngine
 
     void SceneRenderer::SmokeParticlesPass()
     {
-        if (m_Scene->m_SmokeEnvironment.SortedSmokeParticles.empty())
+        if (m_Scene->m_SmokeEnvironment.VisibleSmokeParticlesCount == 0u)
             return;
 
         TextureViewSpecification defaultTextureViewSpecification{};
@@ -1361,6 +1457,66 @@ namespace DLEngine
         Renderer::SubmitFullscreenQuad();
     }
 
+    void SceneRenderer::RasterizeOccluders(const Camera& camera, const Math::Frustum& cameraFrustum)
+    {
+        m_OcclusionBuffer.Clear(camera.GetViewMatrix() * camera.GetProjectionMatrix());
+
+        struct OccluderCandidate
+        {
+            OcclusionBuffer::Occluder Occluder;
+            float ScreenSize;
+        };
+        std::vector<OccluderCandidate> candidates{};
+
+        // Dissolving and incinerating instances can be seen through, so only the opaque ones hide anything
+        for (const MeshRegistry::DrawBatch& drawBatch : m_Scene->m_MeshRegistry.GetDrawBatches("GBuffer_PBR_Static"))
+        {
+            const Submesh& submesh{ drawBatch.SourceMesh->GetSubmeshes()[drawBatch.SubmeshIndex] };
+            if (submesh.GetTriangles().size() > MAX_OCCLUDER_TRIANGLES)
+                continue;
+
+            // All the instances of a batch share the store, the ones without a transform are never culled and can not occlude
+            const MeshRegistry::InstanceBatch& instanceBatch{ *drawBatch.Batch };
+            if (instanceBatch.SubmeshInstances.empty() || !instanceBatch.Store->HasUniform("TRANSFORM"))
+                continue;
+
+            for (uint32_t i{ 0u }; i < instanceBatch.SubmeshInstances.size(); ++i)
+            {
+                const Math::AABB& boundingBox{ instanceBatch.WorldBoundingBoxes[i] };
+                if (!Math::Intersects(cameraFrustum, boundingBox))
+                    continue;
+
+                // Squared box diagonal over the squared distance to the box, a rough projected size
+                const Math::Vec3 diagonal{ boundingBox.Max - boundingBox.Min };
+                const Math::Vec3 toCenter{ (boundingBox.Min + boundingBox.Max) * 0.5f - camera.GetPosition() };
+                const float screenSize{ Math::Dot(diagonal, diagonal) / std::max(Math::Dot(toCenter, toCenter), 1.0e-4f) };
+                if (screenSize < MIN_OCCLUDER_SCREEN_SIZE)
+                    continue;
+
+                candidates.emplace_back(OccluderCandidate{
+                    .Occluder = OcclusionBuffer::Occluder{ .SourceSubmesh = &submesh, .MeshToWorld = instanceBatch.WorldTransforms[i] },
+                    .ScreenSize = screenSize
+                });
+            }
+        }
+
+        if (candidates.size() > MAX_OCCLUDERS)
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + MAX_OCCLUDERS, candidates.end(),
+                [](const OccluderCandidate& lhs, const OccluderCandidate& rhs) { return lhs.ScreenSize > rhs.ScreenSize; }
+            );
+            candidates.resize(MAX_OCCLUDERS);
+        }
+
+        std::vector<OcclusionBuffer::Occluder> occluders(candidates.size());
+        std::transform(candidates.begin(), candidates.end(), occluders.begin(),
+            [](const OccluderCandidate& candidate) { return candidate.Occluder; }
+        );
+
+        m_OcclusionBuffer.RasterizeOccluders(occluders);
+        m_Statistics.Occluders = static_cast<uint32_t>(occluders.size());
+    }
+
     void SceneRenderer::UpdateCBCamera(const Camera& camera)
     {
         CBCamera cameraData{};
@@ -1482,12 +1638,13 @@ namespace DLEngine
                 const auto& lightPOV{ directionalLightData.POV.GetViewMatrix() };
                 std::array<Math::Vec3, 8> lightPOVFrustumCorners{};
 
+                Math::TransformPoints(sceneCameraFrustum.Corners, lightPOV, lightPOVFrustumCorners);
+
                 Math::Vec3 lightPOVFrustumNearZ{ Math::Numeric::Max }, lightPOVFrustumFarZ{ -Math::Numeric::Max };
-                for (uint32_t cornerIndex{ 0u }; cornerIndex < sceneCameraFrustum.Corners.size(); ++cornerIndex)
+                for (const auto& lightPOVFrustumCorner : lightPOVFrustumCorners)
                 {
-                    lightPOVFrustumCorners[cornerIndex] = Math::PointToSpace(sceneCameraFrustum.Corners[cornerIndex], lightPOV);
-                    lightPOVFrustumNearZ = Math::Min(lightPOVFrustumNearZ, lightPOVFrustumCorners[cornerIndex]);
-                    lightPOVFrustumFarZ = Math::Max(lightPOVFrustumFarZ, lightPOVFrustumCorners[cornerIndex]);
+                    lightPOVFrustumNearZ = Math::Min(lightPOVFrustumNearZ, lightPOVFrustumCorner);
+                    lightPOVFrustumFarZ = Math::Max(lightPOVFrustumFarZ, lightPOVFrustumCorner);
                 }
 
                 Math::Vec3 lightPOVFrustumNearMinXY{ Math::Numeric::Max }, lightPOVFrustumNearMaxXY{ -Math::Numeric::Max };
@@ -1536,6 +1693,7 @@ namespace DLEngine
             m_SceneShadowEnvironment.SBPointLightsPOVs = StructuredBuffer::Create(sizeof(Math::Mat4x4), pointLightsCount * 6u);
 
         m_SceneShadowEnvironment.PointLightsData.resize(pointLightsCount);
+        m_PointLights.resize(pointLightsCount);
 
         auto pointLightsSB{ m_SBPointLights->Map().As<PointLight>() };
         auto pointLightsPOVsSB{ m_SceneShadowEnvironment.SBPointLightsPOVs->Map().As<Math::Mat4x4>() };
@@ -1543,13 +1701,14 @@ namespace DLEngine
         {
             auto& [light, meshUUID] { m_Scene->m_LightEnvironment.PointLights[i] };
 
-            const auto& transform{ m_Scene->m_MeshRegistry.GetInstance(meshUUID)->Get<Math::Mat4x4>("TRANSFORM") };
+            const auto& transform{ m_Scene->m_MeshRegistry.GetMeshToWorld(meshUUID) };
 
             PointLight transformedLight{ light };
             transformedLight.Position = Math::PointToSpace(light.Position, transform);
 
             // Upload point light data to the structured buffer
             pointLightsSB[i] = transformedLight;
+            m_PointLights[i] = transformedLight;
 
             // Update point light view and projection matrices
             {
@@ -1617,6 +1776,7 @@ namespace DLEngine
             m_SceneShadowEnvironment.SBSpotLightsPOVs = StructuredBuffer::Create(sizeof(Math::Mat4x4), spotLightsCount);
 
         m_SceneShadowEnvironment.SpotLightsData.resize(spotLightsCount);
+        m_SpotLights.resize(spotLightsCount);
 
         auto spotLightsSB{ m_SBSpotLights->Map().As<SpotLight>() };
         auto spotLightsPOVsSB{ m_SceneShadowEnvironment.SBSpotLightsPOVs->Map().As<Math::Mat4x4>() };
@@ -1624,13 +1784,14 @@ namespace DLEngine
         {
             auto& [light, meshUUID] { m_Scene->m_LightEnvironment.SpotLights[i] };
 
-            const auto& transform{ m_Scene->m_MeshRegistry.GetInstance(meshUUID)->Get<Math::Mat4x4>("TRANSFORM") };
+            const auto& transform{ m_Scene->m_MeshRegistry.GetMeshToWorld(meshUUID) };
 
             SpotLight transformedLight{ light };
             transformedLight.Position = Math::PointToSpace(light.Position, transform);
             transformedLight.Direction = Math::Normalize(Math::DirectionToSpace(light.Direction, transform));
 
             spotLightsSB[i] = transformedLight;
+            m_SpotLights[i] = transformedLight;
             
             // Update spot light view and projection matrices
             {
@@ -1655,12 +1816,46 @@ namespace DLEngine
         m_SBSpotLights->Unmap();
     }
 
+    void SceneRenderer::UpdateLightClusters(const Camera& camera)
+    {
+        m_LightClusters.Build(camera, m_PointLights, m_SpotLights, LIGHT_CONTRIBUTION_THRESHOLD);
+
+        const auto clusterLightRanges{ m_LightClusters.GetClusterLightRanges() };
+        const auto lightIndices{ m_LightClusters.GetLightIndices() };
+        const uint32_t lightIndicesCount{ static_cast<uint32_t>(lightIndices.size()) };
+
+        // Recreate light indices structured buffer if needed
+        if (m_SBClusterLightIndices->GetElementsCount() < lightIndicesCount)
+            m_SBClusterLightIndices = StructuredBuffer::Create(sizeof(uint32_t), lightIndicesCount);
+
+        auto clusterLightRangesSB{ m_SBClusterLightRanges->Map().As<LightClusters::ClusterLightRange>() };
+        std::ranges::copy(clusterLightRanges, clusterLightRangesSB);
+        m_SBClusterLightRanges->Unmap();
+
+        if (lightIndicesCount > 0u)
+        {
+            auto lightIndicesSB{ m_SBClusterLightIndices->Map().As<uint32_t>() };
+            std::ranges::copy(lightIndices, lightIndicesSB);
+            m_SBClusterLightIndices->Unmap();
+        }
+
+        CBLightsCount lightsCount{ *m_CBLightsCount->GetLocalData().As<CBLightsCount>() };
+        lightsCount.ClusterSliceScale = m_LightClusters.GetSliceScale();
+        lightsCount.ClusterSliceBias = m_LightClusters.GetSliceBias();
+        m_CBLightsCount->SetData(Buffer{ &lightsCount, sizeof(CBLightsCount) });
+
+        m_Statistics.ClusteredLightIndices = lightIndicesCount;
+    }
+
     void SceneRenderer::UpdateDecalsData()
     {
+        const Ref<InstanceStore>& decalStore{ m_Scene->m_DecalStore };
         const uint32_t decalsCount{ static_cast<uint32_t>(m_Scene->m_Decals.size()) };
         if (decalsCount == 0u)
             return;
 
+        DL_ASSERT(decalStore->GetInstanceCount() == decalsCount, "Decal store holds rows of removed decals");
+
         // Recreate decals instance buffer if needed
         const auto& transformBufferLayout{ m_DecalsTransformBuffer->GetLayout() };
         const size_t requiredDecalsTransformBufferSize{ transformBufferLayout.GetStride() * decalsCount };
@@ -1672,37 +1867,18 @@ namespace DLEngine
         if (m_DecalsInstanceBuffer->GetSize() != requiredDecalsInstanceBufferSize)
             m_DecalsInstanceBuffer = VertexBuffer::Create(instanceBufferLayout, requiredDecalsInstanceBufferSize);
 
-        auto* decalsTransformsBuffer{ m_DecalsTransformBuffer->Map().As<VBDecalTransform>() };
-        auto* decalsInstanceBuffer{ m_DecalsInstanceBuffer->Map().As<VBDecalInstance>() };
-        for (uint32_t decalIndex{ 0u }; decalIndex < decalsCount; ++decalIndex)
-        {
-            const auto& decal{ m_Scene->m_Decals[decalIndex] };
-
-            const Math::Mat4x4& decalToWorld{ decal.DecalInstance->Get<Math::Mat4x4>("DECAL_TO_WORLD") };
-            const Math::Mat4x4& worldToDecal{ decal.DecalInstance->Get<Math::Mat4x4>("WORLD_TO_DECAL") };
-            const Math::Vec3& decalTintColor{ decal.DecalInstance->Get<Math::Vec3>("DECAL_TINT_COLOR") };
-            const MeshRegistry::MeshUUID decalParentMeshUUID{ decal.DecalInstance->Get<MeshRegistry::MeshUUID>("PARENT_INSTANCE_UUID") };
-
-            VBDecalTransform gpuDecalTransform{};
-            gpuDecalTransform.DecalToWorld = decalToWorld;
-            gpuDecalTransform.WorldToDecal = worldToDecal;
-            decalsTransformsBuffer[decalIndex] = gpuDecalTransform;
-
-            VBDecalInstance gpuDecalInstance{};
-            gpuDecalInstance.TintColor = decalTintColor;
-            
-            gpuDecalInstance.ParentMeshInstanceUUID[0u] = reinterpret_cast<const uint32_t*>(&decalParentMeshUUID)[0u];
-            gpuDecalInstance.ParentMeshInstanceUUID[1u] = reinterpret_cast<const uint32_t*>(&decalParentMeshUUID)[1u];
-            
-            decalsInstanceBuffer[decalIndex] = gpuDecalInstance;
-        }
+        // The store holds the decals only and its columns are laid out as the instance buffers, so each buffer is filled by one copy
+        const Buffer decalTransforms{ decalStore->GetColumnData(1u) };
+        const Buffer decalInstances{ decalStore->GetColumnData(2u) };
+        m_DecalsTransformBuffer->Map().Write(decalTransforms.Data, decalTransforms.Size);
+        m_DecalsInstanceBuffer->Map().Write(decalInstances.Data, decalInstances.Size);
         m_DecalsTransformBuffer->Unmap();
         m_DecalsInstanceBuffer->Unmap();
     }
 
     void SceneRenderer::UpdateSmokeParticlesData()
     {
-        const uint32_t smokeParticlesCount{ static_cast<uint32_t>(m_Scene->m_SmokeEnvironment.SortedSmokeParticles.size()) };
+        const uint32_t smokeParticlesCount{ m_Scene->m_SmokeEnvironment.VisibleSmokeParticlesCount };
         
         if (smokeParticlesCount == 0u)
             return;
@@ -1713,28 +1889,30 @@ namespace DLEngine
         if (m_SmokeParticlesInstanceBuffer->GetSize() != requiredSmokeParticlesInstanceBufferSize)
             m_SmokeParticlesInstanceBuffer = VertexBuffer::Create(instanceBufferLayout, requiredSmokeParticlesInstanceBufferSize);
 
+        // Every sorted particle is written straight from the emitter streams into its slot of the mapped buffer
         auto* smokeParticlesInstanceBuffer{ m_SmokeParticlesInstanceBuffer->Map().As<VBSmokeParticle>() };
-        for (uint32_t sortedParticleIndex{ 0u }; sortedParticleIndex < smokeParticlesCount; ++sortedParticleIndex)
-        {
-            const auto& smokeParticleID{ m_Scene->m_SmokeEnvironment.SortedSmokeParticles[sortedParticleIndex] };
-            const uint32_t smokeEmitterIndex{ smokeParticleID.first };
-            const uint32_t smokeParticleIndex{ smokeParticleID.second };
-
-            const auto& smokeEmitter{ m_Scene->m_SmokeEnvironment.SmokeEmitters[smokeEmitterIndex].first };
-            const auto& smokeParticle{ smokeEmitter.Particles[smokeParticleIndex] };
-
-            VBSmokeParticle gpuSmokeParticle{};
-            gpuSmokeParticle.WorldPosition = smokeParticle.Position;
-            gpuSmokeParticle.TintColor = smokeEmitter.SpawnedParticleTintColor;
-            gpuSmokeParticle.InitialSize = smokeEmitter.InitialParticleSize;
-            gpuSmokeParticle.EndSize = smokeEmitter.FinalParticleSize;
-            gpuSmokeParticle.EmissionIntensity = smokeEmitter.ParticleEmissionIntensity;
-            gpuSmokeParticle.LifetimeMS = smokeParticle.LifetimeMS;
-            gpuSmokeParticle.LifetimePassedMS = smokeParticle.LifetimePassedMS;
-            gpuSmokeParticle.Rotation = smokeParticle.Rotation;
-
-            smokeParticlesInstanceBuffer[sortedParticleIndex] = gpuSmokeParticle;
-        }
+        const auto& sortedSmokeParticles{ m_Scene->m_SmokeEnvironment.SortedSmokeParticles };
+        std::for_each(std::execution::par, sortedSmokeParticles.begin(), sortedSmokeParticles.begin() + smokeParticlesCount,
+            [this, smokeParticlesInstanceBuffer, &sortedSmokeParticles](const auto& smokeParticleID)
+            {
+                const size_t sortedParticleIndex{ static_cast<size_t>(&smokeParticleID - sortedSmokeParticles.data()) };
+                const uint32_t smokeEmitterIndex{ smokeParticleID.first };
+                const uint32_t smokeParticleIndex{ smokeParticleID.second };
+
+                const auto& smokeEmitter{ m_Scene->m_SmokeEnvironment.SmokeEmitters[smokeEmitterIndex].first };
+                const auto& smokeParticles{ smokeEmitter.Particles };
+
+                auto& gpuSmokeParticle{ smokeParticlesInstanceBuffer[sortedParticleIndex] };
+                gpuSmokeParticle.WorldPosition = smokeParticles.GetPosition(smokeParticleIndex);
+                gpuSmokeParticle.TintColor = smokeEmitter.SpawnedParticleTintColor;
+                gpuSmokeParticle.InitialSize = smokeEmitter.InitialParticleSize;
+                gpuSmokeParticle.EndSize = smokeEmitter.FinalParticleSize;
+                gpuSmokeParticle.EmissionIntensity = smokeEmitter.ParticleEmissionIntensity;
+                gpuSmokeParticle.LifetimeMS = smokeParticles.GetLifetimeMS(smokeParticleIndex);
+                gpuSmokeParticle.LifetimePassedMS = smokeParticles.GetLifetimePassedMS(smokeParticleIndex);
+                gpuSmokeParticle.Rotation = smokeParticles.GetRotation(smokeParticleIndex);
+            }
+        );
         m_SmokeParticlesInstanceBuffer->Unmap();
     }
 
@@ -1,4 +1,6 @@
 #pragma once
+#include "DLEngine/Renderer/LightClusters.h"
+#include "DLEngine/Renderer/OcclusionBuffer.h"
 #include "DLEngine/Renderer/Pipeline.h"
 #include "DLEngine/Renderer/PipelineCompute.h"
 #include "DLEngine/Renderer/Scene.h"
@@ -93,6 +95,22 @@ namespace DLEngine
         bool ForceRecreateDirectionalLightShadowMaps{ false };
     };
 
+    // Instances that survived frustum culling in each pass, summed over all lights of the pass
+    struct SceneRendererStatistics
+    {
+        MeshRegistry::CullingStatistics GBufferPass;
+        MeshRegistry::CullingStatistics DirectionalShadowPass;
+        MeshRegistry::CullingStatistics PointShadowPass;
+        MeshRegistry::CullingStatistics SpotShadowPass;
+
+        uint32_t RenderedPointShadowFaces{ 0u };
+        uint32_t TotalPointShadowFaces{ 0u };
+
+        uint32_t Occluders{ 0u };
+
+        uint32_t ClusteredLightIndices{ 0u };
+    };
+
     struct SceneRendererSpecification
     {
         Ref<TextureCube> Skybox;
@@ -111,6 +129,8 @@ namespace DLEngine
         void SetPostProcessingSettings(const PostProcessingSettings& postProcessingSettings);
         void SetShadowMappingSettings(const ShadowMappingSettings& shadowMapSettings);
 
+        const SceneRendererStatistics& GetStatistics() const noexcept { return m_Statistics; }
+
     private:
         void Init();
 
@@ -129,10 +149,13 @@ namespace DLEngine
         void SmokeParticlesPass();
         void PostProcessPass();
 
+        void RasterizeOccluders(const Camera& camera, const Math::Frustum& cameraFrustum);
+
         void UpdateCBCamera(const Camera& camera);
         void UpdateDirectionalLightsData();
         void UpdatePointLightsData();
         void UpdateSpotLightsData();
+        void UpdateLightClusters(const Camera& camera);
 
         void UpdateDecalsData();
         void UpdateSmokeParticlesData();
@@ -144,6 +167,16 @@ namespace DLEngine
         SceneShadowEnvironment m_SceneShadowEnvironment;
 
         SceneEnvironment m_SceneEnvironment;
+
+        SceneRendererStatistics m_Statistics;
+
+        OcclusionBuffer m_OcclusionBuffer;
+
+        LightClusters m_LightClusters;
+
+        // World space copies of the lights uploaded this frame, input of the light clusters
+        std::vector<PointLight> m_PointLights;
+        std::vector<SpotLight> m_SpotLights;
         
         Ref<Scene> m_Scene;
 
@@ -158,6 +191,8 @@ namespace DLEngine
         Ref<StructuredBuffer> m_SBDirectionalLights;
         Ref<StructuredBuffer> m_SBPointLights;
         Ref<StructuredBuffer> m_SBSpotLights;
+        Ref<StructuredBuffer> m_SBClusterLightRanges;
+        Ref<StructuredBuffer> m_SBClusterLightIndices;
 
         Ref<Texture2D> m_GBufferAlbedo;
         Ref<Texture2D> m_GBufferMetalnessRoughness;
@@ -0,0 +1,230 @@
+#include "dlpch.h"
+#include "SmokeParticlePool.h"
+
+#if defined(DL_MATH_BACKEND_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace DLEngine
+{
+    namespace
+    {
+        // The update kernel works on packets of particles, eight wide with the AVX2 backend and four wide with DirectXMath otherwise
+#if defined(DL_MATH_BACKEND_AVX2)
+        constexpr uint32_t PACKET_SIZE{ 8u };
+        using Packet = __m256;
+
+        DL_FORCEINLINE Packet LoadPacket(const float* stream) noexcept { return _mm256_loadu_ps(stream); }
+        DL_FORCEINLINE void StorePacket(float* stream, Packet packet) noexcept { _mm256_storeu_ps(stream, packet); }
+
+        DL_FORCEINLINE Packet ReplicatePacket(float value) noexcept { return _mm256_set1_ps(value); }
+        DL_FORCEINLINE Packet AddPackets(Packet a, Packet b) noexcept { return _mm256_add_ps(a, b); }
+        DL_FORCEINLINE Packet MultiplyAddPackets(Packet a, Packet b, Packet c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+
+        // One bit per lane, set where a <= b
+        DL_FORCEINLINE uint32_t LessOrEqualMask(Packet a, Packet b) noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ))); }
+#else
+        constexpr uint32_t PACKET_SIZE{ 4u };
+        using Packet = DirectX::XMVECTOR;
+
+        DL_FORCEINLINE Packet LoadPacket(const float* stream) noexcept { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(stream)); }
+        DL_FORCEINLINE void StorePacket(float* stream, Packet packet) noexcept { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(stream), packet); }
+
+        DL_FORCEINLINE Packet ReplicatePacket(float value) noexcept { return DirectX::XMVectorReplicate(value); }
+        DL_FORCEINLINE Packet AddPackets(Packet a, Packet b) noexcept { return DirectX::XMVectorAdd(a, b); }
+        DL_FORCEINLINE Packet MultiplyAddPackets(Packet a, Packet b, Packet c) noexcept { return DirectX::XMVectorMultiplyAdd(a, b, c); }
+
+        // One bit per lane, set where a <= b
+        DL_FORCEINLINE uint32_t LessOrEqualMask(Packet a, Packet b) noexcept
+        {
+            DirectX::XMUINT4 mask;
+            DirectX::XMStoreUInt4(&mask, DirectX::XMVectorLessOrEqual(a, b));
+            return (mask.x & 1u) | (mask.y & 2u) | (mask.z & 4u) | (mask.w & 8u);
+        }
+#endif
+
+        constexpr uint32_t FULL_PACKET_MASK{ (1u << PACKET_SIZE) - 1u };
+    }
+
+    void SmokeParticlePool::Append(std::span<const SmokeParticle> particles)
+    {
+        const uint32_t firstIndex{ m_Size };
+        Resize(m_Size + static_cast<uint32_t>(particles.size()));
+
+        for (uint32_t i{ 0u }; i < static_cast<uint32_t>(particles.size()); ++i)
+        {
+            const auto& particle{ particles[i] };
+            const uint32_t index{ firstIndex + i };
+
+            m_PositionsX[index] = particle.Position.x;
+            m_PositionsY[index] = particle.Position.y;
+            m_PositionsZ[index] = particle.Position.z;
+            m_VelocitiesX[index] = particle.VelocityPerSecond.x;
+            m_VelocitiesY[index] = particle.VelocityPerSecond.y;
+            m_VelocitiesZ[index] = particle.VelocityPerSecond.z;
+            m_LifetimesMS[index] = particle.LifetimeMS;
+            m_LifetimesPassedMS[index] = particle.LifetimePassedMS;
+            m_Rotations[index] = particle.Rotation;
+        }
+    }
+
+    void SmokeParticlePool::Clear()
+    {
+        Resize(0u);
+
+        m_BlockIndicesAfterUpdate.clear();
+        m_SizeAfterUpdate = 0u;
+    }
+
+    void SmokeParticlePool::Update(DeltaTime dt)
+    {
+        const uint32_t blocksCount{ (m_Size + UpdateBlockSize - 1u) / UpdateBlockSize };
+        m_BlockAliveCounts.resize(blocksCount);
+        m_BlockOffsets.resize(blocksCount);
+        m_BlockIndicesAfterUpdate.resize(m_Size);
+
+        // Every block integrates its particles and compacts the survivors to its own beginning
+        std::for_each(std::execution::par, m_BlockAliveCounts.begin(), m_BlockAliveCounts.end(),
+            [this, dt](uint32_t& aliveCount)
+            {
+                const uint32_t begin{ static_cast<uint32_t>(&aliveCount - m_BlockAliveCounts.data()) * UpdateBlockSize };
+                const uint32_t end{ std::min(begin + UpdateBlockSize, m_Size) };
+                const uint32_t packedEnd{ begin + (end - begin) / PACKET_SIZE * PACKET_SIZE };
+
+                const Packet deltaTimeS{ ReplicatePacket(dt.GetSeconds()) };
+                const Packet deltaTimeMS{ ReplicatePacket(dt.GetMilliseconds()) };
+
+                uint32_t aliveIndex{ begin };
+                for (uint32_t i{ begin }; i < packedEnd; i += PACKET_SIZE)
+                {
+                    const Packet velocityX{ LoadPacket(m_VelocitiesX.data() + i) };
+                    const Packet velocityY{ LoadPacket(m_VelocitiesY.data() + i) };
+                    const Packet velocityZ{ LoadPacket(m_VelocitiesZ.data() + i) };
+
+                    const Packet positionX{ MultiplyAddPackets(velocityX, deltaTimeS, LoadPacket(m_PositionsX.data() + i)) };
+                    const Packet positionY{ MultiplyAddPackets(velocityY, deltaTimeS, LoadPacket(m_PositionsY.data() + i)) };
+                    const Packet positionZ{ MultiplyAddPackets(velocityZ, deltaTimeS, LoadPacket(m_PositionsZ.data() + i)) };
+
+                    const Packet lifetime{ LoadPacket(m_LifetimesMS.data() + i) };
+                    const Packet lifetimePassed{ AddPackets(LoadPacket(m_LifetimesPassedMS.data() + i), deltaTimeMS) };
+
+                    const uint32_t aliveMask{ LessOrEqualMask(lifetimePassed, lifetime) };
+                    if (aliveMask == FULL_PACKET_MASK)
+                    {
+                        StorePacket(m_PositionsX.data() + aliveIndex, positionX);
+                        StorePacket(m_PositionsY.data() + aliveIndex, positionY);
+                        StorePacket(m_PositionsZ.data() + aliveIndex, positionZ);
+                        StorePacket(m_LifetimesPassedMS.data() + aliveIndex, lifetimePassed);
+
+                        // Nothing expired so far in the block, the rest of the particle is already in place
+                        if (aliveIndex != i)
+                        {
+                            StorePacket(m_VelocitiesX.data() + aliveIndex, velocityX);
+                            StorePacket(m_VelocitiesY.data() + aliveIndex, velocityY);
+                            StorePacket(m_VelocitiesZ.data() + aliveIndex, velocityZ);
+                            StorePacket(m_LifetimesMS.data() + aliveIndex, lifetime);
+                            StorePacket(m_Rotations.data() + aliveIndex, LoadPacket(m_Rotations.data() + i));
+                        }
+
+                        for (uint32_t lane{ 0u }; lane < PACKET_SIZE; ++lane)
+                            m_BlockIndicesAfterUpdate[i + lane] = aliveIndex - begin + lane;
+
+                        aliveIndex += PACKET_SIZE;
+                        continue;
+                    }
+
+                    std::array<float, PACKET_SIZE> px, py, pz, vx, vy, vz, life, passed, rotation;
+                    StorePacket(px.data(), positionX);
+                    StorePacket(py.data(), positionY);
+                    StorePacket(pz.data(), positionZ);
+                    StorePacket(vx.data(), velocityX);
+                    StorePacket(vy.data(), velocityY);
+                    StorePacket(vz.data(), velocityZ);
+                    StorePacket(life.data(), lifetime);
+                    StorePacket(passed.data(), lifetimePassed);
+                    StorePacket(rotation.data(), LoadPacket(m_Rotations.data() + i));
+
+                    // Branchless compaction, aliveIndex never runs ahead of the lanes that were already loaded
+                    for (uint32_t lane{ 0u }; lane < PACKET_SIZE; ++lane)
+                    {
+                        const uint32_t isAlive{ (aliveMask >> lane) & 1u };
+
+                        m_PositionsX[aliveIndex] = px[lane];
+                        m_PositionsY[aliveIndex] = py[lane];
+                        m_PositionsZ[aliveIndex] = pz[lane];
+                        m_VelocitiesX[aliveIndex] = vx[lane];
+                        m_VelocitiesY[aliveIndex] = vy[lane];
+                        m_VelocitiesZ[aliveIndex] = vz[lane];
+                        m_LifetimesMS[aliveIndex] = life[lane];
+                        m_LifetimesPassedMS[aliveIndex] = passed[lane];
+                        m_Rotations[aliveIndex] = rotation[lane];
+                        m_BlockIndicesAfterUpdate[i + lane] = isAlive != 0u ? aliveIndex - begin : RemovedIndex;
+                        aliveIndex += isAlive;
+                    }
+                }
+
+                for (uint32_t i{ packedEnd }; i < end; ++i)
+                {
+                    const float lifetimePassed{ m_LifetimesPassedMS[i] + dt.GetMilliseconds() };
+                    if (lifetimePassed > m_LifetimesMS[i])
+                    {
+                        m_BlockIndicesAfterUpdate[i] = RemovedIndex;
+                        continue;
+                    }
+
+                    m_PositionsX[aliveIndex] = m_PositionsX[i] + m_VelocitiesX[i] * dt.GetSeconds();
+                    m_PositionsY[aliveIndex] = m_PositionsY[i] + m_VelocitiesY[i] * dt.GetSeconds();
+                    m_PositionsZ[aliveIndex] = m_PositionsZ[i] + m_VelocitiesZ[i] * dt.GetSeconds();
+                    m_VelocitiesX[aliveIndex] = m_VelocitiesX[i];
+                    m_VelocitiesY[aliveIndex] = m_VelocitiesY[i];
+                    m_VelocitiesZ[aliveIndex] = m_VelocitiesZ[i];
+                    m_LifetimesMS[aliveIndex] = m_LifetimesMS[i];
+                    m_LifetimesPassedMS[aliveIndex] = lifetimePassed;
+                    m_Rotations[aliveIndex] = m_Rotations[i];
+                    m_BlockIndicesAfterUpdate[i] = aliveIndex - begin;
+                    ++aliveIndex;
+                }
+
+                aliveCount = aliveIndex - begin;
+            }
+        );
+
+        // Join the survivors of the blocks, blocks without expired particles before them stay in place
+        uint32_t size{ 0u };
+        for (uint32_t block{ 0u }; block < blocksCount; ++block)
+        {
+            const uint32_t blockBegin{ block * UpdateBlockSize };
+            if (size != blockBegin)
+                MoveParticles(blockBegin, size, m_BlockAliveCounts[block]);
+
+            m_BlockOffsets[block] = size;
+            size += m_BlockAliveCounts[block];
+        }
+
+        Resize(size);
+        m_SizeAfterUpdate = size;
+    }
+
+    void SmokeParticlePool::Resize(uint32_t size)
+    {
+        m_PositionsX.resize(size);
+        m_PositionsY.resize(size);
+        m_PositionsZ.resize(size);
+        m_VelocitiesX.resize(size);
+        m_VelocitiesY.resize(size);
+        m_VelocitiesZ.resize(size);
+        m_LifetimesMS.resize(size);
+        m_LifetimesPassedMS.resize(size);
+        m_Rotations.resize(size);
+
+        m_Size = size;
+    }
+
+    void SmokeParticlePool::MoveParticles(uint32_t srcIndex, uint32_t dstIndex, uint32_t count) noexcept
+    {
+        DL_ASSERT(dstIndex <= srcIndex, "Particles are only moved towards the beginning of the pool");
+
+        for (auto* stream : { &m_PositionsX, &m_PositionsY, &m_PositionsZ, &m_VelocitiesX, &m_VelocitiesY, &m_VelocitiesZ, &m_LifetimesMS, &m_LifetimesPassedMS, &m_Rotations })
+            std::copy_n(stream->data() + srcIndex, count, stream->data() + dstIndex);
+    }
+}
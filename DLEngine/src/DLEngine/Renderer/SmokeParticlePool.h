@@ -0,0 +1,90 @@
+#pragma once
+#include "DLEngine/Math/Math.h"
+#include "DLEngine/Math/Vec3.h"
+
+#include "DLEngine/Utils/DeltaTime.h"
+
+namespace DLEngine
+{
+    struct SmokeParticle
+    {
+        Math::Vec3 Position{ 0.0f };
+        Math::Vec3 VelocityPerSecond{ 0.0f };
+        float Rotation{ 0.0f };
+        float LifetimeMS{ Math::Numeric::Max };
+        float LifetimePassedMS{ 0.0f };
+    };
+
+    // Structure of arrays storage for the particles of a smoke emitter. Every particle field lives in its own stream,
+    // so the update kernel processes four particles at a time with SIMD, eight with the AVX2 math backend, and only touches the fields it needs
+    class SmokeParticlePool
+    {
+    public:
+        static constexpr uint32_t RemovedIndex{ std::numeric_limits<uint32_t>::max() };
+
+    public:
+        uint32_t GetSize() const noexcept { return m_Size; }
+        bool IsEmpty() const noexcept { return m_Size == 0u; }
+
+        void Append(std::span<const SmokeParticle> particles);
+        void Clear();
+
+        // Moves the particles by their velocities and ages them. The expired particles are removed,
+        // the rest keep their relative order
+        void Update(DeltaTime dt);
+
+        // Index a particle had before the last update maps to after it, RemovedIndex if it expired.
+        // The particles appended since the last update start at GetSizeAfterUpdate
+        uint32_t GetUpdatedIndex(uint32_t indexBeforeUpdate) const noexcept
+        {
+            const uint32_t blockIndex{ m_BlockIndicesAfterUpdate[indexBeforeUpdate] };
+            return blockIndex == RemovedIndex ? RemovedIndex : m_BlockOffsets[indexBeforeUpdate / UpdateBlockSize] + blockIndex;
+        }
+        uint32_t GetSizeBeforeUpdate() const noexcept { return static_cast<uint32_t>(m_BlockIndicesAfterUpdate.size()); }
+        uint32_t GetSizeAfterUpdate() const noexcept { return m_SizeAfterUpdate; }
+
+        Math::Vec3 GetPosition(uint32_t index) const noexcept { return Math::Vec3{ m_PositionsX[index], m_PositionsY[index], m_PositionsZ[index] }; }
+        float GetRotation(uint32_t index) const noexcept { return m_Rotations[index]; }
+        float GetLifetimeMS(uint32_t index) const noexcept { return m_LifetimesMS[index]; }
+        float GetLifetimePassedMS(uint32_t index) const noexcept { return m_LifetimesPassedMS[index]; }
+
+        std::span<const float> GetPositionsX() const noexcept { return { m_PositionsX.data(), m_Size }; }
+        std::span<const float> GetPositionsY() const noexcept { return { m_PositionsY.data(), m_Size }; }
+        std::span<const float> GetPositionsZ() const noexcept { return { m_PositionsZ.data(), m_Size }; }
+
+    private:
+        // Particles updated by one task, small enough to balance the load and large enough to hide the task overhead
+        static constexpr uint32_t UpdateBlockSize{ 16384u };
+
+        static_assert(UpdateBlockSize % 8u == 0u, "Blocks are updated up to eight particles at a time");
+
+    private:
+        void Resize(uint32_t size);
+
+        // Moves count particles from srcIndex down to dstIndex in every stream
+        void MoveParticles(uint32_t srcIndex, uint32_t dstIndex, uint32_t count) noexcept;
+
+    private:
+        std::vector<float> m_PositionsX;
+        std::vector<float> m_PositionsY;
+        std::vector<float> m_PositionsZ;
+
+        std::vector<float> m_VelocitiesX;
+        std::vector<float> m_VelocitiesY;
+        std::vector<float> m_VelocitiesZ;
+
+        std::vector<float> m_LifetimesMS;
+        std::vector<float> m_LifetimesPassedMS;
+        std::vector<float> m_Rotations;
+
+        // Particles left alive in every update block, the blocks are compacted in parallel and then joined
+        std::vector<uint32_t> m_BlockAliveCounts;
+        std::vector<uint32_t> m_BlockOffsets;
+
+        // Index of every particle within its block after the last update, relative to the block offset
+        std::vector<uint32_t> m_BlockIndicesAfterUpdate;
+
+        uint32_t m_Size{ 0u };
+        uint32_t m_SizeAfterUpdate{ 0u };
+    };
+}
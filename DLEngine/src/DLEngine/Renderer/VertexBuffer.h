@@ -9,7 +9,8 @@ namespace DLEngine
     enum class VertexBufferUsage
     {
         None = 0,
-        Static, Dynamic
+        // Dynamic buffers are rewritten as a whole through Map, Updatable ones are patched in ranges through SetData
+        Static, Dynamic, Updatable
     };
 
     class VertexBuffer
@@ -20,6 +21,8 @@ namespace DLEngine
         virtual Buffer Map() = 0;
         virtual void Unmap() = 0;
 
+        virtual void SetData(const Buffer& buffer, size_t offset = 0u) = 0;
+
         virtual const VertexBufferLayout& GetLayout() const noexcept = 0;
         virtual size_t GetSize() const noexcept = 0;
 
@@ -1,5 +1,5 @@
 #include "Include/GBufferResources.hlsli"
-#include "Include/Lighting.hlsli"
+#include "Include/LightClusters.hlsli"
 
 struct VertexOutput
 {
@@ -57,7 +57,7 @@ float4 mainPS(VertexOutput psInput) : SV_TARGET
     if (!c_UseIBL)
         indirectLighting = c_IndirectLightingRadiance * albedo;
 
-    const float3 directLighting = CalculateDirectLighting(view, surface, worldPos.xyz);
+    const float3 directLighting = CalculateClusteredDirectLighting(view, surface, worldPos.xyz, psInput.v_TexCoords);
 
     return float4(indirectLighting + directLighting + emission, 1.0);
 }
\ No newline at end of file
@@ -55,6 +55,9 @@ cbuffer LightsCount : register(b4)
     uint c_DirectionalLightsCount;
     uint c_PointLightsCount;
     uint c_SpotLightsCount;
+    float c_ClusterSliceScale;
+    uint3 c_ClustersCount;
+    float c_ClusterSliceBias;
 };
 
 struct DirectionalLight
@@ -0,0 +1,44 @@
+#ifndef _LIGHT_CLUSTERS_HLSLI_
+#define _LIGHT_CLUSTERS_HLSLI_
+
+#include "Buffers.hlsli"
+#include "Lighting.hlsli"
+
+// Point lights of the cluster go first, then its spot lights
+struct ClusterLightRange
+{
+    uint Offset;
+    uint PointLightsCount;
+    uint SpotLightsCount;
+};
+StructuredBuffer<ClusterLightRange> t_ClusterLightRanges  : register(t21);
+StructuredBuffer<uint>              t_ClusterLightIndices : register(t22);
+
+uint CalculateClusterIndex(in const float2 texCoords, in const float viewDepth)
+{
+    const uint2 clusterXY = min(uint2(texCoords * float2(c_ClustersCount.xy)), c_ClustersCount.xy - 1u);
+    const uint clusterZ = uint(clamp(floor(log(viewDepth) * c_ClusterSliceScale + c_ClusterSliceBias), 0.0, float(c_ClustersCount.z - 1u)));
+
+    return (clusterZ * c_ClustersCount.y + clusterXY.y) * c_ClustersCount.x + clusterXY.x;
+}
+
+// Same as CalculateDirectLighting, but only the point and spot lights assigned to the cluster of the pixel are evaluated
+float3 CalculateClusteredDirectLighting(in const View view, in const Surface surface, in const float3 worldPos, in const float2 texCoords)
+{
+    float3 directLighting = DirectionalLightContribution(view, surface, worldPos);
+    
+    const float viewDepth = mul(float4(worldPos, 1.0), c_View).z;
+    const ClusterLightRange lightRange = t_ClusterLightRanges[CalculateClusterIndex(texCoords, viewDepth)];
+    
+    const uint pointLightsEnd = lightRange.Offset + lightRange.PointLightsCount;
+    for (uint i = lightRange.Offset; i < pointLightsEnd; ++i)
+        directLighting += PointLightContribution(view, surface, worldPos, t_ClusterLightIndices[i]);
+    
+    const uint spotLightsEnd = pointLightsEnd + lightRange.SpotLightsCount;
+    for (uint j = pointLightsEnd; j < spotLightsEnd; ++j)
+        directLighting += SpotLightContribution(view, surface, worldPos, t_ClusterLightIndices[j]);
+    
+    return directLighting;
+}
+
+#endif
\ No newline at end of file
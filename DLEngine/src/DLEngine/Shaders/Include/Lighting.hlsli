@@ -150,88 +150,92 @@ float3 DirectionalLightContribution(in const View view, in const Surface surface
     return directLighting;
 }
 
-float3 PointLightContribution(in const View view, in const Surface surface, in const float3 worldPos)
+float3 PointLightContribution(in const View view, in const Surface surface, in const float3 worldPos, in const uint pointLightIndex)
 {
-    float3 directLighting = float3(0.0, 0.0, 0.0);
-    
-    View currentView = view;
-    
-    for (uint pointLightIndex = 0; pointLightIndex < c_PointLightsCount; ++pointLightIndex)
-    {
-        const PointLight pointLight = t_PointLights[pointLightIndex];
+    const PointLight pointLight = t_PointLights[pointLightIndex];
         
-        const float3 lightWorldPos = pointLight.Position;
+    const float3 lightWorldPos = pointLight.Position;
         
-        const float sphereDist = max(length(lightWorldPos - worldPos), pointLight.Radius);
-        const float solidAngle = CalculateSphereSolidAngle(pointLight.Radius, sphereDist);
+    const float sphereDist = max(length(lightWorldPos - worldPos), pointLight.Radius);
+    const float solidAngle = CalculateSphereSolidAngle(pointLight.Radius, sphereDist);
 
-        const float3 sphereDir = normalize(lightWorldPos - worldPos);
-        const float sphereSin = pointLight.Radius / sphereDist;
-        const float sphereCos = sqrt(1.0 - sphereSin * sphereSin);
-        float3 lightDir = ApproximateClosestSphereDir(view.ReflectionDir, sphereCos, sphereDir * sphereDist, sphereDir, sphereDist, pointLight.Radius);
+    const float3 sphereDir = normalize(lightWorldPos - worldPos);
+    const float sphereSin = pointLight.Radius / sphereDist;
+    const float sphereCos = sqrt(1.0 - sphereSin * sphereSin);
+    float3 lightDir = ApproximateClosestSphereDir(view.ReflectionDir, sphereCos, sphereDir * sphereDist, sphereDir, sphereDist, pointLight.Radius);
         
-        float specularNoL = dot(surface.SurfaceNormal, lightDir);
-        ClampDirToHorizon(lightDir, specularNoL, surface.SurfaceNormal, Epsilon);
+    float specularNoL = dot(surface.SurfaceNormal, lightDir);
+    ClampDirToHorizon(lightDir, specularNoL, surface.SurfaceNormal, Epsilon);
 
-        // Plane equation: Ax + By + Cz + D = 0, where (A, B, C) is its normal.
-        const float geometryPlaneD = -dot(worldPos, surface.GeometryNormal);
-        const float geometryPlaneH = dot(lightWorldPos, surface.GeometryNormal) + geometryPlaneD;
-        const float geometryFalloff = saturate((geometryPlaneH + pointLight.Radius) / (2.0 * pointLight.Radius));
+    // Plane equation: Ax + By + Cz + D = 0, where (A, B, C) is its normal.
+    const float geometryPlaneD = -dot(worldPos, surface.GeometryNormal);
+    const float geometryPlaneH = dot(lightWorldPos, surface.GeometryNormal) + geometryPlaneD;
+    const float geometryFalloff = saturate((geometryPlaneH + pointLight.Radius) / (2.0 * pointLight.Radius));
         
-        const float surfacePlaneD = -dot(worldPos, surface.SurfaceNormal);
-        const float surfacePlaneH = dot(lightWorldPos, surface.SurfaceNormal) + surfacePlaneD;
-        const float surfaceFalloff = saturate((surfacePlaneH + pointLight.Radius) / (2.0 * pointLight.Radius));
+    const float surfacePlaneD = -dot(worldPos, surface.SurfaceNormal);
+    const float surfacePlaneH = dot(lightWorldPos, surface.SurfaceNormal) + surfacePlaneD;
+    const float surfaceFalloff = saturate((surfacePlaneH + pointLight.Radius) / (2.0 * pointLight.Radius));
 
-        const float falloff = geometryFalloff * surfaceFalloff;
+    const float falloff = geometryFalloff * surfaceFalloff;
         
-        currentView.NoL = max(max(dot(surface.SurfaceNormal, sphereDir), surfaceFalloff * sphereSin), Epsilon);
+    View currentView = view;
+    currentView.NoL = max(max(dot(surface.SurfaceNormal, sphereDir), surfaceFalloff * sphereSin), Epsilon);
         
-        Light light;
-        light.SpecularLightDir = lightDir;
-        light.Radiance = pointLight.Radiance;
-        light.SolidAngle = solidAngle;
+    Light light;
+    light.SpecularLightDir = lightDir;
+    light.Radiance = pointLight.Radiance;
+    light.SolidAngle = solidAngle;
 
-        float3 lightContribution = PBR_RenderingEquation(currentView, surface, light) * falloff;
+    float3 lightContribution = PBR_RenderingEquation(currentView, surface, light) * falloff;
         
-        if (c_UseOmnidirectionalShadows)
-            lightContribution *= VisibilityForPointLight(pointLightIndex, worldPos, surface.SurfaceNormal);
+    if (c_UseOmnidirectionalShadows)
+        lightContribution *= VisibilityForPointLight(pointLightIndex, worldPos, surface.SurfaceNormal);
 
-        directLighting += lightContribution;
-    }
-    
-    return directLighting;
+    return lightContribution;
 }
 
-float3 SpotLightContribution(in const View view, in const Surface surface, in const float3 worldPos)
+float3 PointLightContribution(in const View view, in const Surface surface, in const float3 worldPos)
 {
     float3 directLighting = float3(0.0, 0.0, 0.0);
     
-    View currentView = view;
+    for (uint pointLightIndex = 0; pointLightIndex < c_PointLightsCount; ++pointLightIndex)
+        directLighting += PointLightContribution(view, surface, worldPos, pointLightIndex);
     
-    for (uint spotLightIndex = 0; spotLightIndex < c_SpotLightsCount; ++spotLightIndex)
-    {
-        const SpotLight spotLight = t_SpotLights[spotLightIndex];
+    return directLighting;
+}
 
-        const float3 lightWorldPos = spotLight.Position;
-        const float3 lightDir = normalize(lightWorldPos - worldPos);
+float3 SpotLightContribution(in const View view, in const Surface surface, in const float3 worldPos, in const uint spotLightIndex)
+{
+    const SpotLight spotLight = t_SpotLights[spotLightIndex];
 
-        const float sphereDist = max(length(lightWorldPos - worldPos), spotLight.Radius);
-        const float solidAngle = CalculateSphereSolidAngle(spotLight.Radius, sphereDist);
+    const float3 lightWorldPos = spotLight.Position;
+    const float3 lightDir = normalize(lightWorldPos - worldPos);
 
-        currentView.NoL = max(dot(surface.SurfaceNormal, lightDir), Epsilon);
+    const float sphereDist = max(length(lightWorldPos - worldPos), spotLight.Radius);
+    const float solidAngle = CalculateSphereSolidAngle(spotLight.Radius, sphereDist);
+
+    View currentView = view;
+    currentView.NoL = max(dot(surface.SurfaceNormal, lightDir), Epsilon);
             
-        Light light;
-        light.SpecularLightDir = lightDir;
-        light.Radiance = spotLight.Radiance;
-        light.SolidAngle = solidAngle;
+    Light light;
+    light.SpecularLightDir = lightDir;
+    light.Radiance = spotLight.Radiance;
+    light.SolidAngle = solidAngle;
 
-        float3 lightContribution = PBR_RenderingEquation(currentView, surface, light) * CalclulateSpotLightCutoffIntensity(spotLight, lightDir);
+    float3 lightContribution = PBR_RenderingEquation(currentView, surface, light) * CalclulateSpotLightCutoffIntensity(spotLight, lightDir);
 
-        if (c_UseSpotShadows)
-            lightContribution *= VisibilityForSpotLight(spotLightIndex, worldPos, surface.SurfaceNormal);
+    if (c_UseSpotShadows)
+        lightContribution *= VisibilityForSpotLight(spotLightIndex, worldPos, surface.SurfaceNormal);
 
-        directLighting += lightContribution;
-    }
+    return lightContribution;
+}
+
+float3 SpotLightContribution(in const View view, in const Surface surface, in const float3 worldPos)
+{
+    float3 directLighting = float3(0.0, 0.0, 0.0);
+    
+    for (uint spotLightIndex = 0; spotLightIndex < c_SpotLightsCount; ++spotLightIndex)
+        directLighting += SpotLightContribution(view, surface, worldPos, spotLightIndex);
     
     return directLighting;
 }
@@ -4,6 +4,7 @@
 cbuffer OmnidirectionalLightShadowData : register(b5)
 {
     float4x4 c_ViewProjections[6];
+    uint     c_VisibleFacesMask;
 };
 
 struct VertexInput
@@ -57,6 +58,10 @@ void mainGS(triangle VertexOutput input[3], inout TriangleStream<GeometryOutput>
 {
     for (uint faceIndex = 0; faceIndex < 6; ++faceIndex)
     {
+        // Faces that no caster reaches are culled on the CPU
+        if ((c_VisibleFacesMask & (1u << faceIndex)) == 0u)
+            continue;
+
         for (uint vertexIndex = 0; vertexIndex < 3; ++vertexIndex)
         {
             GeometryOutput outputVertex;
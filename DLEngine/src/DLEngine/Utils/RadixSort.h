@@ -1,21 +1,26 @@
 #pragma once
-#include <functional>
+#include <array>
+#include <bit>
+#include <execution>
+#include <span>
+#include <thread>
 #include <vector>
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#include "DLEngine/Math/MathBackend.h"
+
 namespace DLEngine
 {
 #define PREFETCH 1
 
 #if PREFETCH
-#include <xmmintrin.h>	// for prefetch
 #define pfval	64
 #define pfval2	128
-#define pf(x)	_mm_prefetch(reinterpret_cast<const char*>(x + i + pfval), 0)
-#define pf2(x)	_mm_prefetch(reinterpret_cast<const char*>(x + i + pfval2), 0)
+#define pf(x)	DL_PREFETCH(x + i + pfval)
+#define pf2(x)	DL_PREFETCH(x + i + pfval2)
 #else
 #define pf(x)
 #define pf2(x)
@@ -29,13 +34,13 @@ namespace DLEngine
         //  if it's 1 (negative float), it flips all bits
         //  if it's 0 (positive float), it flips the sign only
         // ================================================================================================
-        __forceinline uint32_t FloatFlip(uint32_t f)
+        DL_FORCEINLINE uint32_t FloatFlip(uint32_t f)
         {
             uint32_t mask = -int32_t(f >> 31) | 0x80000000;
             return f ^ mask;
         }
 
-        __forceinline void FloatFlipX(uint32_t& f)
+        DL_FORCEINLINE void FloatFlipX(uint32_t& f)
         {
             uint32_t mask = -int32_t(f >> 31) | 0x80000000;
             f ^= mask;
@@ -47,7 +52,7 @@ namespace DLEngine
         //  if sign is 1 (negative), it flips the sign bit back
         //  if sign is 0 (positive), it flips all bits back
         // ================================================================================================
-        __forceinline uint32_t IFloatFlip(uint32_t f)
+        DL_FORCEINLINE uint32_t IFloatFlip(uint32_t f)
         {
             uint32_t mask = ((f >> 31) - 1) | 0x80000000;
             return f ^ mask;
@@ -58,108 +63,6 @@ namespace DLEngine
 #define _1(x)	(x >> 11 & 0x7FF)
 #define _2(x)	(x >> 22 )
 
-#if 0
-        template <typename T>
-        void FloatRadixSort(const std::vector<T>& arr, std::vector<T>& sortedArr, const std::function<float(const T&)>& floatKeyExtractor)
-        {
-            const uint32_t elementsCount{ static_cast<uint32_t>(arr.size()) };
-            sortedArr.reserve(elementsCount);
-            sortedArr.clear();
-
-            std::vector<uint32_t> sortedKeys(elementsCount);
-            std::vector<uint32_t> keys(elementsCount);
-            std::unordered_map<float, uint32_t> keyToIndexMap;
-            keyToIndexMap.reserve(elementsCount);
-
-            for (uint32_t i = 0; i < elementsCount; ++i)
-            {
-                float key{ floatKeyExtractor(arr[i]) };
-         
-                keyToIndexMap[key] = i;
-                keys[i] = reinterpret_cast<uint32_t&>(key);
-            }
-
-            // 3 histograms on the stack:
-            constexpr uint32_t kHist{ 2048u };
-            uint32_t b0[kHist * 3u]{};
-
-            uint32_t* b1{ b0 + kHist };
-            uint32_t* b2{ b1 + kHist };
-
-            memset(b0, 0u, kHist * 3u * sizeof(uint32_t));
-
-            // 1. parallel histogramming pass
-            //
-            for (uint32_t i{ 0u }; i < elementsCount; ++i)
-            {
-                pf(keys.data());
-
-                uint32_t fi{ Utils::FloatFlip(keys[i]) };
-
-                b0[_0(fi)]++;
-                b1[_1(fi)]++;
-                b2[_2(fi)]++;
-            }
-
-            // 2. Sum the histograms -- each histogram entry records the number of values preceding itself.
-            {
-                uint32_t sum0{ 0u }, sum1{ 0u }, sum2{ 0u };
-                uint32_t tsum;
-                for (uint32_t i{ 0u }; i < kHist; ++i)
-                {
-
-                    tsum = b0[i] + sum0;
-                    b0[i] = sum0 - 1;
-                    sum0 = tsum;
-
-                    tsum = b1[i] + sum1;
-                    b1[i] = sum1 - 1;
-                    sum1 = tsum;
-
-                    tsum = b2[i] + sum2;
-                    b2[i] = sum2 - 1;
-                    sum2 = tsum;
-                }
-            }
-
-            // byte 0: floatflip entire value, read/write histogram, write out flipped
-            for (uint32_t i{ 0u }; i < elementsCount; ++i)
-            {
-
-                uint32_t fi{ keys[i] };
-                Utils::FloatFlipX(fi);
-                uint32_t pos{ _0(fi) };
-
-                pf2(keys.data());
-                sortedKeys[++b0[pos]] = fi;
-            }
-
-            // byte 1: read/write histogram, copy
-            //   sorted -> array
-            for (uint32_t i{ 0u }; i < elementsCount; ++i)
-            {
-                uint32_t si{ sortedKeys[i] };
-                uint32_t pos{ _1(si) };
-            
-                pf2(sortedKeys.data());
-                keys[++b1[pos]] = si;
-            }
-
-            // byte 2: read/write histogram, copy & flip out
-            //   array -> sorted
-            for (uint32_t i{ 0u }; i < elementsCount; ++i)
-            {
-                uint32_t ai{ keys[i] };
-                uint32_t pos{ _2(ai) };
-
-                pf2(keys.data());
-                sortedKeys[++b2[pos]] = Utils::IFloatFlip(ai);
-            }
-
-            for (uint32_t i{ 0u }; i < elementsCount; ++i)
-                sortedArr.push_back(arr[keyToIndexMap[reinterpret_cast<float&>(sortedKeys[i])]]);
-        }
-#endif
         static void RadixSort11(float* farray, float* sorted, uint32_t elements)
         {
             uint32_t i;
@@ -244,5 +147,301 @@ namespace DLEngine
             // to write original:
             memcpy(array, sorted, elements * 4);
         }
+
+        template <typename Key>
+        struct RadixSortKey;
+
+        // Maps the key to unsigned bits that keep the order of the keys
+        template <>
+        struct RadixSortKey<float>
+        {
+            using Bits = uint32_t;
+            static Bits ToBits(float key) noexcept { return FloatFlip(std::bit_cast<uint32_t>(key)); }
+        };
+
+        template <>
+        struct RadixSortKey<uint32_t>
+        {
+            using Bits = uint32_t;
+            static Bits ToBits(uint32_t key) noexcept { return key; }
+        };
+
+        template <>
+        struct RadixSortKey<uint64_t>
+        {
+            using Bits = uint64_t;
+            static Bits ToBits(uint64_t key) noexcept { return key; }
+        };
+
+        template <typename Key>
+        concept RadixSortable = requires(Key key) { RadixSortKey<Key>::ToBits(key); };
+
+        // ================================================================================================
+        // Stable LSD radix sort of keys together with their payloads, 11 bits per pass.
+        //  keys and payloads are sorted in place in ascending order of the keys,
+        //  the scratch spans are used as the second buffer of every pass and must be at least as large.
+        //  Passes where all the keys share the same digit are skipped.
+        // ================================================================================================
+        template <RadixSortable Key, typename Payload>
+        void RadixSort(std::span<Key> keys, std::span<Payload> payloads, std::span<Key> keysScratch, std::span<Payload> payloadsScratch)
+        {
+            using KeyTraits = RadixSortKey<Key>;
+            using Bits = typename KeyTraits::Bits;
+
+            constexpr uint32_t kDigitBits{ 11u };
+            constexpr uint32_t kHist{ 1u << kDigitBits };
+            constexpr uint32_t kPasses{ (sizeof(Bits) * 8u + kDigitBits - 1u) / kDigitBits };
+
+            DL_ASSERT(keys.size() == payloads.size(), "Every key must have a payload");
+            DL_ASSERT(keysScratch.size() >= keys.size() && payloadsScratch.size() >= payloads.size(), "Scratch buffers are too small");
+
+            const size_t elements{ keys.size() };
+            if (elements < 2u)
+                return;
+
+            const auto digit{ [](Bits bits, uint32_t pass) { return static_cast<uint32_t>(bits >> (pass * kDigitBits)) & (kHist - 1u); } };
+
+            // 1.  histograms of all passes in a single read
+            std::array<std::array<uint32_t, kHist>, kPasses> histograms{};
+            for (size_t i{ 0u }; i < elements; ++i)
+            {
+                pf(keys.data());
+
+                const Bits bits{ KeyTraits::ToBits(keys[i]) };
+                for (uint32_t pass{ 0u }; pass < kPasses; ++pass)
+                    ++histograms[pass][digit(bits, pass)];
+            }
+
+            Key* srcKeys{ keys.data() };
+            Key* dstKeys{ keysScratch.data() };
+            Payload* srcPayloads{ payloads.data() };
+            Payload* dstPayloads{ payloadsScratch.data() };
+
+            for (uint32_t pass{ 0u }; pass < kPasses; ++pass)
+            {
+                auto& histogram{ histograms[pass] };
+                if (histogram[digit(KeyTraits::ToBits(srcKeys[0u]), pass)] == elements)
+                    continue;
+
+                // 2.  each histogram entry records the number of values preceding itself
+                uint32_t sum{ 0u };
+                for (auto& bucket : histogram)
+                {
+                    const uint32_t count{ bucket };
+                    bucket = sum;
+                    sum += count;
+                }
+
+                // 3.  scatter keys with their payloads to the other buffer
+                for (size_t i{ 0u }; i < elements; ++i)
+                {
+                    pf2(srcKeys);
+
+                    const uint32_t pos{ histogram[digit(KeyTraits::ToBits(srcKeys[i]), pass)]++ };
+                    dstKeys[pos] = srcKeys[i];
+                    dstPayloads[pos] = srcPayloads[i];
+                }
+
+                std::swap(srcKeys, dstKeys);
+                std::swap(srcPayloads, dstPayloads);
+            }
+
+            if (srcKeys != keys.data())
+            {
+                std::copy(srcKeys, srcKeys + elements, keys.data());
+                std::copy(srcPayloads, srcPayloads + elements, payloads.data());
+            }
+        }
+
+        // ================================================================================================
+        // Multi-threaded version of RadixSort with the same contract, falls back to it for small arrays.
+        //  The array is split into one contiguous chunk per hardware thread. Every pass counts per chunk
+        //  histograms in parallel, merges them into per chunk output offsets with a prefix sum and
+        //  scatters the chunks in parallel. Scattered elements are staged in small per digit
+        //  write-combining buffers so the writes to the other buffer go out in whole cache lines.
+        //  8 bits per pass keep the write-combining buffers of a chunk in the L1/L2 cache.
+        // ================================================================================================
+        template <RadixSortable Key, typename Payload>
+        void RadixSortParallel(std::span<Key> keys, std::span<Payload> payloads, std::span<Key> keysScratch, std::span<Payload> payloadsScratch)
+        {
+            using KeyTraits = RadixSortKey<Key>;
+            using Bits = typename KeyTraits::Bits;
+
+            constexpr size_t kParallelThreshold{ 1u << 16u };
+
+            constexpr uint32_t kDigitBits{ 8u };
+            constexpr uint32_t kHist{ 1u << kDigitBits };
+            constexpr uint32_t kPasses{ sizeof(Bits) * 8u / kDigitBits };
+            constexpr uint32_t kWriteCombiningElements{ 16u };
+
+            const size_t elements{ keys.size() };
+            const size_t chunksCount{ std::max(std::thread::hardware_concurrency(), 1u) };
+            if (elements < kParallelThreshold || chunksCount == 1u)
+            {
+                RadixSort(keys, payloads, keysScratch, payloadsScratch);
+                return;
+            }
+
+            DL_ASSERT(keys.size() == payloads.size(), "Every key must have a payload");
+            DL_ASSERT(keysScratch.size() >= keys.size() && payloadsScratch.size() >= payloads.size(), "Scratch buffers are too small");
+
+            const auto digit{ [](Bits bits, uint32_t pass) { return static_cast<uint32_t>(bits >> (pass * kDigitBits)) & (kHist - 1u); } };
+
+            struct Chunk
+            {
+                size_t Begin{ 0u };
+                size_t End{ 0u };
+
+                std::array<uint32_t, kHist> Offsets;
+                std::array<uint32_t, kHist> BufferedCounts;
+                std::array<std::array<Key, kWriteCombiningElements>, kHist> BufferedKeys;
+                std::array<std::array<Payload, kWriteCombiningElements>, kHist> BufferedPayloads;
+            };
+
+            const size_t chunkSize{ (elements + chunksCount - 1u) / chunksCount };
+
+            std::vector<Chunk> chunks(chunksCount);
+            for (size_t i{ 0u }; i < chunksCount; ++i)
+            {
+                chunks[i].Begin = std::min(i * chunkSize, elements);
+                chunks[i].End = std::min(chunks[i].Begin + chunkSize, elements);
+            }
+
+            Key* srcKeys{ keys.data() };
+            Key* dstKeys{ keysScratch.data() };
+            Payload* srcPayloads{ payloads.data() };
+            Payload* dstPayloads{ payloadsScratch.data() };
+
+            for (uint32_t pass{ 0u }; pass < kPasses; ++pass)
+            {
+                // 1.  per chunk histograms
+                std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+                    [&](Chunk& chunk)
+                    {
+                        chunk.Offsets.fill(0u);
+                        for (size_t i{ chunk.Begin }; i < chunk.End; ++i)
+                            ++chunk.Offsets[digit(KeyTraits::ToBits(srcKeys[i]), pass)];
+                    }
+                );
+
+                // 2.  merge: the output of a digit in a chunk starts after the same digit of the previous chunks
+                //     and after all smaller digits of every chunk
+                std::array<uint32_t, kHist> totals{};
+                for (const auto& chunk : chunks)
+                    for (uint32_t d{ 0u }; d < kHist; ++d)
+                        totals[d] += chunk.Offsets[d];
+
+                if (totals[digit(KeyTraits::ToBits(srcKeys[0u]), pass)] == elements)
+                    continue;
+
+                uint32_t sum{ 0u };
+                for (uint32_t d{ 0u }; d < kHist; ++d)
+                {
+                    for (auto& chunk : chunks)
+                    {
+                        const uint32_t count{ chunk.Offsets[d] };
+                        chunk.Offsets[d] = sum;
+                        sum += count;
+                    }
+                }
+
+                // 3.  parallel scatter through the write-combining buffers
+                std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+                    [&](Chunk& chunk)
+                    {
+                        chunk.BufferedCounts.fill(0u);
+
+                        const auto flush{ [&](uint32_t d, uint32_t count)
+                            {
+                                std::copy_n(chunk.BufferedKeys[d].data(), count, dstKeys + chunk.Offsets[d]);
+                                std::copy_n(chunk.BufferedPayloads[d].data(), count, dstPayloads + chunk.Offsets[d]);
+                                chunk.Offsets[d] += count;
+                            }
+                        };
+
+                        for (size_t i{ chunk.Begin }; i < chunk.End; ++i)
+                        {
+                            const uint32_t d{ digit(KeyTraits::ToBits(srcKeys[i]), pass) };
+                            uint32_t& buffered{ chunk.BufferedCounts[d] };
+
+                            chunk.BufferedKeys[d][buffered] = srcKeys[i];
+                            chunk.BufferedPayloads[d][buffered] = srcPayloads[i];
+
+                            if (++buffered == kWriteCombiningElements)
+                            {
+                                flush(d, kWriteCombiningElements);
+                                buffered = 0u;
+                            }
+                        }
+
+                        for (uint32_t d{ 0u }; d < kHist; ++d)
+                            flush(d, chunk.BufferedCounts[d]);
+                    }
+                );
+
+                std::swap(srcKeys, dstKeys);
+                std::swap(srcPayloads, dstPayloads);
+            }
+
+            if (srcKeys != keys.data())
+            {
+                std::copy(std::execution::par, srcKeys, srcKeys + elements, keys.data());
+                std::copy(std::execution::par, srcPayloads, srcPayloads + elements, payloads.data());
+            }
+        }
+
+        // ================================================================================================
+        // Restores the ascending order of nearly sorted keys with their payloads, e.g. last frame order with updated keys.
+        //  An insertion sort with two bounds: no element is moved more than maxDisplacement places back, and all the
+        //  elements together are moved at most maxShiftsPerElement places per element. Elements already in order cost
+        //  one comparison, so the repair stays a few streaming passes over the data while the keys barely changed.
+        //  Returns false as soon as a bound is exceeded, the keys keep their payloads but are left partly sorted then
+        //  and have to be sorted from scratch
+        // ================================================================================================
+        template <RadixSortable Key, typename Payload>
+        bool RepairSortedOrder(std::span<Key> keys, std::span<Payload> payloads, size_t maxDisplacement, float maxShiftsPerElement)
+        {
+            DL_ASSERT(keys.size() == payloads.size(), "Every key must have a payload");
+
+            const size_t elements{ keys.size() };
+            const size_t maxShiftsCount{ static_cast<size_t>(static_cast<float>(elements) * maxShiftsPerElement) };
+
+            size_t shiftsCount{ 0u };
+            for (size_t i{ 1u }; i < elements; ++i)
+            {
+                if (!(keys[i] < keys[i - 1u]))
+                    continue;
+
+                const Key key{ keys[i] };
+                const Payload payload{ payloads[i] };
+                const size_t lowestIndex{ i > maxDisplacement ? i - maxDisplacement : 0u };
+
+                size_t j{ i };
+                for (; j > lowestIndex && key < keys[j - 1u]; --j)
+                {
+                    keys[j] = keys[j - 1u];
+                    payloads[j] = payloads[j - 1u];
+                }
+
+                keys[j] = key;
+                payloads[j] = payload;
+
+                shiftsCount += i - j;
+                if (shiftsCount > maxShiftsCount || (j > 0u && key < keys[j - 1u]))
+                    return false;
+            }
+
+            return true;
+        }
     }
-}
\ No newline at end of file
+}
+
+// The helpers above are only meant for the sorts in this header
+#undef _0
+#undef _1
+#undef _2
+#undef pf
+#undef pf2
+#undef pfval
+#undef pfval2
+#undef PREFETCH
@@ -0,0 +1,150 @@
+#include "dlpch.h"
+#include "RandomStream.h"
+
+#include <bit>
+
+namespace DLEngine
+{
+    namespace
+    {
+        constexpr uint64_t GOLDEN_GAMMA{ 0x9E3779B97F4A7C15ull };
+
+        // SplitMix64 finalizer
+        constexpr uint64_t Mix(uint64_t value) noexcept
+        {
+            value = (value ^ (value >> 30u)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27u)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31u);
+        }
+
+        constexpr uint64_t Hash(uint64_t key, uint64_t counter) noexcept
+        {
+            return Mix(key + (counter + 1u) * GOLDEN_GAMMA);
+        }
+
+        // The upper 23 bits become the mantissa of a float in [1, 2), which is then moved to [0, 1)
+        constexpr uint32_t UnitFloatBits(uint32_t bits) noexcept
+        {
+            return (bits >> 9u) | 0x3F800000u;
+        }
+
+        DirectX::XMVECTOR UnitFloats(const std::array<uint32_t, 4u>& bits) noexcept
+        {
+            const std::array<uint32_t, 4u> floatBits{
+                UnitFloatBits(bits[0u]), UnitFloatBits(bits[1u]), UnitFloatBits(bits[2u]), UnitFloatBits(bits[3u])
+            };
+
+            return DirectX::XMVectorSubtract(DirectX::XMLoadInt4(floatBits.data()), DirectX::XMVectorReplicate(1.0f));
+        }
+
+        // Four unit vectors from the hashes of the counters counter, counter + stride, ...
+        void UnitVectors(uint64_t key, uint64_t counter, uint64_t stride, DirectX::XMVECTOR& x, DirectX::XMVECTOR& y, DirectX::XMVECTOR& z) noexcept
+        {
+            using namespace DirectX;
+
+            std::array<uint32_t, 4u> zBits, angleBits;
+            for (uint32_t lane{ 0u }; lane < 4u; ++lane)
+            {
+                const uint64_t hash{ Hash(key, counter + lane * stride) };
+                zBits[lane] = static_cast<uint32_t>(hash);
+                angleBits[lane] = static_cast<uint32_t>(hash >> 32u);
+            }
+
+            // Uniform z and angle around it give a uniform distribution on the sphere
+            const XMVECTOR one{ XMVectorReplicate(1.0f) };
+            z = XMVectorMultiplyAdd(UnitFloats(zBits), XMVectorReplicate(2.0f), XMVectorNegate(one));
+            const XMVECTOR angle{ XMVectorScale(UnitFloats(angleBits), 2.0f * Math::Numeric::Pi) };
+
+            XMVECTOR sin, cos;
+            XMVectorSinCos(&sin, &cos, angle);
+
+            const XMVECTOR radius{ XMVectorSqrt(XMVectorMax(XMVectorNegativeMultiplySubtract(z, z, one), XMVectorZero())) };
+            x = XMVectorMultiply(radius, cos);
+            y = XMVectorMultiply(radius, sin);
+        }
+
+        void StoreVectors(std::span<Math::Vec3> vectors, size_t index, DirectX::FXMVECTOR x, DirectX::FXMVECTOR y, DirectX::FXMVECTOR z) noexcept
+        {
+            DirectX::XMFLOAT4 xs, ys, zs;
+            DirectX::XMStoreFloat4(&xs, x);
+            DirectX::XMStoreFloat4(&ys, y);
+            DirectX::XMStoreFloat4(&zs, z);
+
+            const size_t count{ std::min<size_t>(4u, vectors.size() - index) };
+            for (size_t lane{ 0u }; lane < count; ++lane)
+                vectors[index + lane] = Math::Vec3{ (&xs.x)[lane], (&ys.x)[lane], (&zs.x)[lane] };
+        }
+    }
+
+    RandomStream::RandomStream(uint64_t seed, uint64_t streamIndex) noexcept
+        : m_Key(Mix(Mix(seed + GOLDEN_GAMMA) + streamIndex))
+    {}
+
+    float RandomStream::GenerateFloat(float min, float max) noexcept
+    {
+        const uint32_t bits{ UnitFloatBits(static_cast<uint32_t>(Hash(m_Key, m_Counter++) >> 32u)) };
+        return min + (std::bit_cast<float>(bits) - 1.0f) * (max - min);
+    }
+
+    void RandomStream::GenerateFloats(std::span<float> values, float min, float max) noexcept
+    {
+        using namespace DirectX;
+
+        const XMVECTOR scale{ XMVectorReplicate(max - min) };
+        const XMVECTOR offset{ XMVectorReplicate(min) };
+
+        // Lanes past the end of the span are computed and dropped, the counter only advances by the values written
+        for (size_t i{ 0u }; i < values.size(); i += 4u)
+        {
+            std::array<uint32_t, 4u> bits;
+            for (uint32_t lane{ 0u }; lane < 4u; ++lane)
+                bits[lane] = static_cast<uint32_t>(Hash(m_Key, m_Counter + i + lane) >> 32u);
+
+            XMFLOAT4 result;
+            XMStoreFloat4(&result, XMVectorMultiplyAdd(UnitFloats(bits), scale, offset));
+            std::copy_n(&result.x, std::min<size_t>(4u, values.size() - i), values.data() + i);
+        }
+
+        m_Counter += values.size();
+    }
+
+    void RandomStream::GenerateUnitVectors(std::span<Math::Vec3> vectors) noexcept
+    {
+        for (size_t i{ 0u }; i < vectors.size(); i += 4u)
+        {
+            DirectX::XMVECTOR x, y, z;
+            UnitVectors(m_Key, m_Counter + i, 1u, x, y, z);
+            StoreVectors(vectors, i, x, y, z);
+        }
+
+        m_Counter += vectors.size();
+    }
+
+    void RandomStream::GeneratePointsInSphere(std::span<Math::Vec3> points, float radius) noexcept
+    {
+        using namespace DirectX;
+
+        const XMVECTOR oneThird{ XMVectorReplicate(1.0f / 3.0f) };
+        const XMVECTOR sphereRadius{ XMVectorReplicate(radius) };
+
+        // Every point takes two counters, one for the direction and one for the distance
+        for (size_t i{ 0u }; i < points.size(); i += 4u)
+        {
+            const uint64_t counter{ m_Counter + 2u * i };
+
+            XMVECTOR x, y, z;
+            UnitVectors(m_Key, counter, 2u, x, y, z);
+
+            std::array<uint32_t, 4u> distanceBits;
+            for (uint32_t lane{ 0u }; lane < 4u; ++lane)
+                distanceBits[lane] = static_cast<uint32_t>(Hash(m_Key, counter + 2u * lane + 1u) >> 32u);
+
+            // The cube root keeps the density uniform over the volume
+            const XMVECTOR distance{ XMVectorMultiply(XMVectorExp2(XMVectorMultiply(XMVectorLog2(UnitFloats(distanceBits)), oneThird)), sphereRadius) };
+
+            StoreVectors(points, i, XMVectorMultiply(x, distance), XMVectorMultiply(y, distance), XMVectorMultiply(z, distance));
+        }
+
+        m_Counter += 2u * points.size();
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "DLEngine/Math/Vec3.h"
+
+namespace DLEngine
+{
+    // Counter based random number generator. The n-th value of a stream is a hash of the stream key and n,
+    // so a stream is replayed exactly from its seed and no state is shared between the streams.
+    // The batch functions generate four values at a time with SIMD
+    class RandomStream
+    {
+    public:
+        // Streams with the same seed and different indices are independent
+        explicit RandomStream(uint64_t seed = 0u, uint64_t streamIndex = 0u) noexcept;
+
+        uint64_t GetCounter() const noexcept { return m_Counter; }
+        void Skip(uint64_t count) noexcept { m_Counter += count; }
+
+        // Uniformly distributed in [min, max)
+        float GenerateFloat(float min, float max) noexcept;
+        void GenerateFloats(std::span<float> values, float min, float max) noexcept;
+
+        // Uniformly distributed on the unit sphere
+        void GenerateUnitVectors(std::span<Math::Vec3> vectors) noexcept;
+
+        // Uniformly distributed in the ball of the given radius around the origin
+        void GeneratePointsInSphere(std::span<Math::Vec3> points, float radius) noexcept;
+
+    private:
+        uint64_t m_Key;
+        uint64_t m_Counter{ 0u };
+    };
+}
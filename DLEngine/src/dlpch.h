@@ -17,6 +17,7 @@
 #include <array>
 #include <map>
 #include <set>
+#include <span>
 #include <stack>
 #include <string_view>
 #include <string>
@@ -33,12 +34,16 @@
 #include "DLEngine/Math/Vec3.h"
 #include "DLEngine/Math/Vec4.h"
 
-#include "DLEngine/Core/Application.h"
 #include "DLEngine/Core/Assert.h"
 #include "DLEngine/Core/Base.h"
 #include "DLEngine/Core/Buffer.h"
+
+// The window, the input and the HRESULT exceptions are Windows only, the math and geometry sources also build without them
+#if defined(_WIN32)
+#include "DLEngine/Core/Application.h"
 #include "DLEngine/Core/DLException.h"
 #include "DLEngine/Core/Input.h"
+#endif
 
 #include "DLEngine/Utils/DeltaTime.h"
 #include "DLEngine/Utils/RandomGenerator.h"
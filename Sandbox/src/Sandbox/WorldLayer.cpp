@@ -121,6 +121,26 @@ void WorldLayer::OnImGuiRender()
         ImGui::Text(std::format("Time (s): {0:.2f}", m_Time).c_str());
         ImGui::Text(std::format("Delta time (ms): {0:.2f}", m_DeltaTime).c_str());
         ImGui::Text(std::format("Overall Particles Count: {0}", m_Scene->GetOverallParticlesCount()).c_str());
+
+        const auto& rendererStatistics{ m_SceneRenderer->GetStatistics() };
+        const auto cullingText{ [](std::string_view passName, const DLEngine::MeshRegistry::CullingStatistics& statistics)
+            {
+                return std::format("{0} instances: {1} / {2}", passName, statistics.VisibleInstances, statistics.TotalInstances);
+            }
+        };
+        ImGui::Text(cullingText("GBuffer", rendererStatistics.GBufferPass).c_str());
+        ImGui::Text(std::format("Occluders: {0}", rendererStatistics.Occluders).c_str());
+        ImGui::Text(cullingText("Directional shadow", rendererStatistics.DirectionalShadowPass).c_str());
+        ImGui::Text(cullingText("Point shadow", rendererStatistics.PointShadowPass).c_str());
+        ImGui::Text(std::format("Point shadow faces: {0} / {1}", rendererStatistics.RenderedPointShadowFaces, rendererStatistics.TotalPointShadowFaces).c_str());
+        ImGui::Text(cullingText("Spot shadow", rendererStatistics.SpotShadowPass).c_str());
+        ImGui::Text(std::format("Clustered light indices: {0}", rendererStatistics.ClusteredLightIndices).c_str());
+
+        const auto& uploadStatistics{ m_Scene->GetMeshRegistry().GetUploadStatistics() };
+        ImGui::Text(std::format("Instance uploads (KB): {0:.2f} in {1} ranges", uploadStatistics.UploadedBytes / 1024.0, uploadStatistics.UploadedRanges).c_str());
+        ImGui::Text(std::format("Gathered instance ranges: {0}", uploadStatistics.GatheredRanges).c_str());
+        ImGui::Text(std::format("Instance buffer reallocations: {0}", uploadStatistics.ReallocatedBuffers).c_str());
+        ImGui::Text(std::format("Released instance views: {0}", uploadStatistics.ReleasedViews).c_str());
     }
 
     if (ImGui::CollapsingHeader("Settings"))
@@ -266,6 +286,10 @@ void WorldLayer::OnImGuiRender()
 
         if (ImGui::Button("Clear Smoke Emitters"))
             m_Scene->ClearSmokeEmitters();
+
+        bool incrementalParticlesSort{ m_Scene->IsSmokeSortIncremental() };
+        if (ImGui::Checkbox("Incremental Particles Sort", &incrementalParticlesSort))
+            m_Scene->SetSmokeSortIncremental(incrementalParticlesSort);
     }
 
     ImGui::End();
@@ -754,6 +778,7 @@ void WorldLayer::AddObjectsToScene()
         sceneMeshRegistry.AddSubmesh(cube, 0u, pbrCobblestoneMaterial, instance);
 #else
 
+        std::vector<DLEngine::MeshRegistry::SubmeshEntry> cubes{};
         for (int32_t x{ -5 }; x < 5; ++x)
         {
             for (int32_t z{ -5 }; z < 5; ++z)
@@ -772,9 +797,16 @@ void WorldLayer::AddObjectsToScene()
                 else
                     pbrMaterial = pbrMetalSteelMaterial;
 
-                sceneMeshRegistry.AddSubmesh(cube, 0u, pbrMaterial, instance);
+                cubes.emplace_back(DLEngine::MeshRegistry::SubmeshEntry{
+                    .SourceMesh = cube,
+                    .SubmeshIndex = 0u,
+                    .SourceMaterial = pbrMaterial,
+                    .SubmeshInstance = instance
+                });
             }
         }
+
+        sceneMeshRegistry.AddSubmeshes(cubes);
 #endif
 
     }
@@ -960,12 +992,14 @@ bool WorldLayer::OnKeyPressedEvent(DLEngine::KeyPressedEvent& e)
         ray.Direction = DLEngine::Math::Normalize(camera.ConstructFrustumPosNoTranslation(cursorPosNDC));
 
         auto& sceneMeshRegistry{ m_Scene->GetMeshRegistry() };
+        sceneMeshRegistry.UpdateInstanceBVH();
+
         DLEngine::MeshRegistry::IntersectInfo intersectInfo{};
         if (DLEngine::Math::Intersects(ray, sceneMeshRegistry, intersectInfo))
         {
             const DLEngine::Ref<DLEngine::Instance>& intersectedInstance{ sceneMeshRegistry.GetInstance(intersectInfo.UUID) };
             if (intersectedInstance->GetShader()->GetName() != "GBuffer_PBR_Static" ||
-                intersectedInstance->GetName() == "PBR_Static Flashlight Instance")
+                intersectInfo.UUID == m_FlashlightMeshUUID)
             {
                 return false;
             }
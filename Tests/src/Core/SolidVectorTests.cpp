@@ -0,0 +1,201 @@
+#include "TestFramework.h"
+
+#include "DLEngine/Core/solid_vector.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        using Record = solid_vector<uint32_t, float, std::string>;
+
+        // Every column of the element holds a value derived from the same key, so a column left behind by an erase is caught
+        Record::ID InsertRecord(Record& records, uint32_t key)
+        {
+            return records.insert(key, static_cast<float>(key) * 0.5f, std::to_string(key));
+        }
+
+        bool IsRecordOf(const Record& records, Record::ID id, uint32_t key)
+        {
+            return records.get<0u>(id) == key && records.get<1u>(id) == static_cast<float>(key) * 0.5f && records.get<2u>(id) == std::to_string(key);
+        }
+    }
+
+    DL_TEST(DefaultIDIsNeverContained)
+    {
+        solid_vector<uint32_t> values{};
+        DL_CHECK(!values.contains(solid_vector_id{}));
+
+        values.insert(1u);
+        DL_CHECK(!values.contains(solid_vector_id{}));
+        DL_CHECK(!values.contains(solid_vector_id{ .Slot = 0u, .Generation = 0u }));
+    }
+
+    DL_TEST(StaleIDIsRejectedAfterItsSlotIsReused)
+    {
+        solid_vector<uint32_t> values{};
+        const solid_vector_id staleID{ values.insert(1u) };
+        values.erase(staleID);
+        DL_CHECK(!values.contains(staleID));
+
+        // The freed slot is taken by the next insert under a new generation
+        const solid_vector_id id{ values.insert(2u) };
+        DL_CHECK(id.Slot == staleID.Slot);
+        DL_CHECK(id.Generation != staleID.Generation);
+        DL_CHECK(values.contains(id));
+        DL_CHECK(!values.contains(staleID));
+        DL_CHECK(values[id] == 2u);
+    }
+
+    DL_TEST(ClearInvalidatesEveryID)
+    {
+        solid_vector<uint32_t> values{};
+        const std::array<solid_vector_id, 3u> ids{ values.insert(1u), values.insert(2u), values.insert(3u) };
+        values.clear();
+
+        DL_CHECK(values.empty());
+        for (const solid_vector_id id : ids)
+            DL_CHECK(!values.contains(id));
+
+        const solid_vector_id id{ values.insert(4u) };
+        DL_CHECK(values.contains(id));
+        DL_CHECK(std::ranges::find(ids, id) == ids.end());
+    }
+
+    DL_TEST(EraseMovesTheLastElementIntoTheHole)
+    {
+        solid_vector<uint32_t> values{};
+        std::vector<solid_vector_id> ids{};
+        for (uint32_t i{ 0u }; i < 5u; ++i)
+            ids.push_back(values.insert(i));
+
+        values.erase(ids[1u]);
+
+        DL_CHECK(values.size() == 4u);
+        DL_CHECK(std::ranges::equal(values.column(), std::array{ 0u, 4u, 2u, 3u }));
+        DL_CHECK(values.getIndex(ids[4u]) == 1u);
+        DL_CHECK(values.getID(1u) == ids[4u]);
+        DL_CHECK(values[ids[4u]] == 4u);
+
+        // Erasing the last element moves nothing
+        values.erase(ids[3u]);
+
+        DL_CHECK(std::ranges::equal(values.column(), std::array{ 0u, 4u, 2u }));
+        DL_CHECK(values.getIndex(ids[2u]) == 2u);
+    }
+
+    // The index view is handed out with the columns as spans, it has to agree with the vector and reject stale IDs the same way
+    DL_TEST(IndicesResolveIDsLikeTheVector)
+    {
+        solid_vector<uint32_t> values{};
+        std::vector<solid_vector_id> ids{};
+        for (uint32_t i{ 0u }; i < 4u; ++i)
+            ids.push_back(values.insert(i));
+        values.erase(ids[0u]);
+
+        const solid_vector_indices indices{ values.indices() };
+        DL_CHECK(!indices.contains(ids[0u]));
+        DL_CHECK(!indices.contains(solid_vector_id{}));
+
+        for (uint32_t i{ 1u }; i < 4u; ++i)
+        {
+            DL_CHECK(indices.contains(ids[i]));
+            DL_CHECK(indices.getIndex(ids[i]) == values.getIndex(ids[i]));
+            DL_CHECK(values.column()[indices.getIndex(ids[i])] == i);
+        }
+    }
+
+    DL_TEST(InsertRangeMatchesInsertingOneByOne)
+    {
+        const std::array<uint32_t, 4u> keys{ 7u, 3u, 9u, 1u };
+        const std::array<float, 4u> weights{ 0.5f, 1.5f, 2.5f, 3.5f };
+
+        solid_vector<uint32_t, float> oneByOne{};
+        std::vector<solid_vector_id> oneByOneIDs{};
+        for (size_t i{ 0u }; i < keys.size(); ++i)
+            oneByOneIDs.push_back(oneByOne.insert(keys[i], weights[i]));
+
+        solid_vector<uint32_t, float> range{};
+        const std::vector<solid_vector_id> rangeIDs{ range.insert_range(std::span<const uint32_t>{ keys }, std::span<const float>{ weights }) };
+
+        DL_CHECK(rangeIDs == oneByOneIDs);
+        DL_CHECK(range.capacity() >= static_cast<uint32_t>(keys.size()));
+        DL_CHECK(std::ranges::equal(range.column<0u>(), keys));
+        DL_CHECK(std::ranges::equal(range.column<1u>(), weights));
+
+        for (size_t i{ 0u }; i < keys.size(); ++i)
+        {
+            DL_CHECK(range.get<0u>(rangeIDs[i]) == keys[i]);
+            DL_CHECK(range.get<1u>(rangeIDs[i]) == weights[i]);
+        }
+    }
+
+    DL_TEST(InsertRangeOfNothingAddsNothing)
+    {
+        solid_vector<uint32_t, float> values{};
+        values.insert(1u, 1.0f);
+
+        const std::vector<solid_vector_id> ids{ values.insert_range(std::span<const uint32_t>{}, std::span<const float>{}) };
+
+        DL_CHECK(ids.empty());
+        DL_CHECK(values.size() == 1u);
+    }
+
+    DL_TEST(ColumnsStayInStepAfterErases)
+    {
+        constexpr uint32_t RECORDS_COUNT{ 1000u };
+
+        Record records{};
+        std::vector<Record::ID> ids{};
+        for (uint32_t key{ 0u }; key < RECORDS_COUNT; ++key)
+            ids.push_back(InsertRecord(records, key));
+
+        // Every third record goes, in an order that moves elements from all over the arrays
+        std::vector<uint32_t> erasedKeys{};
+        for (uint32_t key{ 0u }; key < RECORDS_COUNT; key += 3u)
+            erasedKeys.push_back((key * 577u) % RECORDS_COUNT);
+        std::ranges::sort(erasedKeys);
+        erasedKeys.erase(std::ranges::unique(erasedKeys).begin(), erasedKeys.end());
+        std::ranges::reverse(erasedKeys);
+
+        for (const uint32_t key : erasedKeys)
+            records.erase(ids[key]);
+
+        DL_CHECK(records.size() == RECORDS_COUNT - static_cast<uint32_t>(erasedKeys.size()));
+
+        for (uint32_t key{ 0u }; key < RECORDS_COUNT; ++key)
+        {
+            const bool isErased{ std::ranges::find(erasedKeys, key) != erasedKeys.end() };
+            DL_CHECK(records.contains(ids[key]) != isErased);
+            if (!isErased)
+                DL_CHECK(IsRecordOf(records, ids[key], key));
+        }
+
+        // The dense arrays and the IDs agree at every index
+        for (uint32_t index{ 0u }; index < records.size(); ++index)
+        {
+            const Record::ID id{ records.getID(index) };
+            DL_CHECK(records.getIndex(id) == index);
+            DL_CHECK(IsRecordOf(records, id, records.column<0u>()[index]));
+        }
+
+        uint32_t visitedCount{ 0u };
+        records.for_each(std::execution::seq, [&](Record::ID id, uint32_t key, float weight, const std::string& name)
+            {
+                ++visitedCount;
+                DL_CHECK(ids[key] == id);
+                DL_CHECK(weight == static_cast<float>(key) * 0.5f);
+                DL_CHECK(name == std::to_string(key));
+            }
+        );
+        DL_CHECK(visitedCount == records.size());
+
+        // Reinserting fills the freed slots, the new elements are consistent as well and the old IDs stay stale
+        for (const uint32_t key : erasedKeys)
+        {
+            const Record::ID id{ InsertRecord(records, RECORDS_COUNT + key) };
+            DL_CHECK(!records.contains(ids[key]));
+            DL_CHECK(IsRecordOf(records, id, RECORDS_COUNT + key));
+        }
+        DL_CHECK(records.size() == RECORDS_COUNT);
+    }
+}
@@ -0,0 +1,181 @@
+#include "TestFramework.h"
+
+#include "DLEngine/Math/BatchTransform.h"
+#include "DLEngine/Math/Mat4A.h"
+
+#include "DLEngine/Utils/RandomStream.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        // Odd, so the kernels working on pairs also run their last element alone
+        constexpr uint32_t ELEMENTS_COUNT{ 37u };
+        constexpr float TOLERANCE{ 1.0e-4f };
+
+        Math::Mat4x4 RandomTransform(RandomStream& random)
+        {
+            const Math::Vec3 axis{ Math::Normalize(Math::Vec3{ random.GenerateFloat(-1.0f, 1.0f), random.GenerateFloat(-1.0f, 1.0f), random.GenerateFloat(0.1f, 1.0f) }) };
+            const Math::Vec3 scale{ random.GenerateFloat(0.5f, 2.0f), random.GenerateFloat(0.5f, 2.0f), random.GenerateFloat(0.5f, 2.0f) };
+            const Math::Vec3 translation{ random.GenerateFloat(-10.0f, 10.0f), random.GenerateFloat(-10.0f, 10.0f), random.GenerateFloat(-10.0f, 10.0f) };
+
+            return Math::Mat4x4::Scale(scale) * Math::Mat4x4::Rotate(axis, random.GenerateFloat(0.0f, Math::Numeric::Pi)) * Math::Mat4x4::Translate(translation);
+        }
+
+        std::vector<Math::Mat4x4> RandomTransforms(RandomStream& random)
+        {
+            std::vector<Math::Mat4x4> transforms(ELEMENTS_COUNT);
+            std::ranges::generate(transforms, [&random] { return RandomTransform(random); });
+            return transforms;
+        }
+
+        std::vector<Math::Vec3> RandomVectors(RandomStream& random)
+        {
+            std::vector<Math::Vec3> vectors(ELEMENTS_COUNT);
+            std::ranges::generate(vectors, [&random] { return Math::Vec3{ random.GenerateFloat(-5.0f, 5.0f), random.GenerateFloat(-5.0f, 5.0f), random.GenerateFloat(-5.0f, 5.0f) }; });
+            return vectors;
+        }
+
+        std::vector<Math::AABB> RandomAABBs(RandomStream& random)
+        {
+            const std::vector<Math::Vec3> centers{ RandomVectors(random) };
+
+            std::vector<Math::AABB> aabbs(ELEMENTS_COUNT);
+            std::ranges::transform(centers, aabbs.begin(), [&random](const Math::Vec3& center)
+            {
+                const Math::Vec3 extents{ random.GenerateFloat(0.1f, 2.0f), random.GenerateFloat(0.1f, 2.0f), random.GenerateFloat(0.1f, 2.0f) };
+                return Math::AABB{ .Min = center - extents, .Max = center + extents };
+            });
+            return aabbs;
+        }
+
+        bool NearlyEqual(const Math::Vec3& lhs, const Math::Vec3& rhs)
+        {
+            return Math::Length(lhs - rhs) <= TOLERANCE * std::max(1.0f, Math::Length(rhs));
+        }
+
+        bool NearlyEqual(const Math::AABB& lhs, const Math::AABB& rhs)
+        {
+            return NearlyEqual(lhs.Min, rhs.Min) && NearlyEqual(lhs.Max, rhs.Max);
+        }
+
+        bool NearlyEqual(const Math::Mat4x4& lhs, const Math::Mat4x4& rhs)
+        {
+            for (uint32_t row{ 0u }; row < 4u; ++row)
+                for (uint32_t column{ 0u }; column < 4u; ++column)
+                    if (std::abs(lhs.m[row][column] - rhs.m[row][column]) > TOLERANCE * std::max(1.0f, std::abs(rhs.m[row][column])))
+                        return false;
+
+            return true;
+        }
+
+        template <typename T>
+        bool AllNearlyEqual(std::span<const T> lhs, std::span<const T> rhs)
+        {
+            return std::ranges::equal(lhs, rhs, [](const T& l, const T& r) { return NearlyEqual(l, r); });
+        }
+    }
+
+    // Every kernel against the same math done one element at a time through Mat4A
+    DL_TEST(BatchTransformsMatchMat4A)
+    {
+        RandomStream random{ 17u };
+        const std::vector<Math::Mat4x4> transforms{ RandomTransforms(random) };
+        const std::vector<Math::Mat4x4> otherTransforms{ RandomTransforms(random) };
+        const std::vector<Math::Vec3> vectors{ RandomVectors(random) };
+        const std::vector<Math::AABB> aabbs{ RandomAABBs(random) };
+        const Math::Mat4x4& shared{ otherTransforms.front() };
+
+        std::vector<Math::Vec3> expectedVectors(ELEMENTS_COUNT), outVectors(ELEMENTS_COUNT);
+        std::vector<Math::AABB> expectedAABBs(ELEMENTS_COUNT), outAABBs(ELEMENTS_COUNT);
+        std::vector<Math::Mat4x4> expectedMatrices(ELEMENTS_COUNT), outMatrices(ELEMENTS_COUNT);
+
+        std::ranges::transform(vectors, expectedVectors.begin(), [&shared](const Math::Vec3& v) { return Math::Mat4A{ shared }.TransformPoint(Math::Vec3A{ v }).Store(); });
+        Math::TransformPoints(vectors, shared, outVectors);
+        DL_CHECK(AllNearlyEqual<Math::Vec3>(outVectors, expectedVectors));
+
+        std::ranges::transform(vectors, transforms, expectedVectors.begin(), [](const Math::Vec3& v, const Math::Mat4x4& m) { return Math::Mat4A{ m }.TransformPoint(Math::Vec3A{ v }).Store(); });
+        Math::TransformPoints(vectors, transforms, outVectors);
+        DL_CHECK(AllNearlyEqual<Math::Vec3>(outVectors, expectedVectors));
+
+        std::ranges::transform(vectors, expectedVectors.begin(), [&shared](const Math::Vec3& v) { return Math::Mat4A{ shared }.TransformDirection(Math::Vec3A{ v }).Store(); });
+        Math::TransformDirections(vectors, shared, outVectors);
+        DL_CHECK(AllNearlyEqual<Math::Vec3>(outVectors, expectedVectors));
+
+        std::ranges::transform(vectors, transforms, expectedVectors.begin(), [](const Math::Vec3& v, const Math::Mat4x4& m) { return Math::Mat4A{ m }.TransformDirection(Math::Vec3A{ v }).Store(); });
+        Math::TransformDirections(vectors, transforms, outVectors);
+        DL_CHECK(AllNearlyEqual<Math::Vec3>(outVectors, expectedVectors));
+
+        std::ranges::transform(aabbs, expectedAABBs.begin(), [&shared](const Math::AABB& aabb) { return Math::Mat4A{ shared }.TransformAABB(aabb); });
+        Math::TransformAABBs(aabbs, shared, outAABBs);
+        DL_CHECK(AllNearlyEqual<Math::AABB>(outAABBs, expectedAABBs));
+
+        std::ranges::transform(aabbs, transforms, expectedAABBs.begin(), [](const Math::AABB& aabb, const Math::Mat4x4& m) { return Math::Mat4A{ m }.TransformAABB(aabb); });
+        Math::TransformAABBs(aabbs, transforms, outAABBs);
+        DL_CHECK(AllNearlyEqual<Math::AABB>(outAABBs, expectedAABBs));
+
+        std::ranges::transform(transforms, expectedAABBs.begin(), [&aabbs](const Math::Mat4x4& m) { return Math::Mat4A{ m }.TransformAABB(aabbs.front()); });
+        Math::TransformAABB(aabbs.front(), transforms, outAABBs);
+        DL_CHECK(AllNearlyEqual<Math::AABB>(outAABBs, expectedAABBs));
+
+        std::ranges::transform(transforms, expectedMatrices.begin(), [&shared](const Math::Mat4x4& m) { return (Math::Mat4A{ m } * Math::Mat4A{ shared }).Store(); });
+        Math::MultiplyMatrices(transforms, shared, outMatrices);
+        DL_CHECK(AllNearlyEqual<Math::Mat4x4>(outMatrices, expectedMatrices));
+
+        std::ranges::transform(transforms, otherTransforms, expectedMatrices.begin(), [](const Math::Mat4x4& l, const Math::Mat4x4& r) { return (Math::Mat4A{ l } * Math::Mat4A{ r }).Store(); });
+        Math::MultiplyMatrices(transforms, otherTransforms, outMatrices);
+        DL_CHECK(AllNearlyEqual<Math::Mat4x4>(outMatrices, expectedMatrices));
+
+        std::ranges::transform(transforms, expectedMatrices.begin(), [](const Math::Mat4x4& m) { return Math::Mat4A::Inverse(Math::Mat4A{ m }).Store(); });
+        Math::InverseMatrices(transforms, outMatrices);
+        DL_CHECK(AllNearlyEqual<Math::Mat4x4>(outMatrices, expectedMatrices));
+    }
+
+    // The outputs may alias the inputs, callers transform their arrays in place
+    DL_TEST(BatchTransformsWorkInPlace)
+    {
+        RandomStream random{ 29u };
+        const std::vector<Math::Mat4x4> transforms{ RandomTransforms(random) };
+        const std::vector<Math::Mat4x4> otherTransforms{ RandomTransforms(random) };
+        const std::vector<Math::AABB> aabbs{ RandomAABBs(random) };
+
+        std::vector<Math::AABB> expectedAABBs(ELEMENTS_COUNT);
+        Math::TransformAABBs(aabbs, transforms, expectedAABBs);
+
+        std::vector<Math::AABB> inPlaceAABBs{ aabbs };
+        Math::TransformAABBs(inPlaceAABBs, transforms, inPlaceAABBs);
+        DL_CHECK(AllNearlyEqual<Math::AABB>(inPlaceAABBs, expectedAABBs));
+
+        std::vector<Math::Mat4x4> expectedMatrices(ELEMENTS_COUNT);
+        Math::MultiplyMatrices(transforms, otherTransforms, expectedMatrices);
+
+        std::vector<Math::Mat4x4> inPlaceLhs{ transforms };
+        Math::MultiplyMatrices(inPlaceLhs, otherTransforms, inPlaceLhs);
+        DL_CHECK(AllNearlyEqual<Math::Mat4x4>(inPlaceLhs, expectedMatrices));
+
+        std::vector<Math::Mat4x4> inPlaceRhs{ otherTransforms };
+        Math::MultiplyMatrices(transforms, inPlaceRhs, inPlaceRhs);
+        DL_CHECK(AllNearlyEqual<Math::Mat4x4>(inPlaceRhs, expectedMatrices));
+    }
+
+    // The kernels write exactly the elements of the output span, the neighbours of an unpadded Vec3 or AABB are left alone
+    DL_TEST(BatchTransformsStayInsideTheirSpans)
+    {
+        RandomStream random{ 41u };
+        const std::vector<Math::Mat4x4> transforms{ RandomTransforms(random) };
+        const std::vector<Math::Vec3> vectors{ RandomVectors(random) };
+
+        constexpr float GUARD{ 12345.0f };
+
+        std::vector<Math::Vec3> outVectors(ELEMENTS_COUNT + 2u, Math::Vec3{ GUARD });
+        Math::TransformPoints(vectors, transforms.front(), std::span{ outVectors }.subspan(1u, ELEMENTS_COUNT));
+        DL_CHECK(NearlyEqual(outVectors.front(), Math::Vec3{ GUARD }));
+        DL_CHECK(NearlyEqual(outVectors.back(), Math::Vec3{ GUARD }));
+
+        const Math::AABB guardAABB{ .Min = Math::Vec3{ GUARD }, .Max = Math::Vec3{ GUARD } };
+        std::vector<Math::AABB> outAABBs(ELEMENTS_COUNT + 2u, guardAABB);
+        Math::TransformAABB(RandomAABBs(random).front(), transforms, std::span{ outAABBs }.subspan(1u, ELEMENTS_COUNT));
+        DL_CHECK(NearlyEqual(outAABBs.front(), guardAABB));
+        DL_CHECK(NearlyEqual(outAABBs.back(), guardAABB));
+    }
+}
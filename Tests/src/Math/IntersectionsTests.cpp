@@ -0,0 +1,204 @@
+#include "TestFramework.h"
+
+#include "DLEngine/Math/Distance.h"
+#include "DLEngine/Math/Intersections.h"
+#include "DLEngine/Math/Math.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        constexpr float NEAR_Z{ 0.1f };
+        constexpr float FAR_Z{ 10.0f };
+
+        Math::AABB BoxAt(const Math::Vec3& center, float halfSize)
+        {
+            return Math::AABB{ .Min = center - Math::Vec3{ halfSize }, .Max = center + Math::Vec3{ halfSize } };
+        }
+
+        Math::Frustum FrustumLookingTo(const Math::Vec3& forward, const Math::Vec3& up)
+        {
+            const Math::Mat4x4 view{ Math::Mat4x4::LookTo(Math::Vec3{ 0.0f }, forward, up) };
+            const Math::Mat4x4 projection{ Math::Mat4x4::PerspectiveFov(Math::Numeric::Pi / 2.0f, 1.0f, NEAR_Z, FAR_Z) };
+            return Math::FrustumFromViewProjection(view * projection);
+        }
+
+        // Faces of a point light shadow cube at the origin, in the +X, -X, +Y, -Y, +Z, -Z order of the shadow pass
+        std::array<Math::Frustum, 6u> CubeFaceFrustums()
+        {
+            return {
+                FrustumLookingTo(Math::Vec3{  1.0f,  0.0f,  0.0f }, Math::Vec3{ 0.0f, 1.0f,  0.0f }),
+                FrustumLookingTo(Math::Vec3{ -1.0f,  0.0f,  0.0f }, Math::Vec3{ 0.0f, 1.0f,  0.0f }),
+                FrustumLookingTo(Math::Vec3{  0.0f,  1.0f,  0.0f }, Math::Vec3{ 0.0f, 0.0f, -1.0f }),
+                FrustumLookingTo(Math::Vec3{  0.0f, -1.0f,  0.0f }, Math::Vec3{ 0.0f, 0.0f,  1.0f }),
+                FrustumLookingTo(Math::Vec3{  0.0f,  0.0f,  1.0f }, Math::Vec3{ 0.0f, 1.0f,  0.0f }),
+                FrustumLookingTo(Math::Vec3{  0.0f,  0.0f, -1.0f }, Math::Vec3{ 0.0f, 1.0f,  0.0f })
+            };
+        }
+
+        // Runs the batch test and checks it reports exactly the expected boxes in ascending order, the same as the scalar test
+        template <typename Volume>
+        void CheckBatch(const Volume& volume, std::span<const Math::AABB> aabbs, std::span<const uint32_t> expectedIndices)
+        {
+            std::vector<uint32_t> visibleIndices(aabbs.size());
+            const uint32_t visibleCount{ Math::Intersects(volume, aabbs, visibleIndices) };
+
+            DL_CHECK(visibleCount == expectedIndices.size());
+            DL_CHECK(std::ranges::equal(std::span{ visibleIndices }.first(std::min<size_t>(visibleCount, visibleIndices.size())), expectedIndices));
+
+            for (uint32_t i{ 0u }; i < aabbs.size(); ++i)
+                DL_CHECK(Math::Intersects(volume, aabbs[i]) == (std::ranges::find(expectedIndices, i) != expectedIndices.end()));
+        }
+    }
+
+    // Eleven boxes cover two full SIMD packets and the scalar tail
+    DL_TEST(FrustumBatchKeepsVisibleBoxesInOrder)
+    {
+        const Math::Frustum frustum{ FrustumLookingTo(Math::Vec3{ 0.0f, 0.0f, 1.0f }, Math::Vec3{ 0.0f, 1.0f, 0.0f }) };
+
+        const std::array<Math::AABB, 11u> aabbs{
+            BoxAt(Math::Vec3{  0.0f, 0.0f,   5.0f }, 0.5f), // Inside
+            BoxAt(Math::Vec3{  0.0f, 0.0f,  -5.0f }, 0.5f), // Behind the camera
+            BoxAt(Math::Vec3{  4.0f, 0.0f,   5.0f }, 0.5f), // Inside, close to the right plane
+            BoxAt(Math::Vec3{ 20.0f, 0.0f,   5.0f }, 0.5f), // Right of the frustum
+            BoxAt(Math::Vec3{  0.0f, 0.0f,  20.0f }, 0.5f), // Beyond the far plane
+            BoxAt(Math::Vec3{  0.0f, 0.0f,  10.0f }, 0.5f), // Crosses the far plane
+            BoxAt(Math::Vec3{  0.0f, 0.0f,   0.0f }, 0.5f), // Contains the camera
+            BoxAt(Math::Vec3{  0.0f, -9.0f,  5.0f }, 0.5f), // Below the frustum
+            BoxAt(Math::Vec3{  0.0f, 0.0f,   2.0f }, 0.5f), // Inside, in the tail
+            BoxAt(Math::Vec3{ -6.0f, 0.0f,   5.0f }, 1.5f), // Crosses the left plane, in the tail
+            BoxAt(Math::Vec3{  0.0f, 0.0f, -20.0f }, 0.5f)  // Behind the camera, in the tail
+        };
+
+        constexpr std::array<uint32_t, 6u> expectedIndices{ 0u, 2u, 5u, 6u, 8u, 9u };
+        CheckBatch(frustum, aabbs, expectedIndices);
+    }
+
+    DL_TEST(SphereBatchRejectsBoxesOutsideTheCorners)
+    {
+        const Math::Sphere sphere{ .Center = Math::Vec3{ 0.0f }, .Radius = 1.0f };
+
+        const std::array<Math::AABB, 6u> aabbs{
+            BoxAt(Math::Vec3{ 0.0f }, 0.1f),              // Inside
+            BoxAt(Math::Vec3{ 1.0f, 1.0f, 1.0f }, 0.2f),  // Overlaps the bounding box of the sphere, but not the sphere
+            BoxAt(Math::Vec3{ 1.0f, 0.0f, 0.0f }, 0.2f),  // Crosses the surface
+            BoxAt(Math::Vec3{ 3.0f, 0.0f, 0.0f }, 0.5f),  // Outside
+            BoxAt(Math::Vec3{ 0.0f }, 5.0f),              // Contains the sphere
+            BoxAt(Math::Vec3{ 0.0f, -1.1f, 0.0f }, 0.2f)  // Crosses the surface, in the tail
+        };
+
+        constexpr std::array<uint32_t, 4u> expectedIndices{ 0u, 2u, 4u, 5u };
+        CheckBatch(sphere, aabbs, expectedIndices);
+    }
+
+    // Fifteen boxes run an eight wide packet of the AVX2 backend, a four wide packet and the scalar tail
+    DL_TEST(BatchMatchesScalarTestOnEveryPacketWidth)
+    {
+        const Math::Frustum frustum{ FrustumLookingTo(Math::Vec3{ 0.0f, 0.0f, 1.0f }, Math::Vec3{ 0.0f, 1.0f, 0.0f }) };
+        const Math::Sphere sphere{ .Center = Math::Vec3{ 0.0f, 0.0f, 5.0f }, .Radius = 4.0f };
+
+        // A row of boxes across the frustum and the sphere, both volumes keep some of every packet
+        std::array<Math::AABB, 15u> aabbs{};
+        for (uint32_t i{ 0u }; i < aabbs.size(); ++i)
+            aabbs[i] = BoxAt(Math::Vec3{ (static_cast<float>(i) - 7.0f) * 1.5f, 0.0f, 5.0f }, 0.5f);
+
+        const auto visibleIndices{ [&aabbs](const auto& volume)
+        {
+            std::vector<uint32_t> indices{};
+            for (uint32_t i{ 0u }; i < aabbs.size(); ++i)
+                if (Math::Intersects(volume, aabbs[i]))
+                    indices.push_back(i);
+            return indices;
+        } };
+
+        const std::vector<uint32_t> frustumIndices{ visibleIndices(frustum) };
+        const std::vector<uint32_t> sphereIndices{ visibleIndices(sphere) };
+        DL_CHECK(frustumIndices.size() > 0u && frustumIndices.size() < aabbs.size());
+        DL_CHECK(sphereIndices.size() > 0u && sphereIndices.size() < frustumIndices.size());
+
+        CheckBatch(frustum, aabbs, frustumIndices);
+        CheckBatch(sphere, aabbs, sphereIndices);
+    }
+
+    DL_TEST(BatchOfNoBoxesIsEmpty)
+    {
+        const Math::Frustum frustum{ FrustumLookingTo(Math::Vec3{ 0.0f, 0.0f, 1.0f }, Math::Vec3{ 0.0f, 1.0f, 0.0f }) };
+        const Math::Sphere sphere{ .Center = Math::Vec3{ 0.0f }, .Radius = 1.0f };
+
+        DL_CHECK(Math::Intersects(frustum, std::span<const Math::AABB>{}, std::span<uint32_t>{}) == 0u);
+        DL_CHECK(Math::Intersects(sphere, std::span<const Math::AABB>{}, std::span<uint32_t>{}) == 0u);
+    }
+
+    // The cull records the nearest of the visible boxes only, the batch is sorted by it
+    DL_TEST(MinDistanceLooksAtTheIndexedBoxesOnly)
+    {
+        const std::array aabbs{ BoxAt(Math::Vec3{ 0.0f, 0.0f, 2.0f }, 0.5f), BoxAt(Math::Vec3{ 0.0f, 0.0f, 5.0f }, 0.5f), BoxAt(Math::Vec3{ 0.0f }, 1.0f) };
+        const std::array farIndices{ 1u, 0u };
+        const std::array insideIndices{ 2u };
+
+        DL_CHECK(std::abs(Math::MinDistanceSquared(Math::Vec3{ 0.0f }, aabbs, farIndices) - 1.5f * 1.5f) < 1.0e-5f);
+        DL_CHECK(Math::MinDistanceSquared(Math::Vec3{ 0.0f }, aabbs, insideIndices) == 0.0f);
+        DL_CHECK(Math::MinDistanceSquared(Math::Vec3{ 0.0f }, aabbs, std::span<const uint32_t>{}) == std::numeric_limits<float>::max());
+    }
+
+    DL_TEST(CubeFacesMaskHasOnlyTheFacesThatSeeABox)
+    {
+        const std::array<Math::Frustum, 6u> faceFrustums{ CubeFaceFrustums() };
+
+        const std::array<Math::AABB, 5u> aabbs{
+            BoxAt(Math::Vec3{  5.0f,  0.0f,  0.0f }, 0.5f), // +X
+            BoxAt(Math::Vec3{  0.0f, -5.0f,  0.0f }, 0.5f), // -Y
+            BoxAt(Math::Vec3{  0.0f,  0.0f, -5.0f }, 0.5f), // -Z
+            BoxAt(Math::Vec3{ 50.0f,  0.0f,  0.0f }, 0.5f), // Beyond the light radius
+            BoxAt(Math::Vec3{  0.0f }, 1.0f)                // Around the light
+        };
+
+        constexpr uint32_t POSITIVE_X_BIT{ 1u << 0u };
+        constexpr uint32_t NEGATIVE_Y_BIT{ 1u << 3u };
+        constexpr uint32_t NEGATIVE_Z_BIT{ 1u << 5u };
+        constexpr uint32_t ALL_FACES_MASK{ (1u << 6u) - 1u };
+
+        const auto Mask = [&](std::initializer_list<uint32_t> indices)
+            {
+                return Math::FrustumsIntersectionMask(faceFrustums, aabbs, std::span{ indices.begin(), indices.size() });
+            };
+
+        DL_CHECK(Mask({ 0u }) == POSITIVE_X_BIT);
+        DL_CHECK(Mask({ 1u }) == NEGATIVE_Y_BIT);
+        DL_CHECK(Mask({ 0u, 1u, 2u }) == (POSITIVE_X_BIT | NEGATIVE_Y_BIT | NEGATIVE_Z_BIT));
+        DL_CHECK(Mask({ 3u }) == 0u);
+        DL_CHECK(Mask({ 4u }) == ALL_FACES_MASK);
+        DL_CHECK(Mask({}) == 0u);
+    }
+
+    // Only the referenced boxes count, so the boxes culled by the light sphere do not light up faces
+    DL_TEST(CubeFacesMaskIgnoresUnreferencedBoxes)
+    {
+        const std::array<Math::Frustum, 6u> faceFrustums{ CubeFaceFrustums() };
+
+        const std::array<Math::AABB, 2u> aabbs{
+            BoxAt(Math::Vec3{ 5.0f, 0.0f, 0.0f }, 0.5f), // +X
+            BoxAt(Math::Vec3{ 0.0f, 0.0f, 5.0f }, 0.5f)  // +Z
+        };
+
+        constexpr std::array<uint32_t, 1u> indices{ 1u };
+        DL_CHECK(Math::FrustumsIntersectionMask(faceFrustums, aabbs, indices) == (1u << 4u));
+    }
+
+    // A millimetre triangle has a tiny cross product, it must not pass for parallel to a ray hitting it head on
+    DL_TEST(RayHitsSmallTriangle)
+    {
+        const Math::Triangle triangle{
+            .V0 = Math::Vec3{ -0.001f, -0.001f, 5.0f },
+            .V1 = Math::Vec3{  0.0f,    0.001f, 5.0f },
+            .V2 = Math::Vec3{  0.001f, -0.001f, 5.0f }
+        };
+
+        Math::IntersectInfo intersectInfo{};
+        DL_CHECK(Math::Intersects(Math::Ray{ .Origin = Math::Vec3{ 0.0f }, .Direction = Math::Vec3{ 0.0f, 0.0f, 1.0f } }, triangle, intersectInfo));
+        DL_CHECK(std::abs(intersectInfo.T - 5.0f) < 1e-4f);
+
+        // Grazing the plane is still parallel
+        DL_CHECK(!Math::Intersects(Math::Ray{ .Origin = Math::Vec3{ 0.0f, 0.0f, 5.0f }, .Direction = Math::Vec3{ 1.0f, 0.0f, 0.0f } }, triangle, intersectInfo));
+    }
+}
@@ -0,0 +1,219 @@
+#include "TestFramework.h"
+
+#include "DLEngine/Math/Mat4x4.h"
+#include "DLEngine/Math/Vec3.h"
+
+#include "DLEngine/Renderer/InstanceStore.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        constexpr uint32_t TRANSFORM_BINDING_POINT{ 1u };
+        constexpr uint32_t DATA_BINDING_POINT{ 2u };
+
+        // A transform column and a data column, as the shaders of the meshes have them
+        class LayoutOnlyShader : public Shader
+        {
+        public:
+            LayoutOnlyShader()
+            {
+                m_InputLayout[TRANSFORM_BINDING_POINT] = { VertexBufferLayout{ { "TRANSFORM", ShaderDataType::Mat4 } }, InputLayoutType::PerInstance, 1u };
+                m_InputLayout[DATA_BINDING_POINT] = {
+                    VertexBufferLayout{
+                        { "KEY"         , ShaderDataType::Uint  },
+                        { "ELAPSED_TIME", ShaderDataType::Float }
+                    },
+                    InputLayoutType::PerInstance, 1u
+                };
+            }
+
+            const std::string& GetName() const noexcept override { return m_Name; }
+            const std::map<uint32_t, InputLayoutSpecification>& GetInputLayout() const noexcept override { return m_InputLayout; }
+
+        private:
+            std::string m_Name{ "LayoutOnly" };
+            std::map<uint32_t, InputLayoutSpecification> m_InputLayout;
+        };
+
+        // Every column of the row holds a value derived from the same key, so a column left behind by a free is caught
+        InstanceStore::ID AllocateKeyed(InstanceStore& store, uint32_t key)
+        {
+            const InstanceStore::ID id{ store.Allocate() };
+
+            const Math::Mat4x4 transform{ Math::Mat4x4::Translate(Math::Vec3{ static_cast<float>(key), 0.0f, 0.0f }) };
+            const float elapsedTime{ static_cast<float>(key) * 0.5f };
+            store.Set(id, store.GetTransformHandle(), Buffer{ &transform, sizeof(Math::Mat4x4) });
+            store.Set(id, store.GetUniformHandle("KEY"), Buffer{ &key, sizeof(uint32_t) });
+            store.Set(id, store.GetUniformHandle("ELAPSED_TIME"), Buffer{ &elapsedTime, sizeof(float) });
+
+            return id;
+        }
+
+        bool IsRowOf(const InstanceStore& store, InstanceStore::ID id, uint32_t key)
+        {
+            return store.Get<uint32_t>(id, store.GetUniformHandle("KEY")) == key &&
+                store.Get<float>(id, store.GetUniformHandle("ELAPSED_TIME")) == static_cast<float>(key) * 0.5f &&
+                store.Get<Math::Mat4x4>(id, store.GetTransformHandle())._41 == static_cast<float>(key);
+        }
+    }
+
+    DL_TEST(InstanceStoreColumnsFollowTheLayouts)
+    {
+        InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+        DL_CHECK(store.HasUniform("TRANSFORM"));
+        DL_CHECK(store.GetTransformHandle().IsValid());
+        DL_CHECK(!store.GetUniformHandle("MISSING").IsValid());
+
+        const UniformHandle elapsedTimeHandle{ store.GetUniformHandle("ELAPSED_TIME") };
+        DL_CHECK(elapsedTimeHandle.Offset == sizeof(uint32_t));
+        DL_CHECK(elapsedTimeHandle.Size == sizeof(float));
+
+        // New rows are zeroed
+        const InstanceStore::ID id{ store.Allocate() };
+        DL_CHECK(store.Get<float>(id, elapsedTimeHandle) == 0.0f);
+        DL_CHECK(store.GetRow(id, DATA_BINDING_POINT).Size == sizeof(uint32_t) + sizeof(float));
+        DL_CHECK(store.GetColumnData(TRANSFORM_BINDING_POINT).Size == sizeof(Math::Mat4x4));
+    }
+
+    // Freeing moves the last row into the freed one: the columns stay dense and the IDs keep addressing their rows
+    DL_TEST(InstanceStoreFreeKeepsColumnsDense)
+    {
+        InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+
+        std::vector<InstanceStore::ID> ids{};
+        for (uint32_t key{ 0u }; key < 8u; ++key)
+            ids.push_back(AllocateKeyed(store, key));
+
+        store.Free(ids[2u]);
+        store.Free(ids[0u]);
+        store.Free(ids[7u]);
+        DL_CHECK(store.GetInstanceCount() == 5u);
+        DL_CHECK(store.GetColumnData(TRANSFORM_BINDING_POINT).Size == 5u * sizeof(Math::Mat4x4));
+        DL_CHECK(store.GetColumnData(DATA_BINDING_POINT).Size == 5u * (sizeof(uint32_t) + sizeof(float)));
+
+        for (const uint32_t key : { 1u, 3u, 4u, 5u, 6u })
+            DL_CHECK(IsRowOf(store, ids[key], key));
+
+        // The columns hold exactly the live rows, row i belongs to GetID(i)
+        const std::span<const Math::Mat4x4> transforms{ store.GetColumn<Math::Mat4x4>(TRANSFORM_BINDING_POINT) };
+        DL_CHECK(transforms.size() == 5u);
+        for (uint32_t row{ 0u }; row < store.GetInstanceCount(); ++row)
+        {
+            DL_CHECK(store.GetRowIndex(store.GetID(row)) == row);
+            DL_CHECK(transforms[row]._41 == store.Get<Math::Mat4x4>(store.GetID(row), store.GetTransformHandle())._41);
+        }
+    }
+
+    DL_TEST(InstanceStoreFreedIDsAreStale)
+    {
+        InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+
+        const InstanceStore::ID freed{ AllocateKeyed(store, 1u) };
+        DL_CHECK(store.Contains(freed));
+        DL_CHECK(!store.Contains(InstanceStore::ID{}));
+
+        store.Free(freed);
+        DL_CHECK(!store.Contains(freed));
+
+        // The slot is reused by the next row, the old ID still does not address it
+        const InstanceStore::ID reused{ AllocateKeyed(store, 2u) };
+        DL_CHECK(reused.Slot == freed.Slot);
+        DL_CHECK(!store.Contains(freed));
+        DL_CHECK(IsRowOf(store, reused, 2u));
+    }
+
+    DL_TEST(InstanceStoreAllocateCopiesTheSourceRow)
+    {
+        InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+
+        const InstanceStore::ID source{ AllocateKeyed(store, 3u) };
+        const InstanceStore::ID copy{ store.Allocate(source) };
+        DL_CHECK(IsRowOf(store, copy, 3u));
+
+        const uint32_t key{ 4u };
+        store.Set(copy, store.GetUniformHandle("KEY"), Buffer{ &key, sizeof(uint32_t) });
+        DL_CHECK(IsRowOf(store, source, 3u));
+    }
+
+    // Every Set bumps the data version of its row, only a Set of the transform bumps the transform version
+    DL_TEST(InstanceStoreVersionsTrackSets)
+    {
+        InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+
+        const InstanceStore::ID other{ store.Allocate() };
+        const InstanceStore::ID id{ store.Allocate() };
+        const uint32_t dataVersion{ store.GetDataVersion(id) };
+        const uint32_t transformVersion{ store.GetTransformVersion(id) };
+
+        const float elapsedTime{ 1.0f };
+        store.Set(id, store.GetUniformHandle("ELAPSED_TIME"), Buffer{ &elapsedTime, sizeof(float) });
+        DL_CHECK(store.GetDataVersion(id) == dataVersion + 1u);
+        DL_CHECK(store.GetTransformVersion(id) == transformVersion);
+
+        const Math::Mat4x4 transform{ Math::Mat4x4::Identity() };
+        store.Set(id, store.GetTransformHandle(), Buffer{ &transform, sizeof(Math::Mat4x4) });
+        DL_CHECK(store.GetDataVersion(id) == dataVersion + 2u);
+        DL_CHECK(store.GetTransformVersion(id) == transformVersion + 1u);
+        DL_CHECK(store.GetDataVersion(other) == dataVersion);
+
+        // The versions move with their rows, freeing the first row moves the last one into its place
+        const uint32_t movedVersion{ store.GetDataVersion(id) };
+        store.Free(other);
+        DL_CHECK(store.GetRowIndex(id) == 0u);
+        DL_CHECK(store.GetDataVersion(id) == movedVersion);
+        DL_CHECK(store.GetDataVersions()[store.GetRowIndex(id)] == movedVersion);
+    }
+
+    // EditColumn counts as a Set of every row, of the transform only when the column holds it
+    DL_TEST(InstanceStoreEditColumnBumpsEveryRow)
+    {
+        InstanceStore store{ CreateRef<LayoutOnlyShader>() };
+
+        const InstanceStore::ID first{ AllocateKeyed(store, 1u) };
+        const InstanceStore::ID second{ AllocateKeyed(store, 2u) };
+        const uint32_t firstTransformVersion{ store.GetTransformVersion(first) };
+        const uint32_t secondDataVersion{ store.GetDataVersion(second) };
+
+        for (Math::Mat4x4& transform : store.EditColumn<Math::Mat4x4>(TRANSFORM_BINDING_POINT))
+            transform._42 = 1.0f;
+        DL_CHECK(store.GetTransformVersion(first) == firstTransformVersion + 1u);
+        DL_CHECK(store.GetDataVersion(second) == secondDataVersion + 1u);
+        DL_CHECK(store.Get<Math::Mat4x4>(second, store.GetTransformHandle())._42 == 1.0f);
+
+        struct Data
+        {
+            uint32_t Key;
+            float ElapsedTime;
+        };
+        const std::span<Data> data{ store.EditColumn<Data>(DATA_BINDING_POINT) };
+        DL_CHECK(data.size() == 2u);
+        DL_CHECK(store.GetTransformVersion(first) == firstTransformVersion + 1u);
+        DL_CHECK(store.GetDataVersion(second) == secondDataVersion + 2u);
+    }
+
+    // The library hands out one store per shader while it is in use and keeps none alive
+    DL_TEST(InstanceStoreLibraryReleasesUnusedStores)
+    {
+        InstanceStoreLibrary library{};
+        const Ref<Shader> shader{ CreateRef<LayoutOnlyShader>() };
+
+        Ref<InstanceStore> store{ library.Get(shader) };
+        DL_CHECK(library.Get(shader) == store);
+
+        const std::weak_ptr<InstanceStore> released{ store };
+        store.reset();
+        DL_CHECK(released.expired());
+        DL_CHECK(shader.use_count() == 1);
+
+        store = library.Get(shader);
+        DL_CHECK(store != nullptr);
+        DL_CHECK(store->GetShader() == shader);
+
+        // A shader loaded again under the same name gets a store of its own
+        const Ref<Shader> reloaded{ CreateRef<LayoutOnlyShader>() };
+        const Ref<InstanceStore> reloadedStore{ library.Get(reloaded) };
+        DL_CHECK(reloadedStore != store);
+        DL_CHECK(reloadedStore->GetShader() == reloaded);
+    }
+}
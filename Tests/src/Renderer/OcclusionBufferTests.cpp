@@ -0,0 +1,189 @@
+#include "TestFramework.h"
+
+#include "DLEngine/Math/BatchTransform.h"
+#include "DLEngine/Math/Math.h"
+
+#include "DLEngine/Renderer/Mesh/Mesh.h"
+#include "DLEngine/Renderer/OcclusionBuffer.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        constexpr float NEAR_Z{ 0.1f };
+        constexpr float FAR_Z{ 100.0f };
+
+        Math::AABB BoxAt(const Math::Vec3& center, float halfSize)
+        {
+            return Math::AABB{ .Min = center - Math::Vec3{ halfSize }, .Max = center + Math::Vec3{ halfSize } };
+        }
+
+        // Camera at the origin looking down +Z, with the aspect ratio of the buffer
+        Math::Mat4x4 CreateViewProjection()
+        {
+            const Math::Mat4x4 view{ Math::Mat4x4::LookTo(Math::Vec3{ 0.0f }, Math::Vec3{ 0.0f, 0.0f, 1.0f }, Math::Vec3{ 0.0f, 1.0f, 0.0f }) };
+            const Math::Mat4x4 projection{ Math::Mat4x4::PerspectiveFov(Math::Numeric::Pi / 2.0f,
+                static_cast<float>(OcclusionBuffer::Width) / static_cast<float>(OcclusionBuffer::Height), NEAR_Z, FAR_Z
+            ) };
+            return view * projection;
+        }
+
+        // Unit quad in the XY plane, facing the camera
+        Submesh CreateQuad()
+        {
+            std::vector<Submesh::Vertex> vertices{
+                Submesh::Vertex{ .Position = Math::Vec3{ -1.0f, -1.0f, 0.0f } },
+                Submesh::Vertex{ .Position = Math::Vec3{ -1.0f,  1.0f, 0.0f } },
+                Submesh::Vertex{ .Position = Math::Vec3{  1.0f,  1.0f, 0.0f } },
+                Submesh::Vertex{ .Position = Math::Vec3{  1.0f, -1.0f, 0.0f } }
+            };
+            std::vector<Submesh::Triangle> triangles{ Submesh::Triangle{ 0u, 1u, 2u }, Submesh::Triangle{ 0u, 2u, 3u } };
+
+            return Submesh{ "Quad", std::move(vertices), std::move(triangles) };
+        }
+
+        // Closed unit cube around the origin
+        Submesh CreateCube()
+        {
+            std::vector<Submesh::Vertex> vertices;
+            for (uint32_t corner{ 0u }; corner < 8u; ++corner)
+            {
+                vertices.push_back(Submesh::Vertex{ .Position = Math::Vec3{
+                    corner & 1u ? 1.0f : -1.0f,
+                    corner & 2u ? 1.0f : -1.0f,
+                    corner & 4u ? 1.0f : -1.0f
+                } });
+            }
+
+            std::vector<Submesh::Triangle> triangles{
+                Submesh::Triangle{ 0u, 2u, 3u }, Submesh::Triangle{ 0u, 3u, 1u }, // -Z
+                Submesh::Triangle{ 4u, 5u, 7u }, Submesh::Triangle{ 4u, 7u, 6u }, // +Z
+                Submesh::Triangle{ 0u, 4u, 6u }, Submesh::Triangle{ 0u, 6u, 2u }, // -X
+                Submesh::Triangle{ 1u, 3u, 7u }, Submesh::Triangle{ 1u, 7u, 5u }, // +X
+                Submesh::Triangle{ 0u, 1u, 5u }, Submesh::Triangle{ 0u, 5u, 4u }, // -Y
+                Submesh::Triangle{ 2u, 6u, 7u }, Submesh::Triangle{ 2u, 7u, 3u }  // +Y
+            };
+
+            return Submesh{ "Cube", std::move(vertices), std::move(triangles) };
+        }
+
+        Math::AABB GetWorldBounds(const Submesh& submesh, const Math::Mat4x4& meshToWorld)
+        {
+            Math::AABB worldBounds{};
+            Math::TransformAABBs(std::span{ &submesh.GetBoundingBox(), 1u }, meshToWorld, std::span{ &worldBounds, 1u });
+            return worldBounds;
+        }
+
+        // A quad at z = 5 that covers the whole screen
+        const Math::Mat4x4& GetWallToWorld()
+        {
+            static const Math::Mat4x4 s_WallToWorld{ Math::Mat4x4::Scale(Math::Vec3{ 50.0f }) * Math::Mat4x4::Translate(Math::Vec3{ 0.0f, 0.0f, 5.0f }) };
+            return s_WallToWorld;
+        }
+    }
+
+    DL_TEST(EmptyBufferOccludesNothing)
+    {
+        OcclusionBuffer occlusionBuffer{};
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders({});
+
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f, 0.0f, 10.0f }, 1.0f)));
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f, 0.0f, 90.0f }, 1.0f)));
+    }
+
+    DL_TEST(BoxBehindAWallIsOccluded)
+    {
+        const Submesh quad{ CreateQuad() };
+        const std::array<OcclusionBuffer::Occluder, 1u> occluders{ OcclusionBuffer::Occluder{ .SourceSubmesh = &quad, .MeshToWorld = GetWallToWorld() } };
+
+        OcclusionBuffer occlusionBuffer{};
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders(occluders);
+
+        DL_CHECK(occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f, 0.0f, 10.0f }, 1.0f)));
+        DL_CHECK(occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 6.0f, -2.0f, 20.0f }, 3.0f)));
+
+        // In front of the wall and crossing it
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f, 0.0f, 2.0f }, 1.0f)));
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f, 0.0f, 5.0f }, 1.0f)));
+    }
+
+    // The corners behind the camera cannot be projected, so such boxes are kept even behind a wall that covers the screen
+    DL_TEST(BoxCrossingTheNearPlaneIsNeverOccluded)
+    {
+        const Submesh quad{ CreateQuad() };
+        const std::array<OcclusionBuffer::Occluder, 1u> occluders{ OcclusionBuffer::Occluder{ .SourceSubmesh = &quad, .MeshToWorld = GetWallToWorld() } };
+
+        OcclusionBuffer occlusionBuffer{};
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders(occluders);
+
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f }, 0.5f)));
+        DL_CHECK(!occlusionBuffer.IsOccluded(Math::AABB{ .Min = Math::Vec3{ -1.0f, -1.0f, -1.0f }, .Max = Math::Vec3{ 1.0f, 1.0f, 20.0f } }));
+    }
+
+    // Nothing is known about the depth outside of the screen
+    DL_TEST(OffScreenBoxIsNeverOccluded)
+    {
+        const Submesh quad{ CreateQuad() };
+        const std::array<OcclusionBuffer::Occluder, 1u> occluders{ OcclusionBuffer::Occluder{ .SourceSubmesh = &quad, .MeshToWorld = GetWallToWorld() } };
+
+        OcclusionBuffer occlusionBuffer{};
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders(occluders);
+
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 100.0f, 0.0f, 10.0f }, 1.0f)));
+        DL_CHECK(!occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 0.0f, -50.0f, 10.0f }, 1.0f)));
+    }
+
+    // The depth bias has to keep the front faces of an occluder from hiding its own bounds
+    DL_TEST(OccluderDoesNotHideItself)
+    {
+        const Submesh quad{ CreateQuad() };
+        const Submesh cube{ CreateCube() };
+
+        const Math::Mat4x4 cubeToWorld{ Math::Mat4x4::Rotate(0.3f, 0.7f, 0.0f) * Math::Mat4x4::Translate(Math::Vec3{ 1.0f, 0.5f, 8.0f }) };
+        const std::array<OcclusionBuffer::Occluder, 2u> occluders{
+            OcclusionBuffer::Occluder{ .SourceSubmesh = &quad, .MeshToWorld = GetWallToWorld() },
+            OcclusionBuffer::Occluder{ .SourceSubmesh = &cube, .MeshToWorld = cubeToWorld }
+        };
+
+        OcclusionBuffer occlusionBuffer{};
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders(std::span{ occluders }.last(1u));
+
+        DL_CHECK(!occlusionBuffer.IsOccluded(GetWorldBounds(cube, cubeToWorld)));
+        DL_CHECK(occlusionBuffer.IsOccluded(BoxAt(Math::Vec3{ 1.0f, 0.5f, 20.0f }, 0.2f)));
+
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders(occluders);
+
+        DL_CHECK(!occlusionBuffer.IsOccluded(GetWorldBounds(quad, GetWallToWorld())));
+    }
+
+    DL_TEST(RemoveOccludedKeepsVisibleBoxesInOrder)
+    {
+        const Submesh quad{ CreateQuad() };
+        const std::array<OcclusionBuffer::Occluder, 1u> occluders{ OcclusionBuffer::Occluder{ .SourceSubmesh = &quad, .MeshToWorld = GetWallToWorld() } };
+
+        OcclusionBuffer occlusionBuffer{};
+        occlusionBuffer.Clear(CreateViewProjection());
+        occlusionBuffer.RasterizeOccluders(occluders);
+
+        const std::array<Math::AABB, 5u> aabbs{
+            BoxAt(Math::Vec3{ 0.0f, 0.0f, 10.0f }, 1.0f),   // Behind the wall
+            BoxAt(Math::Vec3{ 0.0f, 0.0f,  2.0f }, 1.0f),   // In front of the wall
+            BoxAt(Math::Vec3{ 2.0f, 1.0f, 30.0f }, 1.0f),   // Behind the wall
+            BoxAt(Math::Vec3{ 100.0f, 0.0f, 10.0f }, 1.0f), // Off screen
+            BoxAt(Math::Vec3{ 0.0f }, 0.5f)                 // Around the camera
+        };
+
+        std::array<uint32_t, 4u> indices{ 4u, 2u, 1u, 0u };
+        const uint32_t visibleCount{ occlusionBuffer.RemoveOccluded(aabbs, indices) };
+
+        constexpr std::array<uint32_t, 2u> expectedIndices{ 4u, 1u };
+        DL_CHECK(visibleCount == expectedIndices.size());
+        DL_CHECK(std::ranges::equal(std::span{ indices }.first(std::min<size_t>(visibleCount, indices.size())), expectedIndices));
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "DLEngine/Core/Headless.h"
+
+namespace DLEngine::Tests
+{
+    using TestFunc = void();
+
+    // Fails the running test, which keeps running so every failed check of it is reported
+    void ReportFailure(std::string_view condition, std::string_view file, int line);
+}
+
+#define DL_TEST(name) DL_HEADLESS_ENTRY(::DLEngine::Tests::TestFunc, name)
+
+#define DL_CHECK(condition) { if (!(condition)) ::DLEngine::Tests::ReportFailure(#condition, __FILE__, __LINE__); }
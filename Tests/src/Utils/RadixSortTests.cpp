@@ -0,0 +1,115 @@
+#include "TestFramework.h"
+
+#include "DLEngine/Utils/RadixSort.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        constexpr size_t MAX_DISPLACEMENT{ 4u };
+        constexpr float MAX_SHIFTS_PER_ELEMENT{ 1.0f };
+
+        // Keys 0 to count - 1 in order, every payload is its own key, so a key separated from its payload is caught
+        void FillSorted(std::vector<float>& keys, std::vector<uint32_t>& payloads, uint32_t count)
+        {
+            payloads.resize(count);
+            std::iota(payloads.begin(), payloads.end(), 0u);
+
+            keys.resize(count);
+            std::ranges::transform(payloads, keys.begin(), [](uint32_t payload) { return static_cast<float>(payload); });
+        }
+
+        bool Repair(std::vector<float>& keys, std::vector<uint32_t>& payloads, float maxShiftsPerElement = MAX_SHIFTS_PER_ELEMENT)
+        {
+            return Utils::RepairSortedOrder<float, uint32_t>(keys, payloads, MAX_DISPLACEMENT, maxShiftsPerElement);
+        }
+
+        bool KeysKeepTheirPayloads(std::span<const float> keys, std::span<const uint32_t> payloads)
+        {
+            return std::ranges::equal(keys, payloads, {}, {}, [](uint32_t payload) { return static_cast<float>(payload); });
+        }
+    }
+
+    DL_TEST(RepairOfSortedKeysChangesNothing)
+    {
+        std::vector<float> keys;
+        std::vector<uint32_t> payloads;
+        FillSorted(keys, payloads, 100u);
+
+        DL_CHECK(Repair(keys, payloads));
+        DL_CHECK(std::ranges::is_sorted(keys));
+        DL_CHECK(KeysKeepTheirPayloads(keys, payloads));
+
+        std::vector<float> noKeys;
+        std::vector<uint32_t> noPayloads;
+        DL_CHECK(Repair(noKeys, noPayloads));
+    }
+
+    // Neighbours swapped all over the array, the way particles pass each other while the camera barely moves
+    DL_TEST(RepairRestoresSwappedNeighbours)
+    {
+        std::vector<float> keys;
+        std::vector<uint32_t> payloads;
+        FillSorted(keys, payloads, 1000u);
+
+        for (size_t i{ 0u }; i + 1u < keys.size(); i += 7u)
+        {
+            std::swap(keys[i], keys[i + 1u]);
+            std::swap(payloads[i], payloads[i + 1u]);
+        }
+
+        // An element two places from its spot in the tail
+        std::swap(keys[997u], keys[999u]);
+        std::swap(payloads[997u], payloads[999u]);
+
+        DL_CHECK(Repair(keys, payloads));
+        DL_CHECK(std::ranges::is_sorted(keys));
+        DL_CHECK(KeysKeepTheirPayloads(keys, payloads));
+    }
+
+    // Equal keys keep their order, like the radix sort the repair stands in for
+    DL_TEST(RepairIsStable)
+    {
+        std::vector<float> keys{ 1.0f, 2.0f, 1.0f, 3.0f, 2.0f };
+        std::vector<uint32_t> payloads{ 0u, 1u, 2u, 3u, 4u };
+
+        DL_CHECK(Repair(keys, payloads));
+        DL_CHECK(std::ranges::equal(keys, std::array{ 1.0f, 1.0f, 2.0f, 2.0f, 3.0f }));
+        DL_CHECK(std::ranges::equal(payloads, std::array{ 0u, 2u, 1u, 4u, 3u }));
+    }
+
+    // The element of key 10 is moved 40 places after its spot, the repair would have to move it back that far
+    DL_TEST(RepairGivesUpOnAnElementFarFromItsPlace)
+    {
+        std::vector<float> keys;
+        std::vector<uint32_t> payloads;
+        FillSorted(keys, payloads, 100u);
+
+        std::rotate(keys.begin() + 10u, keys.begin() + 11u, keys.begin() + 51u);
+        std::rotate(payloads.begin() + 10u, payloads.begin() + 11u, payloads.begin() + 51u);
+
+        DL_CHECK(!Repair(keys, payloads));
+        DL_CHECK(KeysKeepTheirPayloads(keys, payloads));
+    }
+
+    // Every element is within the displacement bound, but together they move more than the shifts bound allows
+    DL_TEST(RepairGivesUpOnTooManyShifts)
+    {
+        std::vector<float> keys;
+        std::vector<uint32_t> payloads;
+        FillSorted(keys, payloads, 100u);
+
+        // Reversed groups of four cost 1.5 shifts per element
+        for (size_t i{ 0u }; i < keys.size(); i += MAX_DISPLACEMENT)
+        {
+            std::reverse(keys.begin() + i, keys.begin() + i + MAX_DISPLACEMENT);
+            std::reverse(payloads.begin() + i, payloads.begin() + i + MAX_DISPLACEMENT);
+        }
+
+        DL_CHECK(!Repair(keys, payloads, MAX_SHIFTS_PER_ELEMENT * 0.5f));
+        DL_CHECK(KeysKeepTheirPayloads(keys, payloads));
+
+        DL_CHECK(Repair(keys, payloads, MAX_SHIFTS_PER_ELEMENT * 2.0f));
+        DL_CHECK(std::ranges::is_sorted(keys));
+    }
+}
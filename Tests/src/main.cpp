@@ -0,0 +1,50 @@
+#include "TestFramework.h"
+
+namespace DLEngine::Tests
+{
+    namespace
+    {
+        uint32_t s_FailedChecksCount{ 0u };
+    }
+
+    void ReportFailure(std::string_view condition, std::string_view file, int line)
+    {
+        DL_LOG_ERROR_TAG("Tests", "{0}({1}): check failed: {2}", file, line, condition);
+        ++s_FailedChecksCount;
+    }
+}
+
+// Headless, nothing here creates a window or a device. The optional argument runs only the tests whose name contains it.
+// Returns the number of failed tests, so a build step or a script can tell that something broke
+int main(int argc, char** argv)
+{
+    using namespace DLEngine::Tests;
+
+    DLEngine::Log::Init();
+
+    const std::string_view filter{ argc > 1 ? argv[1] : "" };
+
+    int failedTestsCount{ 0 };
+    for (const auto& [name, func] : DLEngine::Headless::GetSortedEntries<TestFunc>())
+    {
+        if (name.find(filter) == std::string_view::npos)
+            continue;
+
+        const uint32_t failedChecksBefore{ s_FailedChecksCount };
+        func();
+
+        if (s_FailedChecksCount == failedChecksBefore)
+        {
+            DL_LOG_INFO_TAG("Tests", "[  OK  ] {0}", name);
+        }
+        else
+        {
+            DL_LOG_ERROR_TAG("Tests", "[FAILED] {0}", name);
+            ++failedTestsCount;
+        }
+    }
+
+    DL_LOG_INFO_TAG("Tests", "{0} failed", failedTestsCount);
+
+    return failedTestsCount;
+}